@@ -0,0 +1,34 @@
+(function() {
+    // Returns true if a form field of the page has been edited since it was loaded
+    var isFieldModified = function(elem) {
+        var tagName = elem.nodeName.toLowerCase();
+        if (tagName == 'select') {
+            for (var i = 0; i < elem.options.length; ++i) {
+                if (elem.options[i].selected != elem.options[i].defaultSelected) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        var eType = (elem.type !== undefined) ? elem.type.toLowerCase() : '';
+        if (eType == 'checkbox' || eType == 'radio') {
+            return elem.checked != elem.defaultChecked;
+        }
+        if (eType == 'hidden' || eType == 'submit' || eType == 'button' || eType == 'reset' || eType == 'image' || eType == 'file') {
+            return false;
+        }
+        return elem.value != elem.defaultValue;
+    };
+
+    var fields = document.querySelectorAll('input, textarea, select');
+    for (var i = 0; i < fields.length; ++i) {
+        if (isFieldModified(fields[i])) {
+            return true;
+        }
+    }
+
+    // Rich text editors use editable elements rather than form fields
+    var active = document.activeElement;
+    return active != null && active.isContentEditable === true && active.textContent.length > 0;
+})();
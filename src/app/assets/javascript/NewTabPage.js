@@ -56,7 +56,7 @@ const cellTemplate = '<div class="cell" draggable="true"><div class="closeContai
             + '<div class="titleContainer"><div class="titleTextWrapper"><span class="title">{{title}}</span></div></div></a></div></div>';
 const cellTemplateNoThumbnail = '<div class="cell" draggable="true"><div class="closeContainer">'
             + '<span data-elemid="{{id}}" class="close">&times;</span></div><div class="thumbnailContainer"><a href="{{url}}">'
-            + '<div class="thumbnail thumbnailMock"></div><div class="titleContainer"><div class="titleTextWrapper">'
+            + '<div class="thumbnail thumbnailMock"><img class="favicon" src="{{favicon}}" alt=""></div><div class="titleContainer"><div class="titleTextWrapper">'
             + '<span class="title">{{title}}</span></div></div></a></div></div>';
 
 // Callback when user pins a page to the set
@@ -66,7 +66,8 @@ formAddPageElem.onsubmit = function(e) {
     let cardInfo = {
         url: inputPageUrl.value,
         title: inputPageTitle.value,
-        thumbnail: ''
+        thumbnail: '',
+        favicon: 'viper://favicon/' + encodeURIComponent(inputPageUrl.value)
     };
     
     if (cardInfo.url == '')
@@ -86,7 +87,8 @@ formAddPageElem.onsubmit = function(e) {
     let cardHtml = cellTemplateNoThumbnail.replace(/{{id}}/g, cardId)
                                           .replace(/{{url}}/g, cardInfo.url)
                                           .replace(/{{title}}/g, cardInfo.title)
-                                          .replace(/{{imgSrc}}/g, cardInfo.thumbnail);
+                                          .replace(/{{imgSrc}}/g, cardInfo.thumbnail)
+                                          .replace(/{{favicon}}/g, cardInfo.favicon);
     
     let mainContainer = document.getElementById('mainGrid');
     mainContainer.removeChild(mainContainer.lastChild);
@@ -128,6 +130,7 @@ document.addEventListener('click', function(e) {
         itemHtml = itemHtml.replace(/{{id}}/g, nextItem)
                            .replace(/{{url}}/g, item.url)
                            .replace(/{{imgSrc}}/g, item.thumbnail)
+                           .replace(/{{favicon}}/g, item.favicon)
                            .replace(/{{title}}/g, item.title);
         mainContainer.innerHTML += itemHtml;
         ++nextItem;
@@ -151,6 +154,7 @@ getFavoritePages().then(function(result) {
         itemHtml = itemHtml.replace(/{{id}}/g, i)
                            .replace(/{{url}}/g, item.url)
                            .replace(/{{imgSrc}}/g, item.thumbnail)
+                           .replace(/{{favicon}}/g, item.favicon)
                            .replace(/{{title}}/g, item.title);
         mainContainer.innerHTML += itemHtml;
     }
@@ -5,6 +5,7 @@
 #include "MainWindow.h"
 #include "SecurityManager.h"
 #include "SchemeRegistry.h"
+#include "Tracer.h"
 #include "URLSuggestion.h"
 #include "WebWidget.h"
 #include "ui/welcome_window/WelcomeWindow.h"
@@ -133,6 +134,20 @@ int main(int argc, char *argv[])
         }
     }
 
+    // Check for the trace flag, in the form "--trace" or "--trace=/path/to/trace.json". When specified, startup and
+    // runtime events are recorded and written as a Chrome trace event file when the browser exits
+    std::vector<bool> isTraceArg(static_cast<size_t>(argc), false);
+    for (int i = 1; i < argc; ++i)
+    {
+        if (strcmp(argv[i], "--trace") == 0 || strncmp(argv[i], "--trace=", 8) == 0)
+        {
+            const char *traceFile = argv[i][7] == '=' ? &argv[i][8] : "viper-trace.json";
+            Tracer::instance().start(traceFile);
+            Tracer::instance().setThreadName("Main");
+            isTraceArg[static_cast<size_t>(i)] = true;
+        }
+    }
+
 #ifndef Q_OS_WIN
     qInstallMessageHandler(&viperQtMessageHandler);
 #endif
@@ -154,6 +169,9 @@ int main(int argc, char *argv[])
     {
         for (int i = 1; i < argc; ++i)
         {
+            if (isTraceArg[static_cast<size_t>(i)])
+                continue;
+
             QString arg(argv[i]);
             QUrl url = QUrl::fromUserInput(arg);
             if (!url.isEmpty() && !url.scheme().isEmpty() && url.isValid())
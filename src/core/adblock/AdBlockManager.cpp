@@ -6,6 +6,7 @@
 #include "InternalDownloadItem.h"
 #include "DownloadManager.h"
 #include "SchemeRegistry.h"
+#include "Tracer.h"
 
 #include <QDir>
 #include <QDirIterator>
@@ -607,12 +608,20 @@ void AdBlockManager::onSettingChanged(BrowserSetting setting, const QVariant &va
 
 void AdBlockManager::loadSubscriptions()
 {
+    applySubscriptions(readSubscriptions());
+}
+
+AdBlockManager::SubscriptionConfig AdBlockManager::readSubscriptions()
+{
+    VIPER_TRACE_SCOPE("adblock", "AdBlockManager::readSubscriptions");
+
+    SubscriptionConfig config { std::vector<Subscription>(), 0 };
     if (!m_enabled)
-        return;
+        return config;
 
     QFile configFile(m_configFile);
     if (!configFile.exists() || !configFile.open(QIODevice::ReadOnly))
-        return;
+        return config;
 
     // Attempt to parse config/subscription info file
     QByteArray configData = configFile.readAll();
@@ -627,7 +636,7 @@ void AdBlockManager::loadSubscriptions()
         const QString key = it.key();
         if (key.compare(QLatin1String("requests_blocked")) == 0)
         {
-            m_requestHandler->setTotalNumberOfBlockedRequests(it.value().toString().toULongLong());
+            config.RequestsBlocked = it.value().toString().toULongLong();
             continue;
         }
         Subscription subscription(key);
@@ -662,10 +671,42 @@ void AdBlockManager::loadSubscriptions()
         if (!source.isEmpty())
             subscription.setSourceUrl(QUrl(source));
 
-        m_subscriptions.push_back(std::move(subscription));
+        // Filters are parsed here, rather than by extractFilters(), so that the parsing happens on the calling thread
+        subscription.load(this);
+
+        config.Subscriptions.push_back(std::move(subscription));
     }
 
-    extractFilters();
+    return config;
+}
+
+void AdBlockManager::applySubscriptions(SubscriptionConfig &&config)
+{
+    VIPER_TRACE_SCOPE("adblock", "AdBlockManager::applySubscriptions");
+
+    if (config.RequestsBlocked > 0)
+        m_requestHandler->setTotalNumberOfBlockedRequests(config.RequestsBlocked);
+
+    if (config.Subscriptions.empty())
+        return;
+
+    const bool hasModel = m_adBlockModel != nullptr;
+    const int firstRow = static_cast<int>(m_subscriptions.size());
+    if (hasModel)
+        m_adBlockModel->beginInsertRows(QModelIndex(), firstRow, firstRow + static_cast<int>(config.Subscriptions.size()) - 1);
+
+    for (Subscription &subscription : config.Subscriptions)
+        m_subscriptions.push_back(std::move(subscription));
+
+    if (hasModel)
+        m_adBlockModel->endInsertRows();
+
+    m_domainStylesheetCache.clear();
+    m_jsInjectionCache.clear();
+
+    // The filters of the new subscriptions were already parsed by readSubscriptions()
+    clearFilters();
+    m_filterContainer.extractFilters(m_subscriptions);
 }
 
 void AdBlockManager::clearFilters()
@@ -681,6 +722,7 @@ void AdBlockManager::extractFilters()
         s.load(this);
     }
 
+    VIPER_TRACE_SCOPE("adblock", "FilterContainer::extractFilters");
     m_filterContainer.extractFilters(m_subscriptions);
 }
 
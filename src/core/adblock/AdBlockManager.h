@@ -128,9 +128,27 @@ public Q_SLOTS:
 
 // Called by BrowserApplication:
 protected:
+    /// Subscriptions read from the configuration file, with their filters parsed
+    struct SubscriptionConfig
+    {
+        /// Subscriptions listed in the configuration file
+        std::vector<Subscription> Subscriptions;
+
+        /// Total number of requests blocked in previous sessions
+        quint64 RequestsBlocked;
+    };
+
     /// Loads active subscriptions
     void loadSubscriptions();
 
+    /// Reads the subscriptions from the configuration file, and parses their filters. Only reads the configuration
+    /// and the resources of the manager, which are loaded by its constructor, so it may be called from a worker thread
+    SubscriptionConfig readSubscriptions();
+
+    /// Adds the subscriptions that were read by \ref readSubscriptions, and extracts their filters. Must be called
+    /// from the thread of the manager
+    void applySubscriptions(SubscriptionConfig &&config);
+
 private Q_SLOTS:
     /// Loads the uBlock Origin-style resource file into the resource map
     void loadResourceFile(const QString &path);
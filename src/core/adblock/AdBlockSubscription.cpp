@@ -1,5 +1,6 @@
 #include "AdBlockSubscription.h"
 #include "AdBlockFilterParser.h"
+#include "Tracer.h"
 
 #include <QDir>
 #include <QFile>
@@ -97,6 +98,10 @@ void Subscription::load(AdBlockManager *adBlockManager)
     if (!m_enabled || m_filePath.isEmpty())
         return;
 
+    TraceSpan traceSpan("adblock", "Subscription::load");
+    if (traceSpan.isActive())
+        traceSpan.setDetail(m_filePath.toStdString());
+
     // Load subscription file
     QFile subFile(m_filePath);
     if (!subFile.exists() || !subFile.open(QIODevice::ReadOnly))
@@ -21,6 +21,9 @@
 #include "SecurityManager.h"
 #include "SearchEngineManager.h"
 #include "Settings.h"
+#include "SpeculativeLoader.h"
+#include "TabHibernator.h"
+#include "Tracer.h"
 #include "NetworkAccessManager.h"
 #include "RequestInterceptor.h"
 #include "UserAgentManager.h"
@@ -33,6 +36,9 @@
 #include "config.h"
 
 #include <cmath>
+#include <functional>
+#include <memory>
+#include <utility>
 #include <vector>
 #include <QDesktopServices>
 #include <QDir>
@@ -40,6 +46,7 @@
 #include <QFileInfo>
 #include <QPalette>
 #include <QPluginLoader>
+#include <QThread>
 #include <QUrl>
 #include <QDebug>
 #include <QWebEngineCookieStore>
@@ -51,8 +58,13 @@
 #include <QtWebEngineCoreVersion>
 
 BrowserApplication::BrowserApplication(BrowserIPC *ipc, int &argc, char **argv) :
-    QApplication(argc, argv)
+    QApplication(argc, argv),
+    m_startupTasks(),
+    m_timeToFirstWindow(0),
+    m_pluginsLoaded(false)
 {
+    VIPER_TRACE_SCOPE("startup", "BrowserApplication::BrowserApplication");
+
     QCoreApplication::setOrganizationName(QLatin1String("Vaccarelli"));
     QCoreApplication::setApplicationName(QLatin1String("Viper-Browser"));
     QCoreApplication::setApplicationVersion(QLatin1String(VIPER_VERSION_STR));
@@ -74,100 +86,179 @@ BrowserApplication::BrowserApplication(BrowserIPC *ipc, int &argc, char **argv)
     m_settings = new Settings(m_defaultProfile->settings());
     registerService(m_settings);
 
-    // Initialize favicon storage module
-    //m_databaseScheduler.addWorker("FaviconStore",
-    //                              std::bind(DatabaseFactory::createDBWorker<FaviconStore>, m_settings->getPathValue(BrowserSetting::FaviconPath)));
-    m_faviconMgr = new FaviconManager(m_settings->getPathValue(BrowserSetting::FaviconPath));
-    registerService(m_faviconMgr);
+    // Follows the tabs of every window, to hibernate the background tabs when needed
+    m_tabHibernator = new TabHibernator(m_settings, this);
 
-    // Bookmark setup
-    m_databaseScheduler.addWorker("BookmarkStore",
-                                  std::bind(DatabaseFactory::createDBWorker<BookmarkStore>, m_settings->getPathValue(BrowserSetting::BookmarkPath)));
-    m_bookmarkManager = new BookmarkManager(m_serviceLocator, m_databaseScheduler, nullptr);
-    registerService(m_bookmarkManager);
+    // Services that the first window does not need are created the first time they are looked up
+    m_autoFill = nullptr;
+    registerFactory("AutoFill", [this]() -> QObject* {
+        m_autoFill = new AutoFill(m_settings);
+        return m_autoFill;
+    });
 
-    // Initialize cookie jar and cookie manager UI
-    m_cookieJar = new CookieJar(m_settings, m_defaultProfile, false);
-    registerService(m_cookieJar);
+    m_speculativeLoader = nullptr;
+    registerFactory("SpeculativeLoader", [this]() -> QObject* {
+        m_speculativeLoader = new SpeculativeLoader(m_settings, m_defaultProfile);
+        return m_speculativeLoader;
+    });
 
-    m_cookieUI = new CookieWidget(m_defaultProfile);
-    registerService(m_cookieUI);
+    m_userAgentMgr = nullptr;
+    registerFactory("UserAgentManager", [this]() -> QObject* {
+        m_userAgentMgr = new UserAgentManager(m_settings, m_defaultProfile);
+        return m_userAgentMgr;
+    });
+
+    // Depends on the history manager and thumbnail store, which are created before any web page is
+    m_favoritePagesMgr = nullptr;
+    registerFactory("favoritePageManager", [this]() -> QObject* {
+        m_favoritePagesMgr = new FavoritePagesManager(m_historyMgr, m_thumbnailStore.get(), m_settings->getPathValue(BrowserSetting::FavoritePagesFile));
+        return m_favoritePagesMgr;
+    });
 
-    // Get default profile and load cookies now that the cookie jar is instantiated
-    m_defaultProfile->cookieStore()->loadAllCookies();
+    // Extension storage, used by user scripts through the web channel
+    registerFactory("storage", [this]() -> QObject* {
+        m_extStorage = DatabaseFactory::createWorker<ExtStorage>(m_settings->getPathValue(BrowserSetting::ExtensionStoragePath));
+        return m_extStorage.get();
+    });
 
-    // Initialize auto fill manager
-    m_autoFill = new AutoFill(m_settings);
-    registerService(m_autoFill);
+    // The remaining services are created by a graph of startup tasks. Database and file loads that do not
+    // create QObjects run on worker threads, while everything else runs on this thread in the order it was
+    // added, as soon as its dependencies are ready
+    const QString faviconPath = m_settings->getPathValue(BrowserSetting::FaviconPath);
+    auto faviconStore = std::make_shared<std::unique_ptr<FaviconStore>>();
+    m_startupTasks.addTask("FaviconStore", StartupThread::Worker, {}, [faviconStore, faviconPath](){
+        *faviconStore = DatabaseFactory::createWorker<FaviconStore>(faviconPath);
+    });
 
     // Initialize download manager
-    const std::vector<QWebEngineProfile*> webProfiles { m_defaultProfile, m_privateProfile };
-    m_downloadMgr = new DownloadManager(m_settings, webProfiles);
-    registerService(m_downloadMgr);
+    m_startupTasks.addTask("DownloadManager", StartupThread::Main, {}, [this](){
+        const std::vector<QWebEngineProfile*> webProfiles { m_defaultProfile, m_privateProfile };
+        m_downloadMgr = new DownloadManager(m_settings, webProfiles);
+        registerService(m_downloadMgr);
+    });
 
-    // Initialize advertisement blocking system
-    m_adBlockManager = new adblock::AdBlockManager(m_serviceLocator, m_settings);
-    registerService(m_adBlockManager);
+    // Initialize advertisement blocking system, and load its subscriptions in the background (will do nothing if disabled)
+    m_startupTasks.addTask("AdBlockManager", StartupThread::Main, { "DownloadManager" }, [this](){
+        m_adBlockManager = new adblock::AdBlockManager(m_serviceLocator, m_settings);
+        registerService(m_adBlockManager);
+    });
+    // Filters are parsed on the worker thread, and handed to the manager on this thread before the first window is shown
+    auto subscriptionConfig = std::make_shared<adblock::AdBlockManager::SubscriptionConfig>();
+    m_startupTasks.addTask("AdBlockSubscriptions", StartupThread::Worker, { "AdBlockManager" }, [this, subscriptionConfig](){
+        *subscriptionConfig = m_adBlockManager->readSubscriptions();
+    });
+    m_startupTasks.addTask("AdBlockApply", StartupThread::Main, { "AdBlockSubscriptions" }, [this, subscriptionConfig](){
+        m_adBlockManager->applySubscriptions(std::move(*subscriptionConfig));
+    });
 
     // Instantiate the history manager and related systems
-    m_databaseScheduler.addWorker("HistoryStore",
-                                  std::bind(DatabaseFactory::createDBWorker<HistoryStore>, m_settings->getPathValue(BrowserSetting::HistoryPath)));
-    m_historyMgr = new HistoryManager(m_serviceLocator, m_databaseScheduler);
-    registerService(m_historyMgr);
+    m_startupTasks.addTask("HistoryManager", StartupThread::Main, {}, [this](){
+        m_databaseScheduler.addWorker("HistoryStore",
+                                      std::bind(DatabaseFactory::createDBWorker<HistoryStore>, m_settings->getPathValue(BrowserSetting::HistoryPath)));
+        m_historyMgr = new HistoryManager(m_serviceLocator, m_databaseScheduler);
+        registerService(m_historyMgr);
+    });
 
-    m_thumbnailStore = DatabaseFactory::createWorker<WebPageThumbnailStore>(m_serviceLocator, m_settings->getPathValue(BrowserSetting::ThumbnailPath));
-    registerService(m_thumbnailStore.get());
+    // Initialize favicon manager once its storage module has been loaded
+    m_startupTasks.addTask("FaviconManager", StartupThread::Main, { "FaviconStore" }, [this, faviconStore](){
+        m_faviconMgr = new FaviconManager(std::move(*faviconStore));
+        registerService(m_faviconMgr);
+    });
 
-    m_favoritePagesMgr = new FavoritePagesManager(m_historyMgr, m_thumbnailStore.get(), m_settings->getPathValue(BrowserSetting::FavoritePagesFile));
-    registerService(m_favoritePagesMgr);
+    // Bookmark setup
+    m_startupTasks.addTask("BookmarkManager", StartupThread::Main, { "FaviconManager" }, [this](){
+        m_databaseScheduler.addWorker("BookmarkStore",
+                                      std::bind(DatabaseFactory::createDBWorker<BookmarkStore>, m_settings->getPathValue(BrowserSetting::BookmarkPath)));
+        m_bookmarkManager = new BookmarkManager(m_serviceLocator, m_databaseScheduler, nullptr);
+        registerService(m_bookmarkManager);
+    });
 
-    // Create network access manager
-    m_networkAccessMgr = new NetworkAccessManager;
-    m_networkAccessMgr->setCookieJar(m_cookieJar);
-    registerService(m_networkAccessMgr);
+    // The database workers can start loading as soon as every manager has registered its init callback
+    m_startupTasks.addTask("DatabaseScheduler", StartupThread::Main, { "HistoryManager", "BookmarkManager" }, [this](){
+        m_databaseScheduler.run();
+    });
 
-    m_downloadMgr->setNetworkAccessManager(m_networkAccessMgr);
-    m_faviconMgr->setNetworkAccessManager(m_networkAccessMgr);
+    // Initialize cookie jar and cookie manager UI
+    m_startupTasks.addTask("CookieJar", StartupThread::Main, {}, [this](){
+        m_cookieJar = new CookieJar(m_settings, m_defaultProfile, false);
+        registerService(m_cookieJar);
 
-    // Setup user agent manager before settings
-    m_userAgentMgr = new UserAgentManager(m_settings, m_defaultProfile);
-    registerService(m_userAgentMgr);
+        m_cookieUI = new CookieWidget(m_defaultProfile);
+        registerService(m_cookieUI);
 
-    // Setup user script manager
-    m_userScriptMgr = new UserScriptManager(m_downloadMgr, m_settings);
-    registerService(m_userScriptMgr);
+        // Get default profile and load cookies now that the cookie jar is instantiated
+        m_defaultProfile->cookieStore()->loadAllCookies();
+    });
 
-    // Setup extension storage manager
-    m_extStorage = DatabaseFactory::createWorker<ExtStorage>(m_settings->getPathValue(BrowserSetting::ExtensionStoragePath));
-    registerService(m_extStorage.get());
+    m_startupTasks.addTask("WebPageThumbnailStore", StartupThread::Main, { "BookmarkManager", "HistoryManager" }, [this](){
+        m_thumbnailStore = DatabaseFactory::createWorker<WebPageThumbnailStore>(m_serviceLocator, m_settings->getPathValue(BrowserSetting::ThumbnailPath));
+        registerService(m_thumbnailStore.get());
+    });
 
-    // Apply global web scripts
-    installGlobalWebScripts();
+    // Create network access manager
+    m_startupTasks.addTask("NetworkAccessManager", StartupThread::Main, { "CookieJar", "DownloadManager", "FaviconManager" }, [this](){
+        m_networkAccessMgr = new NetworkAccessManager;
+        m_networkAccessMgr->setCookieJar(m_cookieJar);
+        registerService(m_networkAccessMgr);
 
-    // Apply web settings
-    m_webSettings = new WebSettings(m_serviceLocator, m_defaultProfile->settings(), m_defaultProfile, m_privateProfile);
+        m_downloadMgr->setNetworkAccessManager(m_networkAccessMgr);
+        m_faviconMgr->setNetworkAccessManager(m_networkAccessMgr);
+    });
+
+    // Setup user script manager
+    m_startupTasks.addTask("UserScriptManager", StartupThread::Main, { "DownloadManager" }, [this](){
+        m_userScriptMgr = new UserScriptManager(m_downloadMgr, m_settings);
+        registerService(m_userScriptMgr);
+    });
+
+    // Apply global web scripts, then web settings
+    m_startupTasks.addTask("GlobalWebScripts", StartupThread::Main, {}, [this](){
+        installGlobalWebScripts();
+    });
+    m_startupTasks.addTask("WebSettings", StartupThread::Main, { "GlobalWebScripts", "CookieJar" }, [this](){
+        m_webSettings = new WebSettings(m_serviceLocator, m_defaultProfile->settings(), m_defaultProfile, m_privateProfile);
+    });
 
     // Load search engine information
-    SearchEngineManager::instance().loadSearchEngines(m_settings->getPathValue(BrowserSetting::SearchEnginesFile));
+    m_startupTasks.addTask("SearchEngines", StartupThread::Main, {}, [this](){
+        SearchEngineManager::instance().loadSearchEngines(m_settings->getPathValue(BrowserSetting::SearchEnginesFile));
+    });
 
-    // Load ad block subscriptions (will do nothing if disabled)
-    m_adBlockManager->loadSubscriptions();
+    // Everything a browser window needs to be shown. Tabs issue requests to the ad block system as soon as
+    // they are created, so its filters must be ready as well
+    m_startupTasks.addTask("MainWindow", StartupThread::Main,
+                           { "AdBlockApply", "BookmarkManager", "CookieJar", "DatabaseScheduler", "FaviconManager",
+                             "HistoryManager", "NetworkAccessManager", "SearchEngines", "UserScriptManager", "WebPageThumbnailStore", "WebSettings" },
+                           [](){});
+
+    // The following tasks are only required once the first window starts loading web pages
 
     // Set browser's saved sessions file
-    m_sessionMgr.setSessionFile(m_settings->getPathValue(BrowserSetting::SessionFile));
+    m_startupTasks.addTask("SessionManager", StartupThread::Main, {}, [this](){
+        m_sessionMgr.setSessionFile(m_settings->getPathValue(BrowserSetting::SessionFile));
+        m_sessionMgr.startAutosave(m_settings);
+    });
 
     // Inject services into the security manager
-    SecurityManager::instance().setServiceLocator(m_serviceLocator);
+    m_startupTasks.addTask("SecurityManager", StartupThread::Main, { "CookieJar", "HistoryManager", "NetworkAccessManager" }, [this](){
+        SecurityManager::instance().setServiceLocator(m_serviceLocator);
+    });
 
     // Connect aboutToQuit signal to browser's session management slot
     // connect(this, &BrowserApplication::aboutToQuit, this, &BrowserApplication::beforeBrowserQuit);
 
     // Set URL handlers while application is active
-    const std::vector<QString> urlSchemes { QLatin1String("http"), QLatin1String("https"), QLatin1String("viper") };
-    for (const QString &scheme : urlSchemes)
-        QDesktopServices::setUrlHandler(scheme, this, "openUrl");
+    m_startupTasks.addTask("UrlHandlers", StartupThread::Main, {}, [this](){
+        const std::vector<QString> urlSchemes { QLatin1String("http"), QLatin1String("https"), QLatin1String("viper") };
+        for (const QString &scheme : urlSchemes)
+            QDesktopServices::setUrlHandler(scheme, this, "openUrl");
+    });
+
+    if (!m_startupTasks.start())
+        qWarning() << "BrowserApplication - invalid startup task graph";
 
-    m_databaseScheduler.run();
+    // The remaining tasks are completed when the first window is shown
+    m_startupTasks.waitFor("MainWindow");
 }
 
 BrowserApplication::~BrowserApplication()
@@ -175,12 +266,16 @@ BrowserApplication::~BrowserApplication()
     m_ipc = nullptr;
     killTimer(m_ipcTimerId);
 
+    // Ensures every service has been created before deleting them
+    m_startupTasks.waitForAll();
+
     m_databaseScheduler.stop();
 
     delete m_downloadMgr;
     delete m_networkAccessMgr;
     delete m_userAgentMgr;
     delete m_userScriptMgr;
+    delete m_speculativeLoader;
     delete m_privateProfile;
     delete m_viperSchemeHandler;
     delete m_blockedSchemeHandler;
@@ -194,6 +289,10 @@ BrowserApplication::~BrowserApplication()
     delete m_bookmarkManager;
     delete m_settings;
     delete m_defaultProfile;
+
+    // Write the trace file, if tracing was enabled from the command line
+    if (Tracer::isEnabled() && !Tracer::instance().stop())
+        qWarning() << "BrowserApplication - could not write trace file";
 }
 
 BrowserApplication *BrowserApplication::instance()
@@ -208,7 +307,7 @@ adblock::AdBlockManager *BrowserApplication::getAdBlockManager()
 
 AutoFill *BrowserApplication::getAutoFill()
 {
-    return m_autoFill;
+    return m_serviceLocator.getServiceAs<AutoFill>("AutoFill");
 }
 
 Settings *BrowserApplication::getSettings()
@@ -236,6 +335,11 @@ QWebEngineProfile *BrowserApplication::getPrivateBrowsingProfile()
     return m_privateProfile;
 }
 
+std::chrono::microseconds BrowserApplication::getTimeToFirstWindow() const
+{
+    return m_timeToFirstWindow;
+}
+
 MainWindow *BrowserApplication::getWindowById(WId windowId) const
 {
     for (auto it = m_browserWindows.begin(); it != m_browserWindows.end(); ++it)
@@ -266,6 +370,11 @@ bool BrowserApplication::isDarkTheme() const
     return hsp > 127.5;
 }
 
+bool BrowserApplication::arePluginsLoaded() const
+{
+    return m_pluginsLoaded;
+}
+
 void BrowserApplication::prepareToQuit()
 {
     beforeBrowserQuit();
@@ -274,6 +383,8 @@ void BrowserApplication::prepareToQuit()
 
 MainWindow *BrowserApplication::getNewWindow()
 {
+    VIPER_TRACE_SCOPE("window", "BrowserApplication::getNewWindow");
+
     bool firstWindow = m_browserWindows.empty();
 
     MainWindow *w = new MainWindow(m_serviceLocator, false);
@@ -283,6 +394,8 @@ MainWindow *BrowserApplication::getNewWindow()
         if (m_browserWindows.contains(w))
             m_browserWindows.removeOne(w);
     });
+    m_sessionMgr.trackWindow(w);
+    m_tabHibernator->trackWindow(w);
 
     w->show();
 
@@ -290,6 +403,14 @@ MainWindow *BrowserApplication::getNewWindow()
     // the startup mode behavior depending on the user's configuration setting
     if (firstWindow)
     {
+        if (m_timeToFirstWindow.count() == 0)
+        {
+            m_timeToFirstWindow = m_startupTasks.getElapsedTime();
+            Tracer::instance().addInstantEvent("startup", "FirstWindowShown");
+            m_startupTasks.waitForAll();
+            reportStartupTimes();
+        }
+
         loadPlugins();
 
         StartupMode mode = static_cast<StartupMode>(m_settings->getValue(BrowserSetting::StartupMode).toInt());
@@ -323,6 +444,7 @@ MainWindow *BrowserApplication::getNewPrivateWindow()
         if (m_browserWindows.contains(w))
             m_browserWindows.removeOne(w);
     });
+    m_tabHibernator->trackWindow(w);
 
     w->show();
     return w;
@@ -418,6 +540,27 @@ void BrowserApplication::registerService(QObject *service)
         qWarning() << "Could not register " << service->objectName() << " with service registry";
 }
 
+void BrowserApplication::registerFactory(const std::string &name, std::function<QObject*()> &&factory)
+{
+    // Services are QObjects that belong to the thread of the application. The factory runs while the service
+    // locator holds the service's construction lock, so waiting on the application thread from here could deadlock
+    // with a lookup made by that thread. Lazy services can therefore only be created by the application thread,
+    // and lookups from other threads fail until then
+    auto createOnMainThread = [this, name, factory = std::move(factory)]() -> QObject* {
+        if (QThread::currentThread() != thread())
+        {
+            qWarning() << "Service " << QString::fromStdString(name) << " must be created by the application thread";
+            return nullptr;
+        }
+
+        VIPER_TRACE_SCOPE("startup", "BrowserApplication::createService");
+        return factory();
+    };
+
+    if (!m_serviceLocator.addFactory(name, std::move(createOnMainThread)))
+        qWarning() << "Could not register " << QString::fromStdString(name) << " with service registry";
+}
+
 void BrowserApplication::setupWebProfiles()
 {
     // Only two profiles for now, standard and private
@@ -430,7 +573,7 @@ void BrowserApplication::setupWebProfiles()
     registerService(m_privateProfile);
 
     // Instantiate scheme handlers
-    m_viperSchemeHandler = new ViperSchemeHandler(this);
+    m_viperSchemeHandler = new ViperSchemeHandler(m_serviceLocator, this);
     m_blockedSchemeHandler = new BlockedSchemeHandler(m_serviceLocator, this);
 
     // Attach request interceptor and scheme handlers to web profiles
@@ -492,6 +635,34 @@ void BrowserApplication::checkBrowserIPC()
     }
 }
 
+void BrowserApplication::reportStartupTimes()
+{
+    if (!Tracer::isEnabled())
+        return;
+
+    qDebug() << "Time to first window:" << m_timeToFirstWindow.count() / 1000.0 << "ms";
+
+    for (const StartupTaskTiming &timing : m_startupTasks.getTimings())
+    {
+        qDebug() << "  Startup task" << QString::fromStdString(timing.Name)
+                 << (timing.Thread == StartupThread::Main ? "(main thread)" : "(worker thread)")
+                 << "started at" << timing.StartTime.count() / 1000.0 << "ms and took"
+                 << timing.getDuration().count() / 1000.0 << "ms";
+    }
+
+    for (const ViperServiceLocator::CreationRecord &record : m_serviceLocator.getCreationReport())
+    {
+        if (!record.IsLazy)
+            continue;
+
+        if (record.IsCreated)
+            qDebug() << "  Lazy service" << QString::fromStdString(record.Key) << "created at"
+                     << record.CreatedAt.count() / 1000.0 << "ms and took" << record.Duration.count() / 1000.0 << "ms";
+        else
+            qDebug() << "  Lazy service" << QString::fromStdString(record.Key) << "not created";
+    }
+}
+
 void BrowserApplication::loadPlugins()
 {
     QDir dir = QDir(VIPER_PLUGIN_DIR);
@@ -503,6 +674,7 @@ void BrowserApplication::loadPlugins()
             registerService(plugin);
     }
 
+    m_pluginsLoaded = true;
     emit pluginsLoaded();
 }
 
@@ -1,7 +1,10 @@
 #ifndef BROWSERAPPLICATION_H
 #define BROWSERAPPLICATION_H
 
+#include <chrono>
+#include <functional>
 #include <memory>
+#include <string>
 #include <QApplication>
 #include <QDateTime>
 #include <QList>
@@ -13,6 +16,7 @@
 #include "ServiceLocator.h"
 #include "SessionManager.h"
 #include "Settings.h"
+#include "StartupTaskGraph.h"
 
 namespace adblock {
     class AdBlockManager;
@@ -33,6 +37,8 @@ class MainWindow;
 class NetworkAccessManager;
 class RequestInterceptor;
 class Settings;
+class SpeculativeLoader;
+class TabHibernator;
 class UserAgentManager;
 class UserScriptManager;
 class ViperSchemeHandler;
@@ -83,6 +89,10 @@ class BrowserApplication : public QApplication
     /// Returns a pointer to the private web browsing profile
     QWebEngineProfile *getPrivateBrowsingProfile();
 
+    /// Returns the time between the start of the application and the first browser window being shown,
+    /// or zero if no window has been shown yet
+    std::chrono::microseconds getTimeToFirstWindow() const;
+
     /// Searches for a window with the given identifier, returning a pointer to the
     /// MainWindow if found, or a nullptr otherwise.
     MainWindow *getWindowById(WId windowId) const;
@@ -93,6 +103,10 @@ class BrowserApplication : public QApplication
     /// Returns true if the application is *likely* using a dark theme
     bool isDarkTheme() const;
 
+    /// Returns true once the runtime plugins have been loaded. Services that are created after this
+    /// point will not receive the \ref pluginsLoaded signal
+    bool arePluginsLoaded() const;
+
 Q_SIGNALS:
     /// Emitted when any and all runtime plugins have been loaded into the application
     void pluginsLoaded();
@@ -138,6 +152,10 @@ private Q_SLOTS:
     /// Registers a service with the \ref ViperServiceLocator
     void registerService(QObject *service);
 
+    /// Registers a service with the \ref ViperServiceLocator, which will be created by the given
+    /// factory the first time it is looked up from the application thread. Lookups from other threads fail until then
+    void registerFactory(const std::string &name, std::function<QObject*()> &&factory);
+
     /// Initializes the standard and private web profiles used by the browser.
     /// This includes instantiation of request interceptors and custom scheme handlers.
     void setupWebProfiles();
@@ -149,6 +167,9 @@ private Q_SLOTS:
     /// Loads any dynamic plugins found in the installation directory
     void loadPlugins();
 
+    /// Logs the time to first window, along with the execution times of each startup task, when tracing is enabled
+    void reportStartupTimes();
+
 private:
     /// Inter-process communication handler
     BrowserIPC *m_ipc;
@@ -168,7 +189,7 @@ private Q_SLOTS:
     /// Advertisement blocking system manager
     adblock::AdBlockManager *m_adBlockManager;
 
-    /// AutoFill manager
+    /// AutoFill manager, created on first use
     AutoFill *m_autoFill;
 
     /// Cookie jar
@@ -186,7 +207,7 @@ private Q_SLOTS:
     /// Network access manager
     NetworkAccessManager *m_networkAccessMgr;
 
-    /// User agent manager
+    /// User agent manager, created on first use
     UserAgentManager *m_userAgentMgr;
 
     /// User script manager
@@ -198,6 +219,12 @@ private Q_SLOTS:
     /// Browsing session manager
     SessionManager m_sessionMgr;
 
+    /// Hibernates background tabs automatically
+    TabHibernator *m_tabHibernator;
+
+    /// Connects to the site being typed into the URL bar, created on first use
+    SpeculativeLoader *m_speculativeLoader;
+
     /// Request interceptor
     RequestInterceptor *m_requestInterceptor;
 
@@ -216,10 +243,10 @@ private Q_SLOTS:
     /// Cookie manager
     CookieWidget *m_cookieUI;
 
-    /// Web extension storage - used to store user script data on a per-script basis rather than per-site
+    /// Web extension storage - used to store user script data on a per-script basis rather than per-site. Created on first use
     std::unique_ptr<ExtStorage> m_extStorage;
 
-    /// Maintains a list of the user's favorite web pages
+    /// Maintains a list of the user's favorite web pages. Created on first use
     FavoritePagesManager *m_favoritePagesMgr;
 
     /// Web page thumbnail storage manager
@@ -230,6 +257,15 @@ private Q_SLOTS:
 
     /// Database worker task scheduler
     DatabaseTaskScheduler m_databaseScheduler;
+
+    /// Creates the services of the browser, in parallel where they do not depend on each other
+    StartupTaskGraph m_startupTasks;
+
+    /// Time between the start of the application and the first browser window being shown
+    std::chrono::microseconds m_timeToFirstWindow;
+
+    /// Set to true once the runtime plugins have been loaded
+    bool m_pluginsLoaded;
 };
 
 #define sBrowserApplication BrowserApplication::instance()
@@ -27,6 +27,10 @@ AutoFill::AutoFill(Settings *settings) :
 
     connect(settings, &Settings::settingChanged, this, &AutoFill::onSettingChanged);
     connect(sBrowserApplication, &BrowserApplication::pluginsLoaded, this, &AutoFill::onPluginsLoaded);
+
+    // The auto fill manager is created on first use, which may be after the plugins were loaded
+    if (sBrowserApplication->arePluginsLoaded())
+        onPluginsLoaded();
 }
 
 AutoFill::~AutoFill()
@@ -92,13 +96,9 @@ void AutoFill::onFormSubmitted(WebPage *page, const QString &pageUrl, const QStr
     dialog->alignAndShow(window->frameGeometry());
 }
 
-void AutoFill::onPageLoaded(bool ok)
+void AutoFill::onPageLoaded(WebPage *page)
 {
-    if (!ok || !m_credentialStore || !m_enabled)
-        return;
-
-    WebPage *page = qobject_cast<WebPage*>(sender());
-    if (!page)
+    if (!page || !m_credentialStore || !m_enabled)
         return;
 
     std::vector<WebCredentials> savedLogins = m_credentialStore->getCredentialsFor(page->url());
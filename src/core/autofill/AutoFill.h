@@ -45,10 +45,9 @@ class AutoFill : public QObject, public ISettingsObserver
      */
     void onFormSubmitted(WebPage *page, const QString &pageUrl, const QString &username, const QString &password, const QMap<QString, QVariant> &formData);
 
-public Q_SLOTS:
-    /// Checks for any saved login information for the URL associated with the web page
-    /// that triggered this slot, completing any forms found on the page if auto fill is enabled
-    void onPageLoaded(bool ok);
+    /// Checks for any saved login information for the URL of the given web page, which finished
+    /// loading, completing any forms found on the page if auto fill is enabled
+    void onPageLoaded(WebPage *page);
 
 protected:
     /// Returns a list of all credentials that are stored in the system
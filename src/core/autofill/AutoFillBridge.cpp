@@ -6,10 +6,11 @@
 
 #include <QDebug>
 
-AutoFillBridge::AutoFillBridge(AutoFill *autoFill, WebPage *parent) :
+AutoFillBridge::AutoFillBridge(const ViperServiceLocator &serviceLocator, WebPage *parent) :
     QObject(parent),
+    m_serviceLocator(serviceLocator),
     m_page(parent),
-    m_autoFill(autoFill)
+    m_autoFill(nullptr)
 {
 }
 
@@ -19,5 +20,10 @@ AutoFillBridge::~AutoFillBridge()
 
 void AutoFillBridge::onFormSubmitted(const QString &pageUrl, const QString &username, const QString &password, const QMap<QString, QVariant> &formData)
 {
-    m_autoFill->onFormSubmitted(m_page, pageUrl, username, password, formData);
+    // The auto fill manager is created on first use
+    if (!m_autoFill)
+        m_autoFill = m_serviceLocator.getServiceAs<AutoFill>("AutoFill");
+
+    if (m_autoFill)
+        m_autoFill->onFormSubmitted(m_page, pageUrl, username, password, formData);
 }
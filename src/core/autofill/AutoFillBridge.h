@@ -1,6 +1,8 @@
 #ifndef AUTOFILLBRIDGE_H
 #define AUTOFILLBRIDGE_H
 
+#include "ServiceLocator.h"
+
 #include <QMap>
 #include <QObject>
 #include <QString>
@@ -19,8 +21,9 @@ class AutoFillBridge : public QObject
     Q_OBJECT
 
 public:
-    /// Constructs the AutoFillBridge with a pointer to the auto fill manager and a parent web page
-    explicit AutoFillBridge(AutoFill *autoFill, WebPage *parent);
+    /// Constructs the AutoFillBridge with the service locator, from which the auto fill manager is looked up when
+    /// a form is first submitted, and a parent web page
+    explicit AutoFillBridge(const ViperServiceLocator &serviceLocator, WebPage *parent);
 
     /// AutoFillBridge destructor
     ~AutoFillBridge();
@@ -36,10 +39,13 @@ public Q_SLOTS:
     void onFormSubmitted(const QString &pageUrl, const QString &username, const QString &password, const QMap<QString, QVariant> &formData);
 
 private:
+    /// Service locator of the application
+    const ViperServiceLocator &m_serviceLocator;
+
     /// Pointer to the web page that owns this bridge
     WebPage *m_page;
 
-    /// Pointer to the auto fill manager
+    /// Pointer to the auto fill manager, or a nullptr until a form is submitted
     AutoFill *m_autoFill;
 };
 
@@ -37,7 +37,7 @@ BookmarkManager::BookmarkManager(const ViperServiceLocator &serviceLocator, Data
         m_bookmarkStore = static_cast<BookmarkStore*>(m_taskScheduler.getWorker("BookmarkStore"));
     });
 
-    m_taskScheduler.post([this](){
+    m_taskScheduler.post("BookmarkStore", DatabaseTaskPriority::Interactive, [this](){
         m_nextBookmarkId = m_bookmarkStore->getMaxUniqueId() + 1;
         setRootNode(m_bookmarkStore->getRootNode());
     });
@@ -267,7 +267,8 @@ void BookmarkManager::removeBookmark(BookmarkNode *item)
             parent = m_rootNode.get();
 
         if (m_bookmarkStore)
-            m_taskScheduler.post(&BookmarkStore::removeNode, std::ref(m_bookmarkStore), node->getUniqueId(),
+            m_taskScheduler.post("BookmarkStore", DatabaseTaskPriority::Interactive,
+                                 &BookmarkStore::removeNode, std::ref(m_bookmarkStore), node->getUniqueId(),
                                  parent->getUniqueId(), node->getPosition());
         //emit bookmarkDeleted(node->getUniqueId(), parent->getUniqueId(), node->getPosition());
 
@@ -459,7 +460,8 @@ void BookmarkManager::scheduleBookmarkInsert(const BookmarkNode *node)
         return;
 
     // params: int nodeId, int parentId, int nodeType, const QString &name, const QUrl &url, int position
-    m_taskScheduler.post(&BookmarkStore::insertNode, std::ref(m_bookmarkStore),
+    m_taskScheduler.post("BookmarkStore", DatabaseTaskPriority::Interactive,
+                         &BookmarkStore::insertNode, std::ref(m_bookmarkStore),
                          node->getUniqueId(), node->getParent()->getUniqueId(),
                          static_cast<int>(node->getType()), node->getName(),
                          node->getURL(), node->getPosition());
@@ -471,7 +473,8 @@ void BookmarkManager::scheduleBookmarkUpdate(const BookmarkNode *node)
         return;
 
     // params: int nodeId, int parentId, const QString &name, const QString &url, const QString &shortcut, int position
-    m_taskScheduler.post(&BookmarkStore::updateNode, std::ref(m_bookmarkStore),
+    m_taskScheduler.post("BookmarkStore", DatabaseTaskPriority::Interactive,
+                         &BookmarkStore::updateNode, std::ref(m_bookmarkStore),
                          node->getUniqueId(), node->getParent()->getUniqueId(),
                          node->getName(), node->getURL(), node->getShortcut(),
                          node->getPosition());
@@ -44,61 +44,61 @@ int BookmarkStore::getMaxUniqueId() const
 
 void BookmarkStore::insertNode(int nodeId, int parentId, int nodeType, const QString &name, const QUrl &url, int position)
 {
-    auto stmt = m_database.prepare(R"(INSERT OR REPLACE INTO Bookmarks(ID, ParentID, Type, Name, URL, Position) VALUES (?, ?, ?, ?, ?, ?))");
-    stmt << nodeId
-         << parentId
-         << nodeType
-         << name
-         << url
-         << position;
-
-    if (!stmt.execute())
+    auto stmt = m_database.prepareCached(R"(INSERT OR REPLACE INTO Bookmarks(ID, ParentID, Type, Name, URL, Position) VALUES (?, ?, ?, ?, ?, ?))");
+    *stmt << nodeId
+          << parentId
+          << nodeType
+          << name
+          << url
+          << position;
+
+    if (!stmt->execute())
         qWarning() << "BookmarkStore::onBookmarkCreated - could not create bookmark node.";
 
-    stmt = m_database.prepare(R"(UPDATE Bookmarks SET Position = Position + 1 WHERE ParentID = ? AND Position >= ?)");
-    stmt << parentId
-         << position;
+    stmt = m_database.prepareCached(R"(UPDATE Bookmarks SET Position = Position + 1 WHERE ParentID = ? AND Position >= ?)");
+    *stmt << parentId
+          << position;
 
-    if (!stmt.execute())
+    if (!stmt->execute())
         qWarning() << "BookmarkStore::onBookmarkCreated - could not update bookmark positions.";
 }
 
 void BookmarkStore::removeNode(int nodeId, int parentId, int position)
 {
-    auto stmt = m_database.prepare(R"(DELETE FROM Bookmarks WHERE ID = ? OR ParentID = ?)");
-    stmt << nodeId
-         << nodeId;
-    if (!stmt.execute())
+    auto stmt = m_database.prepareCached(R"(DELETE FROM Bookmarks WHERE ID = ? OR ParentID = ?)");
+    *stmt << nodeId
+          << nodeId;
+    if (!stmt->execute())
         qWarning() << "BookmarkStore::onBookmarkDeleted - could not delete bookmark node.";
 
     // Update positions
-    stmt = m_database.prepare(R"(UPDATE Bookmarks SET Position = Position - 1 WHERE ParentID = ? AND Position >= ?)");
-    stmt << parentId
-         << position;
-    if (!stmt.execute())
+    stmt = m_database.prepareCached(R"(UPDATE Bookmarks SET Position = Position - 1 WHERE ParentID = ? AND Position >= ?)");
+    *stmt << parentId
+          << position;
+    if (!stmt->execute())
         qWarning() << "BookmarkStore::onBookmarkDeleted - could not update bookmark positions";
 }
 
 void BookmarkStore::updateNode(int nodeId, int parentId, const QString &name, const QUrl &url, const QString &shortcut, int position)
 {
     auto stmt =
-            m_database.prepare(R"(UPDATE Bookmarks SET ParentID = ?, Name = ?, URL = ?, Shortcut = ?, Position = ? WHERE ID = ?)");
-    stmt << parentId
-         << name
-         << url
-         << shortcut
-         << position
-         << nodeId;
-
-    if (!stmt.execute())
+            m_database.prepareCached(R"(UPDATE Bookmarks SET ParentID = ?, Name = ?, URL = ?, Shortcut = ?, Position = ? WHERE ID = ?)");
+    *stmt << parentId
+          << name
+          << url
+          << shortcut
+          << position
+          << nodeId;
+
+    if (!stmt->execute())
         qWarning() << "BookmarkStore::onBookmarkChanged - could not update bookmark node.";
 
-    stmt = m_database.prepare(R"(UPDATE Bookmarks SET Position = Position + 1 WHERE ParentID = ? AND Position >= ? AND ID != ?)");
-    stmt << parentId
-         << position
-         << nodeId;
+    stmt = m_database.prepareCached(R"(UPDATE Bookmarks SET Position = Position + 1 WHERE ParentID = ? AND Position >= ? AND ID != ?)");
+    *stmt << parentId
+          << position
+          << nodeId;
 
-    if (!stmt.execute())
+    if (!stmt->execute())
         qWarning() << "BookmarkStore::onBookmarkChanged - could not update bookmark positions.";
 }
 
@@ -200,7 +200,8 @@ void BookmarkStore::setup()
 
 void BookmarkStore::save()
 {
-    if (!m_database.beginTransaction())
+    sqlite::Transaction transaction(m_database);
+    if (!transaction.isActive())
     {
         qWarning() << "BookmarkStore::save - could not start transaction";
         return;
@@ -235,7 +236,7 @@ void BookmarkStore::save()
         }
     }
 
-    if (!m_database.commitTransaction())
+    if (!transaction.commit())
         qWarning() << "BookmarkStore::save - could not commit transaction";
 }
 
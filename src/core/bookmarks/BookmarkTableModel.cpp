@@ -1,12 +1,14 @@
 #include "BookmarkTableModel.h"
 #include "BookmarkNode.h"
 #include "BookmarkManager.h"
+#include "FaviconPixmapCache.h"
 
 #include <deque>
 #include <set>
 
 #include <QByteArray>
 #include <QDataStream>
+#include <QGuiApplication>
 #include <QIODevice>
 #include <QMimeData>
 #include <QSet>
@@ -79,7 +81,7 @@ QVariant BookmarkTableModel::data(const QModelIndex &index, int role) const
                     break;
             }
             if (role == Qt::DecorationRole)
-                return nodeIcon.pixmap(16, 16);
+                return FaviconPixmapCache::instance().pixmap(nodeIcon, 16, qApp->devicePixelRatio());
             if (role == Qt::SizeHintRole)
                 return QSize(16, 16);
             break;
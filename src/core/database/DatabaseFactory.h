@@ -3,6 +3,7 @@
 
 #include "DatabaseWorker.h"
 #include "ServiceLocator.h"
+#include "Tracer.h"
 
 #include <memory>
 #include <type_traits>
@@ -26,6 +27,10 @@ class DatabaseFactory
         // If any of the following conditions are met, setup() must be called:
         //    1. Database file is not present on file system
         //    2. Database file exists, but table structure(s) are not present or corrupted
+        TraceSpan traceSpan("database", "DatabaseFactory::createWorker");
+        if (traceSpan.isActive())
+            traceSpan.setDetail(databaseFile.toStdString());
+
         if (!QFile::exists(databaseFile) || !worker->hasProperStructure())
             worker->setup();
 
@@ -44,6 +49,10 @@ class DatabaseFactory
         // If any of the following conditions are met, setup() must be called:
         //    1. Database file is not present on file system
         //    2. Database file exists, but table structure(s) are not present or corrupted
+        TraceSpan traceSpan("database", "DatabaseFactory::createWorker");
+        if (traceSpan.isActive())
+            traceSpan.setDetail(databaseFile.toStdString());
+
         if (!QFile::exists(databaseFile) || !worker->hasProperStructure())
             worker->setup();
 
@@ -62,6 +71,10 @@ class DatabaseFactory
         // If any of the following conditions are met, setup() must be called:
         //    1. Database file is not present on file system
         //    2. Database file exists, but table structure(s) are not present or corrupted
+        TraceSpan traceSpan("database", "DatabaseFactory::createWorker");
+        if (traceSpan.isActive())
+            traceSpan.setDetail(databaseFile.toStdString());
+
         if (!QFile::exists(databaseFile) || !worker->hasProperStructure())
             worker->setup();
 
@@ -1,24 +1,58 @@
 #include "DatabaseWorker.h"
 
+#include <chrono>
+
 #include <QDebug>
+#include <QFile>
+#include <QtGlobal>
 
-DatabaseWorker::DatabaseWorker(const QString &dbFile) :
-    m_database(dbFile.toStdString())
+DatabaseWorker::DatabaseWorker(const QString &dbFile, const sqlite::DatabaseProfile &profile) :
+    m_database(dbFile.toStdString()),
+    m_profileFile()
 {
     if (!m_database.isValid())
         qWarning() << "Unable to open database " << dbFile;
 
-    // Turn synchronous setting off
-    if (!m_database.execute("PRAGMA journal_mode=WAL"))
-        qWarning() << "In DatabaseWorker constructor - could not set journal mode.";
+    // Journal mode, synchronous setting, memory mapping and caches
+    if (!m_database.applyProfile(profile))
+        qWarning() << "In DatabaseWorker constructor - could not apply database profile. Error message: "
+                   << QString::fromStdString(m_database.getLastError());
 
     // Foreign keys
     if (!m_database.execute("PRAGMA foreign_keys=\"1\""))
         qWarning() << "In DatabaseWorker constructor - could not enable foreign keys.";
+
+    // Opt-in query profiling
+    if (qEnvironmentVariableIsSet("VIPER_SQL_PROFILE") && m_database.isValid())
+    {
+        sqlite::QueryProfiler &profiler = m_database.enableProfiling();
+
+        bool isThresholdValid = false;
+        const int thresholdMs = qEnvironmentVariableIntValue("VIPER_SQL_PROFILE", &isThresholdValid);
+        if (isThresholdValid && thresholdMs >= 0)
+            profiler.setSlowQueryThreshold(std::chrono::milliseconds(thresholdMs));
+
+        profiler.setLogger([dbFile](const std::string &message) {
+            qWarning().noquote() << "In database" << dbFile << "-" << QString::fromStdString(message);
+        });
+
+        m_profileFile = dbFile + QLatin1String(".profile.json");
+    }
 }
 
 DatabaseWorker::~DatabaseWorker()
 {
+    if (m_profileFile.isEmpty())
+        return;
+
+    if (sqlite::QueryProfiler *profiler = m_database.getProfiler())
+    {
+        QFile file(m_profileFile);
+        if (file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+            file.write(QByteArray::fromStdString(profiler->toJson()));
+        else
+            qWarning() << "DatabaseWorker - could not write query profile to" << m_profileFile;
+    }
 }
 
 bool DatabaseWorker::exec(const QString &queryString)
@@ -10,6 +10,11 @@
  * @class DatabaseWorker
  * @brief Base class of all browser components that use their own database for
  *        storage of data and information.
+ *
+ * Setting the VIPER_SQL_PROFILE environment variable enables query profiling on every
+ * worker's connection. Its value is the slow query threshold in milliseconds. Slow queries
+ * are logged along with their query plan, and the statistics of each database are written
+ * to "<database file>.profile.json" when the worker is destroyed.
  */
 class DatabaseWorker
 {
@@ -17,8 +22,9 @@ class DatabaseWorker
     /**
      * @brief DatabaseWorker Constructs an object that interacts with a SQLite database
      * @param dbFile Full path of the database file
+     * @param profile Connection settings, applied when the database is opened
      */
-    explicit DatabaseWorker(const QString &dbFile);
+    explicit DatabaseWorker(const QString &dbFile, const sqlite::DatabaseProfile &profile = sqlite::DatabaseProfile::performance());
 
     /// Closes the database connection
     virtual ~DatabaseWorker();
@@ -43,6 +49,10 @@ class DatabaseWorker
 protected:
     /// Manages the database connection
     sqlite::Database m_database;
+
+private:
+    /// Path of the file that query statistics are exported to, or an empty string if profiling is disabled
+    QString m_profileFile;
 };
 
 #endif // DATABASEWORKER_H
@@ -1,5 +1,7 @@
 #include "database/bindings/QtSQLite.h"
 
+#include <string_view>
+
 sqlite::PreparedStatement &operator<<(sqlite::PreparedStatement &stmt, const QDateTime &input)
 {
     int64_t temp = input.toMSecsSinceEpoch();
@@ -9,21 +11,22 @@ sqlite::PreparedStatement &operator<<(sqlite::PreparedStatement &stmt, const QDa
 
 sqlite::PreparedStatement &operator<<(sqlite::PreparedStatement &stmt, const QString &input)
 {
-    const std::string temp = input.toStdString();
-    stmt.read(temp, true);
+    const QByteArray temp = input.toUtf8();
+    stmt.read(std::string_view(temp.constData(), static_cast<std::size_t>(temp.size())), true);
     return stmt;
 }
 
 sqlite::PreparedStatement &operator<<(sqlite::PreparedStatement &stmt, const QUrl &input)
 {
-    const std::string temp = input.toString(QUrl::FullyEncoded).toStdString();
-    stmt.read(temp, true);
+    const QByteArray temp = input.toEncoded(QUrl::FullyEncoded);
+    stmt.read(std::string_view(temp.constData(), static_cast<std::size_t>(temp.size())), true);
     return stmt;
 }
 
 sqlite::PreparedStatement &operator<<(sqlite::PreparedStatement &stmt, const QByteArray &input)
 {
-    sqlite::Blob temp { input.toStdString() };
+    // SQLite makes its own copy of the data, so the array can be bound without an intermediate copy
+    sqlite::BlobView temp { std::string_view(input.constData(), static_cast<std::size_t>(input.size())) };
     stmt.read(temp, true);
     return stmt;
 }
@@ -38,24 +41,24 @@ sqlite::PreparedStatement &operator>>(sqlite::PreparedStatement &stmt, QDateTime
 
 sqlite::PreparedStatement &operator>>(sqlite::PreparedStatement &stmt, QString &output)
 {
-    std::string temp;
+    std::string_view temp;
     stmt >> temp;
-    output = QString::fromStdString(temp);
+    output = QString::fromUtf8(temp.data(), static_cast<qsizetype>(temp.size()));
     return stmt;
 }
 
 sqlite::PreparedStatement &operator>>(sqlite::PreparedStatement &stmt, QUrl &output)
 {
-    std::string temp;
+    std::string_view temp;
     stmt >> temp;
-    output = QUrl(QString::fromStdString(temp));
+    output = QUrl(QString::fromUtf8(temp.data(), static_cast<qsizetype>(temp.size())));
     return stmt;
 }
 
 sqlite::PreparedStatement &operator>>(sqlite::PreparedStatement &stmt, QByteArray &output)
 {
-    sqlite::Blob temp;
+    sqlite::BlobView temp;
     stmt >> temp;
-    output = QByteArray::fromStdString(temp.data);
+    output = QByteArray(temp.data.data(), static_cast<qsizetype>(temp.data.size()));
     return stmt;
 }
@@ -3,11 +3,12 @@
 
 #include "SQLiteWrapper.h"
 
+#include <QByteArray>
 #include <QDateTime>
 #include <QString>
 #include <QUrl>
 
-/// Bindings of native Qt types to the sqlite wrapper
+/// Bindings of native Qt types to the sqlite wrapper. Values are constructed directly from the column's data, in a single copy
 
 sqlite::PreparedStatement &operator<<(sqlite::PreparedStatement &stmt, const QDateTime &input);
 sqlite::PreparedStatement &operator<<(sqlite::PreparedStatement &stmt, const QString &input);
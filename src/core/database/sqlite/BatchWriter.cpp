@@ -0,0 +1,98 @@
+#include "BatchWriter.h"
+#include "Database.h"
+
+#include <exception>
+
+namespace sqlite
+{
+
+BatchWriter::BatchWriter(Database &database, const std::string &sql, std::size_t chunkSize) :
+    m_database{database},
+    m_statement{database.prepare(sql)},
+    m_chunkSize{chunkSize > 0 ? chunkSize : 1},
+    m_transaction{},
+    m_chunkRows{0},
+    m_chunkRowsWritten{0},
+    m_rowsWritten{0},
+    m_failedRows{0},
+    m_chunksCommitted{0},
+    m_uncaughtExceptions{std::uncaught_exceptions()}
+{
+}
+
+BatchWriter::~BatchWriter()
+{
+    if (std::uncaught_exceptions() > m_uncaughtExceptions)
+    {
+        // The transaction's destructor rolls back the pending chunk
+        m_transaction.reset();
+        return;
+    }
+
+    flush();
+}
+
+bool BatchWriter::flush()
+{
+    if (!m_transaction.has_value())
+        return true;
+
+    m_statement.reset();
+
+    const bool result = m_transaction->commit();
+    m_transaction.reset();
+
+    if (result)
+    {
+        m_rowsWritten += m_chunkRowsWritten;
+        ++m_chunksCommitted;
+    }
+    else
+    {
+        // The rows of the chunk were rolled back along with the failed commit
+        m_failedRows += m_chunkRowsWritten;
+    }
+
+    m_chunkRows = 0;
+    m_chunkRowsWritten = 0;
+    return result;
+}
+
+bool BatchWriter::isValid() const
+{
+    return m_statement.isValid();
+}
+
+uint64_t BatchWriter::getRowsWritten() const
+{
+    return m_rowsWritten + m_chunkRowsWritten;
+}
+
+uint64_t BatchWriter::getFailedRows() const
+{
+    return m_failedRows;
+}
+
+uint64_t BatchWriter::getChunksCommitted() const
+{
+    return m_chunksCommitted;
+}
+
+bool BatchWriter::beginChunk()
+{
+    if (m_transaction.has_value())
+        return true;
+
+    m_transaction.emplace(m_database);
+    if (!m_transaction->isActive())
+    {
+        m_transaction.reset();
+        return false;
+    }
+
+    m_chunkRows = 0;
+    m_chunkRowsWritten = 0;
+    return true;
+}
+
+}
@@ -0,0 +1,132 @@
+#ifndef _SQLITE_BATCH_WRITER_H_
+#define _SQLITE_BATCH_WRITER_H_
+
+#include "PreparedStatement.h"
+#include "Transaction.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+
+namespace sqlite
+{
+
+class Database;
+
+/**
+ * @class BatchWriter
+ * @brief Executes a single statement with many sets of parameters, grouping the executions
+ *        into transactions of a fixed number of rows. Committing once per chunk, rather than
+ *        once per row as in autocommit mode, avoids a journal sync for every row, while keeping
+ *        each transaction short.
+ *
+ * Rows that fail to be written are counted and skipped, without affecting the other rows of
+ * their chunk. The pending chunk is committed by flush(), or when the writer is destroyed,
+ * unless it is destroyed because of an exception, in which case the chunk is rolled back.
+ *
+ *     sqlite::BatchWriter writer(db, "INSERT INTO Words(Word) VALUES (?)");
+ *     for (const std::string &word : words)
+ *         writer.add(word);
+ *     writer.flush();
+ */
+class BatchWriter
+{
+public:
+    /// Default number of rows written per transaction
+    static constexpr std::size_t DefaultChunkSize = 500;
+
+    /**
+     * @brief Constructs the batch writer
+     * @param database Connection to write to
+     * @param sql Statement executed for each row
+     * @param chunkSize Number of rows written in each transaction
+     */
+    BatchWriter(Database &database, const std::string &sql, std::size_t chunkSize = DefaultChunkSize);
+
+    /// Commits the pending chunk, or rolls it back if the writer is destroyed during stack unwinding
+    ~BatchWriter();
+
+    BatchWriter(const BatchWriter&) = delete;
+    BatchWriter &operator=(const BatchWriter&) = delete;
+
+    /// Binds the given values, in order, to the statement's parameters and executes it. Commits the
+    /// current chunk once it is full. Returns true if the row was written, false otherwise
+    template<class ...Args>
+    bool add(const Args &...args)
+    {
+        if (!beginChunk())
+        {
+            ++m_failedRows;
+            return false;
+        }
+
+        m_statement.reset();
+        (m_statement << ... << args);
+
+        const bool result = m_statement.execute();
+        if (result)
+            ++m_chunkRowsWritten;
+        else
+            ++m_failedRows;
+
+        if (++m_chunkRows >= m_chunkSize)
+            flush();
+
+        return result;
+    }
+
+    /// Commits the rows written since the last commit. Returns true on success, or if there were no pending rows
+    bool flush();
+
+    /// Returns true if the statement was compiled successfully
+    bool isValid() const;
+
+    /// Returns the number of rows that were written successfully, including rows of the uncommitted chunk
+    uint64_t getRowsWritten() const;
+
+    /// Returns the number of rows that could not be written, including rows whose chunk failed to commit
+    uint64_t getFailedRows() const;
+
+    /// Returns the number of chunks that have been committed
+    uint64_t getChunksCommitted() const;
+
+private:
+    /// Begins the transaction of a new chunk, if no chunk is in progress. Returns true if a chunk is in progress
+    bool beginChunk();
+
+private:
+    /// Connection being written to
+    Database &m_database;
+
+    /// Statement executed for each row
+    PreparedStatement m_statement;
+
+    /// Maximum number of rows per transaction
+    std::size_t m_chunkSize;
+
+    /// Transaction of the current chunk
+    std::optional<Transaction> m_transaction;
+
+    /// Number of rows executed in the current chunk
+    std::size_t m_chunkRows;
+
+    /// Number of rows of the current chunk that were written successfully
+    std::size_t m_chunkRowsWritten;
+
+    /// Number of rows written successfully in committed chunks
+    uint64_t m_rowsWritten;
+
+    /// Number of rows that could not be written
+    uint64_t m_failedRows;
+
+    /// Number of committed chunks
+    uint64_t m_chunksCommitted;
+
+    /// Number of uncaught exceptions when the writer was constructed, used to detect stack unwinding in the destructor
+    int m_uncaughtExceptions;
+};
+
+}
+
+#endif // _SQLITE_BATCH_WRITER_H_
@@ -2,6 +2,7 @@
 #define _SQLITE_BLOB_H_
 
 #include <string>
+#include <string_view>
 
 namespace sqlite
 {
@@ -10,7 +11,19 @@ namespace sqlite
     {
         std::string data;
     };
+
+    /**
+     * @struct BlobView
+     * @brief Non-owning view of a BLOB value. When read from a result set, the view points
+     *        directly into SQLite's column buffer, and is only valid until the statement is
+     *        stepped to the next row, reset or destroyed. When bound as a parameter, the
+     *        viewed bytes must stay alive until the statement has been executed, unless the
+     *        value is bound with copyData set to true.
+     */
+    struct BlobView
+    {
+        std::string_view data;
+    };
 }
 
 #endif // _SQLITE_BLOB_H_
-
@@ -0,0 +1,75 @@
+#include "ConnectionPool.h"
+
+namespace sqlite
+{
+
+void ConnectionPool::Releaser::operator()(Database *connection) const
+{
+    if (pool != nullptr && connection != nullptr)
+        pool->release(connection);
+}
+
+ConnectionPool::ConnectionPool(const std::string &fileName, std::size_t maxConnections, const DatabaseProfile &profile) :
+    m_fileName{fileName},
+    m_maxConnections{maxConnections > 0 ? maxConnections : 1},
+    m_profile{profile},
+    m_connections{},
+    m_idle{},
+    m_waitCount{0},
+    m_mutex{},
+    m_cv{}
+{
+}
+
+ConnectionPool::~ConnectionPool()
+{
+}
+
+ConnectionPool::Connection ConnectionPool::acquire()
+{
+    std::unique_lock<std::mutex> lock{m_mutex};
+
+    if (m_idle.empty() && m_connections.size() < m_maxConnections)
+    {
+        auto connection = std::make_unique<Database>(m_fileName, OpenMode::ReadOnly);
+        if (!connection->isValid())
+            return Connection{nullptr, Releaser{this}};
+
+        connection->applyProfile(m_profile);
+        m_idle.push_back(connection.get());
+        m_connections.push_back(std::move(connection));
+    }
+
+    if (m_idle.empty())
+    {
+        ++m_waitCount;
+        m_cv.wait(lock, [this](){ return !m_idle.empty(); });
+    }
+
+    Database *connection = m_idle.back();
+    m_idle.pop_back();
+    return Connection{connection, Releaser{this}};
+}
+
+std::size_t ConnectionPool::getOpenCount() const
+{
+    std::lock_guard<std::mutex> lock{m_mutex};
+    return m_connections.size();
+}
+
+std::size_t ConnectionPool::getWaitCount() const
+{
+    std::lock_guard<std::mutex> lock{m_mutex};
+    return m_waitCount;
+}
+
+void ConnectionPool::release(Database *connection)
+{
+    {
+        std::lock_guard<std::mutex> lock{m_mutex};
+        m_idle.push_back(connection);
+    }
+    m_cv.notify_one();
+}
+
+}
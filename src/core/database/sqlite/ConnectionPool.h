@@ -0,0 +1,97 @@
+#ifndef _SQLITE_CONNECTION_POOL_H_
+#define _SQLITE_CONNECTION_POOL_H_
+
+#include "Database.h"
+#include "DatabaseProfile.h"
+
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace sqlite
+{
+
+/**
+ * @class ConnectionPool
+ * @brief Maintains a small set of read-only connections to a database. Combined with write-ahead
+ *        logging, readers that use the pool never wait for the database's writer, nor for each other.
+ *
+ * Connections are borrowed with acquire() and returned to the pool when the returned handle is destroyed.
+ * The pool itself is thread-safe, while each borrowed connection must only be used by one thread at a time.
+ */
+class ConnectionPool
+{
+public:
+    /// Deleter of a borrowed connection, which returns it to the pool
+    struct Releaser
+    {
+        /// Pool that the connection belongs to
+        ConnectionPool *pool;
+
+        /// Returns the connection to the pool
+        void operator()(Database *connection) const;
+    };
+
+    /// Handle of a borrowed connection
+    using Connection = std::unique_ptr<Database, Releaser>;
+
+    /**
+     * @brief Constructs the pool. Connections are opened when they are first needed
+     * @param fileName Path of the database file
+     * @param maxConnections Maximum number of connections that may be open at once
+     * @param profile Settings applied to each connection
+     */
+    ConnectionPool(const std::string &fileName, std::size_t maxConnections, const DatabaseProfile &profile = DatabaseProfile::reader());
+
+    /// Closes all of the connections. Borrowed connections must be returned beforehand
+    ~ConnectionPool();
+
+    ConnectionPool(const ConnectionPool&) = delete;
+    ConnectionPool &operator=(const ConnectionPool&) = delete;
+
+    /// Borrows a connection, waiting for one to be returned if all of them are in use.
+    /// Returns an empty handle if the connection could not be opened
+    Connection acquire();
+
+    /// Returns the number of connections that have been opened by the pool
+    std::size_t getOpenCount() const;
+
+    /// Returns the number of times acquire() had to wait for a connection to be returned
+    std::size_t getWaitCount() const;
+
+private:
+    /// Puts a borrowed connection back into the pool
+    void release(Database *connection);
+
+private:
+    /// Path of the database file
+    std::string m_fileName;
+
+    /// Maximum number of open connections
+    std::size_t m_maxConnections;
+
+    /// Settings applied to each connection
+    DatabaseProfile m_profile;
+
+    /// All of the connections opened by the pool
+    std::vector<std::unique_ptr<Database>> m_connections;
+
+    /// Connections that are not currently borrowed
+    std::vector<Database*> m_idle;
+
+    /// Number of times acquire() had to wait for a connection
+    std::size_t m_waitCount;
+
+    /// Guards the connection lists
+    mutable std::mutex m_mutex;
+
+    /// Signalled when a connection is returned to the pool
+    std::condition_variable m_cv;
+};
+
+}
+
+#endif // _SQLITE_CONNECTION_POOL_H_
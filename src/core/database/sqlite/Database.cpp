@@ -6,26 +6,46 @@
 #include "PreparedStatement.h"
 
 #include <iostream>
+#include <string>
 
 namespace sqlite
 {
 
-Database::Database(const std::string &fileName) :
+Database::Database(const std::string &fileName, OpenMode mode) :
     m_handle{nullptr},
     m_isHandleValid{false},
-    m_lastError{}
+    m_mode{mode},
+    m_lastError{},
+    m_statementCache{nullptr},
+    m_profiler{nullptr}
 {
     internal::Implementation::instance().init();
 
-    if (sqlite3_open_v2(fileName.c_str(), &m_handle, SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE, NULL) == SQLITE_OK)
+    // Some stores are read from worker threads as well as the GUI thread, so the connection is serialized
+    const int flags = ((mode == OpenMode::ReadOnly) ? SQLITE_OPEN_READONLY : (SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE))
+            | SQLITE_OPEN_FULLMUTEX;
+    if (sqlite3_open_v2(fileName.c_str(), &m_handle, flags, NULL) == SQLITE_OK)
     {
         m_isHandleValid = true;
-        sqlite3_busy_handler(m_handle, internal::busyHandler, nullptr); 
+
+        // Unlike a handler that sleeps for a fixed interval, the built-in busy timeout retries
+        // after short, increasing delays, so a briefly held lock does not stall the caller
+        sqlite3_busy_timeout(m_handle, internal::BusyTimeoutMs);
+    }
+    else if (m_handle != nullptr)
+    {
+        // A handle is allocated even when the connection could not be opened
+        sqlite3_close_v2(m_handle);
+        m_handle = nullptr;
     }
 }
 
 Database::~Database()
 {
+    // Cached statements must be finalized before the connection is closed
+    m_statementCache.reset();
+    m_profiler.reset();
+
     if (m_isHandleValid && m_handle != nullptr)
     {
         sqlite3_close_v2(m_handle);
@@ -37,6 +57,55 @@ bool Database::isValid() const
     return m_isHandleValid && m_handle != nullptr;
 }
 
+bool Database::isReadOnly() const
+{
+    return m_mode == OpenMode::ReadOnly;
+}
+
+bool Database::isInTransaction() const
+{
+    return isValid() && sqlite3_get_autocommit(m_handle) == 0;
+}
+
+bool Database::applyProfile(const DatabaseProfile &profile)
+{
+    if (!isValid())
+        return false;
+
+    bool result = true;
+
+    if (!isReadOnly() && profile.writeAheadLog)
+        result &= execute("PRAGMA journal_mode=WAL");
+
+    switch (profile.synchronous)
+    {
+        case SynchronousMode::Off:
+            result &= execute("PRAGMA synchronous=OFF");
+            break;
+        case SynchronousMode::Normal:
+            result &= execute("PRAGMA synchronous=NORMAL");
+            break;
+        case SynchronousMode::Full:
+            result &= execute("PRAGMA synchronous=FULL");
+            break;
+    }
+
+    if (profile.mmapSize > 0)
+        result &= execute("PRAGMA mmap_size=" + std::to_string(profile.mmapSize));
+
+    // Negative values are interpreted by SQLite as a size in KiB, rather than a number of pages
+    if (profile.cacheSizeKiB > 0)
+        result &= execute("PRAGMA cache_size=-" + std::to_string(profile.cacheSizeKiB));
+
+    if (profile.tempStoreInMemory)
+        result &= execute("PRAGMA temp_store=MEMORY");
+
+    if (profile.queryOnly)
+        result &= execute("PRAGMA query_only=1");
+
+    return result;
+}
+
 bool Database::beginTransaction()
 {
     static constexpr char beginTransactionSql[] = "BEGIN TRANSACTION";
@@ -92,5 +161,35 @@ PreparedStatement Database::prepare(const char *sql, int nByte) const
     return PreparedStatement({}, m_handle, sql, nByte);
 }
 
+CachedStatement Database::prepareCached(std::string_view sql) const
+{
+    return getStatementCache().checkout(sql);
 }
 
+StatementCache &Database::getStatementCache() const
+{
+    if (!m_statementCache)
+        m_statementCache = std::make_unique<StatementCache>(*this);
+
+    return *m_statementCache;
+}
+
+QueryProfiler &Database::enableProfiling()
+{
+    if (!m_profiler)
+        m_profiler = std::make_unique<QueryProfiler>(Badge<Database>{}, m_handle);
+
+    return *m_profiler;
+}
+
+void Database::disableProfiling()
+{
+    m_profiler.reset();
+}
+
+QueryProfiler *Database::getProfiler() const
+{
+    return m_profiler.get();
+}
+
+}
@@ -1,7 +1,13 @@
 #ifndef _SQLITE_DATABASE_H_
 #define _SQLITE_DATABASE_H_
 
+#include "DatabaseProfile.h"
+#include "QueryProfiler.h"
+#include "StatementCache.h"
+
+#include <memory>
 #include <string>
+#include <string_view>
 
 struct sqlite3;
 
@@ -10,6 +16,19 @@ namespace sqlite
 
 class PreparedStatement;
 
+/// Handle of a statement borrowed from a connection's statement cache
+using CachedStatement = StatementCache::Handle;
+
+/// Access mode of a database connection
+enum class OpenMode
+{
+    /// Connection may read and write, creating the database file if it does not exist
+    ReadWrite,
+
+    /// Connection may only read from an existing database file
+    ReadOnly
+};
+
 /**
  * @class Database
  * @brief Point of entry for the library's wrapper functionality.
@@ -23,9 +42,9 @@ class Database
     Database(const Database&) = delete;
     Database &operator=(const Database&) = delete;
 
-    /// Constructs the database with a given database file.
+    /// Constructs the database with a given database file and access mode.
     /// The connection is opened immediately in the constructor
-    explicit Database(const std::string &fileName);
+    explicit Database(const std::string &fileName, OpenMode mode = OpenMode::ReadWrite);
 
     /// Closes the database connection
     ~Database();
@@ -51,6 +70,17 @@ class Database
     /// Returns true if the connection is open and in a valid state, otherwise returns false.
     bool isValid() const;
 
+    /// Returns true if the connection was opened in read-only mode
+    bool isReadOnly() const;
+
+    /// Returns true if a transaction is in progress on the connection, false if it is in autocommit mode
+    bool isInTransaction() const;
+
+    /// Applies the settings of the given profile to the connection, returning true if all of them
+    /// could be applied, false otherwise. Settings that require write access are skipped on
+    /// read-only connections.
+    bool applyProfile(const DatabaseProfile &profile);
+
     /**
      * @brief Prepares the given SQL statement
      * @param sql The SQL string to be prepared
@@ -66,6 +96,29 @@ class Database
      */
     PreparedStatement prepare(const char *sql, int nByte) const;
 
+    /**
+     * @brief Returns a prepared statement for the given SQL string from the connection's statement
+     *        cache, preparing it only if it is not cached yet. Intended for queries that are executed
+     *        repeatedly. The statement is returned to the cache when the handle is destroyed, and the
+     *        handle must not outlive the database.
+     * @param sql The SQL string to be prepared
+     * @return Handle of the reset statement, with no bound parameters
+     */
+    CachedStatement prepareCached(std::string_view sql) const;
+
+    /// Returns the statement cache of the connection
+    StatementCache &getStatementCache() const;
+
+    /// Starts collecting execution statistics of the statements run on the connection, returning the
+    /// profiler. Profiling adds overhead to every statement, and is meant to be used for diagnostics
+    QueryProfiler &enableProfiling();
+
+    /// Stops collecting execution statistics, discarding the profiler
+    void disableProfiling();
+
+    /// Returns the profiler of the connection, or a nullptr if profiling is not enabled
+    QueryProfiler *getProfiler() const;
+
 private:
     /// Pointer to the database connection
     sqlite3 *m_handle;
@@ -73,8 +126,17 @@ class Database
     /// Flag representing the validity of the connection
     bool m_isHandleValid;
 
+    /// Access mode of the connection
+    OpenMode m_mode;
+
     /// Contains any error message set from the last failing call to execute(const char*)
     std::string m_lastError;
+
+    /// Statements prepared with prepareCached()
+    mutable std::unique_ptr<StatementCache> m_statementCache;
+
+    /// Collects statement execution statistics, when profiling is enabled
+    std::unique_ptr<QueryProfiler> m_profiler;
 };
 
 }
@@ -0,0 +1,63 @@
+#ifndef _SQLITE_DATABASE_PROFILE_H_
+#define _SQLITE_DATABASE_PROFILE_H_
+
+#include <cstdint>
+
+namespace sqlite
+{
+
+/// Values of the synchronous PRAGMA
+enum class SynchronousMode
+{
+    Off,
+    Normal,
+    Full
+};
+
+/**
+ * @struct DatabaseProfile
+ * @brief Connection settings applied through PRAGMA statements when a database is opened
+ */
+struct DatabaseProfile
+{
+    /// Use write-ahead logging, so that readers and a writer can access the database at the same time
+    bool writeAheadLog;
+
+    /// How often SQLite waits for data to reach the disk
+    SynchronousMode synchronous;
+
+    /// Maximum number of bytes of the database file to access through memory-mapped I/O. Disabled when 0
+    int64_t mmapSize;
+
+    /// Size of the page cache, in KiB. The SQLite default is used when 0
+    int cacheSizeKiB;
+
+    /// Store temporary tables and indices in memory instead of on disk
+    bool tempStoreInMemory;
+
+    /// Prevents the connection from making any changes to the database
+    bool queryOnly;
+
+    /// Returns a profile that leaves every setting at its SQLite default, except for write-ahead logging
+    static DatabaseProfile defaults()
+    {
+        return DatabaseProfile { true, SynchronousMode::Full, 0, 0, false, false };
+    }
+
+    /// Returns a profile tuned for a connection that reads and writes: write-ahead logging, which stays
+    /// consistent with synchronous=NORMAL, 64 MiB of memory-mapped I/O and an 8 MiB page cache
+    static DatabaseProfile performance()
+    {
+        return DatabaseProfile { true, SynchronousMode::Normal, 64 * 1024 * 1024, 8 * 1024, true, false };
+    }
+
+    /// Returns a profile tuned for a connection that only reads, with a smaller page cache
+    static DatabaseProfile reader()
+    {
+        return DatabaseProfile { true, SynchronousMode::Normal, 64 * 1024 * 1024, 2 * 1024, true, true };
+    }
+};
+
+}
+
+#endif // _SQLITE_DATABASE_PROFILE_H_
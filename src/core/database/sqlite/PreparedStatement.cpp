@@ -42,6 +42,11 @@ PreparedStatement::~PreparedStatement()
     }
 }
 
+bool PreparedStatement::isValid() const
+{
+    return m_handle != nullptr;
+}
+
 bool PreparedStatement::execute()
 {
     if (m_handle == nullptr || m_state != State::Ready)
@@ -102,6 +107,31 @@ bool PreparedStatement::next()
     return false;
 }
 
+std::string_view PreparedStatement::getTextView(int index) const
+{
+    if (m_handle == nullptr || index < 0 || index >= m_numCols)
+        return std::string_view();
+
+    // sqlite3_column_bytes must be called after sqlite3_column_text, as the latter may convert the value
+    const char *data = reinterpret_cast<const char*>(sqlite3_column_text(m_handle, index));
+    if (data == nullptr)
+        return std::string_view();
+
+    return std::string_view(data, static_cast<std::size_t>(sqlite3_column_bytes(m_handle, index)));
+}
+
+std::string_view PreparedStatement::getBlobView(int index) const
+{
+    if (m_handle == nullptr || index < 0 || index >= m_numCols)
+        return std::string_view();
+
+    const char *data = reinterpret_cast<const char*>(sqlite3_column_blob(m_handle, index));
+    if (data == nullptr)
+        return std::string_view();
+
+    return std::string_view(data, static_cast<std::size_t>(sqlite3_column_bytes(m_handle, index)));
+}
+
 void PreparedStatement::reset()
 {
     if (m_handle == nullptr)
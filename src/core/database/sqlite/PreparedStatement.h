@@ -9,6 +9,7 @@
 
 #include <iostream>
 #include <string>
+#include <string_view>
 #include <type_traits>
 
 namespace sqlite
@@ -42,6 +43,9 @@ class PreparedStatement
     /// Frees the resources that were associated with the statement
     ~PreparedStatement();
 
+    /// Returns true if the statement was compiled successfully, false otherwise
+    bool isValid() const;
+
     /**
      * @brief Executes the statement - this may be invoked for
      *        any type of statement (SELECT, UPDATE, INSERT, CREATE,
@@ -87,10 +91,15 @@ class PreparedStatement
             auto bindingType = copyData ? SQLITE_TRANSIENT : SQLITE_STATIC;
             sqlite3_bind_text(m_handle, index, value.data(), value.size(), bindingType);
         }
-        else if constexpr (std::is_same_v<Blob, paramType>)
+        else if constexpr (std::is_same_v<std::string_view, paramType>)
+        {
+            auto bindingType = copyData ? SQLITE_TRANSIENT : SQLITE_STATIC;
+            sqlite3_bind_text(m_handle, index, value.data(), static_cast<int>(value.size()), bindingType);
+        }
+        else if constexpr (std::is_same_v<Blob, paramType> || std::is_same_v<BlobView, paramType>)
         {
             auto bindingType = copyData ? SQLITE_TRANSIENT : SQLITE_STATIC;
-            sqlite3_bind_blob(m_handle, index, value.data.data(), value.data.size(), bindingType);
+            sqlite3_bind_blob(m_handle, index, value.data.data(), static_cast<int>(value.data.size()), bindingType);
         }
         else if constexpr (std::is_integral_v<paramType>)
         {
@@ -119,6 +128,22 @@ class PreparedStatement
         }
     }
 
+    /**
+     * @brief Returns a view of the text stored in the given column of the current row, without
+     *        copying it. The view is invalidated when the statement is stepped to the next row,
+     *        reset or destroyed, and is empty if the column is NULL or out of range.
+     * @param index Column index, beginning at 0
+     */
+    std::string_view getTextView(int index) const;
+
+    /**
+     * @brief Returns a view of the bytes stored in the given column of the current row, without
+     *        copying them. The view is invalidated when the statement is stepped to the next row,
+     *        reset or destroyed, and is empty if the column is NULL or out of range.
+     * @param index Column index, beginning at 0
+     */
+    std::string_view getBlobView(int index) const;
+
     // Attempts to read the value of the current (row,column) into the output type
     template <class T>
     void write(T &output)
@@ -129,34 +154,24 @@ class PreparedStatement
         using paramType = typename std::decay<T>::type;
         if constexpr (std::is_same_v<std::string, paramType>)
         {
-            if (sqlite3_column_type(m_handle, m_colIdx) == SQLITE_NULL)
-            {
-                output = std::string();
-            }
-            else
-            {
-                const char *data = reinterpret_cast<const char*>(sqlite3_column_text(m_handle, m_colIdx));
-                int numBytes = sqlite3_column_bytes(m_handle, m_colIdx);
-
-                output = std::string(data, numBytes);
-            }
-            
+            const std::string_view data = getTextView(m_colIdx);
+            output.assign(data.data(), data.size());
+            m_colIdx++;
+        }
+        else if constexpr (std::is_same_v<std::string_view, paramType>)
+        {
+            output = getTextView(m_colIdx);
             m_colIdx++;
         }
         else if constexpr (std::is_same_v<Blob, paramType>)
         {
-            if (sqlite3_column_type(m_handle, m_colIdx) == SQLITE_NULL)
-            {
-                output.data = std::string();
-            }
-            else
-            {
-                const char *data = reinterpret_cast<const char*>(sqlite3_column_text(m_handle, m_colIdx));
-                int numBytes = sqlite3_column_bytes(m_handle, m_colIdx);
-
-                output.data = std::string(data, numBytes);
-            }
-
+            const std::string_view data = getBlobView(m_colIdx);
+            output.data.assign(data.data(), data.size());
+            m_colIdx++;
+        }
+        else if constexpr (std::is_same_v<BlobView, paramType>)
+        {
+            output.data = getBlobView(m_colIdx);
             m_colIdx++;
         }
         else if constexpr (std::is_integral_v<paramType>)
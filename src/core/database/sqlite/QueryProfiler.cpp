@@ -0,0 +1,428 @@
+#include "internal/implementation.h"
+#include "QueryProfiler.h"
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <iostream>
+#include <sstream>
+
+namespace sqlite
+{
+
+/// Escapes a string for use as a JSON string value
+static std::string escapeJson(const std::string &value)
+{
+    std::string result;
+    result.reserve(value.size());
+
+    for (char c : value)
+    {
+        switch (c)
+        {
+            case '"':  result += "\\\""; break;
+            case '\\': result += "\\\\"; break;
+            case '\n': result += "\\n";  break;
+            case '\r': result += "\\r";  break;
+            case '\t': result += "\\t";  break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20)
+                {
+                    static constexpr char hexDigits[] = "0123456789abcdef";
+                    result += "\\u00";
+                    result += hexDigits[(c >> 4) & 0xf];
+                    result += hexDigits[c & 0xf];
+                }
+                else
+                    result += c;
+                break;
+        }
+    }
+
+    return result;
+}
+
+QueryProfiler::QueryProfiler(Badge<Database>, sqlite3 *handle) :
+    m_handle{handle},
+    m_explainHandle{nullptr},
+    m_slowQueryThreshold{DefaultSlowQueryThreshold},
+    m_logger{},
+    m_running{},
+    m_currentStatement{nullptr},
+    m_normalizedSql{},
+    m_stats{},
+    m_mutex{}
+{
+    if (m_handle == nullptr)
+        return;
+
+    sqlite3_trace_v2(m_handle, SQLITE_TRACE_STMT | SQLITE_TRACE_PROFILE | SQLITE_TRACE_ROW | SQLITE_TRACE_CLOSE,
+                     &QueryProfiler::onTrace, this);
+    sqlite3_busy_handler(m_handle, &QueryProfiler::onBusy, this);
+}
+
+QueryProfiler::~QueryProfiler()
+{
+    if (m_handle != nullptr)
+    {
+        sqlite3_trace_v2(m_handle, 0, nullptr, nullptr);
+        sqlite3_busy_timeout(m_handle, internal::BusyTimeoutMs);
+    }
+
+    if (m_explainHandle != nullptr)
+        sqlite3_close_v2(m_explainHandle);
+}
+
+std::chrono::microseconds QueryProfiler::getSlowQueryThreshold() const
+{
+    std::lock_guard<std::mutex> lock{m_mutex};
+    return m_slowQueryThreshold;
+}
+
+void QueryProfiler::setSlowQueryThreshold(std::chrono::microseconds threshold)
+{
+    std::lock_guard<std::mutex> lock{m_mutex};
+    m_slowQueryThreshold = threshold;
+}
+
+void QueryProfiler::setLogger(Logger logger)
+{
+    std::lock_guard<std::mutex> lock{m_mutex};
+    m_logger = std::move(logger);
+}
+
+std::vector<QueryStats> QueryProfiler::getStats() const
+{
+    std::vector<QueryStats> result;
+    {
+        std::lock_guard<std::mutex> lock{m_mutex};
+        result.reserve(m_stats.size());
+        for (const auto &it : m_stats)
+            result.push_back(it.second);
+    }
+
+    std::sort(result.begin(), result.end(), [](const QueryStats &a, const QueryStats &b) {
+        return a.totalTime > b.totalTime;
+    });
+    return result;
+}
+
+void QueryProfiler::reset()
+{
+    std::lock_guard<std::mutex> lock{m_mutex};
+    m_stats.clear();
+}
+
+std::string QueryProfiler::toJson() const
+{
+    std::ostringstream stream;
+    stream << "{\n  \"queries\": [";
+
+    bool isFirst = true;
+    for (const QueryStats &stats : getStats())
+    {
+        const int64_t averageTime = stats.count > 0 ? stats.totalTime.count() / static_cast<int64_t>(stats.count) : 0;
+
+        stream << (isFirst ? "\n" : ",\n")
+               << "    {\n"
+               << "      \"sql\": \"" << escapeJson(stats.sql) << "\",\n"
+               << "      \"count\": " << stats.count << ",\n"
+               << "      \"totalTimeNs\": " << stats.totalTime.count() << ",\n"
+               << "      \"maxTimeNs\": " << stats.maxTime.count() << ",\n"
+               << "      \"averageTimeNs\": " << averageTime << ",\n"
+               << "      \"rowsStepped\": " << stats.rowsStepped << ",\n"
+               << "      \"busyWaits\": " << stats.busyWaits << ",\n"
+               << "      \"slowCount\": " << stats.slowCount << ",\n"
+               << "      \"queryPlan\": \"" << escapeJson(stats.queryPlan) << "\"\n"
+               << "    }";
+        isFirst = false;
+    }
+
+    stream << (isFirst ? "]\n}\n" : "\n  ]\n}\n");
+    return stream.str();
+}
+
+std::string QueryProfiler::normalize(const std::string &sql)
+{
+    std::string result;
+    result.reserve(sql.size());
+
+    auto isIdentifierChar = [](char c) {
+        return std::isalnum(static_cast<unsigned char>(c)) || c == '_' || c == '$';
+    };
+
+    bool pendingSpace = false;
+    for (std::size_t i = 0; i < sql.size();)
+    {
+        const char c = sql[i];
+
+        if (std::isspace(static_cast<unsigned char>(c)))
+        {
+            pendingSpace = !result.empty();
+            ++i;
+            continue;
+        }
+
+        if (pendingSpace)
+        {
+            result += ' ';
+            pendingSpace = false;
+        }
+
+        if (c == '\'')
+        {
+            // String literal, in which quotes are escaped by doubling them
+            ++i;
+            while (i < sql.size())
+            {
+                if (sql[i] == '\'')
+                {
+                    if (i + 1 < sql.size() && sql[i + 1] == '\'')
+                        i += 2;
+                    else
+                        break;
+                }
+                else
+                    ++i;
+            }
+
+            result += '?';
+            ++i;
+        }
+        else if (c == '"' || c == '`' || c == '[')
+        {
+            // Quoted identifier, kept as-is
+            const char closing = (c == '[') ? ']' : c;
+            const std::size_t end = sql.find(closing, i + 1);
+            const std::size_t length = (end == std::string::npos ? sql.size() : end + 1) - i;
+            result.append(sql, i, length);
+            i += length;
+        }
+        else if (std::isdigit(static_cast<unsigned char>(c)) && (result.empty() || !isIdentifierChar(result.back())))
+        {
+            // Numeric literal, including decimals, exponents and hexadecimal values
+            while (i < sql.size() && (isIdentifierChar(sql[i]) || sql[i] == '.'
+                                      || ((sql[i] == '+' || sql[i] == '-') && (sql[i - 1] == 'e' || sql[i - 1] == 'E'))))
+                ++i;
+
+            result += '?';
+        }
+        else
+        {
+            result += c;
+            ++i;
+        }
+    }
+
+    // Trailing semicolons do not change the statement
+    while (!result.empty() && (result.back() == ';' || result.back() == ' '))
+        result.pop_back();
+
+    return result;
+}
+
+int QueryProfiler::onTrace(unsigned type, void *context, void *p, void *x)
+{
+    QueryProfiler *profiler = static_cast<QueryProfiler*>(context);
+
+    switch (type)
+    {
+        case SQLITE_TRACE_STMT:
+        {
+            // Statements executed by triggers are reported with a comment instead of their text,
+            // and belong to the statement that is already running
+            const char *text = static_cast<const char*>(x);
+            if (text != nullptr && text[0] == '-' && text[1] == '-')
+                break;
+
+            sqlite3_stmt *statement = static_cast<sqlite3_stmt*>(p);
+            profiler->m_running[statement] = RunningStatement{0, 0, std::chrono::steady_clock::now()};
+            profiler->m_currentStatement = statement;
+            break;
+        }
+        case SQLITE_TRACE_ROW:
+        {
+            profiler->m_running[static_cast<sqlite3_stmt*>(p)].rowsStepped++;
+            break;
+        }
+        case SQLITE_TRACE_PROFILE:
+        {
+            const int64_t nanoseconds = *static_cast<sqlite3_int64*>(x);
+            profiler->recordExecution(static_cast<sqlite3_stmt*>(p), std::chrono::nanoseconds(nanoseconds));
+            break;
+        }
+        case SQLITE_TRACE_CLOSE:
+        {
+            profiler->m_handle = nullptr;
+            break;
+        }
+        default:
+            break;
+    }
+
+    return 0;
+}
+
+int QueryProfiler::onBusy(void *context, int count)
+{
+    // Same schedule of delays, in milliseconds, as the busy handler installed by sqlite3_busy_timeout
+    static constexpr std::array<int, 12> delays = { 1, 2, 5, 10, 15, 20, 25, 25, 25, 50, 50, 100 };
+    static constexpr std::array<int, 12> totals = { 0, 1, 3, 8, 18, 33, 53, 78, 103, 128, 178, 228 };
+
+    QueryProfiler *profiler = static_cast<QueryProfiler*>(context);
+    if (profiler->m_currentStatement != nullptr)
+    {
+        auto it = profiler->m_running.find(profiler->m_currentStatement);
+        if (it != profiler->m_running.end())
+            it->second.busyWaits++;
+    }
+
+    const std::size_t index = static_cast<std::size_t>(count);
+    int delay = 0, prior = 0;
+    if (index < delays.size())
+    {
+        delay = delays[index];
+        prior = totals[index];
+    }
+    else
+    {
+        delay = delays.back();
+        prior = totals.back() + delay * static_cast<int>(index - (delays.size() - 1));
+    }
+
+    if (prior + delay > internal::BusyTimeoutMs)
+    {
+        delay = internal::BusyTimeoutMs - prior;
+        if (delay <= 0)
+            return 0;
+    }
+
+    sqlite3_sleep(delay);
+    return 1;
+}
+
+void QueryProfiler::recordExecution(sqlite3_stmt *statement, std::chrono::nanoseconds reportedDuration)
+{
+    RunningStatement running { 0, 0, {} };
+    std::chrono::nanoseconds duration = reportedDuration;
+
+    auto runningIt = m_running.find(statement);
+    if (runningIt != m_running.end())
+    {
+        running = runningIt->second;
+        m_running.erase(runningIt);
+
+        duration = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - running.startedAt);
+    }
+
+    if (m_currentStatement == statement)
+        m_currentStatement = nullptr;
+
+    const char *text = sqlite3_sql(statement);
+    if (text == nullptr)
+        return;
+
+    const std::string sql(text);
+    auto normalizedIt = m_normalizedSql.find(sql);
+    if (normalizedIt == m_normalizedSql.end())
+    {
+        if (m_normalizedSql.size() >= MaxNormalizedSqlCacheSize)
+            m_normalizedSql.clear();
+        normalizedIt = m_normalizedSql.emplace(sql, normalize(sql)).first;
+    }
+    const std::string &normalizedSql = normalizedIt->second;
+
+    bool needsQueryPlan = false;
+    Logger logger;
+    {
+        std::lock_guard<std::mutex> lock{m_mutex};
+
+        QueryStats &stats = m_stats[normalizedSql];
+        if (stats.count == 0)
+            stats.sql = normalizedSql;
+
+        stats.count++;
+        stats.totalTime += duration;
+        stats.maxTime = std::max(stats.maxTime, duration);
+        stats.rowsStepped += running.rowsStepped;
+        stats.busyWaits += running.busyWaits;
+
+        if (duration < m_slowQueryThreshold)
+            return;
+
+        stats.slowCount++;
+        needsQueryPlan = stats.queryPlan.empty();
+        logger = m_logger;
+    }
+
+    std::string queryPlan;
+    if (needsQueryPlan)
+    {
+        queryPlan = explainQueryPlan(sql);
+
+        std::lock_guard<std::mutex> lock{m_mutex};
+        m_stats[normalizedSql].queryPlan = queryPlan;
+    }
+
+    std::ostringstream message;
+    message << "Slow query (" << std::chrono::duration_cast<std::chrono::microseconds>(duration).count() << " us, "
+            << running.rowsStepped << " rows, " << running.busyWaits << " busy waits): " << normalizedSql;
+    if (!queryPlan.empty())
+        message << "\nQuery plan:\n" << queryPlan;
+
+    if (logger)
+        logger(message.str());
+    else
+        std::cerr << "[SQLite3] " << message.str() << std::endl;
+}
+
+std::string QueryProfiler::explainQueryPlan(const std::string &sql)
+{
+    if (m_explainHandle == nullptr)
+    {
+        const char *fileName = (m_handle != nullptr) ? sqlite3_db_filename(m_handle, "main") : nullptr;
+        if (fileName == nullptr || fileName[0] == '\0')
+            return std::string();
+
+        if (sqlite3_open_v2(fileName, &m_explainHandle, SQLITE_OPEN_READONLY, nullptr) != SQLITE_OK)
+        {
+            sqlite3_close_v2(m_explainHandle);
+            m_explainHandle = nullptr;
+            return std::string();
+        }
+
+        sqlite3_busy_timeout(m_explainHandle, 100);
+    }
+
+    const std::string explainSql = "EXPLAIN QUERY PLAN " + sql;
+    sqlite3_stmt *statement = nullptr;
+    if (sqlite3_prepare_v2(m_explainHandle, explainSql.c_str(), -1, &statement, nullptr) != SQLITE_OK)
+        return std::string("(query plan unavailable: ") + sqlite3_errmsg(m_explainHandle) + ")";
+
+    // Each row contains the node's id, the id of its parent and a description
+    std::map<int, int> depths;
+    std::string result;
+    while (sqlite3_step(statement) == SQLITE_ROW)
+    {
+        const int id = sqlite3_column_int(statement, 0);
+        const int parent = sqlite3_column_int(statement, 1);
+        const unsigned char *detail = sqlite3_column_text(statement, 3);
+
+        const auto parentIt = depths.find(parent);
+        const int depth = parentIt != depths.end() ? parentIt->second + 1 : 0;
+        depths[id] = depth;
+
+        result.append(static_cast<std::size_t>(depth) * 2, ' ');
+        result += "- ";
+        result += detail != nullptr ? reinterpret_cast<const char*>(detail) : "";
+        result += '\n';
+    }
+
+    sqlite3_finalize(statement);
+
+    if (!result.empty())
+        result.pop_back();
+    return result;
+}
+
+}
@@ -0,0 +1,170 @@
+#ifndef _SQLITE_QUERY_PROFILER_H_
+#define _SQLITE_QUERY_PROFILER_H_
+
+#include "sqlite3.h"
+
+#include "Badge.h"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace sqlite
+{
+
+class Database;
+
+/// Aggregated statistics of all executions of a normalized SQL statement
+struct QueryStats
+{
+    /// Statement text, with whitespace collapsed and literals replaced by '?'
+    std::string sql;
+
+    /// Number of times the statement was executed
+    uint64_t count;
+
+    /// Total execution time
+    std::chrono::nanoseconds totalTime;
+
+    /// Longest single execution time
+    std::chrono::nanoseconds maxTime;
+
+    /// Number of result rows stepped through
+    uint64_t rowsStepped;
+
+    /// Number of times the statement had to wait for a lock held by another connection
+    uint64_t busyWaits;
+
+    /// Number of executions that exceeded the slow query threshold
+    uint64_t slowCount;
+
+    /// Output of EXPLAIN QUERY PLAN, captured the first time the statement was slow
+    std::string queryPlan;
+
+    /// Default constructor
+    QueryStats() : sql(), count(0), totalTime(0), maxTime(0), rowsStepped(0), busyWaits(0), slowCount(0), queryPlan() {}
+};
+
+/**
+ * @class QueryProfiler
+ * @brief Collects per-statement timing information of a database connection through sqlite3_trace_v2.
+ *        Profilers are created with Database::enableProfiling().
+ *
+ * Statistics are aggregated by normalized SQL text, so that executions of the same statement with
+ * different literals or formatting are counted together. Statements that take longer than the slow
+ * query threshold are reported to the logger, along with their query plan.
+ *
+ * Statistics are recorded on the thread that uses the connection, while getStats() and toJson()
+ * may be called from any thread. The state of running statements is only accessed from the
+ * connection's own callbacks, on the thread that uses the connection, and is not guarded.
+ */
+class QueryProfiler
+{
+public:
+    /// Receives reports of slow queries
+    using Logger = std::function<void(const std::string&)>;
+
+    /// Default slow query threshold
+    static constexpr std::chrono::milliseconds DefaultSlowQueryThreshold { 50 };
+
+    /// Maximum number of statements whose normalized SQL text is cached
+    static constexpr std::size_t MaxNormalizedSqlCacheSize = 256;
+
+    /// Installs the trace and busy handler callbacks on the connection. Only called by the \ref Database class
+    QueryProfiler(Badge<Database>, sqlite3 *handle);
+
+    /// Removes the callbacks from the connection, restoring its busy timeout
+    ~QueryProfiler();
+
+    QueryProfiler(const QueryProfiler&) = delete;
+    QueryProfiler &operator=(const QueryProfiler&) = delete;
+
+    /// Returns the execution time above which a statement is reported as slow
+    std::chrono::microseconds getSlowQueryThreshold() const;
+
+    /// Sets the execution time above which a statement is reported as slow
+    void setSlowQueryThreshold(std::chrono::microseconds threshold);
+
+    /// Sets the receiver of slow query reports. By default, reports are written to the standard error stream
+    void setLogger(Logger logger);
+
+    /// Returns the statistics of each statement, in descending order of total execution time
+    std::vector<QueryStats> getStats() const;
+
+    /// Clears all of the collected statistics. Statements that are currently running are recorded once they complete
+    void reset();
+
+    /// Returns the collected statistics as a JSON document
+    std::string toJson() const;
+
+    /// Returns the normalized form of the given SQL text, in which whitespace is collapsed and
+    /// string and numeric literals are replaced by '?'
+    static std::string normalize(const std::string &sql);
+
+private:
+    /// Statistics of a statement that is currently being executed
+    struct RunningStatement
+    {
+        /// Number of rows stepped through so far
+        uint64_t rowsStepped;
+
+        /// Number of busy waits so far
+        uint64_t busyWaits;
+
+        /// Time at which the statement began to run
+        std::chrono::steady_clock::time_point startedAt;
+    };
+
+    /// Receives events from sqlite3_trace_v2
+    static int onTrace(unsigned type, void *context, void *p, void *x);
+
+    /// Busy handler, which counts each wait before sleeping for the same intervals as sqlite3_busy_timeout
+    static int onBusy(void *context, int count);
+
+    /// Records the completed execution of a statement. The duration reported by SQLite is only used if the
+    /// start of the statement was not traced, as its resolution may be as coarse as a millisecond
+    void recordExecution(sqlite3_stmt *statement, std::chrono::nanoseconds reportedDuration);
+
+    /// Returns the output of EXPLAIN QUERY PLAN for the given SQL text. The plan is prepared on a separate,
+    /// read-only connection, since the profiled connection may not be used from within its trace callback
+    std::string explainQueryPlan(const std::string &sql);
+
+private:
+    /// Profiled connection
+    sqlite3 *m_handle;
+
+    /// Connection used to explain slow queries, opened when first needed. Only used on the connection's thread
+    sqlite3 *m_explainHandle;
+
+    /// Execution time above which statements are reported as slow
+    std::chrono::microseconds m_slowQueryThreshold;
+
+    /// Receiver of slow query reports
+    Logger m_logger;
+
+    /// Statements currently being executed. Only used on the connection's thread
+    std::unordered_map<sqlite3_stmt*, RunningStatement> m_running;
+
+    /// Statement whose execution began most recently, to which busy waits are attributed. Only used on the connection's thread
+    sqlite3_stmt *m_currentStatement;
+
+    /// Cache of normalized SQL text, by the original text. Cleared when it exceeds \ref MaxNormalizedSqlCacheSize
+    /// entries, since statements built with inline literals each have their own text. Only used on the connection's thread
+    std::unordered_map<std::string, std::string> m_normalizedSql;
+
+    /// Statistics by normalized SQL text
+    std::map<std::string, QueryStats> m_stats;
+
+    /// Guards the statistics, the slow query threshold and the logger
+    mutable std::mutex m_mutex;
+};
+
+}
+
+#endif // _SQLITE_QUERY_PROFILER_H_
@@ -8,6 +8,12 @@
 #include "Row.h"
 #include "PreparedStatement.h"
 #include "Database.h"
+#include "DatabaseProfile.h"
+#include "ConnectionPool.h"
+#include "QueryProfiler.h"
+#include "StatementCache.h"
+#include "Transaction.h"
+#include "BatchWriter.h"
 
 #endif // _SQLITE_WRAPPER_H_
 
@@ -0,0 +1,129 @@
+#include "Database.h"
+#include "StatementCache.h"
+
+#include <iterator>
+
+namespace sqlite
+{
+
+void StatementCache::Returner::operator()(PreparedStatement *statement) const
+{
+    if (entry != nullptr && cache != nullptr)
+        cache->checkin(entry);
+    else
+        delete statement;
+}
+
+StatementCache::StatementCache(const Database &database, std::size_t capacity) :
+    m_database{database},
+    m_capacity{capacity},
+    m_entries{},
+    m_index{},
+    m_hits{0},
+    m_misses{0},
+    m_evictions{0},
+    m_mutex{}
+{
+}
+
+StatementCache::~StatementCache()
+{
+}
+
+StatementCache::Handle StatementCache::checkout(std::string_view sql)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    auto it = m_index.find(sql);
+    if (it != m_index.end() && !it->second->inUse)
+    {
+        ++m_hits;
+
+        // Move the entry to the front of the list, marking it as the most recently used
+        m_entries.splice(m_entries.begin(), m_entries, it->second);
+
+        Entry &entry = m_entries.front();
+        entry.inUse = true;
+        entry.statement->reset();
+        return Handle{entry.statement.get(), Returner{this, &entry}};
+    }
+
+    ++m_misses;
+
+    auto statement = std::make_unique<PreparedStatement>(m_database.prepare(std::string(sql)));
+    if (it != m_index.end() || m_capacity == 0 || !statement->isValid())
+        return Handle{statement.release(), Returner{this, nullptr}};
+
+    m_entries.push_front(Entry{std::string(sql), std::move(statement), true});
+    Entry &entry = m_entries.front();
+    m_index[entry.sql] = m_entries.begin();
+
+    trim();
+    return Handle{entry.statement.get(), Returner{this, &entry}};
+}
+
+std::size_t StatementCache::getCapacity() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_capacity;
+}
+
+void StatementCache::setCapacity(std::size_t capacity)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_capacity = capacity;
+    trim();
+}
+
+void StatementCache::clear()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (auto it = m_entries.begin(); it != m_entries.end();)
+    {
+        auto current = it++;
+        if (!current->inUse)
+            erase(current);
+    }
+}
+
+StatementCacheStats StatementCache::getStats() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return StatementCacheStats{m_hits, m_misses, m_evictions, m_entries.size()};
+}
+
+void StatementCache::checkin(Entry *entry)
+{
+    // Release any lock held by a query whose results were not read to the end
+    entry->statement->reset();
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    entry->inUse = false;
+
+    trim();
+}
+
+void StatementCache::trim()
+{
+    auto it = m_entries.end();
+    while (m_entries.size() > m_capacity && it != m_entries.begin())
+    {
+        auto current = std::prev(it);
+        if (current->inUse)
+        {
+            it = current;
+            continue;
+        }
+
+        erase(current);
+        ++m_evictions;
+    }
+}
+
+void StatementCache::erase(std::list<Entry>::iterator it)
+{
+    m_index.erase(it->sql);
+    m_entries.erase(it);
+}
+
+}
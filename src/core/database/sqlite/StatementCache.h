@@ -0,0 +1,151 @@
+#ifndef _SQLITE_STATEMENT_CACHE_H_
+#define _SQLITE_STATEMENT_CACHE_H_
+
+#include "PreparedStatement.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace sqlite
+{
+
+class Database;
+
+/// Usage statistics of a \ref StatementCache
+struct StatementCacheStats
+{
+    /// Number of checkouts that reused a cached statement
+    uint64_t hits;
+
+    /// Number of checkouts that had to prepare a new statement
+    uint64_t misses;
+
+    /// Number of statements that were finalized to stay within the cache's capacity
+    uint64_t evictions;
+
+    /// Number of statements currently held by the cache
+    std::size_t size;
+};
+
+/**
+ * @class StatementCache
+ * @brief Bounded, least-recently-used cache of the prepared statements of a single
+ *        connection, keyed by their SQL text. Reusing a statement saves SQLite from
+ *        parsing and planning the same query on every call.
+ *
+ * Statements are borrowed with checkout() and returned to the cache when the returned
+ * handle is destroyed. A statement is reset, and its bindings cleared, both when it is
+ * checked out and when it is returned, so that it never holds a read lock while idle.
+ * If the statement of a query is already checked out, a separate, uncached statement is
+ * prepared instead.
+ *
+ * The cache may be used from several threads, as the connection it belongs to may be:
+ * its bookkeeping is guarded by a mutex, and a checked out statement is only ever used
+ * by the thread holding its handle. Handles must not outlive the cache.
+ */
+class StatementCache
+{
+    /// Cached statement and its state
+    struct Entry
+    {
+        /// SQL text of the statement
+        std::string sql;
+
+        /// Prepared statement
+        std::unique_ptr<PreparedStatement> statement;
+
+        /// Set to true while the statement is checked out
+        bool inUse;
+    };
+
+public:
+    /// Deleter of a checked out statement, which returns it to the cache
+    struct Returner
+    {
+        /// Cache that the statement belongs to
+        StatementCache *cache;
+
+        /// Entry of the statement, or a nullptr if the statement is not cached
+        Entry *entry;
+
+        /// Returns the statement to the cache, or finalizes it if it is not cached
+        void operator()(PreparedStatement *statement) const;
+    };
+
+    /// Handle of a checked out statement
+    using Handle = std::unique_ptr<PreparedStatement, Returner>;
+
+    /// Default maximum number of statements held by a cache
+    static constexpr std::size_t DefaultCapacity = 64;
+
+    /// Constructs the cache for the given connection
+    explicit StatementCache(const Database &database, std::size_t capacity = DefaultCapacity);
+
+    /// Finalizes all of the cached statements
+    ~StatementCache();
+
+    StatementCache(const StatementCache&) = delete;
+    StatementCache &operator=(const StatementCache&) = delete;
+
+    /// Returns a prepared statement for the given query, reusing a cached one when possible
+    Handle checkout(std::string_view sql);
+
+    /// Returns the maximum number of statements held by the cache
+    std::size_t getCapacity() const;
+
+    /// Sets the maximum number of statements held by the cache, evicting the least recently used ones if necessary.
+    /// A capacity of 0 disables caching
+    void setCapacity(std::size_t capacity);
+
+    /// Finalizes all of the statements that are not currently checked out
+    void clear();
+
+    /// Returns the usage statistics of the cache
+    StatementCacheStats getStats() const;
+
+private:
+    /// Puts a checked out statement back into the cache
+    void checkin(Entry *entry);
+
+    /// Evicts the least recently used statements that are not checked out, until the cache is within its capacity.
+    /// Must be called with the mutex held
+    void trim();
+
+    /// Removes the given entry, finalizing its statement
+    void erase(std::list<Entry>::iterator it);
+
+private:
+    /// Connection that the statements belong to
+    const Database &m_database;
+
+    /// Maximum number of cached statements
+    std::size_t m_capacity;
+
+    /// Cached statements, from the most to the least recently used
+    std::list<Entry> m_entries;
+
+    /// Index of the cached statements by their SQL text, which refers to the string held by the entry
+    std::unordered_map<std::string_view, std::list<Entry>::iterator> m_index;
+
+    /// Number of checkouts that reused a cached statement
+    uint64_t m_hits;
+
+    /// Number of checkouts that prepared a new statement
+    uint64_t m_misses;
+
+    /// Number of evicted statements
+    uint64_t m_evictions;
+
+    /// Guards the entries, the index and the statistics
+    mutable std::mutex m_mutex;
+};
+
+}
+
+#endif // _SQLITE_STATEMENT_CACHE_H_
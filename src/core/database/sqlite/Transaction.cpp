@@ -0,0 +1,72 @@
+#include "Database.h"
+#include "Transaction.h"
+
+#include <string>
+
+namespace sqlite
+{
+
+/// Name of the savepoints used for nested transactions. Since transactions are strictly nested, the most
+/// recent savepoint with this name always belongs to the innermost transaction
+static constexpr char savepointName[] = "sqlite_wrapper_transaction";
+
+Transaction::Transaction(Database &database) :
+    m_database{database},
+    m_isSavepoint{database.isInTransaction()},
+    m_isActive{false}
+{
+    if (m_isSavepoint)
+        m_isActive = m_database.execute(std::string("SAVEPOINT ") + savepointName);
+    else
+        m_isActive = m_database.beginTransaction();
+}
+
+Transaction::~Transaction()
+{
+    if (m_isActive)
+        rollback();
+}
+
+bool Transaction::commit()
+{
+    if (!m_isActive)
+        return false;
+
+    const bool result = m_isSavepoint ? m_database.execute(std::string("RELEASE ") + savepointName)
+                                      : m_database.commitTransaction();
+    if (!result)
+    {
+        rollback();
+        return false;
+    }
+
+    m_isActive = false;
+    return true;
+}
+
+bool Transaction::rollback()
+{
+    if (!m_isActive)
+        return false;
+
+    m_isActive = false;
+
+    // Rolling back to a savepoint keeps it on the stack, so it must also be released
+    if (m_isSavepoint)
+        return m_database.execute(std::string("ROLLBACK TO ") + savepointName)
+                && m_database.execute(std::string("RELEASE ") + savepointName);
+
+    return m_database.rollbackTransaction();
+}
+
+bool Transaction::isActive() const
+{
+    return m_isActive;
+}
+
+bool Transaction::isSavepoint() const
+{
+    return m_isSavepoint;
+}
+
+}
@@ -0,0 +1,62 @@
+#ifndef _SQLITE_TRANSACTION_H_
+#define _SQLITE_TRANSACTION_H_
+
+namespace sqlite
+{
+
+class Database;
+
+/**
+ * @class Transaction
+ * @brief Scoped transaction on a database connection. The transaction begins when the object is
+ *        constructed, and is rolled back when the object is destroyed unless commit() was called,
+ *        including when the scope is left because of an exception.
+ *
+ * Transactions may be nested. A transaction that begins while the connection is already in a
+ * transaction is implemented as a savepoint, so that rolling it back only reverts the changes
+ * made since it began, and committing it only makes its changes part of the outer transaction.
+ *
+ *     sqlite::Transaction transaction(db);
+ *     ...
+ *     if (!transaction.commit())
+ *         ... // changes have been rolled back
+ */
+class Transaction
+{
+public:
+    /// Begins a transaction, or a savepoint if the connection is already in a transaction
+    explicit Transaction(Database &database);
+
+    /// Rolls the transaction back if it has not been committed
+    ~Transaction();
+
+    Transaction(const Transaction&) = delete;
+    Transaction &operator=(const Transaction&) = delete;
+
+    /// Commits the transaction, or releases the savepoint. Returns true on success. If the commit
+    /// fails, the transaction is rolled back
+    bool commit();
+
+    /// Reverts the changes made since the transaction began. Returns true on success
+    bool rollback();
+
+    /// Returns true if the transaction began successfully and has not yet been committed or rolled back
+    bool isActive() const;
+
+    /// Returns true if the transaction is nested within another, and is implemented as a savepoint
+    bool isSavepoint() const;
+
+private:
+    /// Connection that the transaction belongs to
+    Database &m_database;
+
+    /// True if the transaction is nested in another transaction
+    bool m_isSavepoint;
+
+    /// True while the transaction is in progress
+    bool m_isActive;
+};
+
+}
+
+#endif // _SQLITE_TRANSACTION_H_
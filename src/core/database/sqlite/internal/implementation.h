@@ -9,10 +9,8 @@ namespace sqlite
 namespace internal
 {
 
-constexpr int BusyTimeoutIntervalMs = 250;
-
-/// Handles a busy error when a database is locked by another thread
-int busyHandler(void*, int numTries);
+/// Maximum amount of time spent waiting for a lock held by another connection, in milliseconds
+constexpr int BusyTimeoutMs = 5000;
 
 /**
  * @class Implementation
@@ -6,7 +6,6 @@
 
 #include <chrono>
 #include <QByteArray>
-#include <QBuffer>
 #include <QFile>
 #include <QSet>
 #include <QJsonArray>
@@ -17,21 +16,6 @@
 
 const QString FavoritePagesManager::Version = QStringLiteral("1.1");
 
-QString WebPageInformation::getThumbnailInBase64() const
-{
-    QString result = QLatin1String("data:image/png;base64, ");
-
-    QByteArray data;
-    QBuffer buffer(&data);
-    Thumbnail.save(&buffer, "PNG");
-
-    if (data.isEmpty())
-        return QString();
-
-    result.append(data.toBase64());
-    return result;
-}
-
 FavoritePagesManager::FavoritePagesManager(HistoryManager *historyMgr, WebPageThumbnailStore *thumbnailStore, const QString &dataFile, QObject *parent) :
     QObject(parent),
     m_timerId(0),
@@ -75,7 +59,7 @@ bool FavoritePagesManager::isPresent(const QUrl &url) const
     return false;
 }
 
-QVariantList FavoritePagesManager::getFavorites() const
+QVariantList FavoritePagesManager::getFavorites()
 {
     QVariantList result;
 
@@ -86,7 +70,8 @@ QVariantList FavoritePagesManager::getFavorites() const
             item[QLatin1String("position")] = pageInfo.Position;
             item[QLatin1String("title")] = pageInfo.Title;
             item[QLatin1String("url")] = pageInfo.URL;
-            item[QLatin1String("thumbnail")] = pageInfo.getThumbnailInBase64();
+            item[QLatin1String("thumbnail")] = getThumbnailUrl(pageInfo.URL);
+            item[QLatin1String("favicon")] = getFaviconUrl(pageInfo.URL);
             result.append(item);
         }
     };
@@ -108,7 +93,6 @@ void FavoritePagesManager::addFavorite(const QUrl &url, const QString &title)
     pageInfo.Position = static_cast<int>(m_favoritePages.size());
     pageInfo.URL = url;
     pageInfo.Title = title;
-    pageInfo.Thumbnail = m_thumbnailStore->getThumbnail(url);
 
     if (title.isEmpty())
     {
@@ -192,7 +176,6 @@ void FavoritePagesManager::loadFavorites()
         pageInfo.Position = currentPage.value(QLatin1String("position")).toInt();
         pageInfo.Title = currentPage.value(QLatin1String("title")).toString();
         pageInfo.URL = QUrl(currentPage.value(QLatin1String("url")).toString());
-        pageInfo.Thumbnail = m_thumbnailStore->getThumbnail(pageInfo.URL);
 
         m_favoritePages.push_back(pageInfo);
         favoritedUrls.insert(pageInfo.URL);
@@ -240,7 +223,7 @@ void FavoritePagesManager::loadFromHistory()
     // Load most frequent visits, and then remove any that the user requested to be excluded from
     // the new tab page
     const int numResults = 10 + static_cast<int>(m_excludedPages.size());
-    m_historyManager->loadMostVisitedEntries(numResults, [=](std::vector<WebPageInformation> &&results){
+    m_historyManager->loadMostVisitedEntries(numResults).then(this, [this](std::vector<WebPageInformation> results){
         int itemPosition = static_cast<int>(m_favoritePages.size());
         m_mostVisitedPages = std::move(results);
         for (auto it = m_mostVisitedPages.begin(); it != m_mostVisitedPages.end();)
@@ -249,9 +232,8 @@ void FavoritePagesManager::loadFromHistory()
                 it = m_mostVisitedPages.erase(it);
             else
             {
-                // Set position and get the thumbnail if we will keep this result
+                // Set position if we will keep this result. The thumbnail is loaded when the page is displayed
                 it->Position = itemPosition++;
-                it->Thumbnail = m_thumbnailStore->getThumbnail(it->URL);
                 ++it;
             }
         }
@@ -301,3 +283,22 @@ void FavoritePagesManager::save()
     saveFile.write(doc.toJson());
     saveFile.close();
 }
+
+QString FavoritePagesManager::getThumbnailUrl(const QUrl &pageUrl) const
+{
+    if (!m_thumbnailStore)
+        return QString();
+
+    // The tag changes along with the thumbnail, allowing the web engine to cache the image indefinitely
+    const QString tag = m_thumbnailStore->getThumbnailTag(pageUrl);
+    if (tag.isEmpty())
+        return QString();
+
+    const QString host = QString::fromLatin1(QUrl::toPercentEncoding(pageUrl.host().toLower()));
+    return QStringLiteral("viper://thumbnail/%1?v=%2").arg(host, tag);
+}
+
+QString FavoritePagesManager::getFaviconUrl(const QUrl &pageUrl) const
+{
+    return QStringLiteral("viper://favicon/%1").arg(QString::fromLatin1(QUrl::toPercentEncoding(pageUrl.toString())));
+}
@@ -4,7 +4,6 @@
 #include <vector>
 
 #include <QDateTime>
-#include <QImage>
 #include <QMetaType>
 #include <QObject>
 #include <QString>
@@ -15,8 +14,8 @@
 class HistoryManager;
 class WebPageThumbnailStore;
 
-/// Stores information about a specific web page, such as its URL, title
-/// and a thumbnail
+/// Stores information about a specific web page, such as its URL and title.
+/// Thumbnails are fetched by the new tab page from the viper://thumbnail endpoint.
 struct WebPageInformation
 {
     /// Position of the web page on the favorites web page
@@ -27,12 +26,6 @@ struct WebPageInformation
 
     /// URL of the page
     QUrl URL;
-
-    /// A small image of the web page
-    QImage Thumbnail;
-
-    /// Returns the thumbnail as a base-64 encoded string
-    QString getThumbnailInBase64() const;
 };
 
 /// Stores information about an entry that the user removed from the New Tab page
@@ -75,8 +68,9 @@ class FavoritePagesManager : public QObject
     bool isPresent(const QUrl &url) const;
 
 public Q_SLOTS:
-    /// Returns a list of the user's favorite web pages. The QVariants in the list may be converted to \ref WebPageInformation
-    QVariantList getFavorites() const;
+    /// Returns a list of the user's favorite web pages. The QVariants in the list may be converted to \ref WebPageInformation.
+    /// Each item references its thumbnail and favicon by their viper:// URLs, rather than carrying the image data itself.
+    QVariantList getFavorites();
 
     /// Adds an item to the list of favorited (pinned) web pages
     void addFavorite(const QUrl &url, const QString &title);
@@ -105,6 +99,12 @@ public Q_SLOTS:
     /// Saves the lists of favorite pages and excluded pages to disk
     void save();
 
+    /// Returns the viper:// URL of the thumbnail of the given page, or an empty string if the page has no thumbnail
+    QString getThumbnailUrl(const QUrl &pageUrl) const;
+
+    /// Returns the viper:// URL of the favicon of the given page
+    QString getFaviconUrl(const QUrl &pageUrl) const;
+
 private:
     /// Unique identifier of the page update timer
     int m_timerId;
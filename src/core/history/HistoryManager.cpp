@@ -35,7 +35,7 @@ HistoryManager::HistoryManager(const ViperServiceLocator &serviceLocator, Databa
         m_historyStore = static_cast<HistoryStore*>(m_taskScheduler.getWorker("HistoryStore"));
     });
 
-    m_taskScheduler.post([this](){
+    m_taskScheduler.post("HistoryStore", DatabaseTaskPriority::Interactive, [this](){
         //onHistoryRecordsLoaded(m_historyStore->getEntries());
         onRecentItemsLoaded(m_historyStore->getRecentItems());
 
@@ -62,7 +62,7 @@ void HistoryManager::clearAllHistory()
     m_recentItems.clear();
     m_historyItems.clear();
 
-    m_taskScheduler.post(&HistoryStore::clearAllHistory, std::ref(m_historyStore));
+    m_taskScheduler.post("HistoryStore", DatabaseTaskPriority::Background, &HistoryStore::clearAllHistory, std::ref(m_historyStore));
 }
 
 void HistoryManager::clearHistoryFrom(const QDateTime &start)
@@ -72,7 +72,7 @@ void HistoryManager::clearHistoryFrom(const QDateTime &start)
 
 void HistoryManager::clearHistoryInRange(std::pair<QDateTime, QDateTime> range)
 {
-    m_taskScheduler.post([this, range](){
+    m_taskScheduler.post("HistoryStore", DatabaseTaskPriority::Background, [this, range](){
         m_recentItems.clear();
 
         m_historyStore->clearHistoryInRange(range);
@@ -115,7 +115,8 @@ void HistoryManager::addVisit(const QUrl &url, const QString &title, const QDate
             || url.toString(QUrl::FullyEncoded).startsWith(QLatin1String("data:"), Qt::CaseInsensitive))
         return;
 
-    m_taskScheduler.post(&HistoryStore::addVisit, std::ref(m_historyStore), QUrl(url), QString(title),
+    m_taskScheduler.post("HistoryStore", DatabaseTaskPriority::Interactive,
+                         &HistoryStore::addVisit, std::ref(m_historyStore), QUrl(url), QString(title),
                          QDateTime(visitTime), QUrl(requestedUrl), wasTypedByUser);
 
     if (!CommonUtil::doUrlsMatch(requestedUrl, url))
@@ -165,21 +166,21 @@ void HistoryManager::addVisitToLocalStore(const QUrl &url, const QString &title,
 
 void HistoryManager::getHistoryBetween(const QDateTime &startDate, const QDateTime &endDate, std::function<void(std::vector<URLRecord>)> callback)
 {
-    m_taskScheduler.post([this, startDate, endDate, callback](){
+    m_taskScheduler.post("HistoryStore", DatabaseTaskPriority::Interactive, [this, startDate, endDate, callback](){
         callback(m_historyStore->getHistoryBetween(startDate, endDate));
     });
 }
 
 void HistoryManager::getHistoryFrom(const QDateTime &startDate, std::function<void(std::vector<URLRecord>)> callback)
 {
-    m_taskScheduler.post([this, startDate, callback](){
+    m_taskScheduler.post("HistoryStore", DatabaseTaskPriority::Interactive, [this, startDate, callback](){
         callback(m_historyStore->getHistoryFrom(startDate));
     });
 }
 
 void HistoryManager::contains(const QUrl &url, std::function<void(bool)> callback)
 {
-    m_taskScheduler.post([this, url, callback](){
+    m_taskScheduler.post("HistoryStore", DatabaseTaskPriority::Interactive, [this, url, callback](){
         callback(m_historyStore->contains(url));
     });
 }
@@ -197,7 +198,7 @@ HistoryEntry HistoryManager::getEntry(const QUrl &url) const
 
 void HistoryManager::getTimesVisitedHost(const QUrl &host, std::function<void(int)> callback)
 {
-    m_taskScheduler.post([this, host, callback](){
+    m_taskScheduler.post("HistoryStore", DatabaseTaskPriority::Interactive, [this, host, callback](){
         callback(m_historyStore->getTimesVisitedHost(host));
     });
 }
@@ -236,23 +237,23 @@ void HistoryManager::onHistoryRecordsLoaded(std::vector<URLRecord> &&records)
     }
 }
 
-void HistoryManager::loadMostVisitedEntries(int limit, std::function<void(std::vector<WebPageInformation>)> callback)
+QFuture<std::vector<WebPageInformation>> HistoryManager::loadMostVisitedEntries(int limit)
 {
-    m_taskScheduler.post([this, limit, callback](){
-        callback(m_historyStore->loadMostVisitedEntries(limit));
+    return m_taskScheduler.schedule("HistoryStore", DatabaseTaskPriority::Interactive, [this, limit](){
+        return m_historyStore->loadMostVisitedEntries(limit);
     });
 }
 
 void HistoryManager::loadWordDatabase(std::function<void(std::map<int, QString>)> callback)
 {
-    m_taskScheduler.post([this, callback](){
+    m_taskScheduler.post("HistoryStore", DatabaseTaskPriority::Background, [this, callback](){
         callback(m_historyStore->getWords());
     });
 }
 
 void HistoryManager::loadHistoryWordMapping(std::function<void(std::map<int, std::vector<int>>)> callback)
 {
-    m_taskScheduler.post([this, callback](){
+    m_taskScheduler.post("HistoryStore", DatabaseTaskPriority::Background, [this, callback](){
         callback(m_historyStore->getEntryWordMapping());
     });
 }
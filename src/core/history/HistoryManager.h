@@ -12,6 +12,7 @@
 #include <QDateTime>
 #include <QHash>
 #include <QIcon>
+#include <QFuture>
 #include <QList>
 #include <QMetaType>
 #include <QUrl>
@@ -100,7 +101,7 @@ class HistoryManager : public QObject, public ISettingsObserver
 
     /// Fetches the set of most frequently visited web pages, up to the given limit. This is used to
     /// determine which web pages' thumbnails to retrieve for the "New Tab" page
-    void loadMostVisitedEntries(int limit, std::function<void(std::vector<WebPageInformation>)> callback);
+    QFuture<std::vector<WebPageInformation>> loadMostVisitedEntries(int limit);
 
     /// Loads the word table into a map, returning the data in the callback function. Used by the
     /// URL suggestion worker when recommending matches based on user input
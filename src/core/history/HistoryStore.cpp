@@ -1,6 +1,8 @@
 #include "CommonUtil.h"
 #include "HistoryStore.h"
 
+#include <string_view>
+
 #include <QDateTime>
 #include <QUrl>
 #include <QDebug>
@@ -58,9 +60,9 @@ void HistoryStore::clearHistoryInRange(std::pair<QDateTime, QDateTime> range)
 
 bool HistoryStore::contains(const QUrl &url) const
 {
-    auto stmt = m_database.prepare(R"(SELECT VisitID FROM History WHERE URL = ?)");
-    stmt << url;
-    return stmt.next();
+    auto stmt = m_database.prepareCached(R"(SELECT VisitID FROM History WHERE URL = ?)");
+    *stmt << url;
+    return stmt->next();
 }
 
 HistoryEntry HistoryStore::getEntry(const QUrl &url)
@@ -82,12 +84,12 @@ std::vector<VisitEntry> HistoryStore::getVisits(const HistoryEntry &record)
 {
     std::vector<VisitEntry> result;
 
-    auto stmt = m_database.prepare(R"(SELECT Date FROM Visits WHERE VisitID = ? ORDER BY Date ASC)");
-    stmt << record.VisitID;
-    while (stmt.next())
+    auto stmt = m_database.prepareCached(R"(SELECT Date FROM Visits WHERE VisitID = ? ORDER BY Date ASC)");
+    *stmt << record.VisitID;
+    while (stmt->next())
     {
         QDateTime currentDate;
-        stmt >> currentDate;
+        *stmt >> currentDate;
         result.push_back(currentDate);
     }
 
@@ -98,15 +100,15 @@ std::deque<HistoryEntry> HistoryStore::getRecentItems()
 {
     std::deque<HistoryEntry> result;
 
-    auto stmt = m_database.prepare(R"(SELECT Visits.VisitID, History.URL, History.Title,
+    auto stmt = m_database.prepareCached(R"(SELECT Visits.VisitID, History.URL, History.Title,
      History.URLTypedCount, 1, Visits.Date FROM Visits
      INNER JOIN History ON Visits.VisitID = History.VisitID
      ORDER BY Visits.Date DESC LIMIT 15;)");
 
-    while (stmt.next())
+    while (stmt->next())
     {
         HistoryEntry entry;
-        stmt >> entry;
+        *stmt >> entry;
         result.push_back(std::move(entry));
     }
 
@@ -125,39 +127,39 @@ std::vector<URLRecord> HistoryStore::getHistoryBetween(const QDateTime &startDat
     if (!startDate.isValid() || !endDate.isValid())
         return result;
 
-    auto queryVisitIds = m_database.prepare(R"(SELECT DISTINCT VisitID FROM Visits WHERE Date >= ? AND Date <= ?
+    auto queryVisitIds = m_database.prepareCached(R"(SELECT DISTINCT VisitID FROM Visits WHERE Date >= ? AND Date <= ?
                                             ORDER BY Date ASC)");
-    auto queryHistoryItem = m_database.prepare(R"(SELECT URL, Title, URLTypedCount FROM History WHERE VisitID = ?)");
-    auto queryVisitDates = m_database.prepare(R"(SELECT Date FROM Visits WHERE VisitID = ?
+    auto queryHistoryItem = m_database.prepareCached(R"(SELECT URL, Title, URLTypedCount FROM History WHERE VisitID = ?)");
+    auto queryVisitDates = m_database.prepareCached(R"(SELECT Date FROM Visits WHERE VisitID = ?
                                               AND Date >= ? AND Date <= ? ORDER BY Date ASC)");
 
-    queryVisitIds << startDate
-                  << endDate;
-    while (queryVisitIds.next())
+    *queryVisitIds << startDate
+                   << endDate;
+    while (queryVisitIds->next())
     {
         int visitId = 0;
-        queryVisitIds >> visitId;
+        *queryVisitIds >> visitId;
 
-        queryHistoryItem.reset();
-        queryHistoryItem << visitId;
-        if (!queryHistoryItem.execute() || !queryHistoryItem.next())
+        queryHistoryItem->reset();
+        *queryHistoryItem << visitId;
+        if (!queryHistoryItem->execute() || !queryHistoryItem->next())
             continue;
 
         HistoryEntry entry;
         entry.VisitID = visitId;
-        queryHistoryItem >> entry.URL
-                         >> entry.Title
-                         >> entry.URLTypedCount;
+        *queryHistoryItem >> entry.URL
+                          >> entry.Title
+                          >> entry.URLTypedCount;
 
         std::vector<VisitEntry> visits;
-        queryVisitDates.reset();
-        queryVisitDates << visitId
-                        << startDate
-                        << endDate;
-        while (queryVisitDates.next())
+        queryVisitDates->reset();
+        *queryVisitDates << visitId
+                         << startDate
+                         << endDate;
+        while (queryVisitDates->next())
         {
             QDateTime temp = QDateTime();
-            queryVisitDates >> temp;
+            *queryVisitDates >> temp;
             visits.push_back(temp);
         }
 
@@ -171,15 +173,15 @@ std::vector<URLRecord> HistoryStore::getHistoryBetween(const QDateTime &startDat
 
 int HistoryStore::getTimesVisitedHost(const QUrl &url) const
 {
-    auto query = m_database.prepare(R"(SELECT COUNT(NumVisits) FROM (SELECT VisitID, COUNT(VisitID) AS NumVisits
+    auto query = m_database.prepareCached(R"(SELECT COUNT(NumVisits) FROM (SELECT VisitID, COUNT(VisitID) AS NumVisits
                                     FROM Visits INDEXED BY Visit_ID_Index GROUP BY VisitID ) WHERE VisitID IN (SELECT VisitID FROM History
                                     WHERE URL LIKE ?))");
     std::string param = QString("%%1%").arg(url.host().remove(QRegularExpression("^www\\.")).toLower()).toStdString();
-    query << param;
-    if (query.next())
+    *query << param;
+    if (query->next())
     {
         int numVisits = 0;
-        query >> numVisits;
+        *query >> numVisits;
         return numVisits;
     }
 
@@ -188,17 +190,17 @@ int HistoryStore::getTimesVisitedHost(const QUrl &url) const
 
 int HistoryStore::getTimesVisited(const QUrl &url) const
 {
-    auto query = m_database.prepare(R"(SELECT h.VisitID, v.NumVisits FROM History AS h
+    auto query = m_database.prepareCached(R"(SELECT h.VisitID, v.NumVisits FROM History AS h
                                     INNER JOIN (SELECT VisitID, COUNT(VisitID) AS NumVisits
                                     FROM Visits INDEXED BY Visit_ID_Index GROUP BY VisitID) AS v
                                     ON h.VisitID = v.VisitID WHERE h.URL = ?)");
-    query << url;
-    if (query.next())
+    *query << url;
+    if (query->next())
     {
         int visitId = 0,
             numVisits = 0;
-        query >> visitId
-              >> numVisits;
+        *query >> visitId
+               >> numVisits;
         return numVisits;
     }
 
@@ -262,6 +264,9 @@ void HistoryStore::addVisit(const QUrl &url, const QString &title, const QDateTi
     if (url.toString(QUrl::FullyEncoded).startsWith(QStringLiteral("data:")))
         return;
 
+    // Group the writes of the visit, including its word mappings, into a single transaction
+    sqlite::Transaction transaction(m_database);
+
     auto existingEntry = getEntry(url);
     qulonglong visitId = existingEntry.VisitID >= 0 ? static_cast<qulonglong>(existingEntry.VisitID) : ++m_lastVisitID;
     if (existingEntry.VisitID >= 0)
@@ -315,6 +320,9 @@ void HistoryStore::addVisit(const QUrl &url, const QString &title, const QDateTi
 
         addVisit(requestedUrl, title, requestDateTime, requestedUrl, wasTypedByUser);
     }
+
+    if (!transaction.commit())
+        qWarning() << "HistoryStore::addVisit - could not commit visit to database.";
 }
 
 uint64_t HistoryStore::getLastVisitId() const
@@ -423,17 +431,17 @@ void HistoryStore::checkForUpdate()
         return;
 
     bool hasUrlTypeCountColumn = false;
-    const QString urlTypeCountColumn("URLTypedCount");
+    constexpr std::string_view urlTypeCountColumn("URLTypedCount");
 
     while (stmt.next())
     {
         int cid = 0;
-        QString colName;
+        std::string_view colName;
 
         stmt >> cid
              >> colName;
 
-        if (colName.compare(urlTypeCountColumn) == 0)
+        if (colName == urlTypeCountColumn)
         {
             hasUrlTypeCountColumn = true;
             break;
@@ -475,31 +483,31 @@ std::vector<WebPageInformation> HistoryStore::loadMostVisitedEntries(int limit)
         return result;
 
     auto stmt =
-            m_database.prepare(R"(SELECT v.VisitID, COUNT(v.VisitID) AS NumVisits, h.URL, h.Title
+            m_database.prepareCached(R"(SELECT v.VisitID, COUNT(v.VisitID) AS NumVisits, h.URL, h.Title
                                FROM Visits AS v
                                JOIN History AS h
                                  ON v.VisitID = h.VisitID
                                GROUP BY v.VisitID
                                ORDER BY NumVisits DESC LIMIT ?)");
-    stmt << limit;
-    if (!stmt.execute())
+    *stmt << limit;
+    if (!stmt->execute())
     {
         qWarning() << "In HistoryStore::loadMostVisitedEntries - unable to load most frequently visited entries.";
         return result;
     }
 
     int count = 0;
-    while (stmt.next())
+    while (stmt->next())
     {
         int visitId = 0, numVisits = 0;
-        stmt >> visitId
-             >> numVisits;
+        *stmt >> visitId
+              >> numVisits;
 
         WebPageInformation item;
         item.Position = count++;
 
-        stmt >> item.URL
-             >> item.Title;
+        *stmt >> item.URL
+              >> item.Title;
         result.push_back(std::move(item));
     }
 
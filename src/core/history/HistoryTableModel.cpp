@@ -1,6 +1,9 @@
 #include "HistoryTableModel.h"
 #include "HistoryManager.h"
 #include "FaviconManager.h"
+#include "FaviconPixmapCache.h"
+
+#include <QGuiApplication>
 
 #include <utility>
 
@@ -78,7 +81,7 @@ void HistoryTableModel::onHistoryFetched(std::vector<URLRecord> &&entries)
         HistoryTableItem tableItem;
         tableItem.Title = it.getTitle();
         tableItem.URL = it.getUrl().toString();
-        tableItem.Favicon = m_faviconManager->getFavicon(it.getUrl()).pixmap(16, 16);
+        tableItem.Favicon = m_faviconManager->getFavicon(it.getUrl());
         m_commonData.push_back(tableItem);
 
         int itemIndex = static_cast<int>(m_commonData.size()) - 1;
@@ -129,9 +132,9 @@ QVariant HistoryTableModel::data(const QModelIndex &index, int role) const
             if (role == Qt::DisplayRole)
                 return itemData.Title;
             else if (role == Qt::DecorationRole)
-                return itemData.Favicon;
+                return FaviconPixmapCache::instance().pixmap(itemData.Favicon, 16, qApp->devicePixelRatio());
             else if (role == Qt::SizeHintRole)
-                return itemData.Favicon.size();
+                return QSize(16, 16);
             break;
         }
         // URL column
@@ -7,8 +7,8 @@
 #include <vector>
 #include <QAbstractTableModel>
 #include <QDateTime>
+#include <QIcon>
 #include <QMap>
-#include <QPixmap>
 #include <QUrl>
 
 class HistoryManager;
@@ -23,8 +23,8 @@ class FaviconManager;
  */
 struct HistoryTableItem
 {
-    /// Favicon of the page
-    QPixmap Favicon;
+    /// Favicon of the page. Rasterized through the \ref FaviconPixmapCache when displayed
+    QIcon Favicon;
 
     /// Title of the web page
     QString Title;
@@ -0,0 +1,128 @@
+#include "ThumbnailCapturePipeline.h"
+
+#include <QBuffer>
+#include <QFuture>
+#include <QFutureWatcher>
+#include <QtConcurrent>
+
+const QSize ThumbnailCapturePipeline::ThumbnailSize = QSize(375, 500);
+
+ThumbnailCapturePipeline::ThumbnailCapturePipeline(QObject *parent) :
+    QObject(parent),
+    m_hostCaptureInterval(60),
+    m_lastCaptureTimes(),
+    m_lastContentHashes(),
+    m_inProgress(),
+    m_unchangedCount(0)
+{
+}
+
+ThumbnailCapturePipeline::~ThumbnailCapturePipeline()
+{
+}
+
+void ThumbnailCapturePipeline::setHostCaptureInterval(int seconds)
+{
+    m_hostCaptureInterval = seconds;
+}
+
+bool ThumbnailCapturePipeline::shouldCapture(const QStringList &hosts) const
+{
+    const QDateTime now = QDateTime::currentDateTime();
+    for (const QString &host : hosts)
+    {
+        if (m_inProgress.contains(host))
+            continue;
+
+        auto it = m_lastCaptureTimes.find(host);
+        if (it == m_lastCaptureTimes.end() || it.value().secsTo(now) >= m_hostCaptureInterval)
+            return true;
+    }
+
+    return false;
+}
+
+void ThumbnailCapturePipeline::submit(const QStringList &hosts, const QImage &source)
+{
+    if (hosts.empty() || source.isNull())
+        return;
+
+    const QDateTime now = QDateTime::currentDateTime();
+    for (const QString &host : hosts)
+    {
+        m_lastCaptureTimes.insert(host, now);
+        m_inProgress.insert(host);
+    }
+
+    QFutureWatcher<ThumbnailCaptureResult> *watcher = new QFutureWatcher<ThumbnailCaptureResult>(this);
+    connect(watcher, &QFutureWatcher<ThumbnailCaptureResult>::finished, this, [this, watcher](){
+        onCaptureProcessed(watcher->future().result());
+        watcher->deleteLater();
+    });
+    watcher->setFuture(QtConcurrent::run(&ThumbnailCapturePipeline::process, hosts, source));
+}
+
+int ThumbnailCapturePipeline::getUnchangedCount() const
+{
+    return m_unchangedCount;
+}
+
+ThumbnailCaptureResult ThumbnailCapturePipeline::process(const QStringList &hosts, const QImage &source)
+{
+    ThumbnailCaptureResult result;
+    result.Hosts = hosts;
+
+    if (source.isNull())
+        return result;
+
+    QImage thumbnail = source.convertToFormat(QImage::Format_RGB32)
+                             .scaled(ThumbnailSize, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+
+    // Ignore blank pages, or pages that have not been painted yet
+    if (thumbnail.allGray())
+        return result;
+
+    result.ContentHash = qHashBits(thumbnail.constBits(), static_cast<size_t>(thumbnail.sizeInBytes()));
+
+    result.EncodedData = encode(thumbnail);
+    result.Thumbnail = std::move(thumbnail);
+    return result;
+}
+
+QByteArray ThumbnailCapturePipeline::encode(const QImage &thumbnail)
+{
+    QByteArray data;
+    QBuffer buffer(&data);
+    thumbnail.save(&buffer, "JPG", 85);
+    return data;
+}
+
+void ThumbnailCapturePipeline::onCaptureProcessed(const ThumbnailCaptureResult &result)
+{
+    for (const QString &host : result.Hosts)
+        m_inProgress.remove(host);
+
+    if (result.Thumbnail.isNull())
+        return;
+
+    // Only pass along the thumbnail for hosts whose page has changed since the last capture
+    ThumbnailCaptureResult changed = result;
+    changed.Hosts.clear();
+    for (const QString &host : result.Hosts)
+    {
+        auto it = m_lastContentHashes.find(host);
+        if (it != m_lastContentHashes.end() && it.value() == result.ContentHash)
+            continue;
+
+        m_lastContentHashes.insert(host, result.ContentHash);
+        changed.Hosts.append(host);
+    }
+
+    if (changed.Hosts.empty())
+    {
+        ++m_unchangedCount;
+        return;
+    }
+
+    Q_EMIT thumbnailReady(changed);
+}
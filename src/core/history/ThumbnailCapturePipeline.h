@@ -0,0 +1,99 @@
+#ifndef THUMBNAILCAPTUREPIPELINE_H
+#define THUMBNAILCAPTUREPIPELINE_H
+
+#include <QByteArray>
+#include <QDateTime>
+#include <QHash>
+#include <QImage>
+#include <QObject>
+#include <QSet>
+#include <QSize>
+#include <QString>
+#include <QStringList>
+
+/// Result of processing a captured image of a web page
+struct ThumbnailCaptureResult
+{
+    /// Hostnames that the thumbnail belongs to
+    QStringList Hosts;
+
+    /// Downscaled thumbnail of the page, or a null image if the capture was unusable (ex: blank page)
+    QImage Thumbnail;
+
+    /// Thumbnail encoded in the binary format stored by the \ref WebPageThumbnailStore
+    QByteArray EncodedData;
+
+    /// Hash of the thumbnail's pixels, used to detect pages that have not changed since their last capture
+    size_t ContentHash;
+
+    /// Default constructor
+    ThumbnailCaptureResult() : Hosts(), Thumbnail(), EncodedData(), ContentHash(0) {}
+};
+
+/**
+ * @class ThumbnailCapturePipeline
+ * @brief Turns captured images of web pages into thumbnails. The GUI thread only grabs the
+ *        page's framebuffer, while downscaling, blank page detection and encoding are done
+ *        on a worker thread. Captures are throttled per host, and thumbnails that have not
+ *        changed since the last capture of a host are dropped.
+ */
+class ThumbnailCapturePipeline : public QObject
+{
+    Q_OBJECT
+
+public:
+    /// Size of the thumbnails produced by the pipeline
+    static const QSize ThumbnailSize;
+
+    /// Constructs the pipeline with an optional parent
+    explicit ThumbnailCapturePipeline(QObject *parent = nullptr);
+
+    /// Destructor. Results of captures that are still being processed are discarded.
+    ~ThumbnailCapturePipeline();
+
+    /// Sets the minimum number of seconds between two captures of the same host
+    void setHostCaptureInterval(int seconds);
+
+    /// Returns true if any of the given hosts may be captured, based on the time of their last capture
+    /// and whether or not a capture is already in progress
+    bool shouldCapture(const QStringList &hosts) const;
+
+    /// Queues the captured image of a page, belonging to the given hosts, to be processed on a worker thread.
+    /// Emits \ref thumbnailReady when done, unless the thumbnail is unusable or has not changed.
+    void submit(const QStringList &hosts, const QImage &source);
+
+    /// Returns the number of captures that were dropped because the page had not changed
+    int getUnchangedCount() const;
+
+    /// Downscales, checks and encodes the captured image. Safe to call from any thread.
+    static ThumbnailCaptureResult process(const QStringList &hosts, const QImage &source);
+
+    /// Encodes the thumbnail into the binary format stored by the \ref WebPageThumbnailStore
+    static QByteArray encode(const QImage &thumbnail);
+
+Q_SIGNALS:
+    /// Emitted when a new thumbnail has been produced for one or more hosts
+    void thumbnailReady(const ThumbnailCaptureResult &result);
+
+private:
+    /// Handles the result of a capture that was processed on a worker thread
+    void onCaptureProcessed(const ThumbnailCaptureResult &result);
+
+private:
+    /// Minimum number of seconds between two captures of the same host
+    int m_hostCaptureInterval;
+
+    /// Time of the last capture of each host
+    QHash<QString, QDateTime> m_lastCaptureTimes;
+
+    /// Content hash of the last thumbnail produced for each host
+    QHash<QString, size_t> m_lastContentHashes;
+
+    /// Hosts whose capture is currently being processed
+    QSet<QString> m_inProgress;
+
+    /// Number of captures that were dropped because the page had not changed
+    int m_unchangedCount;
+};
+
+#endif // THUMBNAILCAPTUREPIPELINE_H
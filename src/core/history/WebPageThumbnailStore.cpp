@@ -10,6 +10,7 @@
 #include <algorithm>
 #include <array>
 #include <chrono>
+#include <limits>
 #include <set>
 #include <utility>
 #include <QBuffer>
@@ -26,12 +27,18 @@ WebPageThumbnailStore::WebPageThumbnailStore(const ViperServiceLocator &serviceL
     DatabaseWorker(databaseFile),
     m_timerId(0),
     m_thumbnails(),
+    m_dirtyHosts(),
+    m_capturePipeline(),
+    m_lastSaveWriteCount(0),
+    m_saveQueryCount(0),
     m_bookmarkManager(serviceLocator.getServiceAs<BookmarkManager>("BookmarkManager")),
     m_historyManager(serviceLocator.getServiceAs<HistoryManager>("HistoryManager")),
     m_mimeDatabase()
 {
     setObjectName(QStringLiteral("WebPageThumbnailStore"));
 
+    connect(&m_capturePipeline, &ThumbnailCapturePipeline::thumbnailReady, this, &WebPageThumbnailStore::onThumbnailReady);
+
     // Save thumbnails every 10 minutes
     using namespace std::chrono_literals;
     m_timerId = startTimer(10min);
@@ -44,33 +51,62 @@ WebPageThumbnailStore::~WebPageThumbnailStore()
 
 QImage WebPageThumbnailStore::getThumbnail(const QUrl &url)
 {
-    const QString host = url.host().toLower();
-    if (host.isEmpty())
+    const QByteArray data = getThumbnailData(url.host().toLower());
+    if (data.isEmpty())
         return QImage();
 
-    // First, check in-memory storage. Then check the database for a thumbnail.
+    return QImage::fromData(data);
+}
+
+QByteArray WebPageThumbnailStore::getThumbnailData(const QString &host)
+{
+    if (host.isEmpty())
+        return QByteArray();
+
+    // Thumbnails that have not been saved yet are in memory, the others are read from the database when requested
     auto it = m_thumbnails.find(host);
     if (it != m_thumbnails.end())
         return it.value();
 
-    auto stmt = m_database.prepare(R"(SELECT Thumbnail FROM Thumbnails WHERE Host = ?)");
-    stmt << host;
-    if (stmt.next())
-    {
-        QByteArray data;
-        stmt >> data;
-        QByteArray decoded = QByteArray::fromBase64(data);
+    auto stmt = m_database.prepareCached(R"(SELECT Thumbnail FROM Thumbnails WHERE Host = ?)");
+    *stmt << host;
+    if (!stmt->next())
+        return QByteArray();
 
-        QBuffer buffer(&decoded);
-        QImage image;
-        image.load(&buffer, "PNG");
+    QByteArray data;
+    *stmt >> data;
 
-        m_thumbnails.insert(host, image);
+    // Rewrite thumbnails stored in the old format on the next save, keeping them in memory until then
+    if (isLegacyThumbnail(data))
+    {
+        data = convertLegacyThumbnail(data);
+        if (data.isEmpty())
+            return data;
 
-        return image;
+        m_thumbnails.insert(host, data);
+        m_dirtyHosts.insert(host);
     }
 
-    return QImage();
+    return data;
+}
+
+QString WebPageThumbnailStore::getThumbnailTag(const QUrl &url)
+{
+    const QByteArray data = getThumbnailData(url.host().toLower());
+    if (data.isEmpty())
+        return QString();
+
+    return QString::number(qHash(data), 16);
+}
+
+int WebPageThumbnailStore::getLastSaveWriteCount() const
+{
+    return m_lastSaveWriteCount;
+}
+
+int WebPageThumbnailStore::getSaveQueryCount() const
+{
+    return m_saveQueryCount;
 }
 
 void WebPageThumbnailStore::onPageLoaded(bool ok)
@@ -102,38 +138,42 @@ void WebPageThumbnailStore::onPageLoaded(bool ok)
             return;
     }
 
-    std::vector<QUrl> urls { originalUrl };
-    if (!CommonUtil::doUrlsMatch(originalUrl, url, true))
-        urls.push_back(url);
+    QStringList hosts;
+    for (const QUrl &pageUrl : { originalUrl, url })
+    {
+        const QString host = pageUrl.host().toLower();
+        if (!host.isEmpty() && !hosts.contains(host))
+            hosts.append(host);
+    }
+
+    if (!m_capturePipeline.shouldCapture(hosts))
+        return;
 
     // Wait one second before trying to get the thumbnails, otherwise
     // we might get a blank thumbnail
-    QTimer::singleShot(1000, this, [this, ww, urls]() {
+    QTimer::singleShot(1000, this, [this, ww, hosts]() {
         if (ww.isNull())
             return;
         if (WebView *view = ww->view())
         {
-            if (view->getProgress() < 100)
-                return;
-
-            const QPixmap &pixmap = view->getThumbnail();
-            if (pixmap.isNull())
-                return;
-
-            const QImage image = pixmap.toImage();
-            if (image.allGray())
+            if (view->getProgress() < 100 || !m_capturePipeline.shouldCapture(hosts))
                 return;
 
-            for (const QUrl &url : urls)
-            {
-                const QString host = url.host().toLower();
-                if (!host.isEmpty())
-                    m_thumbnails.insert(host, image);
-            }
+            // Only the grab happens on the GUI thread, the pipeline does the rest on a worker thread
+            m_capturePipeline.submit(hosts, view->grabThumbnailSource());
         }
     });
 }
 
+void WebPageThumbnailStore::onThumbnailReady(const ThumbnailCaptureResult &result)
+{
+    for (const QString &host : result.Hosts)
+    {
+        m_thumbnails.insert(host, result.EncodedData);
+        m_dirtyHosts.insert(host);
+    }
+}
+
 void WebPageThumbnailStore::timerEvent(QTimerEvent *event)
 {
     if (event->timerId() == m_timerId)
@@ -151,7 +191,7 @@ void WebPageThumbnailStore::setup()
 {
     // Thumbnails table:
     // Id  |  Host  | Thumbnail
-    // pk    string   string/blob
+    // pk    string   blob (JPEG data; base-64 encoded PNG in older databases)
 
     // Setup table structure
     if (!m_database.execute("CREATE TABLE IF NOT EXISTS Thumbnails(Id INTEGER PRIMARY KEY, Host TEXT UNIQUE, Thumbnail BLOB)"))
@@ -187,30 +227,65 @@ void WebPageThumbnailStore::onMostVisitedPagesLoaded(std::vector<WebPageInformat
         }
     }
 
-    // Save applicable thumbnails
-    auto stmt = m_database.prepare(R"(INSERT OR REPLACE INTO Thumbnails(Host, Thumbnail) VALUES (?, ?))");
+    // Save the applicable thumbnails of memory, which have either changed since the last save or are waiting
+    // for their page to qualify. Thumbnails of pages that are not (yet) frequently visited stay in memory, in
+    // case they qualify on a later save, but no longer count as changes.
+    // Chunks are committed one at a time, and their hosts are only marked clean once they are, so that
+    // thumbnails of a chunk that failed to commit are written on the next save.
+    sqlite::BatchWriter writer(m_database, R"(INSERT OR REPLACE INTO Thumbnails(Host, Thumbnail) VALUES (?, ?))",
+                               std::numeric_limits<std::size_t>::max());
 
-    for (auto it = m_thumbnails.begin(); it != m_thumbnails.end(); ++it)
+    m_lastSaveWriteCount = 0;
+    m_dirtyHosts.clear();
+
+    std::vector<QString> chunkHosts;
+    auto commitChunk = [this, &writer, &chunkHosts]() {
+        if (chunkHosts.empty())
+            return;
+
+        if (writer.flush())
+        {
+            // Saved thumbnails are read back from the database when requested
+            for (const QString &host : chunkHosts)
+                m_thumbnails.remove(host);
+            m_lastSaveWriteCount += static_cast<int>(chunkHosts.size());
+        }
+        else
+        {
+            qWarning() << "WebPageThumbnailStore - could not commit thumbnails to database.";
+            for (const QString &host : chunkHosts)
+                m_dirtyHosts.insert(host);
+        }
+
+        chunkHosts.clear();
+    };
+
+    const QList<QString> unsavedHosts = m_thumbnails.keys();
+    for (const QString &host : unsavedHosts)
     {
-        const std::string host = it.key().toStdString();
-        if (mostVisitedHosts.find(host) == mostVisitedHosts.end())
+        if (mostVisitedHosts.find(host.toStdString()) == mostVisitedHosts.end())
             continue;
 
-        const QImage &image = it.value();
-        if (image.isNull())
+        const QByteArray data = m_thumbnails.value(host);
+        if (data.isEmpty())
+        {
+            m_thumbnails.remove(host);
             continue;
+        }
 
-        QByteArray data;
-        QBuffer buffer(&data);
-        image.save(&buffer, "PNG");
-
-        data = data.toBase64();
-        stmt << host
-             << data;
-
-        if (!stmt.execute())
+        if (!writer.add(host.toStdString(), data))
+        {
             qWarning() << "WebPageThumbnailStore - could not save thumbnail to database.";
+            m_dirtyHosts.insert(host);
+            continue;
+        }
+
+        chunkHosts.push_back(host);
+        if (chunkHosts.size() >= ThumbnailsPerTransaction)
+            commitChunk();
     }
+
+    commitChunk();
 }
 
 void WebPageThumbnailStore::save()
@@ -221,6 +296,34 @@ void WebPageThumbnailStore::save()
     if (!m_historyManager || !m_bookmarkManager)
         return;
 
-    int historyLimit = std::min(static_cast<int>(m_thumbnails.size()), 100);
-    m_historyManager->loadMostVisitedEntries(historyLimit, std::bind(&WebPageThumbnailStore::onMostVisitedPagesLoaded, this, std::placeholders::_1));
+    // Nothing has changed since the last save. Thumbnails waiting for their page to qualify are checked
+    // again on the next save that has changes to write.
+    if (m_dirtyHosts.empty())
+    {
+        m_lastSaveWriteCount = 0;
+        return;
+    }
+
+    ++m_saveQueryCount;
+
+    // Saved thumbnails are not kept in memory, so the limit cannot depend on the number of thumbnails
+    m_historyManager->loadMostVisitedEntries(MostVisitedLimit).then(this, [this](std::vector<WebPageInformation> results){
+        onMostVisitedPagesLoaded(std::move(results));
+    });
+}
+
+QByteArray WebPageThumbnailStore::convertLegacyThumbnail(const QByteArray &data) const
+{
+    QImage image;
+    if (!image.loadFromData(QByteArray::fromBase64(data), "PNG"))
+        return QByteArray();
+
+    return ThumbnailCapturePipeline::encode(image);
+}
+
+bool WebPageThumbnailStore::isLegacyThumbnail(const QByteArray &data)
+{
+    // Older versions stored thumbnails as base-64 encoded PNGs, which always begin with the
+    // encoded form of the PNG signature
+    return data.startsWith(QByteArrayLiteral("iVBORw0KGgo"));
 }
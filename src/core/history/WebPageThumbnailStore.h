@@ -4,14 +4,18 @@
 #include "DatabaseWorker.h"
 #include "HistoryManager.h"
 #include "ServiceLocator.h"
+#include "ThumbnailCapturePipeline.h"
 
+#include <cstddef>
 #include <vector>
 
+#include <QByteArray>
 #include <QHash>
 #include <QImage>
 #include <QMimeDatabase>
 #include <QObject>
 #include <QPixmap>
+#include <QSet>
 #include <QString>
 #include <QUrl>
 
@@ -23,11 +27,20 @@ class HistoryManager;
  * @brief A data store that contains thumbnails of web pages that are
  *        either commonly visited, bookmarked or otherwise favorited by
  *        the user.
+ *
+ * Thumbnails are stored as compressed binary images, and are read from the
+ * database each time they are requested rather than kept in memory. Only the
+ * thumbnails that have changed since the last save are kept in memory, until
+ * they are written back to the database. New thumbnails are produced off the
+ * GUI thread by a \ref ThumbnailCapturePipeline. Thumbnails are handled in
+ * their encoded form, so that they can be served as-is to the new tab page
+ * through the viper://thumbnail endpoint.
  */
 class WebPageThumbnailStore : public QObject, private DatabaseWorker
 {
     friend class BrowserApplication;
     friend class DatabaseFactory;
+    friend class WebPageThumbnailStoreTest;
 
     Q_OBJECT
 
@@ -42,6 +55,21 @@ class WebPageThumbnailStore : public QObject, private DatabaseWorker
     /// as a QImage if found, or returning a null pixmap if it could not be found.
     QImage getThumbnail(const QUrl &url);
 
+    /// Returns the encoded (JPEG) thumbnail associated with the given hostname, without decoding it,
+    /// or an empty byte array if the host has no thumbnail
+    QByteArray getThumbnailData(const QString &host);
+
+    /// Returns a short tag identifying the current version of the thumbnail associated with the given URL,
+    /// or an empty string if the URL has no thumbnail. The tag changes whenever the thumbnail does.
+    QString getThumbnailTag(const QUrl &url);
+
+    /// Returns the number of thumbnails that were written to the database during the last save
+    int getLastSaveWriteCount() const;
+
+    /// Returns the number of saves that looked up the most visited pages, which only happens when
+    /// a thumbnail changed since the previous save
+    int getSaveQueryCount() const;
+
 public Q_SLOTS:
     /// Handles the loadFinished event which is emitted by a \ref WebWidget
     void onPageLoaded(bool ok);
@@ -62,6 +90,13 @@ public Q_SLOTS:
     void load() override;
 
 private:
+    /// Number of thumbnails written per transaction when saving, which keeps the write-ahead log from growing
+    /// by the size of every dirty thumbnail at once
+    static constexpr std::size_t ThumbnailsPerTransaction = 25;
+
+    /// Number of most visited pages whose thumbnails are saved, besides those of bookmarked pages
+    static constexpr int MostVisitedLimit = 100;
+
     /// Callback registered during a call to save() - handles the query to fetch the most frequently
     /// visited web pages
     void onMostVisitedPagesLoaded(std::vector<WebPageInformation> &&results);
@@ -69,12 +104,36 @@ public Q_SLOTS:
     /// Saves thumbnails of web pages into the database
     void save();
 
+    /// Stores the thumbnail produced by the capture pipeline, marking its hosts as dirty
+    void onThumbnailReady(const ThumbnailCaptureResult &result);
+
+    /// Converts thumbnail data that was stored in the older base-64 encoded PNG format into the current
+    /// format, returning an empty byte array if the data could not be decoded
+    QByteArray convertLegacyThumbnail(const QByteArray &data) const;
+
+    /// Returns true if the thumbnail data was stored in the older base-64 encoded PNG format
+    static bool isLegacyThumbnail(const QByteArray &data);
+
+
 private:
     /// Identifier of the timer that is periodically invoked to call the save() method
     int m_timerId;
 
-    /// Hashmap of web hostnames to their corresponding thumbnails
-    QHash<QString, QImage> m_thumbnails;
+    /// Hashmap of web hostnames to the thumbnails that have not been written to the database, kept in their encoded form.
+    /// Besides the changed thumbnails, this holds the thumbnails waiting for their page to be visited often enough
+    QHash<QString, QByteArray> m_thumbnails;
+
+    /// Hostnames of the thumbnails that have changed since the last save
+    QSet<QString> m_dirtyHosts;
+
+    /// Downscales and encodes captured pages off the GUI thread
+    ThumbnailCapturePipeline m_capturePipeline;
+
+    /// Number of thumbnails written to the database during the last save
+    int m_lastSaveWriteCount;
+
+    /// Number of saves that looked up the most visited pages
+    int m_saveQueryCount;
 
     /// Pointer to the \ref BookmarkManager
     BookmarkManager *m_bookmarkManager;
@@ -6,6 +6,7 @@
 
 #include <functional>
 #include <stdexcept>
+#include <utility>
 
 #include <QBuffer>
 #include <QDebug>
@@ -14,18 +15,35 @@
 #include <QNetworkReply>
 #include <QPainter>
 #include <QSvgRenderer>
+#include <QTimer>
 #include <QtConcurrent>
 
+namespace
+{
+    /// Time to wait for the web engine to provide an icon before downloading it ourselves
+    constexpr int EngineIconWaitMs = 1500;
+
+    /// Minimum amount of time between two download attempts of an icon that could not be fetched
+    constexpr qint64 FailedFetchRetrySeconds = 60 * 60;
+}
+
 FaviconManager::FaviconManager(const QString &databaseFile) :
+    FaviconManager(DatabaseFactory::createWorker<FaviconStore>(databaseFile))
+{
+}
+
+FaviconManager::FaviconManager(std::unique_ptr<FaviconStore> faviconStore) :
     QObject(nullptr),
-    m_faviconStore(nullptr),
+    m_faviconStore(std::move(faviconStore)),
     m_networkAccessManager(nullptr),
     m_iconMap(),
     m_iconCache(64),
-    m_mutex()
+    m_mutex(),
+    m_pendingFetches(),
+    m_lastFetchTimes(),
+    m_fetchStats()
 {
     setObjectName(QStringLiteral("FaviconManager"));
-    m_faviconStore = DatabaseFactory::createWorker<FaviconStore>(databaseFile);
 }
 
 void FaviconManager::setNetworkAccessManager(NetworkAccessManager *networkAccessManager)
@@ -96,64 +114,68 @@ void FaviconManager::updateIcon(const QUrl &iconUrl, const QUrl &pageUrl, const
     const QString pageUrlStr = getUrlAsString(pageUrl);
     const std::string urlStdStr = pageUrlStr.toStdString();
 
-    QByteArray pageIconData = CommonUtil::iconToBase64(pageIcon);
-
-    if (!pageIconData.isEmpty() && m_iconCache.has(urlStdStr))
-    {
-        try
-        {
-            std::lock_guard<std::mutex> _(m_mutex);
-            m_iconCache.put(urlStdStr, pageIcon);
-        }
-        catch (std::out_of_range &err)
-        {
-            qDebug() << "FaviconManager::updateIcon - caught error while updating icon cache. Error: " << err.what();
-        }
-    }
-
     const int iconId = m_faviconStore->getFaviconIdForIconUrl(iconUrl);
-    FaviconData &dataRecord = m_faviconStore->getDataRecord(iconId);
-    if (dataRecord.iconData.isEmpty() || !pageIconData.isEmpty())
-        dataRecord.iconData = pageIconData;
 
     // add page url -> icon mapping to favicon store
     m_faviconStore->addPageMapping(pageUrl, iconId);
 
-    if (!dataRecord.iconData.isEmpty())
+    // The web engine has already fetched the icon, so there is no need to download it again
+    if (!pageIcon.isNull())
     {
-        m_faviconStore->saveDataRecord(dataRecord);
+        ++m_fetchStats.engineIcons;
 
-        QIcon icon = CommonUtil::iconFromBase64(dataRecord.iconData);
-        auto it = m_iconMap.find(iconId);
-        if (it != m_iconMap.end())
-            it->second = icon;
-        else
-            m_iconMap.emplace(std::make_pair(iconId, icon));
+        storeIcon(iconId, pageIcon);
+        updateCachedIcon(urlStdStr, pageIcon);
+        resolvePendingFetch(iconUrl, pageIcon);
+        return;
+    }
 
+    // Don't fetch icons that are already known, or that were requested recently without success
+    const FaviconData &dataRecord = m_faviconStore->getDataRecord(iconId);
+    auto lastFetchIt = m_lastFetchTimes.find(iconId);
+    if (!dataRecord.iconData.isEmpty()
+            || (lastFetchIt != m_lastFetchTimes.end()
+                && lastFetchIt->second.secsTo(QDateTime::currentDateTime()) < FailedFetchRetrySeconds))
+    {
+        ++m_fetchStats.freshnessHits;
         return;
     }
 
     if (!m_networkAccessManager)
         return;
 
-    QNetworkRequest request(iconUrl);
-    QNetworkReply *reply = m_networkAccessManager->get(request);
-    if (reply->isFinished())
-        onReplyFinished(reply);
-    else
+    // Share a single fetch between every page that references the icon
+    auto pendingIt = m_pendingFetches.find(iconUrl);
+    if (pendingIt != m_pendingFetches.end())
     {
-        connect(reply, &QNetworkReply::finished, this, [this, reply](){
-            onReplyFinished(reply);
-        });
+        ++m_fetchStats.coalescedRequests;
+        pendingIt->pageUrls.push_back(urlStdStr);
+        return;
     }
+
+    PendingFetch fetch;
+    fetch.pageUrls.push_back(urlStdStr);
+    m_pendingFetches.insert(iconUrl, fetch);
+
+    // The icon URL is usually reported before the web engine has loaded the icon itself,
+    // so give the engine a chance to provide it before going to the network
+    QTimer::singleShot(EngineIconWaitMs, this, [this, iconUrl](){
+        startFetch(iconUrl);
+    });
 }
 
-void FaviconManager::onReplyFinished(QNetworkReply *reply)
+const FaviconFetchStats &FaviconManager::getFetchStats() const
+{
+    return m_fetchStats;
+}
+
+void FaviconManager::onReplyFinished(QNetworkReply *reply, const QUrl &iconUrl)
 {
     QString format = QFileInfo(getUrlAsString(reply->url())).suffix();
     QByteArray data = reply->readAll();
     if (data.isNull())
     {
+        m_pendingFetches.remove(iconUrl);
         reply->deleteLater();
         return;
     }
@@ -188,24 +210,95 @@ void FaviconManager::onReplyFinished(QNetworkReply *reply)
     if (success)
     {
         QIcon icon(QPixmap::fromImage(img));
-        const int iconId = m_faviconStore->getFaviconIdForIconUrl(reply->url());
-        FaviconData &record = m_faviconStore->getDataRecord(iconId);
-        record.iconData = CommonUtil::iconToBase64(icon);
-
-        m_faviconStore->saveDataRecord(record);
-
-        auto it = m_iconMap.find(iconId);
-        if (it != m_iconMap.end())
-            it->second = icon;
-        else
-            m_iconMap.emplace(std::make_pair(iconId, icon));
+        storeIcon(m_faviconStore->getFaviconIdForIconUrl(iconUrl), icon);
+        resolvePendingFetch(iconUrl, icon);
     }
     else
+    {
         qDebug() << "FaviconManager::onReplyFinished - failed to load image from response. Format was " << format;
+        m_pendingFetches.remove(iconUrl);
+    }
 
     reply->deleteLater();
 }
 
+void FaviconManager::startFetch(const QUrl &iconUrl)
+{
+    auto it = m_pendingFetches.find(iconUrl);
+    if (it == m_pendingFetches.end() || it->inFlight)
+        return;
+
+    if (!m_networkAccessManager)
+    {
+        m_pendingFetches.erase(it);
+        return;
+    }
+
+    it->inFlight = true;
+    ++m_fetchStats.networkFetches;
+
+    m_lastFetchTimes[m_faviconStore->getFaviconIdForIconUrl(iconUrl)] = QDateTime::currentDateTime();
+
+    QNetworkRequest request(iconUrl);
+    request.setAttribute(QNetworkRequest::CacheLoadControlAttribute, QNetworkRequest::PreferCache);
+
+    QNetworkReply *reply = m_networkAccessManager->get(request);
+    if (reply->isFinished())
+        onReplyFinished(reply, iconUrl);
+    else
+    {
+        connect(reply, &QNetworkReply::finished, this, [this, reply, iconUrl](){
+            onReplyFinished(reply, iconUrl);
+        });
+    }
+}
+
+void FaviconManager::storeIcon(int iconId, const QIcon &icon)
+{
+    QByteArray iconData = CommonUtil::iconToBase64(icon);
+    if (iconData.isEmpty())
+        return;
+
+    FaviconData &dataRecord = m_faviconStore->getDataRecord(iconId);
+    if (dataRecord.iconData == iconData)
+        return;
+
+    dataRecord.iconData = iconData;
+    m_faviconStore->saveDataRecord(dataRecord);
+
+    auto it = m_iconMap.find(iconId);
+    if (it != m_iconMap.end())
+        it->second = icon;
+    else
+        m_iconMap.emplace(std::make_pair(iconId, icon));
+}
+
+void FaviconManager::resolvePendingFetch(const QUrl &iconUrl, const QIcon &icon)
+{
+    auto it = m_pendingFetches.find(iconUrl);
+    if (it == m_pendingFetches.end())
+        return;
+
+    for (const std::string &pageUrl : it->pageUrls)
+        updateCachedIcon(pageUrl, icon);
+
+    m_pendingFetches.erase(it);
+}
+
+void FaviconManager::updateCachedIcon(const std::string &pageUrl, const QIcon &icon)
+{
+    try
+    {
+        std::lock_guard<std::mutex> _(m_mutex);
+        if (m_iconCache.has(pageUrl))
+            m_iconCache.put(pageUrl, icon);
+    }
+    catch (std::out_of_range &err)
+    {
+        qDebug() << "FaviconManager::updateCachedIcon - caught error while updating icon cache. Error: " << err.what();
+    }
+}
+
 QString FaviconManager::getUrlAsString(const QUrl &url) const
 {
     return url.toString(QUrl::RemoveUserInfo | QUrl::RemoveQuery | QUrl::RemoveFragment);
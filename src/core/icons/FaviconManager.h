@@ -10,7 +10,10 @@
 #include <unordered_map>
 #include <memory>
 #include <mutex>
+#include <string>
+#include <vector>
 
+#include <QDateTime>
 #include <QHash>
 #include <QIcon>
 #include <QObject>
@@ -33,6 +36,10 @@ class FaviconManager : public QObject
     /// Constructs the favicon manager
     explicit FaviconManager(const QString &databaseFile);
 
+    /// Constructs the favicon manager with a favicon store that has already been loaded,
+    /// which allows the store to be loaded on another thread
+    explicit FaviconManager(std::unique_ptr<FaviconStore> faviconStore);
+
     /// Passes the instance of the network access manager, so the favicon manager can download
     /// new icons as they are referenced by a web page.
     void setNetworkAccessManager(NetworkAccessManager *networkAccessManager);
@@ -43,20 +50,53 @@ class FaviconManager : public QObject
 
     /**
      * @brief Attempts to update favicon for a specific URL in the database.
+     *
+     * If the web engine has already fetched the icon, it should be passed as the pageIcon
+     * and will be stored as-is. Otherwise, the icon is downloaded once per icon URL, no matter
+     * how many pages are waiting on it, unless it is already known and still fresh.
      * @param iconUrl The location in which the favicon is stored.
      * @param pageUrl The URL of the page displaying the favicon.
-     * @param pageIcon The favicon on the page.
+     * @param pageIcon The favicon on the page, as provided by the web engine. May be null.
      */
     void updateIcon(const QUrl &iconUrl, const QUrl &pageUrl, const QIcon &pageIcon);
 
+    /// Returns the counters of favicon downloads that were issued and avoided
+    const FaviconFetchStats &getFetchStats() const;
+
 private Q_SLOTS:
-    /// Called after the request for a favicon has been completed
-    void onReplyFinished(QNetworkReply *reply);
+    /// Called after the request for the favicon at the given URL has been completed
+    void onReplyFinished(QNetworkReply *reply, const QUrl &iconUrl);
 
 private:
+    /// Issues the network request for the given icon, unless the web engine has
+    /// provided the icon since the fetch was queued
+    void startFetch(const QUrl &iconUrl);
+
+    /// Stores the icon in the favicon database, if it differs from the stored version,
+    /// and refreshes the in-memory icon mapping
+    void storeIcon(int iconId, const QIcon &icon);
+
+    /// Completes the pending fetch of the given icon URL, updating the cache of every
+    /// page that was waiting on the icon
+    void resolvePendingFetch(const QUrl &iconUrl, const QIcon &icon);
+
+    /// Updates the cached icon of the given page, if the page is in the cache
+    void updateCachedIcon(const std::string &pageUrl, const QIcon &icon);
+
     /// Returns the given URL in string form
     QString getUrlAsString(const QUrl &url) const;
 
+private:
+    /// A single download of an icon URL, shared by every page that references it
+    struct PendingFetch
+    {
+        /// Pages that are waiting on the icon
+        std::vector<std::string> pageUrls;
+
+        /// True if the network request has been issued, false if still waiting on the web engine
+        bool inFlight { false };
+    };
+
 private:
     /// Favicon data store
     std::unique_ptr<FaviconStore> m_faviconStore;
@@ -72,6 +112,15 @@ private Q_SLOTS:
 
     /// Used when updating the LRU cache for thread safety
     mutable std::mutex m_mutex;
+
+    /// Icon downloads that have been requested but not yet completed, keyed by icon URL
+    QHash<QUrl, PendingFetch> m_pendingFetches;
+
+    /// Time of the last network request for each favicon ID, used to avoid re-fetching icons too often
+    std::unordered_map<int, QDateTime> m_lastFetchTimes;
+
+    /// Counters of issued and avoided downloads
+    FaviconFetchStats m_fetchStats;
 };
 
 #endif // FAVICONMANAGER_H
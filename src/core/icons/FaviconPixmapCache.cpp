@@ -0,0 +1,116 @@
+#include "FaviconPixmapCache.h"
+
+#include <cmath>
+
+FaviconPixmapCache::FaviconPixmapCache(int64_t byteBudget) :
+    m_byteBudget(byteBudget),
+    m_bytesUsed(0),
+    m_hits(0),
+    m_misses(0),
+    m_entries(),
+    m_entryMap()
+{
+}
+
+FaviconPixmapCache &FaviconPixmapCache::instance()
+{
+    static FaviconPixmapCache cache;
+    return cache;
+}
+
+QPixmap FaviconPixmapCache::pixmap(const QIcon &icon, int logicalSize, qreal devicePixelRatio)
+{
+    if (icon.isNull() || logicalSize <= 0)
+        return QPixmap();
+
+    return getEntry(icon, logicalSize, devicePixelRatio).pixmap;
+}
+
+QIcon FaviconPixmapCache::rasterizedIcon(const QIcon &icon, int logicalSize, qreal devicePixelRatio)
+{
+    if (icon.isNull() || logicalSize <= 0)
+        return icon;
+
+    return getEntry(icon, logicalSize, devicePixelRatio).icon;
+}
+
+void FaviconPixmapCache::setByteBudget(int64_t byteBudget)
+{
+    m_byteBudget = byteBudget;
+    evict();
+}
+
+int64_t FaviconPixmapCache::getByteBudget() const
+{
+    return m_byteBudget;
+}
+
+int64_t FaviconPixmapCache::getBytesUsed() const
+{
+    return m_bytesUsed;
+}
+
+size_t FaviconPixmapCache::size() const
+{
+    return m_entries.size();
+}
+
+uint64_t FaviconPixmapCache::getHitCount() const
+{
+    return m_hits;
+}
+
+uint64_t FaviconPixmapCache::getMissCount() const
+{
+    return m_misses;
+}
+
+void FaviconPixmapCache::clear()
+{
+    m_entryMap.clear();
+    m_entries.clear();
+    m_bytesUsed = 0;
+}
+
+FaviconPixmapCache::Entry &FaviconPixmapCache::getEntry(const QIcon &icon, int logicalSize, qreal devicePixelRatio)
+{
+    if (devicePixelRatio <= 0.0)
+        devicePixelRatio = 1.0;
+
+    const Key key { icon.cacheKey(), logicalSize, static_cast<int>(std::lround(devicePixelRatio * 100.0)) };
+
+    auto it = m_entryMap.find(key);
+    if (it != m_entryMap.end())
+    {
+        ++m_hits;
+
+        // Move entry to the front of the list
+        m_entries.splice(m_entries.begin(), m_entries, it->second);
+        return *it->second;
+    }
+
+    ++m_misses;
+
+    QPixmap pixmap = icon.pixmap(QSize(logicalSize, logicalSize), devicePixelRatio);
+    const int64_t cost = static_cast<int64_t>(pixmap.width()) * pixmap.height() * pixmap.depth() / 8;
+
+    m_entries.push_front(Entry { key, pixmap, QIcon(pixmap), cost });
+    m_entryMap[key] = m_entries.begin();
+    m_bytesUsed += cost;
+
+    evict();
+
+    // Always keep the most recent entry, even if it alone exceeds the budget
+    return m_entries.front();
+}
+
+void FaviconPixmapCache::evict()
+{
+    while (m_bytesUsed > m_byteBudget && m_entries.size() > 1)
+    {
+        const Entry &lruEntry = m_entries.back();
+        m_bytesUsed -= lruEntry.cost;
+        m_entryMap.erase(lruEntry.key);
+        m_entries.pop_back();
+    }
+}
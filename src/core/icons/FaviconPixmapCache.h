@@ -0,0 +1,131 @@
+#ifndef FAVICONPIXMAPCACHE_H
+#define FAVICONPIXMAPCACHE_H
+
+#include <cstdint>
+#include <list>
+#include <unordered_map>
+
+#include <QIcon>
+#include <QPixmap>
+
+/**
+ * @class FaviconPixmapCache
+ * @brief Stores favicons that have already been rasterized at a given logical size and
+ *        device pixel ratio, so that menus, tab bars and item views can draw them directly
+ *        instead of scaling the same \ref QIcon on every paint.
+ *
+ * Entries are keyed by the icon's cache key, the logical size and the device pixel ratio,
+ * and are evicted in least recently used order once the byte budget has been exceeded.
+ * This class must only be used from the GUI thread.
+ */
+class FaviconPixmapCache
+{
+public:
+    /// Default byte budget of the cache (4 MiB, or roughly 1000 16px icons at 2x DPR)
+    static constexpr int64_t DefaultByteBudget = 4 * 1024 * 1024;
+
+    /// Constructs the pixmap cache with the given byte budget
+    explicit FaviconPixmapCache(int64_t byteBudget = DefaultByteBudget);
+
+    /// Returns the pixmap cache singleton
+    static FaviconPixmapCache &instance();
+
+    /// Returns the given icon rasterized at the logical size and device pixel ratio, creating
+    /// and caching the pixmap if it was not already in the cache
+    QPixmap pixmap(const QIcon &icon, int logicalSize, qreal devicePixelRatio);
+
+    /// Returns an icon containing only the cached pixmap of the given icon at the logical size and
+    /// device pixel ratio. Used by widgets such as menus and tab bars that require a \ref QIcon
+    QIcon rasterizedIcon(const QIcon &icon, int logicalSize, qreal devicePixelRatio);
+
+    /// Sets the maximum number of bytes that may be used by the cached pixmaps, evicting entries if needed
+    void setByteBudget(int64_t byteBudget);
+
+    /// Returns the maximum number of bytes that may be used by the cached pixmaps
+    int64_t getByteBudget() const;
+
+    /// Returns the number of bytes currently used by the cached pixmaps
+    int64_t getBytesUsed() const;
+
+    /// Returns the number of pixmaps in the cache
+    size_t size() const;
+
+    /// Returns the number of lookups that were served from the cache
+    uint64_t getHitCount() const;
+
+    /// Returns the number of lookups that required the icon to be rasterized
+    uint64_t getMissCount() const;
+
+    /// Removes all pixmaps from the cache
+    void clear();
+
+private:
+    /// Identifies a single rasterization of an icon
+    struct Key
+    {
+        /// Cache key of the icon
+        qint64 iconKey;
+
+        /// Logical size of the pixmap, in device independent pixels
+        int logicalSize;
+
+        /// Device pixel ratio, scaled by 100 to avoid floating point comparisons
+        int scaledRatio;
+
+        bool operator==(const Key &other) const
+        {
+            return iconKey == other.iconKey && logicalSize == other.logicalSize && scaledRatio == other.scaledRatio;
+        }
+    };
+
+    /// Hashing function for the cache key
+    struct KeyHasher
+    {
+        size_t operator()(const Key &key) const
+        {
+            size_t seed = std::hash<qint64>()(key.iconKey);
+            seed ^= std::hash<int>()(key.logicalSize) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+            seed ^= std::hash<int>()(key.scaledRatio) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+            return seed;
+        }
+    };
+
+    /// Cached pixmap and its cost, in bytes
+    struct Entry
+    {
+        Key key;
+        QPixmap pixmap;
+        QIcon icon;
+        int64_t cost;
+    };
+
+    using EntryList = std::list<Entry>;
+
+private:
+    /// Returns the cache entry for the icon at the given size and device pixel ratio, creating it if needed
+    Entry &getEntry(const QIcon &icon, int logicalSize, qreal devicePixelRatio);
+
+    /// Evicts the least recently used entries until the cache is within its byte budget
+    void evict();
+
+private:
+    /// Maximum number of bytes used by the cached pixmaps
+    int64_t m_byteBudget;
+
+    /// Number of bytes currently used by the cached pixmaps
+    int64_t m_bytesUsed;
+
+    /// Cache hit counter
+    uint64_t m_hits;
+
+    /// Cache miss counter
+    uint64_t m_misses;
+
+    /// Cached entries, ordered from most to least recently used
+    EntryList m_entries;
+
+    /// Maps keys to their entries in the list
+    std::unordered_map<Key, EntryList::iterator, KeyHasher> m_entryMap;
+};
+
+#endif // FAVICONPIXMAPCACHE_H
@@ -29,23 +29,23 @@ int FaviconStore::getFaviconId(const QUrl &url)
     if (it != m_webPageMap.end())
         return *it;
 
-    auto iconQuery = m_database.prepare(R"(SELECT FaviconID FROM FaviconMap WHERE PageURL LIKE ?)");
+    auto iconQuery = m_database.prepareCached(R"(SELECT FaviconID FROM FaviconMap WHERE PageURL LIKE ?)");
 
     QString searchTemplate(QStringLiteral("%%1%"));
     std::array<QString, 2> searchTerms = { searchTemplate.arg(url.host()),
                                            searchTemplate.arg(URL(url).getSecondLevelDomain()) };
     for (size_t i = 0; i < searchTerms.size(); ++i)
     {
-        iconQuery << searchTerms.at(i);
+        *iconQuery << searchTerms.at(i);
 
-        if (iconQuery.next())
+        if (iconQuery->next())
         {
             int iconId = 0;
-            iconQuery >> iconId;
+            *iconQuery >> iconId;
             return iconId;
         }
 
-        iconQuery.reset();
+        iconQuery->reset();
     }
 
     return -1;
@@ -61,12 +61,12 @@ int FaviconStore::getFaviconIdForIconUrl(const QUrl &url)
             return it.first;
     }
 
-    auto idQuery = m_database.prepare(R"(SELECT FaviconID FROM Favicons WHERE URL = ?)");
-    idQuery << url;
-    if (idQuery.next())
+    auto idQuery = m_database.prepareCached(R"(SELECT FaviconID FROM Favicons WHERE URL = ?)");
+    *idQuery << url;
+    if (idQuery->next())
     {
         int iconId = 0;
-        idQuery >> iconId;
+        *idQuery >> iconId;
         return iconId;
     }
 
@@ -113,10 +113,10 @@ FaviconData &FaviconStore::getDataRecord(int faviconId)
 
 void FaviconStore::saveDataRecord(FaviconData &dataRecord)
 {
-    auto stmt = m_database.prepare(R"(UPDATE FaviconData SET Data = ? WHERE DataID = ?)");
-    stmt << dataRecord.iconData
-         << dataRecord.id;
-    if (!stmt.execute())
+    auto stmt = m_database.prepareCached(R"(UPDATE FaviconData SET Data = ? WHERE DataID = ?)");
+    *stmt << dataRecord.iconData
+          << dataRecord.id;
+    if (!stmt->execute())
         qWarning() << "In FaviconStore::saveDataRecord - could not update favicon data.";
 }
 
@@ -133,11 +133,11 @@ void FaviconStore::addPageMapping(const QUrl &webPageUrl, int faviconId)
     else
         m_webPageMap.insert(webPageUrl, faviconId);
 
-    auto stmt = m_database.prepare(R"(INSERT OR REPLACE INTO FaviconMap(PageURL, FaviconID) VALUES (?, ?))");
-    stmt << webPageUrl
-         << faviconId;
+    auto stmt = m_database.prepareCached(R"(INSERT OR REPLACE INTO FaviconMap(PageURL, FaviconID) VALUES (?, ?))");
+    *stmt << webPageUrl
+          << faviconId;
 
-    if (!stmt.execute())
+    if (!stmt->execute())
         qDebug() << "In FaviconStore::addPageMapping - could not update webpage mapping.";
 }
 
@@ -203,7 +203,8 @@ void FaviconStore::load()
         FaviconData data;
         query >> data;
 
-        m_iconDataMap.emplace(std::make_pair(data.faviconId, data));
+        const int faviconId = data.faviconId;
+        m_iconDataMap.emplace(faviconId, std::move(data));
     }
 
     query = m_database.prepare(R"(SELECT PageURL, FaviconID FROM FaviconMap)");
@@ -20,5 +20,7 @@ void FaviconStoreBridge::updateIconUrl(const QString &faviconUrl)
     if (faviconUrl.isEmpty())
         return;
 
-    m_faviconManager->updateIcon(QUrl(faviconUrl), m_page->url(), m_page->icon());
+    // Only hand over the engine's icon if it belongs to the reported icon URL
+    const QUrl iconUrl(faviconUrl);
+    m_faviconManager->updateIcon(iconUrl, m_page->url(), m_page->iconUrl() == iconUrl ? m_page->icon() : QIcon());
 }
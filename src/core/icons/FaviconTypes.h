@@ -6,6 +6,7 @@
 
 #include <QIcon>
 
+#include <cstdint>
 #include <unordered_map>
 
 #include <QByteArray>
@@ -75,6 +76,25 @@ struct FaviconMap
     FaviconMap() : id(0), faviconId(0), pageUrl() {}
 };
 
+/// Counters describing how many icon downloads the \ref FaviconManager was able to avoid
+struct FaviconFetchStats
+{
+    /// Number of icons taken directly from the web engine instead of being downloaded
+    uint64_t engineIcons { 0 };
+
+    /// Number of icon requests that were attached to an already pending fetch of the same icon URL
+    uint64_t coalescedRequests { 0 };
+
+    /// Number of icon requests that were skipped because the icon was known and still fresh
+    uint64_t freshnessHits { 0 };
+
+    /// Number of network requests that were actually issued
+    uint64_t networkFetches { 0 };
+
+    /// Returns the total number of downloads that were avoided
+    uint64_t fetchesSaved() const { return engineIcons + coalescedRequests + freshnessHits; }
+};
+
 /// Represents the \ref FaviconOrigin structure as a map. Key = favicon Id, value = URL of icon
 using FaviconOriginMap = std::unordered_map<int, QUrl>;
 
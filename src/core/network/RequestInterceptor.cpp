@@ -1,5 +1,6 @@
 #include "AdBlockManager.h"
 #include "RequestInterceptor.h"
+#include "Tracer.h"
 #include "UserAgentManager.h"
 #include "WebPage.h"
 
@@ -28,10 +29,14 @@ void RequestInterceptor::fetchServices()
     {
         m_sendDoNotTrack = settings->getValue(BrowserSetting::SendDoNotTrack).toBool();
 
-        if (UserAgentManager *userAgentManager = m_serviceLocator.getServiceAs<UserAgentManager>("UserAgentManager"))
+        // The user agent manager is created on first use, so it is only looked up when a custom user agent is sent
+        m_sendCustomUserAgent = settings->getValue(BrowserSetting::CustomUserAgent).toBool();
+        if (m_sendCustomUserAgent)
         {
-            m_sendCustomUserAgent = settings->getValue(BrowserSetting::CustomUserAgent).toBool();
-            m_userAgent = m_sendCustomUserAgent ? userAgentManager->getUserAgent().Value.toLatin1() : QByteArray();
+            if (UserAgentManager *userAgentManager = m_serviceLocator.getServiceAs<UserAgentManager>("UserAgentManager"))
+                m_userAgent = userAgentManager->getUserAgent().Value.toLatin1();
+            else
+                m_sendCustomUserAgent = false;
         }
 
         connect(settings, &Settings::settingChanged, this, &RequestInterceptor::onSettingChanged);
@@ -43,6 +48,8 @@ void RequestInterceptor::fetchServices()
 
 void RequestInterceptor::interceptRequest(QWebEngineUrlRequestInfo &info)
 {
+    VIPER_TRACE_SCOPE("navigation", "RequestInterceptor::interceptRequest");
+
     if (!m_adBlockManager)
         fetchServices();
 
@@ -82,10 +89,10 @@ void RequestInterceptor::onSettingChanged(BrowserSetting setting, const QVariant
     else if (setting == BrowserSetting::CustomUserAgent)
     {
         m_sendCustomUserAgent = value.toBool();
+        if (!m_sendCustomUserAgent)
+            return;
 
-        UserAgentManager *userAgentManager = m_serviceLocator.getServiceAs<UserAgentManager>("UserAgentManager");
- 
-        if (m_sendCustomUserAgent && userAgentManager != nullptr)
+        if (UserAgentManager *userAgentManager = m_serviceLocator.getServiceAs<UserAgentManager>("UserAgentManager"))
             m_userAgent = userAgentManager->getUserAgent().Value.toLatin1();
     }
 }
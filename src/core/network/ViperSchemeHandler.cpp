@@ -1,19 +1,66 @@
+#include "FaviconManager.h"
 #include "ViperSchemeHandler.h"
+#include "WebPageThumbnailStore.h"
 
+#include <QBuffer>
+#include <QCryptographicHash>
 #include <QFile>
+#include <QIcon>
 #include <QMimeDatabase>
 #include <QMimeType>
+#include <QMultiMap>
+#include <QPixmap>
 #include <QUrl>
+#include <QUrlQuery>
 #include <QWebEngineUrlRequestJob>
+#include <QtGlobal>
 
-ViperSchemeHandler::ViperSchemeHandler(QObject *parent) :
-    QWebEngineUrlSchemeHandler(parent)
+namespace
+{
+    /// Size of the favicons served by the handler, in pixels, when no size is requested
+    constexpr int DefaultFaviconSize = 32;
+
+    /// Thumbnail URLs carry a version tag, so their contents never change and can be cached indefinitely
+    const QByteArray ThumbnailCacheControl = QByteArrayLiteral("max-age=31536000, immutable");
+
+    /// Favicons may be updated while the new tab page is open, so they are only cached briefly
+    const QByteArray FaviconCacheControl = QByteArrayLiteral("max-age=3600");
+}
+
+ViperSchemeHandler::ViperSchemeHandler(const ViperServiceLocator &serviceLocator, QObject *parent) :
+    QWebEngineUrlSchemeHandler(parent),
+    m_serviceLocator(serviceLocator),
+    m_faviconManager(nullptr),
+    m_thumbnailStore(nullptr)
 {
 }
 
 void ViperSchemeHandler::requestStarted(QWebEngineUrlRequestJob *request)
 {
-    QIODevice *contents = loadFile(request);
+    const QString path = getRequestPath(request);
+
+    // Thumbnails and favicons reveal the history and bookmarks of the user, so they are only served to the
+    // browser's own pages
+    const bool isImageRequest = path.startsWith(QLatin1String("thumbnail/")) || path.startsWith(QLatin1String("favicon/"));
+    if (isImageRequest && !isTrustedInitiator(request))
+    {
+        request->fail(QWebEngineUrlRequestJob::RequestDenied);
+        return;
+    }
+
+    if (path.startsWith(QLatin1String("thumbnail/")))
+    {
+        replyWithThumbnail(request, path.mid(10));
+        return;
+    }
+
+    if (path.startsWith(QLatin1String("favicon/")))
+    {
+        replyWithFavicon(request, path.mid(8));
+        return;
+    }
+
+    QIODevice *contents = loadFile(request, path);
     if (!contents)
     {
         request->fail(QWebEngineUrlRequestJob::UrlNotFound);
@@ -23,23 +70,35 @@ void ViperSchemeHandler::requestStarted(QWebEngineUrlRequestJob *request)
     QMimeDatabase db;
     QMimeType type = db.mimeTypeForData(contents);
     QByteArray mimeType = QByteArray::fromStdString(type.name().toStdString());
-    if (request && request->requestUrl().toString().endsWith(QLatin1String(".css")))
+    if (path.endsWith(QLatin1String(".css")))
         mimeType = QByteArray::fromStdString(R"(text/css)");
     request->reply(mimeType, contents);
 }
 
-QIODevice *ViperSchemeHandler::loadFile(QWebEngineUrlRequestJob *request)
+QString ViperSchemeHandler::getRequestPath(QWebEngineUrlRequestJob *request) const
 {
     // Extract file name from URL
-    QString qrcPath = request->requestUrl().toString();
-    qrcPath = qrcPath.mid(6);
-    if (qrcPath.startsWith(QLatin1String("//")))
-        qrcPath = qrcPath.mid(2);
+    QString path = request->requestUrl().toString(QUrl::FullyEncoded);
+    path = path.mid(6);
+    if (path.startsWith(QLatin1String("//")))
+        path = path.mid(2);
 
-    int paramPos = qrcPath.indexOf("?");
+    int paramPos = path.indexOf(QLatin1Char('?'));
     if (paramPos >= 0)
-        qrcPath = qrcPath.left(paramPos);
+        path = path.left(paramPos);
+
+    return path;
+}
 
+bool ViperSchemeHandler::isTrustedInitiator(QWebEngineUrlRequestJob *request) const
+{
+    // Requests made by the browser itself, such as navigations from the URL bar, have no initiator
+    const QUrl initiator = request->initiator();
+    return initiator.isEmpty() || initiator.scheme().compare(QLatin1String("viper"), Qt::CaseInsensitive) == 0;
+}
+
+QIODevice *ViperSchemeHandler::loadFile(QWebEngineUrlRequestJob *request, const QString &qrcPath)
+{
     // Attempt to load the qrc file
     QFile *f = new QFile(QString(":/%1").arg(qrcPath));
     if (!f->open(QIODevice::ReadOnly))
@@ -51,3 +110,79 @@ QIODevice *ViperSchemeHandler::loadFile(QWebEngineUrlRequestJob *request)
     connect(request, &QObject::destroyed, f, &QFile::deleteLater);
     return f;
 }
+
+void ViperSchemeHandler::replyWithThumbnail(QWebEngineUrlRequestJob *request, const QString &host)
+{
+    if (!m_thumbnailStore)
+        m_thumbnailStore = m_serviceLocator.getServiceAs<WebPageThumbnailStore>("WebPageThumbnailStore");
+
+    QByteArray data;
+    if (m_thumbnailStore)
+        data = m_thumbnailStore->getThumbnailData(QUrl::fromPercentEncoding(host.toLatin1()).toLower());
+
+    if (data.isEmpty())
+    {
+        request->fail(QWebEngineUrlRequestJob::UrlNotFound);
+        return;
+    }
+
+    replyWithImage(request, QByteArrayLiteral("image/jpeg"), data, ThumbnailCacheControl);
+}
+
+void ViperSchemeHandler::replyWithFavicon(QWebEngineUrlRequestJob *request, const QString &pageUrl)
+{
+    if (!m_faviconManager)
+        m_faviconManager = m_serviceLocator.getServiceAs<FaviconManager>("FaviconManager");
+
+    const QUrl url(QUrl::fromPercentEncoding(pageUrl.toLatin1()));
+    if (!m_faviconManager || !url.isValid())
+    {
+        request->fail(QWebEngineUrlRequestJob::UrlNotFound);
+        return;
+    }
+
+    int size = QUrlQuery(request->requestUrl()).queryItemValue(QStringLiteral("size")).toInt();
+    if (size <= 0 || size > 256)
+        size = DefaultFaviconSize;
+
+    const QPixmap pixmap = m_faviconManager->getFavicon(url).pixmap(size, size);
+
+    QByteArray data;
+    QBuffer buffer(&data);
+    if (pixmap.isNull() || !buffer.open(QIODevice::WriteOnly) || !pixmap.save(&buffer, "PNG"))
+    {
+        request->fail(QWebEngineUrlRequestJob::UrlNotFound);
+        return;
+    }
+
+    replyWithImage(request, QByteArrayLiteral("image/png"), data, FaviconCacheControl);
+}
+
+void ViperSchemeHandler::replyWithImage(QWebEngineUrlRequestJob *request, const QByteArray &mimeType, const QByteArray &data, const QByteArray &cacheControl)
+{
+#if (QT_VERSION >= QT_VERSION_CHECK(6, 6, 0))
+    const QByteArray etag = QByteArray("\"")
+            .append(QCryptographicHash::hash(data, QCryptographicHash::Md5).toHex())
+            .append('"');
+
+    QMultiMap<QByteArray, QByteArray> headers;
+    headers.insert(QByteArrayLiteral("Cache-Control"), cacheControl);
+    headers.insert(QByteArrayLiteral("ETag"), etag);
+    request->setAdditionalResponseHeaders(headers);
+#else
+    Q_UNUSED(cacheControl);
+#endif
+
+    QBuffer *buffer = new QBuffer;
+    buffer->setData(data);
+    if (!buffer->open(QIODevice::ReadOnly))
+    {
+        delete buffer;
+        request->fail(QWebEngineUrlRequestJob::UrlNotFound);
+        return;
+    }
+
+    connect(request, &QObject::destroyed, buffer, &QBuffer::deleteLater);
+
+    request->reply(mimeType, buffer);
+}
@@ -1,29 +1,67 @@
 #ifndef VIPERSCHEMEHANDLER_H
 #define VIPERSCHEMEHANDLER_H
 
+#include "ServiceLocator.h"
+
+#include <QByteArray>
 #include <QWebEngineUrlSchemeHandler>
 
+class FaviconManager;
+class WebPageThumbnailStore;
+
 class QIODevice;
 class QWebEngineUrlRequestJob;
 
 /**
  * @class ViperSchemeHandler
- * @brief Implements the viper scheme (wrapper for qrc) for the QtWebEngine backend
+ * @brief Implements the viper scheme (wrapper for qrc) for the QtWebEngine backend.
+ *
+ * Besides the qrc files, the handler serves the images shown on the new tab page as binary data:
+ * viper://thumbnail/<host> returns the JPEG thumbnail of a host, and viper://favicon/<page url>
+ * returns the favicon of a page as a PNG. Both carry cache validators so that the web engine does
+ * not need to fetch the same image again each time the new tab page is opened. Images are only served
+ * to requests initiated by viper pages, or by the browser itself.
  */
 class ViperSchemeHandler : public QWebEngineUrlSchemeHandler
 {
     Q_OBJECT
 
 public:
-    /// Constructs the viper scheme handler with an optional parent
-    ViperSchemeHandler(QObject *parent = nullptr);
+    /// Constructs the viper scheme handler with a reference to the service locator and an optional parent
+    ViperSchemeHandler(const ViperServiceLocator &serviceLocator, QObject *parent = nullptr);
 
     /// Called whenever a request for the viper scheme is started
     void requestStarted(QWebEngineUrlRequestJob *request) override;
 
 private:
+    /// Returns the path of the request URL, without the scheme and any query parameters
+    QString getRequestPath(QWebEngineUrlRequestJob *request) const;
+
+    /// Returns true if the request was made by the browser itself or by a viper page, which may be served
+    /// images derived from the history and bookmarks of the user
+    bool isTrustedInitiator(QWebEngineUrlRequestJob *request) const;
+
     /// Loads the qrc file associated with the viper scheme request
-    QIODevice *loadFile(QWebEngineUrlRequestJob *request);
+    QIODevice *loadFile(QWebEngineUrlRequestJob *request, const QString &qrcPath);
+
+    /// Replies to a request for the thumbnail of the given (percent-encoded) host
+    void replyWithThumbnail(QWebEngineUrlRequestJob *request, const QString &host);
+
+    /// Replies to a request for the favicon of the given (percent-encoded) page URL
+    void replyWithFavicon(QWebEngineUrlRequestJob *request, const QString &pageUrl);
+
+    /// Replies to the request with the image data, along with its cache validators
+    void replyWithImage(QWebEngineUrlRequestJob *request, const QByteArray &mimeType, const QByteArray &data, const QByteArray &cacheControl);
+
+private:
+    /// Service locator
+    const ViperServiceLocator &m_serviceLocator;
+
+    /// Favicon manager, used to serve favicons
+    FaviconManager *m_faviconManager;
+
+    /// Thumbnail store, used to serve web page thumbnails
+    WebPageThumbnailStore *m_thumbnailStore;
 };
 
 #endif // VIPERSCHEMEHANDLER_H
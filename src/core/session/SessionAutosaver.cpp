@@ -0,0 +1,215 @@
+#include "SessionAutosaver.h"
+
+#include <algorithm>
+
+#include <QDebug>
+#include <QSaveFile>
+
+SessionAutosaver::SessionAutosaver(const QString &fileName) :
+    m_fileName(fileName),
+    m_tabs(),
+    m_iconIndices(),
+    m_iconRecords(),
+    m_nextIconIndex(0),
+    m_snapshotNumber(0),
+    m_snapshot(),
+    m_snapshotIcons(),
+    m_numEncodedTabs(0),
+    m_lastNumEncodedTabs(0),
+    m_mutex(),
+    m_pendingSnapshot(),
+    m_hasPendingSnapshot(false),
+    m_numWrites(0),
+    m_writerPool()
+{
+    m_writerPool.setMaxThreadCount(1);
+    m_writerPool.setExpiryTimeout(-1);
+}
+
+SessionAutosaver::~SessionAutosaver()
+{
+    waitForDone();
+}
+
+void SessionAutosaver::addWindow(const SessionWindow &window)
+{
+    m_snapshot.append(SessionWriter::encodeWindow(window));
+}
+
+bool SessionAutosaver::addCachedTab(uintptr_t tabId)
+{
+    auto it = m_tabs.find(tabId);
+    if (it == m_tabs.end())
+        return false;
+
+    CachedTab &cachedTab = it->second;
+    cachedTab.SnapshotNumber = m_snapshotNumber;
+    if (cachedTab.IconIndex >= 0)
+        m_snapshotIcons.push_back(cachedTab.IconIndex);
+
+    m_snapshot.append(cachedTab.Record);
+    return true;
+}
+
+void SessionAutosaver::addTab(uintptr_t tabId, const SessionTab &tab)
+{
+    int32_t iconIndex = -1;
+    if (!tab.Icon.isNull())
+    {
+        const QString iconKey = SessionWriter::getIconKey(tab);
+        auto it = m_iconIndices.find(iconKey);
+        if (it != m_iconIndices.end())
+            iconIndex = it.value();
+        else
+        {
+            const int32_t newIndex = m_nextIconIndex;
+            QByteArray iconRecord = SessionWriter::encodeIcon(newIndex, tab.Icon);
+            if (!iconRecord.isEmpty())
+            {
+                ++m_nextIconIndex;
+                m_iconRecords[newIndex] = std::move(iconRecord);
+                m_iconIndices.insert(iconKey, newIndex);
+                iconIndex = newIndex;
+            }
+        }
+    }
+
+    CachedTab &cachedTab = m_tabs[tabId];
+    cachedTab.Record = SessionWriter::encodeTab(tab, iconIndex);
+    cachedTab.IconIndex = iconIndex;
+    cachedTab.SnapshotNumber = m_snapshotNumber;
+
+    if (iconIndex >= 0)
+        m_snapshotIcons.push_back(iconIndex);
+
+    m_snapshot.append(cachedTab.Record);
+    ++m_numEncodedTabs;
+}
+
+void SessionAutosaver::invalidateTab(uintptr_t tabId)
+{
+    m_tabs.erase(tabId);
+}
+
+void SessionAutosaver::save()
+{
+    // Favicons are written first, so that they precede every tab that refers to them
+    std::sort(m_snapshotIcons.begin(), m_snapshotIcons.end());
+    m_snapshotIcons.erase(std::unique(m_snapshotIcons.begin(), m_snapshotIcons.end()), m_snapshotIcons.end());
+
+    QByteArray records;
+    for (int32_t iconIndex : m_snapshotIcons)
+        records.append(m_iconRecords.at(iconIndex));
+    records.append(m_snapshot);
+
+    // Every open tab is added to each snapshot, so the records left out of this one belong to closed tabs
+    for (auto it = m_tabs.begin(); it != m_tabs.end();)
+    {
+        if (it->second.SnapshotNumber != m_snapshotNumber)
+            it = m_tabs.erase(it);
+        else
+            ++it;
+    }
+
+    auto isIconUsed = [this](int32_t iconIndex) {
+        return std::binary_search(m_snapshotIcons.begin(), m_snapshotIcons.end(), iconIndex);
+    };
+    for (auto it = m_iconRecords.begin(); it != m_iconRecords.end();)
+    {
+        if (!isIconUsed(it->first))
+            it = m_iconRecords.erase(it);
+        else
+            ++it;
+    }
+    for (auto it = m_iconIndices.begin(); it != m_iconIndices.end();)
+    {
+        if (!isIconUsed(it.value()))
+            it = m_iconIndices.erase(it);
+        else
+            ++it;
+    }
+
+    ++m_snapshotNumber;
+    m_snapshot.clear();
+    m_snapshotIcons.clear();
+    m_lastNumEncodedTabs = m_numEncodedTabs;
+    m_numEncodedTabs = 0;
+
+    bool writeScheduled = false;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        writeScheduled = m_hasPendingSnapshot;
+        m_pendingSnapshot = std::move(records);
+        m_hasPendingSnapshot = true;
+    }
+
+    // A snapshot that has not been written yet is replaced rather than written as well
+    if (!writeScheduled)
+        m_writerPool.start([this](){ writePendingSnapshot(); });
+}
+
+void SessionAutosaver::waitForDone()
+{
+    m_writerPool.waitForDone();
+}
+
+int SessionAutosaver::getNumEncodedTabs() const
+{
+    return m_lastNumEncodedTabs;
+}
+
+int SessionAutosaver::getNumWrites() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_numWrites;
+}
+
+int SessionAutosaver::getNumCachedTabs() const
+{
+    return static_cast<int>(m_tabs.size());
+}
+
+int SessionAutosaver::getNumCachedIcons() const
+{
+    return static_cast<int>(m_iconRecords.size());
+}
+
+bool SessionAutosaver::writeSession(const QString &fileName, const QByteArray &records)
+{
+    QSaveFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly))
+        return false;
+
+    SessionWriter writer(&file);
+    writer.addEncodedRecords(records);
+    if (!writer.finish())
+    {
+        file.cancelWriting();
+        return false;
+    }
+
+    return file.commit();
+}
+
+void SessionAutosaver::writePendingSnapshot()
+{
+    QByteArray records;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_hasPendingSnapshot)
+            return;
+
+        records = std::move(m_pendingSnapshot);
+        m_pendingSnapshot = QByteArray();
+        m_hasPendingSnapshot = false;
+    }
+
+    if (!writeSession(m_fileName, records))
+    {
+        qWarning() << "SessionAutosaver - could not write session to" << m_fileName;
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    ++m_numWrites;
+}
@@ -0,0 +1,140 @@
+#ifndef SESSIONAUTOSAVER_H
+#define SESSIONAUTOSAVER_H
+
+#include "SessionStream.h"
+
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include <QByteArray>
+#include <QHash>
+#include <QString>
+#include <QThreadPool>
+
+/**
+ * @class SessionAutosaver
+ * @brief Periodically saves the browsing session, encoding only the tabs that changed since the last save
+ *
+ * A snapshot of the session is built on the GUI thread, window by window and tab by tab, and then written
+ * to the session file by a background thread. The record of each tab is kept after it has been encoded,
+ * and reused by later snapshots until the tab is invalidated, so that unchanged tabs cost neither the
+ * collection of their state nor their encoding. Records of tabs and favicons that are left out of a snapshot,
+ * such as those of closed tabs, are discarded once the snapshot is saved.
+ *
+ * Snapshots are written to a temporary file which then replaces the session file, so that the session
+ * file always holds a complete session even if the browser is killed in the middle of a write. At most one
+ * snapshot is written at a time. A snapshot saved while another is being written waits for that write to
+ * complete, and is replaced by any newer snapshot in the meantime.
+ */
+class SessionAutosaver
+{
+public:
+    /// Constructs the autosaver, which writes snapshots of the session to the given file
+    explicit SessionAutosaver(const QString &fileName);
+
+    /// Waits for any pending snapshot to be written, and destroys the autosaver
+    ~SessionAutosaver();
+
+    /// Adds a window to the snapshot being built. Tabs added afterwards belong to this window
+    void addWindow(const SessionWindow &window);
+
+    /// Adds the previously encoded record of the tab with the given identifier to the snapshot being built.
+    /// Returns false if the tab has not been encoded since it was last invalidated, in which case \ref addTab
+    /// must be called instead
+    bool addCachedTab(uintptr_t tabId);
+
+    /// Encodes a tab, keeps its record for later snapshots, and adds it to the snapshot being built
+    void addTab(uintptr_t tabId, const SessionTab &tab);
+
+    /// Discards the record of a tab that has changed or was closed
+    void invalidateTab(uintptr_t tabId);
+
+    /// Completes the snapshot being built, and writes it to the session file in the background
+    void save();
+
+    /// Waits for every snapshot that has been saved to be written
+    void waitForDone();
+
+    /// Returns the number of tabs that were encoded for the last snapshot, rather than reused
+    int getNumEncodedTabs() const;
+
+    /// Returns the number of snapshots that have been written to the session file
+    int getNumWrites() const;
+
+    /// Returns the number of tab records kept for later snapshots
+    int getNumCachedTabs() const;
+
+    /// Returns the number of favicon records kept for later snapshots
+    int getNumCachedIcons() const;
+
+    /// Writes the given encoded records to a temporary file as a complete session, and replaces the
+    /// session file with it. Returns true on success
+    static bool writeSession(const QString &fileName, const QByteArray &records);
+
+private:
+    /// Writes the latest pending snapshot, if any, on the writer thread
+    void writePendingSnapshot();
+
+private:
+    /// Tab record kept between snapshots
+    struct CachedTab
+    {
+        /// Encoded tab record
+        QByteArray Record;
+
+        /// Index of the tab's favicon, or -1 if it has none
+        int32_t IconIndex;
+
+        /// Number of the last snapshot that the tab was added to
+        int SnapshotNumber;
+    };
+
+    /// Path of the session file
+    const QString m_fileName;
+
+    /// Records of the tabs that have not changed since they were encoded, by tab identifier
+    std::unordered_map<uintptr_t, CachedTab> m_tabs;
+
+    /// Index of each favicon that has been encoded, by its key
+    QHash<QString, int32_t> m_iconIndices;
+
+    /// Encoded record of each favicon, by its index
+    std::unordered_map<int32_t, QByteArray> m_iconRecords;
+
+    /// Index given to the next favicon that is encoded
+    int32_t m_nextIconIndex;
+
+    /// Number of the snapshot being built
+    int m_snapshotNumber;
+
+    /// Window and tab records of the snapshot being built
+    QByteArray m_snapshot;
+
+    /// Indices of the favicons used by the snapshot being built
+    std::vector<int32_t> m_snapshotIcons;
+
+    /// Number of tabs encoded for the snapshot being built
+    int m_numEncodedTabs;
+
+    /// Number of tabs encoded for the last snapshot
+    int m_lastNumEncodedTabs;
+
+    /// Guards the pending snapshot and the write counter
+    mutable std::mutex m_mutex;
+
+    /// Most recent snapshot waiting to be written
+    QByteArray m_pendingSnapshot;
+
+    /// True if a snapshot is waiting to be written
+    bool m_hasPendingSnapshot;
+
+    /// Number of snapshots written to the session file
+    int m_numWrites;
+
+    /// Single thread on which snapshots are written
+    QThreadPool m_writerPool;
+};
+
+#endif // SESSIONAUTOSAVER_H
@@ -1,23 +1,123 @@
 #include "SessionManager.h"
 #include "BrowserApplication.h"
 #include "BrowserTabWidget.h"
-#include "CommonUtil.h"
 #include "MainWindow.h"
-#include "WebHistory.h"
+#include "ProcessStatsReader.h"
+#include "SessionAutosaver.h"
+#include "SessionStream.h"
+#include "Settings.h"
+#include "TabRestoreQueue.h"
+#include "Tracer.h"
+#include "WebPage.h"
 #include "WebWidget.h"
 
-#include <QByteArray>
+#include <algorithm>
+#include <cstdint>
+#include <unordered_set>
+
+#include <QCoreApplication>
+#include <QDebug>
+#include <QDir>
 #include <QFile>
-#include <QJsonArray>
-#include <QJsonDocument>
-#include <QJsonObject>
-#include <QJsonValue>
+#include <QFileInfo>
+#include <QSaveFile>
 #include <QString>
+#include <QTabBar>
+#include <QTimer>
 #include <QUrl>
 
+namespace
+{
+    /// Name of the session file written by versions of the browser that saved sessions as JSON documents
+    const QString LegacySessionFileName = QStringLiteral("last_session.json");
+
+    /// Delay between two autosaves of the session, in milliseconds. At most one snapshot of the session is
+    /// written per interval
+    constexpr int AutosaveInterval = 15000;
+
+    /// Returns the identifier of a tab in the session autosaver
+    uintptr_t getTabId(const QObject *tab)
+    {
+        return reinterpret_cast<uintptr_t>(tab);
+    }
+
+    /// Returns the state of a window that is stored in a session
+    SessionWindow getWindowState(MainWindow *win)
+    {
+        SessionWindow window;
+        window.Geometry = win->geometry();
+        window.IsMaximized = win->isMaximized();
+        window.CurrentTab = win->getTabWidget()->currentIndex();
+        return window;
+    }
+
+    /// Returns the state of a tab that is stored in a session
+    SessionTab getTabState(BrowserTabWidget *tabWidget, int index, WebWidget *ww)
+    {
+        SessionTab tab;
+        tab.Url = ww->url();
+        tab.Title = ww->getTitle();
+        tab.IconUrl = ww->getIconUrl();
+        tab.Icon = ww->getIcon();
+        if (tab.Icon.isNull())
+            tab.Icon = tabWidget->tabIcon(index);
+        tab.History = ww->getEncodedHistory();
+        tab.IsPinned = tabWidget->isTabPinned(index);
+        tab.IsHibernating = ww->isHibernating();
+        return tab;
+    }
+
+    /// Returns the memory used by the browser process and by the renderer processes of the tabs in the given windows,
+    /// in kibibytes. The proportional set size of each process is used where available, so that pages shared between
+    /// the processes are only counted once
+    qint64 getResidentMemory(const std::vector<QPointer<MainWindow>> &windows)
+    {
+        std::unordered_set<int64_t> processIds { static_cast<int64_t>(QCoreApplication::applicationPid()) };
+        for (const QPointer<MainWindow> &win : windows)
+        {
+            if (win.isNull())
+                continue;
+
+            BrowserTabWidget *tabWidget = win->getTabWidget();
+            for (int i = 0; i < tabWidget->count(); ++i)
+            {
+                // Hibernating tabs have no page, and therefore no renderer process
+                WebWidget *ww = tabWidget->getWebWidget(i);
+                if (ww != nullptr && !ww->isHibernating() && ww->page() != nullptr)
+                    processIds.insert(static_cast<int64_t>(ww->page()->renderProcessPid()));
+            }
+        }
+
+        const ProcessStatsReader reader;
+        qint64 total = 0;
+        for (int64_t processId : processIds)
+        {
+            const ProcessStats stats = reader.read(processId, true);
+            const int64_t memory = stats.ProportionalKiB >= 0 ? stats.ProportionalKiB : stats.ResidentKiB;
+            if (memory > 0)
+                total += memory;
+        }
+        return total;
+    }
+}
+
 SessionManager::SessionManager() :
+    QObject(nullptr),
     m_dataFile(),
-    m_savedSession(false)
+    m_savedSession(false),
+    m_restoreQueue(nullptr),
+    m_restoreTimer(),
+    m_numRestoredTabs(0),
+    m_numLoadedTabs(0),
+    m_settings(nullptr),
+    m_autosaver(nullptr),
+    m_autosaveTimer(nullptr),
+    m_autosaveNeeded(false),
+    m_windows()
+{
+}
+
+SessionManager::~SessionManager()
 {
 }
 
@@ -31,163 +131,319 @@ void SessionManager::setSessionFile(const QString &fullPath)
     m_dataFile = fullPath;
 }
 
-void SessionManager::saveState(std::vector<MainWindow*> &windows)
+void SessionManager::startAutosave(Settings *settings)
 {
-    QFile dataFile(m_dataFile);
-    if (!dataFile.open(QIODevice::WriteOnly))
+    if (m_autosaver != nullptr || m_dataFile.isEmpty())
         return;
 
-    // Construct a QJsonDocument containing an array of windows corresponding to the container passed to this method
-    QJsonObject sessionObj;
-    QJsonArray windowArray;
-    for (MainWindow *win : windows)
-    {
-        QJsonObject winObj;
-        QJsonArray tabArray;
+    m_settings = settings;
+    m_autosaver = std::make_unique<SessionAutosaver>(m_dataFile);
 
-        // Add each tab's URL to the array
-        BrowserTabWidget *tabWidget = win->getTabWidget();
-        int numTabs = tabWidget->count();
-        for (int i = 0; i < numTabs; ++i)
-        {
-            WebWidget *ww = tabWidget->getWebWidget(i);
-            if (!ww)
-                continue;
-
-            QJsonObject tabInfoObj;
-            tabInfoObj.insert(QLatin1String("url"), QJsonValue(ww->url().toString()));
-            tabInfoObj.insert(QLatin1String("is_pinned"), QJsonValue(tabWidget->isTabPinned(i)));
-            tabInfoObj.insert(QLatin1String("is_hibernating"), QJsonValue(ww->isHibernating()));
-            tabInfoObj.insert(QLatin1String("title"), QJsonValue(ww->getTitle()));
+    m_autosaveTimer = new QTimer(this);
+    m_autosaveTimer->setInterval(AutosaveInterval);
+    connect(m_autosaveTimer, &QTimer::timeout, this, &SessionManager::autosave);
+    m_autosaveTimer->start();
+}
 
-            QIcon icon = ww->getIcon();
-            if (icon.isNull())
-                icon = tabWidget->tabIcon(i);
+void SessionManager::trackWindow(MainWindow *window)
+{
+    if (window == nullptr || window->isPrivate())
+        return;
 
-            QByteArray faviconB64 = CommonUtil::iconToBase64(icon);
-            auto faviconEncoded = QLatin1String(faviconB64.data());
-            tabInfoObj.insert(QLatin1String("icon"), QJsonValue(faviconEncoded));
-            tabInfoObj.insert(QLatin1String("icon_url"), QJsonValue(ww->getIconUrl().toString()));
+    m_windows.push_back(window);
+
+    BrowserTabWidget *tabWidget = window->getTabWidget();
+    connect(tabWidget, &BrowserTabWidget::newTabCreated, this, &SessionManager::trackTab);
+    connect(tabWidget, &BrowserTabWidget::tabClosing, this, [this](WebWidget *ww){
+        onTabChanged(ww);
+    });
+    connect(tabWidget, &BrowserTabWidget::tabPinned, this, [this, tabWidget](int index, bool){
+        onTabChanged(tabWidget->getWebWidget(index));
+    });
+    connect(tabWidget, &BrowserTabWidget::currentChanged, this, &SessionManager::onSessionChanged);
+    connect(tabWidget->tabBar(), &QTabBar::tabMoved, this, &SessionManager::onSessionChanged);
+    connect(window, &MainWindow::destroyed, this, &SessionManager::onSessionChanged);
+
+    for (int i = 0; i < tabWidget->count(); ++i)
+    {
+        if (WebWidget *ww = tabWidget->getWebWidget(i))
+            trackTab(ww);
+    }
 
-            QByteArray tabHistoryB64 = ww->getEncodedHistory().toBase64();
-            auto tabHistoryEncoded = QLatin1String(tabHistoryB64.data());
-            tabInfoObj.insert(QLatin1String("history"), QJsonValue(tabHistoryEncoded));
+    m_autosaveNeeded = true;
+}
 
-            tabArray.append(QJsonValue(tabInfoObj));
-        }
+void SessionManager::saveState(std::vector<MainWindow*> &windows)
+{
+    VIPER_TRACE_SCOPE("session", "SessionManager::saveState");
 
-        winObj.insert(QLatin1String("tabs"), QJsonValue(tabArray));
-        winObj.insert(QLatin1String("current_tab"), QJsonValue(tabWidget->currentIndex()));
+    // Let any autosave complete first, so that it cannot replace this session
+    if (m_autosaveTimer != nullptr)
+        m_autosaveTimer->stop();
+    if (m_autosaver != nullptr)
+        m_autosaver->waitForDone();
 
-        // Store geometry of window
-        const QRect &winGeom = win->geometry();
-        winObj.insert(QLatin1String("geom_x"), QJsonValue(winGeom.x()));
-        winObj.insert(QLatin1String("geom_y"), QJsonValue(winGeom.y()));
-        winObj.insert(QLatin1String("geom_width"), QJsonValue(winGeom.width()));
-        winObj.insert(QLatin1String("geom_height"), QJsonValue(winGeom.height()));
+    // The session is written to a temporary file, which replaces the session file once it is complete
+    QSaveFile dataFile(m_dataFile);
+    if (!dataFile.open(QIODevice::WriteOnly))
+        return;
 
-        winObj.insert(QLatin1String("is_maximized"), QJsonValue(win->isMaximized()));
+    // Each window and tab is written as soon as its state has been collected
+    SessionWriter writer(&dataFile);
+    for (MainWindow *win : windows)
+    {
+        writer.addWindow(getWindowState(win));
 
-        windowArray.append(QJsonValue(winObj));
+        BrowserTabWidget *tabWidget = win->getTabWidget();
+        const int numTabs = tabWidget->count();
+        for (int i = 0; i < numTabs; ++i)
+        {
+            if (WebWidget *ww = tabWidget->getWebWidget(i))
+                writer.addTab(getTabState(tabWidget, i, ww));
+        }
     }
-    sessionObj.insert(QLatin1String("windows"), QJsonValue(windowArray));
 
-    // Save to file
-    QJsonDocument sessionDoc(sessionObj);
-    dataFile.write(sessionDoc.toJson());
-    dataFile.close();
+    if (!writer.finish() || !dataFile.commit())
+    {
+        qWarning() << "SessionManager - could not write session to" << m_dataFile;
+        return;
+    }
 
     m_savedSession = true;
+
+    // The binary session replaces any session saved by a previous version
+    const QString legacyFile = getLegacySessionFile();
+    if (legacyFile != m_dataFile && QFile::exists(legacyFile))
+        QFile::remove(legacyFile);
 }
 
 void SessionManager::restoreSession(MainWindow *firstWindow, BrowserApplication *browserApplication)
 {
+    VIPER_TRACE_SCOPE("session", "SessionManager::restoreSession");
+
+    // Fall back to the JSON session of a previous version, which is converted on the next save
     QFile dataFile(m_dataFile);
+    if (!dataFile.exists())
+        dataFile.setFileName(getLegacySessionFile());
+
     if (!dataFile.exists() || !dataFile.open(QIODevice::ReadOnly))
         return;
 
-    // Attempt to parse data file
-    QByteArray sessionData = dataFile.readAll();
-    dataFile.close();
-
-    QJsonDocument sessionDoc(QJsonDocument::fromJson(sessionData));
-    if (!sessionDoc.isObject())
+    SessionReader reader(&dataFile);
+    if (!reader.isValid())
+    {
+        qWarning() << "SessionManager - unrecognized session file" << dataFile.fileName();
         return;
+    }
 
-    QJsonObject sessionObj = sessionDoc.object();
-    auto it = sessionObj.find(QLatin1String("windows"));
-    if (it == sessionObj.end())
-        return;
+    // Unless every tab is to be loaded now, only the active tab of each window is loaded. The other tabs start in
+    // hibernation, and are loaded when activated or, if allowed, a few at a time in the background
+    Settings *settings = browserApplication->getSettings();
+    const bool lazyRestore = settings->getValue(BrowserSetting::LazySessionRestore).toBool();
+    const int loadLimit = lazyRestore ? settings->getValue(BrowserSetting::SessionRestoreLoadLimit).toInt() : 0;
+
+    m_restoreQueue = std::make_unique<TabRestoreQueue>(loadLimit);
+    m_restoreTimer.start();
+    m_numRestoredTabs = 0;
+    m_numLoadedTabs = 0;
+
+    TabRestoreQueue *restoreQueue = m_restoreQueue.get();
+    WebWidget *firstActiveTab = nullptr;
 
-    // Load each tab into the appropriate windows
-    bool isFirstWindow = true;
+    // Load each tab into the appropriate windows, as they are read
+    int numWindows = 0;
     MainWindow *currentWindow = firstWindow;
+    BrowserTabWidget *tabWidget = nullptr;
+    int tabIndex = 0;
+    int currentTab = 0;
 
-    QJsonArray winArray = it.value().toArray();
-    for (auto winIt = winArray.constBegin(); winIt != winArray.constEnd(); ++winIt)
+    for (SessionReader::Item item = reader.readNext(); item != SessionReader::Item::End; item = reader.readNext())
     {
-        if (!isFirstWindow)
-            currentWindow = browserApplication->getNewWindow();
+        if (item == SessionReader::Item::Window)
+        {
+            // Set current tab of the previous window to its last active tab
+            if (tabWidget != nullptr)
+                tabWidget->setCurrentIndex(currentTab);
+
+            if (numWindows > 0)
+                currentWindow = browserApplication->getNewWindow();
+            ++numWindows;
+
+            // Restore window properties
+            const SessionWindow &window = reader.getWindow();
+            if (window.IsMaximized)
+                currentWindow->showMaximized();
+            else if (window.Geometry.isValid())
+                currentWindow->setGeometry(window.Geometry);
+
+            tabWidget = currentWindow->getTabWidget();
+            tabIndex = 0;
+            currentTab = window.CurrentTab;
+        }
+        else if (tabWidget != nullptr)
+        {
+            const SessionTab &tab = reader.getTab();
+
+            WebState webState;
+            webState.title = tab.Title;
+            webState.iconUrl = tab.IconUrl;
+            webState.url = tab.Url;
+            webState.icon = tab.Icon;
+            webState.pageHistory = tab.History;
+
+            const bool isActiveTab = (tabIndex == currentTab);
+            const bool deferLoad = lazyRestore && !isActiveTab && !tab.IsHibernating;
+            const bool hibernate = deferLoad || tab.IsHibernating;
+
+            // The first tab of a window already exists. Other tabs that are not loaded now are created without a web view
+            WebWidget *ww = nullptr;
+            if (tabIndex == 0)
+            {
+                ww = qobject_cast<WebWidget*>(tabWidget->widget(0));
+                ww->setHibernation(hibernate);
+                ww->setWebState(std::move(webState));
+            }
+            else if (hibernate)
+                ww = tabWidget->newHibernatedTabAtIndex(tabIndex, std::move(webState));
+            else
+            {
+                ww = tabWidget->newBackgroundTabAtIndex(tabIndex);
+                ww->setWebState(std::move(webState));
+            }
 
-        isFirstWindow = false;
+            tabWidget->setTabPinned(tabIndex, tab.IsPinned);
 
-        QJsonObject winObject = winIt->toObject();
+            if (deferLoad)
+            {
+                ww->setWakeOnActivation(true);
+
+                QObject::connect(ww, &WebWidget::aboutToWake, restoreQueue, [restoreQueue, ww](){
+                    restoreQueue->remove(ww);
+                });
+                QObject::connect(ww, &WebWidget::loadFinished, restoreQueue, [restoreQueue, ww](){
+                    restoreQueue->onLoadFinished(ww);
+                });
+                restoreQueue->enqueue(ww, [restoreQueue, ww](){
+                    if (ww->wakesOnActivation())
+                        ww->setHibernation(false);
+                    else
+                        restoreQueue->onLoadFinished(ww);
+                });
+            }
 
-        // Restore window properties
-        const bool isMaximized = winObject.value(QLatin1String("is_maximized")).toBool(false);
+            if (numWindows == 1 && isActiveTab)
+                firstActiveTab = ww;
 
-        if (isMaximized)
-            currentWindow->showMaximized();
-        else if (winObject.contains(QLatin1String("geom_x")))
-        {
-            QRect winGeom;
-            winGeom.setX(winObject.value(QLatin1String("geom_x")).toInt());
-            winGeom.setY(winObject.value(QLatin1String("geom_y")).toInt());
-            winGeom.setWidth(winObject.value(QLatin1String("geom_width")).toInt(100));
-            winGeom.setHeight(winObject.value(QLatin1String("geom_height")).toInt(100));
-            currentWindow->setGeometry(winGeom);
+            ++m_numRestoredTabs;
+            if (!hibernate)
+                ++m_numLoadedTabs;
+
+            ++tabIndex;
         }
+    }
 
-        // Restore tabs belonging to the window
-        BrowserTabWidget *tabWidget = currentWindow->getTabWidget();
+    if (tabWidget != nullptr)
+        tabWidget->setCurrentIndex(currentTab);
 
-        QJsonArray tabArray = winObject.value(QLatin1String("tabs")).toArray();
-        int i = 0;
-        for (auto tabIt = tabArray.constBegin(); tabIt != tabArray.constEnd(); ++tabIt)
-        {
-            if (tabIt->isString())
-                tabWidget->openLinkInNewTab(QUrl::fromUserInput(tabIt->toString()));
-            else if (tabIt->isObject())
-            {
-                QJsonObject tabInfoObj = tabIt->toObject();
+    QObject::connect(restoreQueue, &TabRestoreQueue::finished, restoreQueue, [this](){
+        if (Tracer::isEnabled())
+            qDebug() << "SessionManager - background tab loading finished after" << m_restoreTimer.elapsed() << "ms."
+                     << "Memory:" << getResidentMemory(m_windows) << "KiB";
+    });
 
-                WebState webState;
-                webState.title = tabInfoObj.value(QLatin1String("title")).toString();
-                webState.iconUrl = QUrl::fromUserInput(tabInfoObj.value(QLatin1String("icon_url")).toString());
-                webState.url = QUrl::fromUserInput(tabInfoObj.value(QLatin1String("url")).toString());
+    // The session is interactive once the active tab of the first window has loaded. Background loads start then,
+    // so that they do not compete with it
+    if (firstActiveTab != nullptr && !firstActiveTab->isHibernating())
+    {
+        QObject::connect(firstActiveTab, &WebWidget::loadFinished, restoreQueue, [this](){
+            onSessionInteractive();
+        }, Qt::SingleShotConnection);
+    }
+    else
+        onSessionInteractive();
+}
 
-                const QByteArray faviconData = tabInfoObj.value(QLatin1String("icon")).toString().toLatin1();
-                if (!faviconData.isNull())
-                    webState.icon = CommonUtil::iconFromBase64(faviconData);
+void SessionManager::onSessionInteractive()
+{
+    Tracer::instance().addInstantEvent("session", "SessionInteractive");
 
-                const QByteArray encodedHistory = tabInfoObj.value(QLatin1String("history")).toString().toLatin1();
-                webState.pageHistory = QByteArray::fromBase64(encodedHistory);
+    if (Tracer::isEnabled())
+        qDebug() << "SessionManager - restored" << m_numRestoredTabs << "tabs, of which" << m_numLoadedTabs
+                 << "were loaded at startup. Time to interactive:" << m_restoreTimer.elapsed() << "ms."
+                 << "Memory:" << getResidentMemory(m_windows) << "KiB";
 
-                WebWidget *ww = (i == 0) ? qobject_cast<WebWidget*>(tabWidget->widget(0)) : tabWidget->newBackgroundTabAtIndex(i);
+    m_restoreQueue->start();
+}
 
-                tabWidget->setTabPinned(i,
-                                        tabInfoObj.value(QLatin1String("is_pinned")).toBool());
+void SessionManager::autosave()
+{
+    if (!m_autosaveNeeded || m_autosaver == nullptr)
+        return;
 
-                ww->setHibernation(tabInfoObj.value(QLatin1String("is_hibernating")).toBool());
+    const auto startupMode = static_cast<StartupMode>(m_settings->getValue(BrowserSetting::StartupMode).toInt());
+    if (startupMode != StartupMode::RestoreSession)
+        return;
 
-                ww->setWebState(std::move(webState));
+    m_windows.erase(std::remove_if(m_windows.begin(), m_windows.end(), [](const QPointer<MainWindow> &win) {
+        return win.isNull();
+    }), m_windows.end());
 
-                ++i;
-            }
-        }
+    // The last window is saved as it closes, so there is no session to save without a window
+    if (m_windows.empty())
+        return;
 
-        // Set current tab to the last active tab
-        int currentTab = winObject.value(QLatin1String("current_tab")).toInt();
-        tabWidget->setCurrentIndex(currentTab);
+    VIPER_TRACE_SCOPE("session", "SessionManager::autosave");
+
+    for (const QPointer<MainWindow> &win : m_windows)
+    {
+        m_autosaver->addWindow(getWindowState(win.data()));
+
+        BrowserTabWidget *tabWidget = win->getTabWidget();
+        for (int i = 0; i < tabWidget->count(); ++i)
+        {
+            WebWidget *ww = tabWidget->getWebWidget(i);
+            if (ww == nullptr)
+                continue;
+
+            if (!m_autosaver->addCachedTab(getTabId(ww)))
+                m_autosaver->addTab(getTabId(ww), getTabState(tabWidget, i, ww));
+        }
     }
+
+    m_autosaver->save();
+    m_autosaveNeeded = false;
+}
+
+void SessionManager::trackTab(WebWidget *webWidget)
+{
+    auto onChanged = [this, webWidget](){
+        onTabChanged(webWidget);
+    };
+    connect(webWidget, &WebWidget::urlChanged,       this, onChanged);
+    connect(webWidget, &WebWidget::titleChanged,     this, onChanged);
+    connect(webWidget, &WebWidget::iconChanged,      this, onChanged);
+    connect(webWidget, &WebWidget::loadFinished,     this, onChanged);
+    connect(webWidget, &WebWidget::aboutToHibernate, this, onChanged);
+    connect(webWidget, &WebWidget::aboutToWake,      this, onChanged);
+    connect(webWidget, &WebWidget::destroyed,        this, &SessionManager::onTabChanged);
+
+    m_autosaveNeeded = true;
+}
+
+void SessionManager::onSessionChanged()
+{
+    m_autosaveNeeded = true;
+}
+
+void SessionManager::onTabChanged(QObject *tab)
+{
+    if (m_autosaver != nullptr && tab != nullptr)
+        m_autosaver->invalidateTab(getTabId(tab));
+
+    m_autosaveNeeded = true;
+}
+
+QString SessionManager::getLegacySessionFile() const
+{
+    return QFileInfo(m_dataFile).dir().filePath(LegacySessionFileName);
 }
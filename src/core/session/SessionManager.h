@@ -1,29 +1,58 @@
 #ifndef SESSIONMANAGER_H
 #define SESSIONMANAGER_H
 
+#include <QElapsedTimer>
+#include <QObject>
+#include <QPointer>
 #include <QString>
+
+#include <memory>
 #include <vector>
 
 class BrowserApplication;
 class MainWindow;
+class SessionAutosaver;
+class Settings;
+class TabRestoreQueue;
+class WebWidget;
+
+class QTimer;
 
 /**
  * @class SessionManager
  * @brief Handles the serialization of active browsing sessions when the application is being closed, and the
  *        deserialization of a saved browsing session when the application is being initialized
+ *
+ * Sessions are stored in the binary format of \ref SessionWriter, and restored one tab at a time. When the
+ * session is restored lazily, only the active tab of each window is loaded right away, and the time it takes
+ * for the first window to become interactive is logged with the memory used by the browser at that point.
+ *
+ * While the browser is running, the session is also saved periodically by a \ref SessionAutosaver, so that
+ * it survives a crash. Only the windows and tabs that changed since the last save are collected again.
  */
-class SessionManager
+class SessionManager : public QObject
 {
+    Q_OBJECT
+
 public:
     /// Default constructor
     SessionManager();
 
+    /// Destructor
+    ~SessionManager();
+
     /// Returns true if the session has already been saved, false if else
     bool alreadySaved() const;
 
     /// Sets the path of the data file in which session information is stored
     void setSessionFile(const QString &fullPath);
 
+    /// Starts saving the session periodically, while the browser is set to restore the session on startup
+    void startAutosave(Settings *settings);
+
+    /// Tracks the changes made to the tabs of a window, so that they are saved by the next autosave
+    void trackWindow(MainWindow *window);
+
     /// Saves the state of each window in the container
     void saveState(std::vector<MainWindow*> &windows);
 
@@ -36,12 +65,61 @@ class SessionManager
      */
     void restoreSession(MainWindow *firstWindow, BrowserApplication *browserApplication);
 
+private Q_SLOTS:
+    /// Saves the windows and tabs that changed since the last autosave, if any
+    void autosave();
+
+    /// Tracks the changes made to a tab, so that they are saved by the next autosave
+    void trackTab(WebWidget *webWidget);
+
+    /// Called when the layout of the session changes, such as a tab being moved or activated
+    void onSessionChanged();
+
+private:
+    /// Called when the state of a tab changes, or when a tab is closed
+    void onTabChanged(QObject *tab);
+
+    /// Called once the active tab of the first restored window has loaded. Logs the restore time and
+    /// starts loading the remaining tabs in the background
+    void onSessionInteractive();
+
+    /// Returns the path of the JSON session file written by previous versions of the browser, which
+    /// is restored if there is no binary session yet
+    QString getLegacySessionFile() const;
+
 private:
     /// Path of the file in which session data is stored
     QString m_dataFile;
 
     /// True if session has already been saved, false if else
     bool m_savedSession;
+
+    /// Loads the tabs of the restored session in the background
+    std::unique_ptr<TabRestoreQueue> m_restoreQueue;
+
+    /// Measures the time since the session started being restored
+    QElapsedTimer m_restoreTimer;
+
+    /// Number of tabs in the restored session
+    int m_numRestoredTabs;
+
+    /// Number of tabs of the restored session that were loaded at startup
+    int m_numLoadedTabs;
+
+    /// Browser settings
+    Settings *m_settings;
+
+    /// Writes the periodic snapshots of the session
+    std::unique_ptr<SessionAutosaver> m_autosaver;
+
+    /// Triggers the periodic saves
+    QTimer *m_autosaveTimer;
+
+    /// True if the session changed since it was last saved
+    bool m_autosaveNeeded;
+
+    /// Windows whose tabs are part of the session, in the order they were opened
+    std::vector<QPointer<MainWindow>> m_windows;
 };
 
 #endif // SESSIONMANAGER_H
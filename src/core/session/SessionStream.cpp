@@ -0,0 +1,348 @@
+#include "SessionStream.h"
+#include "CommonUtil.h"
+
+#include <QBuffer>
+#include <QIODevice>
+#include <QImage>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonValue>
+#include <QPixmap>
+
+namespace
+{
+    /// Identifies a binary session file ("VSES")
+    constexpr quint32 SessionMagic = 0x56534553;
+
+    /// Version of the binary session format
+    constexpr quint16 SessionFormatVersion = 1;
+
+    /// Version of the QDataStream serialization used by the session format
+    constexpr QDataStream::Version StreamVersion = QDataStream::Qt_6_0;
+
+    /// Types of records in a binary session
+    enum RecordType : quint8
+    {
+        EndRecord    = 0,
+        IconRecord   = 1,
+        WindowRecord = 2,
+        TabRecord    = 3
+    };
+
+    /// Encodes an icon as a PNG image
+    QByteArray iconToPng(const QIcon &icon)
+    {
+        QByteArray data;
+        QBuffer buffer(&data);
+        icon.pixmap(32, 32).toImage().save(&buffer, "PNG");
+        return data;
+    }
+
+    /// Decodes an icon from a PNG image
+    QIcon iconFromPng(const QByteArray &data)
+    {
+        QImage image;
+        if (!image.loadFromData(data, "PNG"))
+            return QIcon();
+
+        return QIcon(QPixmap::fromImage(image));
+    }
+}
+
+SessionWriter::SessionWriter(QIODevice *device) :
+    m_stream(device),
+    m_iconIndices()
+{
+    m_stream.setVersion(StreamVersion);
+    m_stream << SessionMagic << SessionFormatVersion;
+}
+
+void SessionWriter::addWindow(const SessionWindow &window)
+{
+    addEncodedRecords(encodeWindow(window));
+}
+
+void SessionWriter::addTab(const SessionTab &tab)
+{
+    addEncodedRecords(encodeTab(tab, getIconIndex(tab)));
+}
+
+void SessionWriter::addEncodedRecords(const QByteArray &records)
+{
+    m_stream.writeRawData(records.constData(), static_cast<int>(records.size()));
+}
+
+bool SessionWriter::finish()
+{
+    addEncodedRecords(encodeRecord(EndRecord, QByteArray()));
+    return m_stream.status() == QDataStream::Ok;
+}
+
+QByteArray SessionWriter::encodeWindow(const SessionWindow &window)
+{
+    QByteArray payload;
+    QDataStream record(&payload, QIODevice::WriteOnly);
+    record.setVersion(StreamVersion);
+    record << window.Geometry << window.IsMaximized << static_cast<qint32>(window.CurrentTab);
+
+    return encodeRecord(WindowRecord, payload);
+}
+
+QByteArray SessionWriter::encodeTab(const SessionTab &tab, int32_t iconIndex)
+{
+    QByteArray payload;
+    QDataStream record(&payload, QIODevice::WriteOnly);
+    record.setVersion(StreamVersion);
+    record << tab.Url << tab.Title << tab.IconUrl << static_cast<qint32>(iconIndex) << tab.IsPinned << tab.IsHibernating << tab.History;
+
+    return encodeRecord(TabRecord, payload);
+}
+
+QByteArray SessionWriter::encodeIcon(int32_t iconIndex, const QIcon &icon)
+{
+    if (icon.isNull())
+        return QByteArray();
+
+    const QByteArray png = iconToPng(icon);
+    if (png.isEmpty())
+        return QByteArray();
+
+    QByteArray payload;
+    QDataStream record(&payload, QIODevice::WriteOnly);
+    record.setVersion(StreamVersion);
+    record << static_cast<qint32>(iconIndex) << png;
+
+    return encodeRecord(IconRecord, payload);
+}
+
+QByteArray SessionWriter::encodeRecord(uint8_t type, const QByteArray &payload)
+{
+    QByteArray data;
+    QDataStream record(&data, QIODevice::WriteOnly);
+    record.setVersion(StreamVersion);
+    record << static_cast<quint8>(type) << payload;
+    return data;
+}
+
+QString SessionWriter::getIconKey(const SessionTab &tab)
+{
+    // Pages of the same site share their favicon, so icons are identified by their URL when they have one
+    return tab.IconUrl.isEmpty() ? QString::number(tab.Icon.cacheKey()) : tab.IconUrl.toString();
+}
+
+int32_t SessionWriter::getIconIndex(const SessionTab &tab)
+{
+    if (tab.Icon.isNull())
+        return -1;
+
+    const QString key = getIconKey(tab);
+    auto it = m_iconIndices.find(key);
+    if (it != m_iconIndices.end())
+        return it.value();
+
+    const qint32 iconIndex = static_cast<qint32>(m_iconIndices.size());
+    const QByteArray iconRecord = encodeIcon(iconIndex, tab.Icon);
+    if (iconRecord.isEmpty())
+        return -1;
+
+    m_iconIndices.insert(key, iconIndex);
+    addEncodedRecords(iconRecord);
+    return iconIndex;
+}
+
+SessionReader::SessionReader(QIODevice *device) :
+    m_stream(device),
+    m_valid(false),
+    m_legacyFormat(false),
+    m_atEnd(true),
+    m_icons(),
+    m_legacyItems(),
+    m_window(),
+    m_tab()
+{
+    m_stream.setVersion(StreamVersion);
+
+    // Sessions saved by previous versions are JSON documents
+    if (device->peek(1).startsWith('{'))
+    {
+        m_legacyFormat = true;
+        loadLegacySession(device->readAll());
+        return;
+    }
+
+    quint32 magic = 0;
+    quint16 version = 0;
+    m_stream >> magic >> version;
+
+    m_valid = m_stream.status() == QDataStream::Ok && magic == SessionMagic && version == SessionFormatVersion;
+    m_atEnd = !m_valid;
+}
+
+bool SessionReader::isLegacyFormat() const
+{
+    return m_legacyFormat;
+}
+
+bool SessionReader::isValid() const
+{
+    return m_valid;
+}
+
+SessionReader::Item SessionReader::readNext()
+{
+    if (!m_legacyFormat)
+        return readNextRecord();
+
+    if (m_legacyItems.empty())
+        return Item::End;
+
+    LegacyItem &item = m_legacyItems.front();
+    const Item type = item.Type;
+    if (type == Item::Window)
+        m_window = std::move(item.Window);
+    else
+        m_tab = std::move(item.Tab);
+
+    m_legacyItems.pop_front();
+    return type;
+}
+
+const SessionWindow &SessionReader::getWindow() const
+{
+    return m_window;
+}
+
+const SessionTab &SessionReader::getTab() const
+{
+    return m_tab;
+}
+
+SessionReader::Item SessionReader::readNextRecord()
+{
+    while (!m_atEnd)
+    {
+        quint8 type = EndRecord;
+        QByteArray payload;
+        m_stream >> type >> payload;
+
+        // A truncated record ends the session
+        if (m_stream.status() != QDataStream::Ok)
+            break;
+
+        QDataStream record(payload);
+        record.setVersion(StreamVersion);
+
+        switch (type)
+        {
+            case EndRecord:
+                m_atEnd = true;
+                break;
+            case IconRecord:
+            {
+                qint32 iconIndex = -1;
+                QByteArray png;
+                record >> iconIndex >> png;
+                if (record.status() == QDataStream::Ok)
+                    m_icons[iconIndex] = iconFromPng(png);
+                break;
+            }
+            case WindowRecord:
+            {
+                SessionWindow window;
+                qint32 currentTab = 0;
+                record >> window.Geometry >> window.IsMaximized >> currentTab;
+                if (record.status() != QDataStream::Ok)
+                {
+                    m_atEnd = true;
+                    break;
+                }
+
+                window.CurrentTab = currentTab;
+                m_window = std::move(window);
+                return Item::Window;
+            }
+            case TabRecord:
+            {
+                SessionTab tab;
+                qint32 iconIndex = -1;
+                record >> tab.Url >> tab.Title >> tab.IconUrl >> iconIndex >> tab.IsPinned >> tab.IsHibernating >> tab.History;
+                if (record.status() != QDataStream::Ok)
+                {
+                    m_atEnd = true;
+                    break;
+                }
+
+                auto it = m_icons.find(iconIndex);
+                if (it != m_icons.end())
+                    tab.Icon = it->second;
+
+                m_tab = std::move(tab);
+                return Item::Tab;
+            }
+            default:
+                // Records added by newer versions of the format are skipped
+                break;
+        }
+    }
+
+    m_atEnd = true;
+    return Item::End;
+}
+
+void SessionReader::loadLegacySession(const QByteArray &data)
+{
+    const QJsonDocument sessionDoc(QJsonDocument::fromJson(data));
+    if (!sessionDoc.isObject())
+        return;
+
+    m_valid = true;
+
+    const QJsonArray winArray = sessionDoc.object().value(QLatin1String("windows")).toArray();
+    for (const QJsonValue &winValue : winArray)
+    {
+        const QJsonObject winObject = winValue.toObject();
+
+        LegacyItem windowItem { Item::Window, SessionWindow(), SessionTab() };
+        windowItem.Window.IsMaximized = winObject.value(QLatin1String("is_maximized")).toBool(false);
+        windowItem.Window.CurrentTab = winObject.value(QLatin1String("current_tab")).toInt();
+        if (winObject.contains(QLatin1String("geom_x")))
+        {
+            QRect &winGeom = windowItem.Window.Geometry;
+            winGeom.setX(winObject.value(QLatin1String("geom_x")).toInt());
+            winGeom.setY(winObject.value(QLatin1String("geom_y")).toInt());
+            winGeom.setWidth(winObject.value(QLatin1String("geom_width")).toInt(100));
+            winGeom.setHeight(winObject.value(QLatin1String("geom_height")).toInt(100));
+        }
+        m_legacyItems.push_back(std::move(windowItem));
+
+        const QJsonArray tabArray = winObject.value(QLatin1String("tabs")).toArray();
+        for (const QJsonValue &tabValue : tabArray)
+        {
+            LegacyItem tabItem { Item::Tab, SessionWindow(), SessionTab() };
+            SessionTab &tab = tabItem.Tab;
+
+            if (tabValue.isString())
+                tab.Url = QUrl::fromUserInput(tabValue.toString());
+            else if (tabValue.isObject())
+            {
+                const QJsonObject tabInfoObj = tabValue.toObject();
+                tab.Url = QUrl::fromUserInput(tabInfoObj.value(QLatin1String("url")).toString());
+                tab.Title = tabInfoObj.value(QLatin1String("title")).toString();
+                tab.IconUrl = QUrl::fromUserInput(tabInfoObj.value(QLatin1String("icon_url")).toString());
+                tab.IsPinned = tabInfoObj.value(QLatin1String("is_pinned")).toBool();
+                tab.IsHibernating = tabInfoObj.value(QLatin1String("is_hibernating")).toBool();
+
+                const QByteArray faviconData = tabInfoObj.value(QLatin1String("icon")).toString().toLatin1();
+                if (!faviconData.isEmpty())
+                    tab.Icon = CommonUtil::iconFromBase64(faviconData);
+
+                tab.History = QByteArray::fromBase64(tabInfoObj.value(QLatin1String("history")).toString().toLatin1());
+            }
+            else
+                continue;
+
+            m_legacyItems.push_back(std::move(tabItem));
+        }
+    }
+}
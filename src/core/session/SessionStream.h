@@ -0,0 +1,199 @@
+#ifndef SESSIONSTREAM_H
+#define SESSIONSTREAM_H
+
+#include <cstdint>
+#include <deque>
+#include <unordered_map>
+
+#include <QByteArray>
+#include <QDataStream>
+#include <QHash>
+#include <QIcon>
+#include <QRect>
+#include <QString>
+#include <QUrl>
+
+class QIODevice;
+
+/// State of a tab in a saved browsing session
+struct SessionTab
+{
+    /// URL of the page
+    QUrl Url;
+
+    /// Title of the page
+    QString Title;
+
+    /// URL of the page's favicon
+    QUrl IconUrl;
+
+    /// Favicon of the page. May be null
+    QIcon Icon;
+
+    /// Serialized history of the page
+    QByteArray History;
+
+    /// True if the tab is pinned
+    bool IsPinned { false };
+
+    /// True if the tab is hibernating
+    bool IsHibernating { false };
+};
+
+/// State of a window in a saved browsing session, excluding its tabs
+struct SessionWindow
+{
+    /// Geometry of the window, when it is not maximized. May be invalid
+    QRect Geometry;
+
+    /// True if the window is maximized
+    bool IsMaximized { false };
+
+    /// Index of the active tab
+    int CurrentTab { 0 };
+};
+
+/**
+ * @class SessionWriter
+ * @brief Writes a browsing session to a device in the binary session format, one record at a time
+ *
+ * The file starts with a magic number and a format version, followed by a sequence of records. Each
+ * record is made of a type, the size of its payload and the payload itself, so that readers can skip
+ * records they do not know about. A window record is followed by the records of its tabs. Favicons are
+ * written once, in an icon record that precedes the first tab using them, and tabs refer to them by index.
+ */
+class SessionWriter
+{
+public:
+    /// Starts writing a session to the given device, which must already be open for writing
+    explicit SessionWriter(QIODevice *device);
+
+    /// Writes a window record. Tabs written afterwards belong to this window
+    void addWindow(const SessionWindow &window);
+
+    /// Writes a tab record, preceded by the record of its favicon if it has not been written yet
+    void addTab(const SessionTab &tab);
+
+    /// Writes records that were encoded with \ref encodeWindow, \ref encodeTab or \ref encodeIcon
+    void addEncodedRecords(const QByteArray &records);
+
+    /// Writes the end of session record. Returns true if every record was written successfully
+    bool finish();
+
+    /// Returns the encoded record of a window
+    static QByteArray encodeWindow(const SessionWindow &window);
+
+    /// Returns the encoded record of a tab, which refers to its favicon by the given index, or -1 if it has none
+    static QByteArray encodeTab(const SessionTab &tab, int32_t iconIndex);
+
+    /// Returns the encoded record of the given favicon, or an empty array if the icon is null. The record
+    /// must be written before the records of the tabs that refer to it
+    static QByteArray encodeIcon(int32_t iconIndex, const QIcon &icon);
+
+    /// Returns the key that identifies the favicon of a tab, so that tabs sharing a favicon refer to the same icon record
+    static QString getIconKey(const SessionTab &tab);
+
+private:
+    /// Returns a record of the given type, encoded with the given payload
+    static QByteArray encodeRecord(uint8_t type, const QByteArray &payload);
+
+    /// Returns the index of the tab's icon, writing an icon record if needed, or -1 if the tab has no icon
+    int32_t getIconIndex(const SessionTab &tab);
+
+private:
+    /// Output stream
+    QDataStream m_stream;
+
+    /// Index of each icon that has already been written, by its URL or cache key
+    QHash<QString, int32_t> m_iconIndices;
+};
+
+/**
+ * @class SessionReader
+ * @brief Reads a browsing session one window or tab at a time, from either the binary session
+ *        format or the JSON format used by previous versions of the browser
+ *
+ * Binary sessions are read record by record. A truncated session yields every record that was
+ * completely written, and then ends.
+ */
+class SessionReader
+{
+public:
+    /// Type of the item returned by \ref readNext
+    enum class Item
+    {
+        /// The start of a window, available through \ref getWindow
+        Window,
+
+        /// A tab of the current window, available through \ref getTab
+        Tab,
+
+        /// The end of the session, or the first malformed record
+        End
+    };
+
+    /// Starts reading a session from the given device, which must already be open for reading
+    explicit SessionReader(QIODevice *device);
+
+    /// Returns true if the session was saved in the JSON format of previous versions
+    bool isLegacyFormat() const;
+
+    /// Returns true if the device contains a session in a known format and version
+    bool isValid() const;
+
+    /// Reads the next window or tab of the session
+    Item readNext();
+
+    /// Returns the window that was last read
+    const SessionWindow &getWindow() const;
+
+    /// Returns the tab that was last read
+    const SessionTab &getTab() const;
+
+private:
+    /// Reads the next item from a binary session
+    Item readNextRecord();
+
+    /// Converts a session in the JSON format into a queue of windows and tabs
+    void loadLegacySession(const QByteArray &data);
+
+private:
+    /// Item read from a session in the JSON format
+    struct LegacyItem
+    {
+        /// Type of the item
+        Item Type;
+
+        /// Window state, if this is a window
+        SessionWindow Window;
+
+        /// Tab state, if this is a tab
+        SessionTab Tab;
+    };
+
+    /// Input stream
+    QDataStream m_stream;
+
+    /// True if the header of the session was recognized
+    bool m_valid;
+
+    /// True if the session was saved in the JSON format
+    bool m_legacyFormat;
+
+    /// True once the end of a binary session, or a malformed record, has been reached
+    bool m_atEnd;
+
+    /// Icons that have been read, by their index
+    std::unordered_map<int32_t, QIcon> m_icons;
+
+    /// Windows and tabs of a session in the JSON format, in the order they are to be returned
+    std::deque<LegacyItem> m_legacyItems;
+
+    /// Window that was last read
+    SessionWindow m_window;
+
+    /// Tab that was last read
+    SessionTab m_tab;
+};
+
+#endif // SESSIONSTREAM_H
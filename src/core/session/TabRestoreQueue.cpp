@@ -0,0 +1,121 @@
+#include "TabRestoreQueue.h"
+
+#include <algorithm>
+
+TabRestoreQueue::TabRestoreQueue(int maxConcurrentLoads, QObject *parent) :
+    QObject(parent),
+    m_maxConcurrentLoads(std::max(maxConcurrentLoads, 0)),
+    m_started(false),
+    m_loadedAny(false),
+    m_finished(false),
+    m_pending(),
+    m_loading()
+{
+}
+
+void TabRestoreQueue::enqueue(QObject *tab, std::function<void()> &&load)
+{
+    if (tab == nullptr)
+        return;
+
+    connect(tab, &QObject::destroyed, this, &TabRestoreQueue::onTabDestroyed, Qt::UniqueConnection);
+    m_pending.push_back(PendingTab { QPointer<QObject>(tab), std::move(load) });
+
+    if (m_started)
+        loadNext();
+}
+
+void TabRestoreQueue::remove(QObject *tab)
+{
+    auto it = std::find_if(m_pending.begin(), m_pending.end(), [tab](const PendingTab &pendingTab) {
+        return pendingTab.Tab == tab;
+    });
+    if (it == m_pending.end())
+        return;
+
+    m_pending.erase(it);
+    disconnect(tab, &QObject::destroyed, this, &TabRestoreQueue::onTabDestroyed);
+
+    checkFinished();
+}
+
+void TabRestoreQueue::start()
+{
+    if (m_started)
+        return;
+
+    m_started = true;
+    loadNext();
+}
+
+bool TabRestoreQueue::isEmpty() const
+{
+    return m_pending.empty() && m_loading.empty();
+}
+
+int TabRestoreQueue::getNumPending() const
+{
+    return static_cast<int>(m_pending.size());
+}
+
+int TabRestoreQueue::getNumLoading() const
+{
+    return static_cast<int>(m_loading.size());
+}
+
+void TabRestoreQueue::onLoadFinished(QObject *tab)
+{
+    auto it = std::find(m_loading.begin(), m_loading.end(), tab);
+    if (it == m_loading.end())
+        return;
+
+    m_loading.erase(it);
+    disconnect(tab, &QObject::destroyed, this, &TabRestoreQueue::onTabDestroyed);
+
+    loadNext();
+}
+
+void TabRestoreQueue::onTabDestroyed(QObject *tab)
+{
+    // The QPointer of a pending tab has already been cleared when this is called
+    m_pending.erase(std::remove_if(m_pending.begin(), m_pending.end(), [](const PendingTab &pendingTab) {
+        return pendingTab.Tab.isNull();
+    }), m_pending.end());
+
+    m_loading.erase(std::remove(m_loading.begin(), m_loading.end(), tab), m_loading.end());
+
+    if (m_started)
+        loadNext();
+}
+
+void TabRestoreQueue::loadNext()
+{
+    if (!m_started)
+        return;
+
+    while (!m_pending.empty() && static_cast<int>(m_loading.size()) < m_maxConcurrentLoads)
+    {
+        PendingTab pendingTab = std::move(m_pending.front());
+        m_pending.pop_front();
+
+        if (pendingTab.Tab.isNull())
+            continue;
+
+        m_loading.push_back(pendingTab.Tab.data());
+        m_loadedAny = true;
+        pendingTab.Load();
+    }
+
+    checkFinished();
+}
+
+void TabRestoreQueue::checkFinished()
+{
+    // With no background loads allowed, the remaining tabs are only loaded when they are activated. A queue that
+    // never started a load has nothing to report
+    if (!m_started || !m_loadedAny || m_finished || !m_loading.empty() || (!m_pending.empty() && m_maxConcurrentLoads > 0))
+        return;
+
+    m_finished = true;
+    emit finished();
+}
@@ -0,0 +1,95 @@
+#ifndef TABRESTOREQUEUE_H
+#define TABRESTOREQUEUE_H
+
+#include <deque>
+#include <functional>
+#include <vector>
+
+#include <QObject>
+#include <QPointer>
+
+/**
+ * @class TabRestoreQueue
+ * @brief Loads the tabs of a restored session in the background, a limited number at a time
+ *
+ * Tabs are loaded in the order they were queued. A tab counts against the limit from the moment its load
+ * is started until \ref onLoadFinished is called for it, or until it is destroyed. Tabs that are loaded by
+ * other means, such as the user activating them, should be removed from the queue with \ref remove.
+ */
+class TabRestoreQueue : public QObject
+{
+    Q_OBJECT
+
+public:
+    /// Constructs the queue, which loads up to the given number of tabs at the same time once it is started
+    explicit TabRestoreQueue(int maxConcurrentLoads, QObject *parent = nullptr);
+
+    /// Adds a tab to the queue, with the function that starts loading it
+    void enqueue(QObject *tab, std::function<void()> &&load);
+
+    /// Removes a tab from the queue, if its load has not started yet
+    void remove(QObject *tab);
+
+    /// Starts loading the queued tabs
+    void start();
+
+    /// Returns true if there are no tabs waiting to be loaded, or being loaded
+    bool isEmpty() const;
+
+    /// Returns the number of tabs waiting for their load to start
+    int getNumPending() const;
+
+    /// Returns the number of tabs being loaded
+    int getNumLoading() const;
+
+Q_SIGNALS:
+    /// Emitted once, when every queued tab has been loaded or removed from the queue after the queue was started.
+    /// Not emitted if the queue never started loading a tab
+    void finished();
+
+public Q_SLOTS:
+    /// Called when a tab has finished loading, successfully or not, freeing its place for the next tab
+    void onLoadFinished(QObject *tab);
+
+private Q_SLOTS:
+    /// Forgets about a tab that has been destroyed
+    void onTabDestroyed(QObject *tab);
+
+private:
+    /// Starts loading tabs until the limit is reached or the queue is empty
+    void loadNext();
+
+    /// Emits the \ref finished signal if there is nothing left for the queue to load
+    void checkFinished();
+
+private:
+    /// A tab waiting to be loaded
+    struct PendingTab
+    {
+        /// The tab
+        QPointer<QObject> Tab;
+
+        /// Starts loading the tab
+        std::function<void()> Load;
+    };
+
+    /// Maximum number of tabs that can be loaded at the same time
+    const int m_maxConcurrentLoads;
+
+    /// True once the queue has been started
+    bool m_started;
+
+    /// True once the queue has started loading a tab
+    bool m_loadedAny;
+
+    /// True once the \ref finished signal has been emitted
+    bool m_finished;
+
+    /// Tabs waiting to be loaded, in the order they are to be loaded
+    std::deque<PendingTab> m_pending;
+
+    /// Tabs being loaded
+    std::vector<QObject*> m_loading;
+};
+
+#endif // TABRESTOREQUEUE_H
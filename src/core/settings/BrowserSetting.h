@@ -130,6 +130,37 @@ enum class BrowserSetting
     /// Determines whether or not all new tabs should be opened in the background, without switching from the current tab
     OpenAllTabsInBackground,
 
+    /// Determines whether only the active tab of each window is loaded when a session is restored, the other tabs
+    /// being loaded when they are first activated
+    LazySessionRestore,
+
+    /// Number of tabs of a restored session that can be loaded in the background at the same time, when the session
+    /// is restored lazily. Tabs are only loaded when activated if this is zero
+    SessionRestoreLoadLimit,
+
+    /// Determines whether background tabs are hibernated automatically, to save memory
+    AutoHibernateTabs,
+
+    /// Number of minutes after which a background tab that has not been selected is hibernated, or zero to
+    /// keep inactive tabs awake
+    TabHibernationIdleTime,
+
+    /// Maximum number of tabs that are kept awake before the least recently used tabs are hibernated, or zero
+    /// for no limit
+    TabHibernationBudget,
+
+    /// Percentage of the system memory below which the available memory is low enough for background tabs to be
+    /// hibernated, or zero to ignore the system memory
+    TabHibernationMemoryThreshold,
+
+    /// Determines whether a connection is opened to the site the user is most likely typing into the URL bar,
+    /// before the input is submitted
+    EnableSpeculativeConnections,
+
+    /// Determines whether the site the user is most likely typing into the URL bar is loaded in the background,
+    /// before the input is submitted
+    EnableSpeculativePrerender,
+
     /// Standard font
     StandardFont,
 
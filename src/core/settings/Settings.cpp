@@ -2,46 +2,135 @@
 
 #include "HistoryManager.h"
 
+#include <utility>
+#include <vector>
+
+#include <QDebug>
 #include <QDir>
 #include <QFileInfo>
+#include <QMetaType>
+#include <QTimer>
 #include <QWebEngineSettings>
 #include <QtWebEngineCoreVersion>
 
-const QString Settings::Version = QStringLiteral("1.0");
+const QString Settings::Version = QStringLiteral("1.4");
+
+namespace
+{
+    /// Name and type of a setting in the settings store
+    struct SettingDescriptor
+    {
+        /// The setting
+        BrowserSetting Setting;
+
+        /// Key of the setting in the settings store
+        const char *Key;
+
+        /// Type that the value of the setting is stored as in memory
+        QMetaType::Type Type;
+    };
+
+    /// Descriptors of every setting, in the order of the \ref BrowserSetting enum
+    const SettingDescriptor SettingDescriptors[] = {
+        { BrowserSetting::StoragePath,                "StoragePath",                QMetaType::QString },
+        { BrowserSetting::CachePath,                  "CachePath",                  QMetaType::QString },
+        { BrowserSetting::BookmarkPath,               "BookmarkPath",               QMetaType::QString },
+        { BrowserSetting::ExtensionStoragePath,       "ExtStoragePath",             QMetaType::QString },
+        { BrowserSetting::HistoryPath,                "HistoryPath",                QMetaType::QString },
+        { BrowserSetting::FaviconPath,                "FaviconPath",                QMetaType::QString },
+        { BrowserSetting::FavoritePagesFile,          "FavoritePagesFile",          QMetaType::QString },
+        { BrowserSetting::ThumbnailPath,              "ThumbnailPath",              QMetaType::QString },
+        { BrowserSetting::SearchEnginesFile,          "SearchEnginesFile",          QMetaType::QString },
+        { BrowserSetting::SessionFile,                "SessionFile",                QMetaType::QString },
+        { BrowserSetting::UserAgentsFile,             "UserAgentsFile",             QMetaType::QString },
+        { BrowserSetting::UserScriptsConfig,          "UserScriptsConfig",          QMetaType::QString },
+        { BrowserSetting::UserScriptsDir,             "UserScriptsDir",             QMetaType::QString },
+        { BrowserSetting::AdBlockPlusConfig,          "AdBlockPlusConfig",          QMetaType::QString },
+        { BrowserSetting::AdBlockPlusDataDir,         "AdBlockPlusDataDir",         QMetaType::QString },
+        { BrowserSetting::ExemptThirdPartyCookieFile, "ExemptThirdPartyCookieFile", QMetaType::QString },
+        { BrowserSetting::HomePage,                   "HomePage",                   QMetaType::QString },
+        { BrowserSetting::StartupMode,                "StartupMode",                QMetaType::Int },
+        { BrowserSetting::NewTabPage,                 "NewTabPage",                 QMetaType::Int },
+        { BrowserSetting::DownloadDir,                "DownloadDir",                QMetaType::QString },
+        { BrowserSetting::AskWhereToSaveDownloads,    "AskWhereToSaveDownloads",    QMetaType::Bool },
+        { BrowserSetting::SendDoNotTrack,             "SendDoNotTrack",             QMetaType::Bool },
+        { BrowserSetting::EnableAutoFill,             "EnableAutoFill",             QMetaType::Bool },
+        { BrowserSetting::EnableJavascript,           "EnableJavascript",           QMetaType::Bool },
+        { BrowserSetting::EnableJavascriptPopups,     "EnableJavascriptPopups",     QMetaType::Bool },
+        { BrowserSetting::AutoLoadImages,             "AutoLoadImages",             QMetaType::Bool },
+        { BrowserSetting::EnablePlugins,              "EnablePlugins",              QMetaType::Bool },
+        { BrowserSetting::EnableCookies,              "EnableCookies",              QMetaType::Bool },
+        { BrowserSetting::EnableThirdPartyCookies,    "EnableThirdPartyCookies",    QMetaType::Bool },
+        { BrowserSetting::CookiesDeleteWithSession,   "CookiesDeleteWithSession",   QMetaType::Bool },
+        { BrowserSetting::EnableXSSAudit,             "EnableXSSAudit",             QMetaType::Bool },
+        { BrowserSetting::EnableBookmarkBar,          "EnableBookmarkBar",          QMetaType::Bool },
+        { BrowserSetting::CustomUserAgent,            "CustomUserAgent",            QMetaType::Bool },
+        { BrowserSetting::UserScriptsEnabled,         "UserScriptsEnabled",         QMetaType::Bool },
+        { BrowserSetting::AdBlockPlusEnabled,         "AdBlockPlusEnabled",         QMetaType::Bool },
+        { BrowserSetting::InspectorPort,              "InspectorPort",              QMetaType::Int },
+        { BrowserSetting::HistoryStoragePolicy,       "HistoryStoragePolicy",       QMetaType::Int },
+        { BrowserSetting::ScrollAnimatorEnabled,      "ScrollAnimatorEnabled",      QMetaType::Bool },
+        { BrowserSetting::OpenAllTabsInBackground,    "OpenAllTabsInBackground",    QMetaType::Bool },
+        { BrowserSetting::LazySessionRestore,         "LazySessionRestore",         QMetaType::Bool },
+        { BrowserSetting::SessionRestoreLoadLimit,    "SessionRestoreLoadLimit",    QMetaType::Int },
+        { BrowserSetting::AutoHibernateTabs,          "AutoHibernateTabs",          QMetaType::Bool },
+        { BrowserSetting::TabHibernationIdleTime,     "TabHibernationIdleTime",     QMetaType::Int },
+        { BrowserSetting::TabHibernationBudget,       "TabHibernationBudget",       QMetaType::Int },
+        { BrowserSetting::TabHibernationMemoryThreshold, "TabHibernationMemoryThreshold", QMetaType::Int },
+        { BrowserSetting::EnableSpeculativeConnections, "EnableSpeculativeConnections", QMetaType::Bool },
+        { BrowserSetting::EnableSpeculativePrerender, "EnableSpeculativePrerender", QMetaType::Bool },
+        { BrowserSetting::StandardFont,               "StandardFont",               QMetaType::QString },
+        { BrowserSetting::SerifFont,                  "SerifFont",                  QMetaType::QString },
+        { BrowserSetting::SansSerifFont,              "SansSerifFont",              QMetaType::QString },
+        { BrowserSetting::CursiveFont,                "CursiveFont",                QMetaType::QString },
+        { BrowserSetting::FantasyFont,                "FantasyFont",                QMetaType::QString },
+        { BrowserSetting::FixedFont,                  "FixedFont",                  QMetaType::QString },
+        { BrowserSetting::StandardFontSize,           "StandardFontSize",           QMetaType::Int },
+        { BrowserSetting::FixedFontSize,              "FixedFontSize",              QMetaType::Int },
+        { BrowserSetting::Version,                    "Version",                    QMetaType::QString }
+    };
+
+    /// Delay between the first unsaved change and the write of every pending change, in milliseconds
+    constexpr int FlushDelay = 1000;
+
+    /// Converts a value to the type of the given setting, if possible. Invalid values are left as-is,
+    /// so that a missing setting can still be told apart from a stored one
+    QVariant toSettingType(const SettingDescriptor &descriptor, const QVariant &value)
+    {
+        const QMetaType type(descriptor.Type);
+        if (!value.isValid() || value.metaType() == type)
+            return value;
+
+        QVariant converted = value;
+        if (converted.convert(type))
+            return converted;
+
+        return value;
+    }
+}
 
 Settings::Settings(QWebEngineSettings *webSettings) :
+    Settings(webSettings, QSettings().fileName(), QSettings::defaultFormat())
+{
+}
+
+Settings::Settings(QWebEngineSettings *webSettings, const QString &fileName, QSettings::Format format) :
     QObject(nullptr),
     m_firstRun(false),
-    m_settings(),
+    m_settings(fileName, format),
     m_storagePath(),
-    m_settingMap {
-        { BrowserSetting::StoragePath, QStringLiteral("StoragePath") },                { BrowserSetting::BookmarkPath, QStringLiteral("BookmarkPath") },
-        { BrowserSetting::ExtensionStoragePath, QStringLiteral("ExtStoragePath") },    { BrowserSetting::HistoryPath, QStringLiteral("HistoryPath") },
-        { BrowserSetting::FaviconPath, QStringLiteral("FaviconPath") },                { BrowserSetting::SearchEnginesFile, QStringLiteral("SearchEnginesFile") },
-        { BrowserSetting::SessionFile, QStringLiteral("SessionFile") },                { BrowserSetting::UserAgentsFile, QStringLiteral("UserAgentsFile") },
-        { BrowserSetting::UserScriptsConfig, QStringLiteral("UserScriptsConfig") },    { BrowserSetting::UserScriptsDir, QStringLiteral("UserScriptsDir") },
-        { BrowserSetting::AdBlockPlusConfig, QStringLiteral("AdBlockPlusConfig") },    { BrowserSetting::ExemptThirdPartyCookieFile, QStringLiteral("ExemptThirdPartyCookieFile") },
-        { BrowserSetting::AdBlockPlusDataDir, QStringLiteral("AdBlockPlusDataDir") },  { BrowserSetting::FixedFontSize, QStringLiteral("FixedFontSize") },
-        { BrowserSetting::HomePage, QStringLiteral("HomePage") },                      { BrowserSetting::StartupMode, QStringLiteral("StartupMode") },
-        { BrowserSetting::NewTabPage, QStringLiteral("NewTabPage") },                  { BrowserSetting::DownloadDir, QStringLiteral("DownloadDir") },
-        { BrowserSetting::SendDoNotTrack, QStringLiteral("SendDoNotTrack") },          { BrowserSetting::AskWhereToSaveDownloads, QStringLiteral("AskWhereToSaveDownloads") },
-        { BrowserSetting::EnableJavascript, QStringLiteral("EnableJavascript") },      { BrowserSetting::EnableJavascriptPopups, QStringLiteral("EnableJavascriptPopups") },
-        { BrowserSetting::AutoLoadImages, QStringLiteral("AutoLoadImages") },          { BrowserSetting::EnablePlugins, QStringLiteral("EnablePlugins") },
-        { BrowserSetting::EnableCookies, QStringLiteral("EnableCookies") },            { BrowserSetting::EnableThirdPartyCookies, QStringLiteral("EnableThirdPartyCookies") },
-        { BrowserSetting::EnableXSSAudit, QStringLiteral("EnableXSSAudit") },          { BrowserSetting::CookiesDeleteWithSession, QStringLiteral("CookiesDeleteWithSession") },
-        { BrowserSetting::EnableBookmarkBar, QStringLiteral("EnableBookmarkBar") },    { BrowserSetting::CustomUserAgent, QStringLiteral("CustomUserAgent") },
-        { BrowserSetting::UserScriptsEnabled, QStringLiteral("UserScriptsEnabled") },  { BrowserSetting::AdBlockPlusEnabled, QStringLiteral("AdBlockPlusEnabled") },
-        { BrowserSetting::InspectorPort, QStringLiteral("InspectorPort") },            { BrowserSetting::HistoryStoragePolicy, QStringLiteral("HistoryStoragePolicy") },
-        { BrowserSetting::StandardFont, QStringLiteral("StandardFont") },              { BrowserSetting::ScrollAnimatorEnabled, QStringLiteral("ScrollAnimatorEnabled") },
-        { BrowserSetting::SerifFont, QStringLiteral("SerifFont") },                    { BrowserSetting::OpenAllTabsInBackground, QStringLiteral("OpenAllTabsInBackground") },
-        { BrowserSetting::SansSerifFont, QStringLiteral("SansSerifFont") },            { BrowserSetting::CursiveFont, QStringLiteral("CursiveFont") },
-        { BrowserSetting::FantasyFont, QStringLiteral("FantasyFont") },                { BrowserSetting::FixedFont, QStringLiteral("FixedFont") },
-        { BrowserSetting::StandardFontSize, QStringLiteral("StandardFontSize") },      { BrowserSetting::EnableAutoFill, QStringLiteral("EnableAutoFill") },
-        { BrowserSetting::CachePath, QStringLiteral("CachePath") },                    { BrowserSetting::ThumbnailPath, QStringLiteral("ThumbnailPath") },
-        { BrowserSetting::FavoritePagesFile, QStringLiteral("FavoritePagesFile") },    { BrowserSetting::Version, QStringLiteral("Version") }
-    },
+    m_values(),
+    m_pendingWrites(),
+    m_flushScheduled(false),
+    m_mutex(),
+    m_flushTimer(new QTimer(this)),
+    m_writerPool(),
     m_webSettings(webSettings)
 {
+    static_assert(sizeof(SettingDescriptors) / sizeof(SettingDescriptor) == NumSettings, "Every setting must have a descriptor");
+    for (std::size_t i = 0; i < NumSettings; ++i)
+        Q_ASSERT(SettingDescriptors[i].Setting == static_cast<BrowserSetting>(i));
+
     setObjectName(QStringLiteral("Settings"));
 
     // Check if defaults need to be set
@@ -52,25 +141,63 @@ Settings::Settings(QWebEngineSettings *webSettings) :
     if (m_settings.value(QStringLiteral("Version")).toString().compare(Version) != 0)
         updateSettings();
 
-    m_storagePath = m_settings.value(QStringLiteral("StoragePath")).toString();
+    m_settings.sync();
+    loadValues();
+
+    m_storagePath = m_values[static_cast<std::size_t>(BrowserSetting::StoragePath)].toString();
+
+    // Writes are stored on a single thread, so that batches are applied in the order they were flushed
+    m_writerPool.setMaxThreadCount(1);
+
+    m_flushTimer->setSingleShot(true);
+    m_flushTimer->setInterval(FlushDelay);
+    connect(m_flushTimer, &QTimer::timeout, this, &Settings::flush);
+}
+
+Settings::~Settings()
+{
+    sync();
 }
 
 QString Settings::getPathValue(BrowserSetting key)
 {
-    return m_storagePath + m_settings.value(m_settingMap.value(key, QStringLiteral("unknown"))).toString();
+    return m_storagePath + getValue(key).toString();
 }
 
 QVariant Settings::getValue(BrowserSetting key)
 {
-    return m_settings.value(m_settingMap.value(key, QStringLiteral("unknown")));
+    const std::size_t index = static_cast<std::size_t>(key);
+    if (index >= NumSettings)
+        return QVariant();
+
+    std::lock_guard<std::mutex> lock{m_mutex};
+    return m_values[index];
 }
 
 void Settings::setValue(BrowserSetting key, const QVariant &value)
 {
-    if (getValue(key) == value)
+    const std::size_t index = static_cast<std::size_t>(key);
+    if (index >= NumSettings)
         return;
 
-    m_settings.setValue(m_settingMap.value(key, QStringLiteral("unknown")), value);
+    const QVariant typedValue = toSettingType(SettingDescriptors[index], value);
+
+    bool scheduleFlush = false;
+    {
+        std::lock_guard<std::mutex> lock{m_mutex};
+        if (m_values[index] == typedValue)
+            return;
+
+        m_values[index] = typedValue;
+        m_pendingWrites.set(index);
+
+        scheduleFlush = !m_flushScheduled;
+        m_flushScheduled = true;
+    }
+
+    // The timer belongs to the thread of the settings, which may not be the calling thread
+    if (scheduleFlush)
+        QMetaObject::invokeMethod(m_flushTimer, qOverload<>(&QTimer::start));
 
     emit settingChanged(key, value);
 }
@@ -80,6 +207,44 @@ bool Settings::firstRun() const
     return m_firstRun;
 }
 
+void Settings::flush()
+{
+    std::vector<std::pair<QString, QVariant>> batch;
+    {
+        std::lock_guard<std::mutex> lock{m_mutex};
+        m_flushScheduled = false;
+
+        if (m_pendingWrites.none())
+            return;
+
+        for (std::size_t i = 0; i < NumSettings; ++i)
+        {
+            if (m_pendingWrites.test(i))
+                batch.emplace_back(QLatin1String(SettingDescriptors[i].Key), m_values[i]);
+        }
+        m_pendingWrites.reset();
+    }
+
+    const QString fileName = m_settings.fileName();
+    const QSettings::Format format = m_settings.format();
+    m_writerPool.start([fileName, format, batch = std::move(batch)](){
+        QSettings settings(fileName, format);
+        for (const std::pair<QString, QVariant> &change : batch)
+            settings.setValue(change.first, change.second);
+
+        settings.sync();
+        if (settings.status() != QSettings::NoError)
+            qWarning() << "Settings - could not write changes to" << fileName;
+    });
+}
+
+void Settings::sync()
+{
+    m_flushTimer->stop();
+    flush();
+    m_writerPool.waitForDone();
+}
+
 void Settings::setDefaults()
 {
     m_firstRun = true;
@@ -110,7 +275,7 @@ void Settings::setDefaults()
     m_settings.setValue(QStringLiteral("ThumbnailPath"), QStringLiteral("web_thumbnails.db"));
     m_settings.setValue(QStringLiteral("UserAgentsFile"),  QStringLiteral("user_agents.json"));
     m_settings.setValue(QStringLiteral("SearchEnginesFile"), QStringLiteral("search_engines.json"));
-    m_settings.setValue(QStringLiteral("SessionFile"), QStringLiteral("last_session.json"));
+    m_settings.setValue(QStringLiteral("SessionFile"), QStringLiteral("last_session.dat"));
     m_settings.setValue(QStringLiteral("UserScriptsDir"), QStringLiteral("UserScripts"));
     m_settings.setValue(QStringLiteral("UserScriptsConfig"), QStringLiteral("user_scripts.json"));
     m_settings.setValue(QStringLiteral("AdBlockPlusConfig"), QStringLiteral("adblock_plus.json"));
@@ -138,16 +303,27 @@ void Settings::setDefaults()
     m_settings.setValue(QStringLiteral("HistoryStoragePolicy"), static_cast<int>(HistoryStoragePolicy::Remember));
     m_settings.setValue(QStringLiteral("ScrollAnimatorEnabled"), false);
     m_settings.setValue(QStringLiteral("OpenAllTabsInBackground"), false);
+    m_settings.setValue(QStringLiteral("LazySessionRestore"), true);
+    m_settings.setValue(QStringLiteral("SessionRestoreLoadLimit"), 0);
+    m_settings.setValue(QStringLiteral("AutoHibernateTabs"), true);
+    m_settings.setValue(QStringLiteral("TabHibernationIdleTime"), 60);
+    m_settings.setValue(QStringLiteral("TabHibernationBudget"), 0);
+    m_settings.setValue(QStringLiteral("TabHibernationMemoryThreshold"), 10);
+    m_settings.setValue(QStringLiteral("EnableSpeculativeConnections"), true);
+    m_settings.setValue(QStringLiteral("EnableSpeculativePrerender"), false);
 
-    m_settings.setValue(QStringLiteral("StandardFont"), m_webSettings->fontFamily(QWebEngineSettings::StandardFont));
-    m_settings.setValue(QStringLiteral("SerifFont"), m_webSettings->fontFamily(QWebEngineSettings::SerifFont));
-    m_settings.setValue(QStringLiteral("SansSerifFont"), m_webSettings->fontFamily(QWebEngineSettings::SansSerifFont));
-    m_settings.setValue(QStringLiteral("CursiveFont"), m_webSettings->fontFamily(QWebEngineSettings::CursiveFont));
-    m_settings.setValue(QStringLiteral("FantasyFont"), m_webSettings->fontFamily(QWebEngineSettings::FantasyFont));
-    m_settings.setValue(QStringLiteral("FixedFont"), m_webSettings->fontFamily(QWebEngineSettings::FixedFont));
+    if (m_webSettings != nullptr)
+    {
+        m_settings.setValue(QStringLiteral("StandardFont"), m_webSettings->fontFamily(QWebEngineSettings::StandardFont));
+        m_settings.setValue(QStringLiteral("SerifFont"), m_webSettings->fontFamily(QWebEngineSettings::SerifFont));
+        m_settings.setValue(QStringLiteral("SansSerifFont"), m_webSettings->fontFamily(QWebEngineSettings::SansSerifFont));
+        m_settings.setValue(QStringLiteral("CursiveFont"), m_webSettings->fontFamily(QWebEngineSettings::CursiveFont));
+        m_settings.setValue(QStringLiteral("FantasyFont"), m_webSettings->fontFamily(QWebEngineSettings::FantasyFont));
+        m_settings.setValue(QStringLiteral("FixedFont"), m_webSettings->fontFamily(QWebEngineSettings::FixedFont));
 
-    m_settings.setValue(QStringLiteral("StandardFontSize"), m_webSettings->fontSize(QWebEngineSettings::DefaultFontSize));
-    m_settings.setValue(QStringLiteral("FixedFontSize"), m_webSettings->fontSize(QWebEngineSettings::DefaultFixedFontSize));
+        m_settings.setValue(QStringLiteral("StandardFontSize"), m_webSettings->fontSize(QWebEngineSettings::DefaultFontSize));
+        m_settings.setValue(QStringLiteral("FixedFontSize"), m_webSettings->fontSize(QWebEngineSettings::DefaultFixedFontSize));
+    }
 
     m_settings.setValue(QStringLiteral("Version"), Version);
 }
@@ -172,6 +348,38 @@ void Settings::updateSettings()
         m_settings.setValue(QStringLiteral("NewTabPage"), static_cast<int>(NewTabType::BlankPage));
         m_settings.setValue(QStringLiteral("FavoritePagesFile"), QStringLiteral("favorite_pages.json"));
     }
+    if (!ok || versionNumber < 1.1f)
+    {
+        // Sessions are saved in a binary format. The JSON session file is read once, and then replaced
+        m_settings.setValue(QStringLiteral("SessionFile"), QStringLiteral("last_session.dat"));
+    }
+    if (!ok || versionNumber < 1.2f)
+    {
+        m_settings.setValue(QStringLiteral("LazySessionRestore"), true);
+        m_settings.setValue(QStringLiteral("SessionRestoreLoadLimit"), 0);
+    }
+    if (!ok || versionNumber < 1.3f)
+    {
+        m_settings.setValue(QStringLiteral("AutoHibernateTabs"), true);
+        m_settings.setValue(QStringLiteral("TabHibernationIdleTime"), 60);
+        m_settings.setValue(QStringLiteral("TabHibernationBudget"), 0);
+        m_settings.setValue(QStringLiteral("TabHibernationMemoryThreshold"), 10);
+    }
+    if (!ok || versionNumber < 1.4f)
+    {
+        m_settings.setValue(QStringLiteral("EnableSpeculativeConnections"), true);
+        m_settings.setValue(QStringLiteral("EnableSpeculativePrerender"), false);
+    }
 
     m_settings.setValue(QStringLiteral("Version"), Version);
 }
+
+void Settings::loadValues()
+{
+    std::lock_guard<std::mutex> lock{m_mutex};
+    for (const SettingDescriptor &descriptor : SettingDescriptors)
+    {
+        const std::size_t index = static_cast<std::size_t>(descriptor.Setting);
+        m_values[index] = toSettingType(descriptor, m_settings.value(QLatin1String(descriptor.Key)));
+    }
+}
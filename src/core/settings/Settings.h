@@ -3,10 +3,18 @@
 
 #include "BrowserSetting.h"
 
+#include <array>
+#include <bitset>
+#include <cstddef>
+#include <mutex>
+
 #include <QObject>
-#include <QMap>
 #include <QSettings>
+#include <QString>
+#include <QThreadPool>
+#include <QVariant>
 
+class QTimer;
 class QWebEngineSettings;
 
 /// The types of pages that can be loaded by default when a new web page or tab is created
@@ -25,6 +33,11 @@ enum class NewTabType
 /**
  * @class Settings
  * @brief Used to access and modify configurable settings of the browser
+ *
+ * Every setting is loaded from the settings store once, on construction, and kept in memory
+ * with the type of its default value. Values can be read from any thread. Changes are applied
+ * to the in-memory values immediately, and written to the settings store in batches by a
+ * background thread.
  */
 class Settings : public QObject
 {
@@ -33,22 +46,38 @@ class Settings : public QObject
     /// Settings version
     const static QString Version;
 
+    /// Number of values in the \ref BrowserSetting enum
+    static constexpr std::size_t NumSettings = static_cast<std::size_t>(BrowserSetting::Version) + 1;
+
 public:
-    /// Settings constructor - loads browser settings and sets to defaults if applicable
+    /// Settings constructor - loads browser settings from the default settings store and sets to defaults if applicable
     explicit Settings(QWebEngineSettings *webSettings);
 
+    /// Constructs the settings from the given settings file. The web settings are only used to fetch the default
+    /// fonts, and may be null
+    Settings(QWebEngineSettings *webSettings, const QString &fileName, QSettings::Format format);
+
+    /// Writes any pending changes to the settings store before destroying the settings
+    ~Settings();
+
     /// Returns the path to the item associated with the path- or file-related key
     QString getPathValue(BrowserSetting key);
 
     /// Returns the value associated with the given key
     QVariant getValue(BrowserSetting key);
 
-    /// Sets the value for the given key
+    /// Sets the value for the given key. The change is written to the settings store shortly after
     void setValue(BrowserSetting key, const QVariant &value);
 
     /// Returns true if the settings have been created in this session, false if else
     bool firstRun() const;
 
+    /// Writes any pending changes to the settings store in the background
+    void flush();
+
+    /// Writes any pending changes to the settings store, and waits for every write to complete
+    void sync();
+
 Q_SIGNALS:
     /// Emitted whenever a setting is changed to the given value
     void settingChanged(BrowserSetting setting, const QVariant &value);
@@ -60,18 +89,37 @@ class Settings : public QObject
     /// Updates the settings after a version change
     void updateSettings();
 
+    /// Loads every setting from the settings store into memory
+    void loadValues();
+
 private:
     /// True if the settings have been created in this session, false if otherwise
     bool m_firstRun;
 
-    /// QSettings object used to access configuration
+    /// QSettings object used to load the configuration and to set its defaults. Changes made after
+    /// construction are written through separate QSettings objects, on the writer thread
     QSettings m_settings;
 
     /// Storage path from settings
     QString m_storagePath;
 
-    /// Mapping of \ref BrowserSetting values to their equivalent key names
-    QMap<BrowserSetting, QString> m_settingMap;
+    /// Current value of each setting, indexed by \ref BrowserSetting
+    std::array<QVariant, NumSettings> m_values;
+
+    /// Settings that have changed since they were last written to the settings store
+    std::bitset<NumSettings> m_pendingWrites;
+
+    /// True while a flush of the pending writes is scheduled
+    bool m_flushScheduled;
+
+    /// Guards the values and the pending writes
+    mutable std::mutex m_mutex;
+
+    /// Delays the flush of pending writes, so that consecutive changes are written together
+    QTimer *m_flushTimer;
+
+    /// Single thread on which the pending writes are stored, in the order they were flushed
+    QThreadPool m_writerPool;
 
     /// Default profile web settings
     QWebEngineSettings *m_webSettings;
@@ -12,14 +12,13 @@
 
 WebSettings::WebSettings(const ViperServiceLocator &serviceLocator, QWebEngineSettings *webEngineSettings, QWebEngineProfile *webEngineProfile, QWebEngineProfile *privateProfile) :
     QObject(nullptr),
+    m_serviceLocator(serviceLocator),
     m_cookieJar(nullptr),
-    m_userAgentManager(nullptr),
     m_webEngineSettings(webEngineSettings),
     m_webEngineProfile(webEngineProfile),
     m_privateWebProfile(privateProfile)
 {
     m_cookieJar = serviceLocator.getServiceAs<CookieJar>("CookieJar");
-    m_userAgentManager = serviceLocator.getServiceAs<UserAgentManager>("UserAgentManager");
 
     if (Settings *settings = serviceLocator.getServiceAs<Settings>("Settings"))
     {
@@ -73,10 +72,11 @@ void WebSettings::onSettingChanged(BrowserSetting setting, const QVariant &value
             break;
         case BrowserSetting::CustomUserAgent:
         {
-            if (!m_userAgentManager)
+            UserAgentManager *userAgentManager = value.toBool() ? getUserAgentManager() : nullptr;
+            if (value.toBool() && !userAgentManager)
                 break;
 
-            const QString userAgentValue = value.toBool() ? m_userAgentManager->getUserAgent().Value : QString();
+            const QString userAgentValue = userAgentManager ? userAgentManager->getUserAgent().Value : QString();
             m_webEngineProfile->setHttpUserAgent(userAgentValue);
 
             if (m_privateWebProfile)
@@ -161,12 +161,12 @@ void WebSettings::init(Settings *settings)
     // Check if custom user agent is used
     if (settings->getValue(BrowserSetting::CustomUserAgent).toBool())
     {
-        if (m_userAgentManager != nullptr)
+        if (UserAgentManager *userAgentManager = getUserAgentManager())
         {
-            m_webEngineProfile->setHttpUserAgent(m_userAgentManager->getUserAgent().Value);
+            m_webEngineProfile->setHttpUserAgent(userAgentManager->getUserAgent().Value);
 
             if (m_privateWebProfile)
-                m_privateWebProfile->setHttpUserAgent(m_userAgentManager->getUserAgent().Value);
+                m_privateWebProfile->setHttpUserAgent(userAgentManager->getUserAgent().Value);
         }
     }
 
@@ -174,3 +174,8 @@ void WebSettings::init(Settings *settings)
     m_webEngineSettings->setAttribute(QWebEngineSettings::PdfViewerEnabled, true);
 #endif
 }
+
+UserAgentManager *WebSettings::getUserAgentManager() const
+{
+    return m_serviceLocator.getServiceAs<UserAgentManager>("UserAgentManager");
+}
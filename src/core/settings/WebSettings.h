@@ -42,13 +42,16 @@ private Q_SLOTS:
     /// Loads the web-related settigns during instantiation of this object into the default web profile
     void init(Settings *appSettings);
 
+    /// Returns the user agent manager, which is only looked up (and thereby created) once a custom user agent is needed
+    UserAgentManager *getUserAgentManager() const;
+
 private:
+    /// Service locator, used to look up the user agent manager
+    const ViperServiceLocator &m_serviceLocator;
+
     /// Points to the application cookie jar
     CookieJar *m_cookieJar;
 
-    /// Points to the browser user agent manager
-    UserAgentManager *m_userAgentManager;
-
     /// Web engine settings for the web profile that was passed in the constructor
     QWebEngineSettings *m_webEngineSettings;
 
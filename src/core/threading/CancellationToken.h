@@ -0,0 +1,35 @@
+#ifndef CANCELLATIONTOKEN_H
+#define CANCELLATIONTOKEN_H
+
+#include <atomic>
+#include <memory>
+
+/**
+ * @class CancellationToken
+ * @brief Allows the owner of a scheduled task to cancel it before it starts. Copies of a token
+ *        share the same state, so cancelling one copy cancels all of them. Safe to use from any thread.
+ */
+class CancellationToken
+{
+public:
+    /// Constructs a token that has not been cancelled
+    CancellationToken() : m_cancelled(std::make_shared<std::atomic_bool>(false)) {}
+
+    /// Cancels the task(s) associated with the token
+    void cancel()
+    {
+        m_cancelled->store(true);
+    }
+
+    /// Returns true if the token has been cancelled
+    bool isCancelled() const
+    {
+        return m_cancelled->load();
+    }
+
+private:
+    /// Cancellation flag, shared between copies of the token
+    std::shared_ptr<std::atomic_bool> m_cancelled;
+};
+
+#endif // CANCELLATIONTOKEN_H
@@ -1,14 +1,19 @@
 #include "DatabaseFactory.h"
 #include "DatabaseTaskScheduler.h"
+#include "Tracer.h"
+
+#include <algorithm>
+
+#include <QDebug>
 
 DatabaseTaskScheduler::DatabaseTaskScheduler() :
-    m_registry(),
-    m_workersToCreate(),
+    m_workers(),
     m_mutex(),
-    m_cv(),
-    m_thread(nullptr),
-    m_tasks(),
+    m_initCondition(),
+    m_pendingConstructions(0),
+    m_initialized(false),
     m_initCallbacks(),
+    m_running(false),
     m_working(false)
 {
 }
@@ -20,9 +25,10 @@ DatabaseTaskScheduler::~DatabaseTaskScheduler()
 
 DatabaseWorker *DatabaseTaskScheduler::getWorker(const std::string &name) const
 {
-    const auto it = m_registry.find(name);
-    if (it != m_registry.end())
-        return it->second.get();
+    std::lock_guard<std::mutex> lock{m_mutex};
+    const auto it = m_workers.find(name);
+    if (it != m_workers.end())
+        return it->second->Worker.get();
     return nullptr;
 }
 
@@ -31,71 +37,272 @@ void DatabaseTaskScheduler::onInit(std::function<void()> &&callback)
     m_initCallbacks.push_back(std::move(callback));
 }
 
-void DatabaseTaskScheduler::post(std::function<void()> &&work)
+void DatabaseTaskScheduler::post(const std::string &workerName, DatabaseTaskPriority priority, std::function<void()> &&work)
 {
-    std::lock_guard<std::mutex> lock{m_mutex};
-    m_tasks.push_back(std::move(work));
-    m_cv.notify_one();
+    enqueue(workerName, priority, std::move(work));
 }
 
 void DatabaseTaskScheduler::addWorker(const std::string &name, std::function<std::unique_ptr<DatabaseWorker>()> construction)
 {
-    m_workersToCreate.push_back({name, construction});
+    std::lock_guard<std::mutex> lock{m_mutex};
+    if (m_running)
+        return;
+
+    auto it = m_workers.find(name);
+    if (it == m_workers.end())
+    {
+        it = m_workers.emplace(name, std::make_unique<WorkerContext>()).first;
+        it->second->Name = name;
+    }
+
+    it->second->Construction = construction;
+}
+
+DatabaseLaneMetrics DatabaseTaskScheduler::getLaneMetrics(const std::string &workerName, DatabaseTaskPriority priority) const
+{
+    WorkerContext *context = nullptr;
+    {
+        std::lock_guard<std::mutex> lock{m_mutex};
+        const auto it = m_workers.find(workerName);
+        if (it == m_workers.end())
+            return DatabaseLaneMetrics();
+        context = it->second.get();
+    }
+
+    std::lock_guard<std::mutex> lock{context->Mutex};
+    return context->Lanes[static_cast<size_t>(priority)].Metrics;
 }
 
 void DatabaseTaskScheduler::run()
 {
-    if (m_thread != nullptr || m_working)
+    std::unique_lock<std::mutex> lock{m_mutex};
+    if (m_running)
         return;
 
+    m_running = true;
     m_working = true;
-    m_thread = new std::thread(&DatabaseTaskScheduler::workerThread, this);
+    m_pendingConstructions = m_workers.size();
+
+    if (m_workers.empty())
+    {
+        lock.unlock();
+        waitForInit(true);
+        return;
+    }
+
+    for (auto &worker : m_workers)
+        startThread(*worker.second);
 }
 
 void DatabaseTaskScheduler::stop()
 {
-    if (m_thread != nullptr)
+    std::vector<WorkerContext*> contexts;
     {
+        std::lock_guard<std::mutex> lock{m_mutex};
+        if (!m_running)
+            return;
+
         m_working = false;
-        m_cv.notify_all();
+        for (auto &worker : m_workers)
+            contexts.push_back(worker.second.get());
+    }
 
-        if (m_thread->joinable())
-            m_thread->join();
+    m_initCondition.notify_all();
 
-        delete m_thread;
-        m_thread = nullptr;
+    for (WorkerContext *context : contexts)
+    {
+        {
+            // Lock before notifying, so that a worker about to wait cannot miss the change in m_working
+            std::lock_guard<std::mutex> lock{context->Mutex};
+        }
+        context->Condition.notify_all();
+
+        if (context->Thread.joinable())
+            context->Thread.join();
     }
+
+    std::lock_guard<std::mutex> lock{m_mutex};
+    m_running = false;
 }
 
-void DatabaseTaskScheduler::workerThread()
+bool DatabaseTaskScheduler::enqueue(const std::string &workerName, DatabaseTaskPriority priority, std::function<void()> &&work)
 {
-    for (auto &&workerInfo : m_workersToCreate)
+    WorkerContext *context = findContext(workerName);
+    if (!context)
+        return false;
+
     {
-        m_registry[workerInfo.first] = workerInfo.second();
+        std::lock_guard<std::mutex> lock{context->Mutex};
+        pushTask(*context, priority, std::move(work));
     }
+    context->Condition.notify_one();
+    return true;
+}
 
-    for (auto &initCallback : m_initCallbacks)
-        initCallback();
+void DatabaseTaskScheduler::enqueueCoalesced(const std::string &workerName, DatabaseTaskPriority priority, const std::string &key,
+                                             std::function<void()> &&work, std::function<void()> &&cancel)
+{
+    WorkerContext *context = findContext(workerName);
+    if (!context)
+    {
+        cancel();
+        return;
+    }
 
-    m_initCallbacks.clear();
+    std::function<void()> cancelReplaced;
+    {
+        std::lock_guard<std::mutex> lock{context->Mutex};
 
-    for (;;)
+        auto it = context->CoalescedTasks.find(key);
+        if (it != context->CoalescedTasks.end())
+        {
+            // Take over the position of the waiting task
+            CoalescedTask &waitingTask = *it->second;
+            cancelReplaced = std::move(waitingTask.Cancel);
+            waitingTask.Work = std::move(work);
+            waitingTask.Cancel = std::move(cancel);
+            context->Lanes[static_cast<size_t>(waitingTask.Priority)].Metrics.TasksCoalesced++;
+        }
+        else
+        {
+            auto coalescedTask = std::make_shared<CoalescedTask>();
+            coalescedTask->Work = std::move(work);
+            coalescedTask->Cancel = std::move(cancel);
+            coalescedTask->Priority = priority;
+            context->CoalescedTasks[key] = coalescedTask;
+
+            // The most recent work is taken when the task starts, so that tasks posted with the same key
+            // after this point are queued separately
+            pushTask(*context, priority, [context, key, coalescedTask](){
+                std::function<void()> latestWork;
+                {
+                    std::lock_guard<std::mutex> lock{context->Mutex};
+                    context->CoalescedTasks.erase(key);
+                    latestWork = std::move(coalescedTask->Work);
+                }
+
+                if (latestWork)
+                    latestWork();
+            });
+        }
+    }
+
+    if (cancelReplaced)
+        cancelReplaced();
+    else
+        context->Condition.notify_one();
+}
+
+void DatabaseTaskScheduler::pushTask(WorkerContext &context, DatabaseTaskPriority priority, std::function<void()> &&work)
+{
+    TaskLane &lane = context.Lanes[static_cast<size_t>(priority)];
+    lane.Tasks.push_back({ std::move(work), std::chrono::steady_clock::now() });
+    lane.Metrics.QueueDepth = lane.Tasks.size();
+    lane.Metrics.MaxQueueDepth = std::max(lane.Metrics.MaxQueueDepth, lane.Metrics.QueueDepth);
+
+    if (Tracer::isEnabled())
+        Tracer::instance().setCounter("database", context.Name + " queue", static_cast<int64_t>(context.Lanes[0].Tasks.size() + context.Lanes[1].Tasks.size()));
+}
+
+DatabaseTaskScheduler::WorkerContext *DatabaseTaskScheduler::findContext(const std::string &name) const
+{
+    std::lock_guard<std::mutex> lock{m_mutex};
+    auto it = m_workers.find(name);
+    if (it != m_workers.end())
+        return it->second.get();
+
+    qWarning() << "DatabaseTaskScheduler - no database worker registered with the name" << QString::fromStdString(name);
+    return nullptr;
+}
+
+void DatabaseTaskScheduler::startThread(WorkerContext &context)
+{
+    context.Thread = std::thread(&DatabaseTaskScheduler::workerThread, this, &context);
+}
+
+void DatabaseTaskScheduler::workerThread(WorkerContext *context)
+{
+    Tracer::instance().setThreadName(context->Name);
+
+    bool constructedLast = false;
     {
         std::unique_lock<std::mutex> lock{m_mutex};
-        m_cv.wait(lock, [this](){
-            return !m_tasks.empty() || !m_working;
+        if (!m_initialized)
+        {
+            lock.unlock();
+
+            // Database connections are opened on the thread that uses them
+            std::unique_ptr<DatabaseWorker> worker;
+            if (context->Construction)
+                worker = context->Construction();
+
+            lock.lock();
+            context->Worker = std::move(worker);
+            constructedLast = (--m_pendingConstructions == 0);
+        }
+    }
+
+    waitForInit(constructedLast);
+
+    for (;;)
+    {
+        std::unique_lock<std::mutex> lock{context->Mutex};
+        context->Condition.wait(lock, [this, context](){
+            return context->hasTasks() || !m_working;
         });
 
-        if (!m_working && m_tasks.empty())
+        if (!m_working && !context->hasTasks())
             break;
 
-        std::function<void()> task = std::move(m_tasks.front());
-        m_tasks.pop_front();
+        // Interactive tasks run before queued background tasks, unless too many of them have been started in a row
+        TaskLane &interactiveLane = context->Lanes[static_cast<size_t>(DatabaseTaskPriority::Interactive)];
+        TaskLane &backgroundLane = context->Lanes[static_cast<size_t>(DatabaseTaskPriority::Background)];
+        const bool runInteractive = !interactiveLane.Tasks.empty()
+                && (backgroundLane.Tasks.empty() || context->InteractiveStreak < InteractiveTasksPerBackgroundTask);
+        TaskLane &lane = runInteractive ? interactiveLane : backgroundLane;
+
+        if (runInteractive && !backgroundLane.Tasks.empty())
+            ++context->InteractiveStreak;
+        else
+            context->InteractiveStreak = 0;
+
+        QueuedTask task = std::move(lane.Tasks.front());
+        lane.Tasks.pop_front();
+
+        const auto waitTime = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - task.PostedAt);
+        DatabaseLaneMetrics &metrics = lane.Metrics;
+        metrics.QueueDepth = lane.Tasks.size();
+        metrics.TasksStarted++;
+        metrics.TotalWaitTime += waitTime;
+        metrics.MaxWaitTime = std::max(metrics.MaxWaitTime, waitTime);
         lock.unlock();
 
-        task();
+        VIPER_TRACE_SCOPE("database", "DatabaseTaskScheduler::runTask");
+        task.Work();
+    }
+}
 
-        if (!m_working && m_tasks.empty())
-            break;
+void DatabaseTaskScheduler::waitForInit(bool constructedLast)
+{
+    if (constructedLast)
+    {
+        // The last worker thread to instantiate its database worker executes the init callbacks
+        VIPER_TRACE_SCOPE("database", "DatabaseTaskScheduler::runInitCallbacks");
+        for (auto &initCallback : m_initCallbacks)
+            initCallback();
+
+        m_initCallbacks.clear();
+
+        {
+            std::lock_guard<std::mutex> lock{m_mutex};
+            m_initialized = true;
+        }
+        m_initCondition.notify_all();
+        return;
     }
+
+    std::unique_lock<std::mutex> lock{m_mutex};
+    m_initCondition.wait(lock, [this](){
+        return m_initialized || !m_working;
+    });
 }
@@ -1,27 +1,105 @@
 #ifndef DATABASETASKSCHEDULER_H
 #define DATABASETASKSCHEDULER_H
 
+#include "CancellationToken.h"
+
+#include <array>
+#include <atomic>
+#include <chrono>
 #include <condition_variable>
+#include <cstdint>
 #include <deque>
 #include <functional>
 #include <memory>
 #include <mutex>
+#include <string>
 #include <thread>
+#include <type_traits>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
+#include <QFuture>
+#include <QPromise>
 #include <QString>
 
 class DatabaseWorker;
 
+/// Priority lanes of a database worker's task queue
+enum class DatabaseTaskPriority
+{
+    /// Tasks that the user is waiting on, such as favicon, bookmark or suggestion lookups
+    Interactive = 0,
+
+    /// Bulk work that may be delayed, such as loading search indices
+    Background = 1
+};
+
+/// Statistics of a single priority lane of a database worker
+struct DatabaseLaneMetrics
+{
+    /// Number of tasks currently waiting in the lane
+    size_t QueueDepth;
+
+    /// Highest number of tasks that were waiting in the lane at the same time
+    size_t MaxQueueDepth;
+
+    /// Number of tasks from the lane that have been started
+    uint64_t TasksStarted;
+
+    /// Total time spent by the started tasks between being posted and being started
+    std::chrono::microseconds TotalWaitTime;
+
+    /// Longest time spent by a task between being posted and being started
+    std::chrono::microseconds MaxWaitTime;
+
+    /// Number of tasks that were replaced by a newer task with the same key before being started
+    uint64_t TasksCoalesced;
+
+    /// Default constructor
+    DatabaseLaneMetrics() : QueueDepth(0), MaxQueueDepth(0), TasksStarted(0), TotalWaitTime(0), MaxWaitTime(0), TasksCoalesced(0) {}
+
+    /// Returns the average time spent by a task between being posted and being started
+    std::chrono::microseconds getAverageWaitTime() const
+    {
+        if (TasksStarted == 0)
+            return std::chrono::microseconds(0);
+        return TotalWaitTime / TasksStarted;
+    }
+};
+
 /**
  * @class DatabaseTaskScheduler
  * @brief Manages a collection of DatabaseWorkers
  *        that operate outside of the main thread
+ *
+ * Each database worker has its own thread, so that work on one database never waits
+ * for work on another. The task queue of each worker is split into an interactive and
+ * a background lane. Tasks posted to the same lane of a worker are executed in the order
+ * they were posted, while queued background tasks are passed over while there are
+ * interactive tasks waiting, up to \ref InteractiveTasksPerBackgroundTask interactive
+ * tasks in a row, so that the background lane always makes progress.
+ *
+ * No order is guaranteed between the two lanes: an interactive task may run before a
+ * background task that was posted earlier. A task that depends on the effects of another
+ * task, such as a read that must see an earlier write, must be posted to the same lane,
+ * or be posted from the continuation of the earlier task.
+ *
+ * Tasks that produce a result are scheduled with schedule(), which returns a \ref QFuture.
+ * Use QFuture::then() with a context object to receive the result on that object's thread:
+ *
+ *     scheduler.schedule("HistoryStore", DatabaseTaskPriority::Interactive, [store]() { return store->getWords(); })
+ *              .then(this, [this](std::map<int, QString> words) { ... });
+ *
+ * Scheduled tasks can be cancelled before they start, either through a \ref CancellationToken
+ * or by cancelling the returned future. Continuations of cancelled tasks are not invoked.
  */
 class DatabaseTaskScheduler
 {
 public:
+    /// Maximum number of interactive tasks that are started in a row while background tasks are waiting
+    static constexpr size_t InteractiveTasksPerBackgroundTask = 8;
+
     /// Constructs the task schedulerr
     DatabaseTaskScheduler();
 
@@ -33,64 +111,242 @@ class DatabaseTaskScheduler
     /// the onInit() method
     DatabaseWorker *getWorker(const std::string &name) const;
 
-    /// Registers a callback to be executed when the worker thread has started
+    /// Registers a callback to be executed when the worker threads have started, after all
+    /// of the database workers have been instantiated and before any task is executed
     void onInit(std::function<void()> &&callback);
 
     /**
-     * @brief Posts a task to the end of the work queue
+     * @brief Posts a task to the end of a worker's work queue
+     * @param workerName Name of the database worker that the task operates on
+     * @param priority Lane of the work queue to post the task to
      * @param f Member function to be invoked
      * @param args Function arguments
      */
     template<class Fn, class ...Args>
-    void post(Fn &&f, Args &&...args)
+    void post(const std::string &workerName, DatabaseTaskPriority priority, Fn &&f, Args &&...args)
     {
-        std::lock_guard<std::mutex> lock{m_mutex};
-        m_tasks.push_back(std::bind(std::forward<Fn>(f), std::forward<Args>(args)...));
-        m_cv.notify_one();
+        enqueue(workerName, priority, std::bind(std::forward<Fn>(f), std::forward<Args>(args)...));
     }
 
-    /// Posts a task to the end of the work queue
-    void post(std::function<void()> &&work);
+    /// Posts a task to the end of the given lane of a worker's work queue
+    void post(const std::string &workerName, DatabaseTaskPriority priority, std::function<void()> &&work);
+
+    /**
+     * @brief Schedules a task that produces a result on a worker's thread
+     * @param workerName Name of the database worker that the task operates on
+     * @param priority Lane of the work queue to post the task to
+     * @param fn Callable to be invoked on the worker thread. Its return value is the result of the future
+     * @param token Optional token, which prevents the task from starting if it is cancelled first
+     * @return A future holding the result of the task. The future is cancelled if the task is cancelled
+     */
+    template<class Fn, class Result = std::invoke_result_t<Fn>>
+    QFuture<Result> schedule(const std::string &workerName, DatabaseTaskPriority priority, Fn &&fn,
+                             const CancellationToken &token = CancellationToken())
+    {
+        auto promise = std::make_shared<QPromise<Result>>();
+        QFuture<Result> future = promise->future();
+        promise->start();
+
+        if (!enqueue(workerName, priority, makeTask<Result>(std::forward<Fn>(fn), promise, token)))
+            cancelPromise(*promise);
+        return future;
+    }
+
+    /**
+     * @brief Schedules a task that produces a result, replacing any task with the same key that is
+     *        still waiting in the worker's queue. The replaced task's future is cancelled, and the
+     *        new task takes over its position in the queue.
+     *
+     * Used to collapse repeated requests, such as saving the same record several times in a row, into the latest one.
+     *
+     * @param workerName Name of the database worker that the task operates on
+     * @param priority Lane of the work queue to post the task to, if no task with the same key is waiting
+     * @param key Identifies the tasks that may replace each other, within the given worker
+     * @param fn Callable to be invoked on the worker thread. Its return value is the result of the future
+     * @param token Optional token, which prevents the task from starting if it is cancelled first
+     * @return A future holding the result of the task
+     */
+    template<class Fn, class Result = std::invoke_result_t<Fn>>
+    QFuture<Result> scheduleCoalesced(const std::string &workerName, DatabaseTaskPriority priority, const std::string &key,
+                                      Fn &&fn, const CancellationToken &token = CancellationToken())
+    {
+        auto promise = std::make_shared<QPromise<Result>>();
+        QFuture<Result> future = promise->future();
+        promise->start();
+
+        enqueueCoalesced(workerName, priority, key, makeTask<Result>(std::forward<Fn>(fn), promise, token),
+                         [promise]() { cancelPromise(*promise); });
+        return future;
+    }
 
     /// Adds a database worker to the pool of workers. It will be constructed after calling the run() method.
     /// Anything registered with this method after calling run() will not be instantiated
     void addWorker(const std::string &name, std::function<std::unique_ptr<DatabaseWorker>()> construction);
 
-    /// Starts the worker thread
+    /// Returns the statistics of the given lane of a worker's work queue
+    DatabaseLaneMetrics getLaneMetrics(const std::string &workerName, DatabaseTaskPriority priority) const;
+
+    /// Starts the worker threads
     void run();
 
-    /// Stops the worker thread
+    /// Stops the worker threads, after they have finished their pending tasks
     void stop();
 
 private:
-    /// Main loop of the worker thread
-    void workerThread();
+    /// Task waiting in a worker's work queue
+    struct QueuedTask
+    {
+        /// Work to be executed
+        std::function<void()> Work;
+
+        /// Time at which the task was posted
+        std::chrono::steady_clock::time_point PostedAt;
+    };
+
+    /// One priority lane of a worker's work queue
+    struct TaskLane
+    {
+        /// Pending tasks, in the order they were posted
+        std::deque<QueuedTask> Tasks;
+
+        /// Lane statistics
+        DatabaseLaneMetrics Metrics;
+    };
+
+    /// Most recent task posted with a given key, which has not yet been started
+    struct CoalescedTask
+    {
+        /// Work to be executed
+        std::function<void()> Work;
+
+        /// Cancels the future of the work, when it is replaced by a newer task
+        std::function<void()> Cancel;
+
+        /// Lane that the task was posted to
+        DatabaseTaskPriority Priority;
+    };
+
+    /// Thread, work queue and instance of a single database worker
+    struct WorkerContext
+    {
+        /// Name of the database worker
+        std::string Name;
+
+        /// Constructs the database worker, on the worker's own thread
+        std::function<std::unique_ptr<DatabaseWorker>()> Construction;
+
+        /// Database worker instance
+        std::unique_ptr<DatabaseWorker> Worker;
+
+        /// Work queue, indexed by \ref DatabaseTaskPriority
+        std::array<TaskLane, 2> Lanes;
+
+        /// Number of interactive tasks started in a row while background tasks were waiting
+        size_t InteractiveStreak { 0 };
+
+        /// Coalesced tasks that are waiting in the work queue, by their key
+        std::unordered_map<std::string, std::shared_ptr<CoalescedTask>> CoalescedTasks;
+
+        /// Guards the work queue
+        mutable std::mutex Mutex;
+
+        /// Signalled when a task is posted, or when the scheduler is stopping
+        std::condition_variable Condition;
+
+        /// Worker thread
+        std::thread Thread;
+
+        /// Returns true if any of the lanes contain a task
+        bool hasTasks() const
+        {
+            return !Lanes[0].Tasks.empty() || !Lanes[1].Tasks.empty();
+        }
+    };
 
 private:
-    /// Hashmap of database worker names to their corresponding instances
-    std::unordered_map<std::string, std::unique_ptr<DatabaseWorker>> m_registry;
+    /// Wraps a callable into a task that fulfills the promise with its result, unless it was cancelled
+    template<class Result, class Fn>
+    static std::function<void()> makeTask(Fn &&fn, std::shared_ptr<QPromise<Result>> promise, CancellationToken token)
+    {
+        return [fn = std::forward<Fn>(fn), promise, token]() mutable {
+            if (token.isCancelled() || promise->isCanceled())
+            {
+                cancelPromise(*promise);
+                return;
+            }
+
+            try
+            {
+                if constexpr (std::is_void_v<Result>)
+                    fn();
+                else
+                    promise->addResult(fn());
+            }
+            catch (...)
+            {
+                promise->setException(std::current_exception());
+            }
+
+            promise->finish();
+        };
+    }
+
+    /// Cancels the future of the promise and marks it as finished
+    template<class Result>
+    static void cancelPromise(QPromise<Result> &promise)
+    {
+        promise.future().cancel();
+        promise.finish();
+    }
+
+    /// Appends a task to the given lane of a worker's work queue. Returns false, without queueing the task, if no
+    /// worker was registered with the given name
+    bool enqueue(const std::string &workerName, DatabaseTaskPriority priority, std::function<void()> &&work);
 
-    /// Vector of callbacks waiting to be executed in the run() method
-    std::vector<std::pair<std::string, 
-        std::function<std::unique_ptr<DatabaseWorker>()>>> m_workersToCreate;
+    /// Appends a task to the given lane of a worker's work queue, or replaces the waiting task that has the same key.
+    /// Cancels the task if no worker was registered with the given name
+    void enqueueCoalesced(const std::string &workerName, DatabaseTaskPriority priority, const std::string &key,
+                          std::function<void()> &&work, std::function<void()> &&cancel);
 
-    /// Mutex
+    /// Appends a task to the lane of a worker's work queue. Must be called with the worker's mutex locked
+    void pushTask(WorkerContext &context, DatabaseTaskPriority priority, std::function<void()> &&work);
+
+    /// Returns the context of the worker with the given name, or a nullptr if no worker was registered with the name
+    WorkerContext *findContext(const std::string &name) const;
+
+    /// Starts the thread of the given worker. Must be called with m_mutex locked
+    void startThread(WorkerContext &context);
+
+    /// Main loop of a worker thread
+    void workerThread(WorkerContext *context);
+
+    /// Waits until all database workers have been instantiated and the init callbacks have been executed
+    void waitForInit(bool constructedLast);
+
+private:
+    /// Hashmap of database worker names to their corresponding threads and work queues
+    std::unordered_map<std::string, std::unique_ptr<WorkerContext>> m_workers;
+
+    /// Guards the hashmap of workers and the startup state
     mutable std::mutex m_mutex;
 
-    /// Condition variable
-    std::condition_variable m_cv;
+    /// Signalled once all of the init callbacks have been executed
+    std::condition_variable m_initCondition;
 
-    /// Worker thread
-    std::thread *m_thread;
+    /// Number of worker threads that have not yet instantiated their database worker
+    size_t m_pendingConstructions;
 
-    /// Pending tasks
-    std::deque<std::function<void()>> m_tasks;
+    /// Set to true once all of the init callbacks have been executed
+    bool m_initialized;
 
-    /// Callbacks to be executed after insantiating all of the database workers in the worker thread
+    /// Callbacks to be executed after insantiating all of the database workers
     std::vector<std::function<void()>> m_initCallbacks;
 
-    /// Worker flag - when set to false, the worker thread will halt
-    bool m_working;
+    /// Set to true while the worker threads are running
+    bool m_running;
+
+    /// Worker flag - when set to false, the worker threads will halt once their queues are empty
+    std::atomic_bool m_working;
 };
 
 #endif // DATABASETASKSCHEDULER_H
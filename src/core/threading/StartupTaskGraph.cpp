@@ -0,0 +1,265 @@
+#include "StartupTaskGraph.h"
+#include "Tracer.h"
+
+#include <algorithm>
+#include <deque>
+
+StartupTaskGraph::StartupTaskGraph() :
+    m_tasks(),
+    m_taskIndices(),
+    m_timings(),
+    m_workers(),
+    m_mutex(),
+    m_condition(),
+    m_createdAt(std::chrono::steady_clock::now()),
+    m_numFinished(0),
+    m_started(false),
+    m_working(true)
+{
+}
+
+StartupTaskGraph::~StartupTaskGraph()
+{
+    {
+        std::lock_guard<std::mutex> lock{m_mutex};
+        m_working = false;
+    }
+    m_condition.notify_all();
+
+    for (std::thread &worker : m_workers)
+    {
+        if (worker.joinable())
+            worker.join();
+    }
+}
+
+bool StartupTaskGraph::addTask(const std::string &name, StartupThread thread, const std::vector<std::string> &dependencies, std::function<void()> &&work)
+{
+    std::lock_guard<std::mutex> lock{m_mutex};
+    if (m_started || m_taskIndices.find(name) != m_taskIndices.end())
+        return false;
+
+    m_taskIndices[name] = m_tasks.size();
+    m_tasks.push_back({ name, thread, dependencies, std::move(work), TaskState::Pending });
+    return true;
+}
+
+bool StartupTaskGraph::start()
+{
+    std::lock_guard<std::mutex> lock{m_mutex};
+    if (m_started)
+        return true;
+
+    // Count the unfinished dependencies of each task, rejecting unknown names
+    std::vector<size_t> numDependencies(m_tasks.size(), 0);
+    std::vector<std::vector<size_t>> dependents(m_tasks.size());
+    for (size_t i = 0; i < m_tasks.size(); ++i)
+    {
+        for (const std::string &dependency : m_tasks[i].Dependencies)
+        {
+            auto it = m_taskIndices.find(dependency);
+            if (it == m_taskIndices.end())
+                return false;
+
+            ++numDependencies[i];
+            dependents[it->second].push_back(i);
+        }
+    }
+
+    // Every task can be visited in topological order if and only if there are no cycles
+    std::deque<size_t> readyTasks;
+    for (size_t i = 0; i < m_tasks.size(); ++i)
+    {
+        if (numDependencies[i] == 0)
+            readyTasks.push_back(i);
+    }
+
+    size_t numVisited = 0;
+    while (!readyTasks.empty())
+    {
+        const size_t taskIndex = readyTasks.front();
+        readyTasks.pop_front();
+        ++numVisited;
+
+        for (size_t dependent : dependents[taskIndex])
+        {
+            if (--numDependencies[dependent] == 0)
+                readyTasks.push_back(dependent);
+        }
+    }
+
+    if (numVisited != m_tasks.size())
+        return false;
+
+    m_started = true;
+
+    const size_t numWorkerTasks = static_cast<size_t>(std::count_if(m_tasks.begin(), m_tasks.end(), [](const Task &task) {
+        return task.Thread == StartupThread::Worker;
+    }));
+    const size_t numThreads = std::min(numWorkerTasks, std::max(size_t{2}, static_cast<size_t>(std::thread::hardware_concurrency())));
+    for (size_t i = 0; i < numThreads; ++i)
+        m_workers.emplace_back(&StartupTaskGraph::workerThread, this);
+
+    return true;
+}
+
+void StartupTaskGraph::waitFor(const std::string &name)
+{
+    if (!start())
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock{m_mutex};
+        if (m_taskIndices.find(name) == m_taskIndices.end())
+            return;
+    }
+
+    const std::unordered_set<std::string> names = getDependencyClosure(name);
+    const Task &target = m_tasks[m_taskIndices.at(name)];
+    runUntil(&names, [&target](){ return target.State == TaskState::Finished; });
+}
+
+void StartupTaskGraph::waitForAll()
+{
+    if (!start())
+        return;
+
+    runUntil(nullptr, [this](){ return m_numFinished == m_tasks.size(); });
+}
+
+bool StartupTaskGraph::isFinished(const std::string &name) const
+{
+    std::lock_guard<std::mutex> lock{m_mutex};
+    auto it = m_taskIndices.find(name);
+    return it != m_taskIndices.end() && m_tasks[it->second].State == TaskState::Finished;
+}
+
+bool StartupTaskGraph::isFinished() const
+{
+    std::lock_guard<std::mutex> lock{m_mutex};
+    return m_numFinished == m_tasks.size();
+}
+
+std::vector<StartupTaskTiming> StartupTaskGraph::getTimings() const
+{
+    std::lock_guard<std::mutex> lock{m_mutex};
+    return m_timings;
+}
+
+std::chrono::microseconds StartupTaskGraph::getElapsedTime() const
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - m_createdAt);
+}
+
+bool StartupTaskGraph::isReady(const Task &task) const
+{
+    return std::all_of(task.Dependencies.begin(), task.Dependencies.end(), [this](const std::string &dependency) {
+        return m_tasks[m_taskIndices.at(dependency)].State == TaskState::Finished;
+    });
+}
+
+StartupTaskGraph::Task *StartupTaskGraph::findReadyTask(StartupThread thread, const std::unordered_set<std::string> *names)
+{
+    for (Task &task : m_tasks)
+    {
+        if (task.State != TaskState::Pending || task.Thread != thread)
+            continue;
+
+        if (names != nullptr && names->find(task.Name) == names->end())
+            continue;
+
+        if (isReady(task))
+            return &task;
+    }
+
+    return nullptr;
+}
+
+void StartupTaskGraph::execute(std::unique_lock<std::mutex> &lock, Task &task)
+{
+    StartupTaskTiming timing { task.Name, task.Thread, getElapsedTime(), std::chrono::microseconds(0) };
+    lock.unlock();
+
+    if (task.Work)
+    {
+        TraceSpan traceSpan("startup", task.Name.c_str());
+        task.Work();
+    }
+
+    timing.EndTime = getElapsedTime();
+
+    lock.lock();
+    task.State = TaskState::Finished;
+    ++m_numFinished;
+    m_timings.push_back(timing);
+
+    // Both the main thread and the worker threads may be waiting on the completion of this task
+    m_condition.notify_all();
+}
+
+std::unordered_set<std::string> StartupTaskGraph::getDependencyClosure(const std::string &name) const
+{
+    std::lock_guard<std::mutex> lock{m_mutex};
+
+    std::unordered_set<std::string> closure { name };
+    std::vector<std::string> pending { name };
+    while (!pending.empty())
+    {
+        const Task &task = m_tasks[m_taskIndices.at(pending.back())];
+        pending.pop_back();
+
+        for (const std::string &dependency : task.Dependencies)
+        {
+            if (closure.insert(dependency).second)
+                pending.push_back(dependency);
+        }
+    }
+
+    return closure;
+}
+
+void StartupTaskGraph::runUntil(const std::unordered_set<std::string> *names, const std::function<bool()> &isDone)
+{
+    std::unique_lock<std::mutex> lock{m_mutex};
+    while (!isDone())
+    {
+        if (Task *task = findReadyTask(StartupThread::Main, names))
+        {
+            task->State = TaskState::Running;
+            execute(lock, *task);
+            continue;
+        }
+
+        // Nothing to run on this thread until a worker task completes
+        m_condition.wait(lock);
+    }
+}
+
+void StartupTaskGraph::workerThread()
+{
+    Tracer::instance().setThreadName("StartupWorker");
+
+    std::unique_lock<std::mutex> lock{m_mutex};
+    for (;;)
+    {
+        Task *task = nullptr;
+        m_condition.wait(lock, [this, &task](){
+            task = findReadyTask(StartupThread::Worker, nullptr);
+            if (task != nullptr || !m_working)
+                return true;
+
+            // Stop once there are no worker tasks left to run
+            return std::none_of(m_tasks.begin(), m_tasks.end(), [](const Task &t) {
+                return t.Thread == StartupThread::Worker && t.State == TaskState::Pending;
+            });
+        });
+
+        // Ready tasks are still executed while the graph is being destroyed, while those
+        // waiting on a main thread task that will never run are abandoned
+        if (task == nullptr)
+            return;
+
+        task->State = TaskState::Running;
+        execute(lock, *task);
+    }
+}
@@ -0,0 +1,176 @@
+#ifndef STARTUPTASKGRAPH_H
+#define STARTUPTASKGRAPH_H
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+/// Thread that a startup task must be executed on
+enum class StartupThread
+{
+    /// The thread that owns the graph, which is required by tasks that create QObjects or widgets
+    Main,
+
+    /// Any thread of the graph's worker pool
+    Worker
+};
+
+/// Execution times of a startup task, relative to the construction of the graph
+struct StartupTaskTiming
+{
+    /// Name of the task
+    std::string Name;
+
+    /// Thread that the task was executed on
+    StartupThread Thread;
+
+    /// Time at which the task was started
+    std::chrono::microseconds StartTime;
+
+    /// Time at which the task was completed
+    std::chrono::microseconds EndTime;
+
+    /// Returns the time spent executing the task
+    std::chrono::microseconds getDuration() const
+    {
+        return EndTime - StartTime;
+    }
+};
+
+/**
+ * @class StartupTaskGraph
+ * @brief Executes a set of named initialization tasks, each of which may depend on others,
+ *        as concurrently as their dependencies and thread requirements allow
+ *
+ * Worker tasks are executed by a pool of threads as soon as all of their dependencies are
+ * complete. Main thread tasks are only executed from within \ref waitFor or \ref waitForAll,
+ * which run the main thread tasks that the awaited task depends on as they become ready, in
+ * the order they were added, and otherwise block until a worker task completes.
+ *
+ * Tasks cannot be added once the graph has been started. The graph must outlive its tasks;
+ * its destructor waits for the worker tasks that are ready, and abandons those that still
+ * depend on a main thread task.
+ */
+class StartupTaskGraph
+{
+public:
+    /// Constructs an empty graph
+    StartupTaskGraph();
+
+    /// Waits for the worker tasks that are running or ready to complete, and stops the worker threads
+    ~StartupTaskGraph();
+
+    /// Adds a task to the graph. Returns false if a task with the same name already exists,
+    /// or if the graph has already been started
+    bool addTask(const std::string &name, StartupThread thread, const std::vector<std::string> &dependencies, std::function<void()> &&work);
+
+    /// Verifies that every dependency exists and that there are no cycles, and if so starts executing
+    /// the worker tasks that are ready. Returns false if the graph is invalid, in which case nothing is executed
+    bool start();
+
+    /// Executes the given task and any task it depends on, blocking until it is complete.
+    /// Starts the graph if needed. Must be called from the main thread
+    void waitFor(const std::string &name);
+
+    /// Executes all of the tasks, blocking until they are complete. Must be called from the main thread
+    void waitForAll();
+
+    /// Returns true if the given task has been completed
+    bool isFinished(const std::string &name) const;
+
+    /// Returns true if every task has been completed
+    bool isFinished() const;
+
+    /// Returns the execution times of the completed tasks, in order of completion
+    std::vector<StartupTaskTiming> getTimings() const;
+
+    /// Returns the time elapsed since the graph was constructed
+    std::chrono::microseconds getElapsedTime() const;
+
+private:
+    /// Execution state of a task
+    enum class TaskState
+    {
+        Pending,
+        Running,
+        Finished
+    };
+
+    /// Task in the graph
+    struct Task
+    {
+        /// Name of the task
+        std::string Name;
+
+        /// Thread requirement of the task
+        StartupThread Thread;
+
+        /// Names of the tasks that must be completed before this one starts
+        std::vector<std::string> Dependencies;
+
+        /// Work performed by the task
+        std::function<void()> Work;
+
+        /// Current state of the task
+        TaskState State;
+    };
+
+    /// Returns true if every dependency of the given task has been completed. Requires a lock on m_mutex
+    bool isReady(const Task &task) const;
+
+    /// Returns a pointer to the first pending task that runs on the given thread, is ready, and belongs
+    /// to the given set of task names (or any task if the set is null). Requires a lock on m_mutex
+    Task *findReadyTask(StartupThread thread, const std::unordered_set<std::string> *names);
+
+    /// Executes the given task, which must already be marked as running, without holding the lock,
+    /// then marks it as finished and wakes up any waiting thread
+    void execute(std::unique_lock<std::mutex> &lock, Task &task);
+
+    /// Returns the names of the given task and of every task it depends on, directly or not
+    std::unordered_set<std::string> getDependencyClosure(const std::string &name) const;
+
+    /// Executes main thread tasks from the given set until the predicate is satisfied
+    void runUntil(const std::unordered_set<std::string> *names, const std::function<bool()> &isDone);
+
+    /// Main loop of a worker thread
+    void workerThread();
+
+private:
+    /// Tasks in the order they were added
+    std::vector<Task> m_tasks;
+
+    /// Index of each task in m_tasks, by name
+    std::unordered_map<std::string, size_t> m_taskIndices;
+
+    /// Execution times of the completed tasks
+    std::vector<StartupTaskTiming> m_timings;
+
+    /// Worker thread pool
+    std::vector<std::thread> m_workers;
+
+    /// Protects the task states and timings
+    mutable std::mutex m_mutex;
+
+    /// Signalled whenever a task is completed, or when the graph is being destroyed
+    std::condition_variable m_condition;
+
+    /// Time at which the graph was constructed
+    std::chrono::steady_clock::time_point m_createdAt;
+
+    /// Number of tasks that have been completed
+    size_t m_numFinished;
+
+    /// True once the graph has been started
+    bool m_started;
+
+    /// False once the graph is being destroyed, after which worker threads stop when no task is ready
+    bool m_working;
+};
+
+#endif // STARTUPTASKGRAPH_H
@@ -197,7 +197,18 @@ std::vector<URLSuggestion> HistorySuggestor::getSuggestionsFromQuery(const std::
 
 void HistorySuggestor::setupConnection()
 {
-    m_historyDb = std::make_unique<sqlite::Database>(m_historyDatabaseFile.toStdString());
+    // The suggestor only reads from the history database, which is written to by the HistoryStore.
+    // With a read-only connection in WAL mode, searches never wait for the writer
+    m_historyDb = std::make_unique<sqlite::Database>(m_historyDatabaseFile.toStdString(), sqlite::OpenMode::ReadOnly);
+    if (!m_historyDb->isValid())
+    {
+        // Try again on the next search, the history database may not have been created yet
+        m_historyDb.reset();
+        return;
+    }
+
+    m_historyDb->applyProfile(sqlite::DatabaseProfile::reader());
+
     m_statements.insert(std::make_pair(Statement::SearchByWholeInput,
                                        m_historyDb->prepare(R"(SELECT H.VisitID, H.URL, H.Title, H.URLTypedCount, V.VisitCount, V.RecentVisit
                                                             FROM History AS H INNER JOIN
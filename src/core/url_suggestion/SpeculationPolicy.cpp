@@ -0,0 +1,203 @@
+#include "SpeculationPolicy.h"
+
+#include <algorithm>
+#include <utility>
+
+#include <QLatin1String>
+
+namespace
+{
+    using namespace std::chrono_literals;
+
+    /// Shortest input that can lead to a speculation
+    constexpr int MinInputLength = 2;
+
+    /// Weight of a visit typed into the URL bar, relative to any other visit
+    constexpr double TypedVisitWeight = 3.0;
+
+    /// Frecency at which the policy is half confident in a site, regardless of the input
+    constexpr double FrecencyScale = 20.0;
+
+    /// Interval during which the same site is not speculated on again
+    constexpr std::chrono::milliseconds RepeatInterval = 10s;
+
+    /// Duration over which the budgets are counted
+    constexpr std::chrono::milliseconds BudgetWindow = 1min;
+
+    /// Returns the input or host in upper case, without its scheme or www prefix
+    QString normalize(const QString &text)
+    {
+        QString result = text.trimmed().toUpper();
+        if (result.startsWith(QLatin1String("HTTPS://")))
+            result.remove(0, 8);
+        else if (result.startsWith(QLatin1String("HTTP://")))
+            result.remove(0, 7);
+
+        if (result.startsWith(QLatin1String("WWW.")))
+            result.remove(0, 4);
+        return result;
+    }
+
+    /// Returns the frecency of a suggestion: its visits, typed visits counting more, weighted by the age of the
+    /// last visit
+    double getFrecency(const URLSuggestion &suggestion, const QDateTime &now)
+    {
+        const qint64 ageDays = suggestion.LastVisit.isValid() ? suggestion.LastVisit.daysTo(now) : -1;
+
+        // Sites last visited more than three months ago, or at an unknown date, count for little
+        double recencyWeight = 0.0;
+        if (ageDays < 0 || ageDays > 90)
+            recencyWeight = 0.1;
+        else if (ageDays <= 4)
+            recencyWeight = 1.0;
+        else if (ageDays <= 14)
+            recencyWeight = 0.7;
+        else if (ageDays <= 31)
+            recencyWeight = 0.5;
+        else
+            recencyWeight = 0.3;
+
+        const double visits = std::max(0, suggestion.VisitCount) + TypedVisitWeight * std::max(0, suggestion.URLTypedCount);
+        return visits * recencyWeight;
+    }
+}
+
+SpeculationPolicy::SpeculationPolicy(Clock clock) :
+    m_clock(std::move(clock)),
+    m_preconnectEnabled(true),
+    m_prerenderEnabled(false),
+    m_preconnectThreshold(0.5),
+    m_prerenderThreshold(0.8),
+    m_preconnectBudget(10),
+    m_prerenderBudget(2),
+    m_preconnectTimes(),
+    m_prerenderTimes(),
+    m_lastDecision { Action::None, QUrl(), 0.0 },
+    m_lastDecisionTime(0)
+{
+}
+
+std::chrono::milliseconds SpeculationPolicy::getMonotonicTime()
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch());
+}
+
+bool SpeculationPolicy::isPreconnectEnabled() const
+{
+    return m_preconnectEnabled;
+}
+
+void SpeculationPolicy::setPreconnectEnabled(bool enabled)
+{
+    m_preconnectEnabled = enabled;
+}
+
+void SpeculationPolicy::setPrerenderEnabled(bool enabled)
+{
+    m_prerenderEnabled = enabled;
+}
+
+void SpeculationPolicy::setThresholds(double preconnectThreshold, double prerenderThreshold)
+{
+    m_preconnectThreshold = preconnectThreshold;
+    m_prerenderThreshold = prerenderThreshold;
+}
+
+void SpeculationPolicy::setBudgets(int preconnectsPerMinute, int prerendersPerMinute)
+{
+    m_preconnectBudget = std::max(0, preconnectsPerMinute);
+    m_prerenderBudget = std::max(0, prerendersPerMinute);
+}
+
+double SpeculationPolicy::getConfidence(const QString &input, const std::vector<URLSuggestion> &suggestions, const QDateTime &now)
+{
+    const QString term = normalize(input);
+    if (term.size() < MinInputLength || suggestions.empty())
+        return 0.0;
+
+    const URLSuggestion &top = suggestions.front();
+    const QUrl url(top.URL);
+    if (!url.isValid() || (url.scheme() != QLatin1String("http") && url.scheme() != QLatin1String("https")))
+        return 0.0;
+
+    // Only the site whose address is being typed is a candidate, not pages whose title matches the input
+    const QString host = normalize(url.host());
+    if (host.isEmpty() || !(host + url.path().toUpper()).startsWith(term))
+        return 0.0;
+
+    const double frecency = getFrecency(top, now);
+    if (frecency <= 0.0)
+        return 0.0;
+
+    // The closest rival is the next suggestion for another site
+    double rivalFrecency = 0.0;
+    for (auto it = suggestions.begin() + 1; it != suggestions.end(); ++it)
+    {
+        if (normalize(QUrl(it->URL).host()) != host)
+        {
+            rivalFrecency = getFrecency(*it, now);
+            break;
+        }
+    }
+
+    const double familiarity = frecency / (frecency + FrecencyScale);
+    const double share = frecency / (frecency + rivalFrecency);
+    const double completion = std::min(1.0, static_cast<double>(term.size()) / static_cast<double>(host.size()));
+    return familiarity * share * (0.5 + 0.5 * completion);
+}
+
+SpeculationPolicy::Decision SpeculationPolicy::evaluate(const QString &input, const std::vector<URLSuggestion> &suggestions)
+{
+    Decision decision { Action::None, QUrl(), 0.0 };
+    if (!m_preconnectEnabled && !m_prerenderEnabled)
+        return decision;
+
+    decision.Confidence = getConfidence(input, suggestions, QDateTime::currentDateTime());
+    if (decision.Confidence < std::min(m_preconnectThreshold, m_prerenderThreshold))
+        return decision;
+
+    decision.Url = QUrl(suggestions.front().URL);
+
+    const std::chrono::milliseconds now = m_clock();
+    const bool isRepeat = m_lastDecision.Kind != Action::None && now - m_lastDecisionTime < RepeatInterval;
+
+    // A page that is already being loaded is not loaded again, nor is a connection opened to its site
+    if (isRepeat && m_lastDecision.Kind == Action::Prerender && m_lastDecision.Url == decision.Url)
+        return Decision { Action::None, decision.Url, decision.Confidence };
+
+    if (m_prerenderEnabled && decision.Confidence >= m_prerenderThreshold && hasBudget(Action::Prerender, now))
+    {
+        decision.Kind = Action::Prerender;
+        m_prerenderTimes.push_back(now);
+    }
+    else if (m_preconnectEnabled
+             && decision.Confidence >= m_preconnectThreshold
+             && !(isRepeat && m_lastDecision.Url.host() == decision.Url.host())
+             && hasBudget(Action::Preconnect, now))
+    {
+        decision.Kind = Action::Preconnect;
+        m_preconnectTimes.push_back(now);
+    }
+
+    if (decision.Kind != Action::None)
+    {
+        m_lastDecision = decision;
+        m_lastDecisionTime = now;
+    }
+    return decision;
+}
+
+void SpeculationPolicy::reset()
+{
+    m_lastDecision = Decision { Action::None, QUrl(), 0.0 };
+}
+
+bool SpeculationPolicy::hasBudget(Action action, std::chrono::milliseconds now)
+{
+    std::deque<std::chrono::milliseconds> &times = action == Action::Prerender ? m_prerenderTimes : m_preconnectTimes;
+    while (!times.empty() && now - times.front() >= BudgetWindow)
+        times.pop_front();
+
+    const int budget = action == Action::Prerender ? m_prerenderBudget : m_preconnectBudget;
+    return static_cast<int>(times.size()) < budget;
+}
@@ -0,0 +1,131 @@
+#ifndef SPECULATIONPOLICY_H
+#define SPECULATIONPOLICY_H
+
+#include "URLSuggestion.h"
+
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <vector>
+
+#include <QDateTime>
+#include <QString>
+#include <QUrl>
+
+/**
+ * @class SpeculationPolicy
+ * @brief Decides whether to connect to, or to load, the site the user is most likely typing into the URL bar
+ *        before they press enter
+ *
+ * The policy only considers the top suggestion of the \ref URLSuggestionWorker , and only when the input is a
+ * prefix of its host. Its confidence in the suggestion grows with the frecency of the site (the number of times
+ * it was visited and typed, weighted by how recently it was last visited), with the share of that frecency over
+ * the next suggested site, and with the part of the host that has been typed.
+ *
+ * A connection is opened once the confidence passes one threshold, and the page is loaded once it passes a
+ * second, higher threshold, if prerendering is enabled. Each kind of speculation has a budget of uses per minute,
+ * and the same site is not speculated on twice in a short interval.
+ */
+class SpeculationPolicy
+{
+public:
+    /// Kinds of speculative work, from the cheapest to the most expensive
+    enum class Action
+    {
+        /// Nothing is done
+        None,
+
+        /// The host name is resolved and a connection is opened to the origin of the URL
+        Preconnect,
+
+        /// The page is loaded in the background
+        Prerender
+    };
+
+    /// Speculative work to do for a URL
+    struct Decision
+    {
+        /// Kind of work to do
+        Action Kind;
+
+        /// URL of the suggestion
+        QUrl Url;
+
+        /// Confidence that the user will navigate to the URL, between 0 and 1
+        double Confidence;
+    };
+
+    /// Returns the current time, relative to an arbitrary but fixed point
+    using Clock = std::function<std::chrono::milliseconds()>;
+
+    /// Constructs the policy with the clock that its budgets are measured against
+    explicit SpeculationPolicy(Clock clock);
+
+    /// Returns the time of a monotonic clock, for use as the clock of the policy
+    static std::chrono::milliseconds getMonotonicTime();
+
+    /// Returns true if connections are opened speculatively
+    bool isPreconnectEnabled() const;
+
+    /// Sets whether connections are opened speculatively. Enabled by default
+    void setPreconnectEnabled(bool enabled);
+
+    /// Sets whether pages are loaded speculatively. Disabled by default
+    void setPrerenderEnabled(bool enabled);
+
+    /// Sets the confidence needed to open a connection, and to load a page
+    void setThresholds(double preconnectThreshold, double prerenderThreshold);
+
+    /// Sets the number of connections that can be opened, and of pages that can be loaded, in any minute
+    void setBudgets(int preconnectsPerMinute, int prerendersPerMinute);
+
+    /// Returns the confidence, between 0 and 1, that the user is typing the input to visit the top suggestion
+    static double getConfidence(const QString &input, const std::vector<URLSuggestion> &suggestions, const QDateTime &now);
+
+    /// Decides what to do with the suggestions found for the input, and uses up the budget of the returned action
+    Decision evaluate(const QString &input, const std::vector<URLSuggestion> &suggestions);
+
+    /// Forgets the last speculation, so that the same site can be speculated on again right away
+    void reset();
+
+private:
+    /// Returns true if the budget of the given action allows one more use at the given time, dropping uses that
+    /// are older than a minute
+    bool hasBudget(Action action, std::chrono::milliseconds now);
+
+private:
+    /// Source of the current time
+    Clock m_clock;
+
+    /// Whether connections are opened speculatively
+    bool m_preconnectEnabled;
+
+    /// Whether pages are loaded speculatively
+    bool m_prerenderEnabled;
+
+    /// Confidence needed to open a connection
+    double m_preconnectThreshold;
+
+    /// Confidence needed to load a page
+    double m_prerenderThreshold;
+
+    /// Number of connections that can be opened in any minute
+    int m_preconnectBudget;
+
+    /// Number of pages that can be loaded in any minute
+    int m_prerenderBudget;
+
+    /// Times of the connections opened in the last minute
+    std::deque<std::chrono::milliseconds> m_preconnectTimes;
+
+    /// Times of the pages loaded in the last minute
+    std::deque<std::chrono::milliseconds> m_prerenderTimes;
+
+    /// Last speculation made
+    Decision m_lastDecision;
+
+    /// Time of the last speculation
+    std::chrono::milliseconds m_lastDecisionTime;
+};
+
+#endif // SPECULATIONPOLICY_H
@@ -1,5 +1,6 @@
 #include "CommonUtil.h"
 #include "UserScript.h"
+#include "UserScriptMatcher.h"
 
 #include <QFile>
 #include <QTextStream>
@@ -14,6 +15,9 @@ UserScript::UserScript() :
     m_injectionTime(ScriptInjectionTime::DocumentEnd),
     m_includes(),
     m_excludes(),
+    m_includeRules(),
+    m_excludeRules(),
+    m_matchRules(),
     m_dependencies(),
     m_scriptData(),
     m_dependencyData()
@@ -74,6 +78,14 @@ bool UserScript::load(const QString &file, const QString &templateData)
     m_dependencyData.clear();
     m_fileName = file;
 
+    // Rules are cleared so that reloading a script does not duplicate them
+    m_includes.clear();
+    m_excludes.clear();
+    m_includeRules.clear();
+    m_excludeRules.clear();
+    m_matchRules.clear();
+    m_dependencies.clear();
+
     // Read file line by line, adding contents to local data buffer and initially parsing the metadata block
     bool foundMetaDataStart = false, foundMetaDataEnd = false;
     QRegularExpression metaDataStart("// ==UserScript=="),
@@ -105,11 +117,20 @@ bool UserScript::load(const QString &file, const QString &templateData)
                 else if (key.compare("noframes") == 0)
                     m_noSubFrames = true;
                 else if (key.compare("include") == 0)
-                    m_includes.push_back(getRegExp(value));
+                {
+                    m_includes.push_back(UserScriptMatcher::getRegExpForGlob(value));
+                    m_includeRules.push_back(value);
+                }
                 else if (key.compare("exclude") == 0)
-                    m_excludes.push_back(getRegExp(value));
+                {
+                    m_excludes.push_back(UserScriptMatcher::getRegExpForGlob(value));
+                    m_excludeRules.push_back(value);
+                }
                 else if (key.compare("match") == 0)
+                {
                     m_includes.push_back(CommonUtil::getRegExpForMatchPattern(value));
+                    m_matchRules.push_back(value);
+                }
                 else if (key.compare("require") == 0)
                     m_dependencies.push_back(value);
                 else if (key.compare("run-at") == 0)
@@ -148,29 +169,6 @@ bool UserScript::load(const QString &file, const QString &templateData)
     return true;
 }
 
-QRegularExpression UserScript::getRegExp(const QString &str)
-{
-    // Check if string is either a single '*' or empty, and if so, set regular expression to match everything
-    if (str.isEmpty() || (str.size() == 1 && str.at(0) == '*'))
-        return QRegularExpression(QStringLiteral(".*"));
-
-    QString converted;
-
-    // Check if rule is a regular expression
-    if (str.startsWith('/') && str.endsWith('/'))
-    {
-        converted = str.mid(1);
-        converted = str.left(str.size() - 1);
-        converted.replace(QStringLiteral("\\"), QStringLiteral("\\\\"));
-        return QRegularExpression(converted);
-    }
-
-    // If the method has not returned at this point, replace each occurrence of a "*" with a ".*"
-    converted = str;
-    converted.replace(QStringLiteral("*"), QStringLiteral(".*"));
-    return QRegularExpression(converted);
-}
-
 QString UserScript::getScriptJSON() const
 {
     QString excludes;
@@ -60,9 +60,6 @@ class UserScript
     bool load(const QString &file, const QString &templateData);
 
 private:
-    /// Converts the include or exclude rule into a QRegularExpression
-    QRegularExpression getRegExp(const QString &str);
-
     /// Converts the extracted script metadata into a JSON object
     QString getScriptJSON() const;
 
@@ -97,6 +94,15 @@ class UserScript
     /// Container of url excluding rules, where the script will never be injected
     std::vector<QRegularExpression> m_excludes;
 
+    /// The @include rules of the script, as written in its metadata block
+    std::vector<QString> m_includeRules;
+
+    /// The @exclude rules of the script, as written in its metadata block
+    std::vector<QString> m_excludeRules;
+
+    /// The @match rules of the script, as written in its metadata block
+    std::vector<QString> m_matchRules;
+
     /// JavaScript dependencies
     std::vector<QString> m_dependencies;
 
@@ -4,19 +4,35 @@
 #include "InternalDownloadItem.h"
 #include "WebEngineScriptAdapter.h"
 
+#include <algorithm>
+
 #include <QDir>
 #include <QFile>
-#include <QRegularExpression>
 #include <QNetworkRequest>
 #include <QUrl>
 
+namespace
+{
+    /// Largest number of origins whose script bundles are cached at once
+    constexpr int MaxCachedBundles = 128;
+}
+
 UserScriptManager::UserScriptManager(DownloadManager *downloadManager, Settings *settings) :
     QObject(nullptr),
     m_downloadManager(downloadManager),
-    m_model(new UserScriptModel(downloadManager, settings, this))
+    m_model(new UserScriptModel(downloadManager, settings, this)),
+    m_matcher(),
+    m_isMatcherStale(true),
+    m_scriptBundles(),
+    m_webEngineScripts()
 {
     setObjectName(QLatin1String("UserScriptManager"));
     connect(settings, &Settings::settingChanged, this, &UserScriptManager::onSettingChanged);
+
+    connect(m_model, &UserScriptModel::rowsInserted, this, &UserScriptManager::onScriptsChanged);
+    connect(m_model, &UserScriptModel::rowsRemoved, this, &UserScriptManager::onScriptsChanged);
+    connect(m_model, &UserScriptModel::dataChanged, this, &UserScriptManager::onScriptsChanged);
+    connect(m_model, &UserScriptModel::modelReset, this, &UserScriptManager::onScriptsChanged);
 }
 
 UserScriptManager::~UserScriptManager()
@@ -38,47 +54,52 @@ QString UserScriptManager::getScriptsFor(const QUrl &url, ScriptInjectionTime in
     if (!m_model->m_enabled)
         return QString();
 
-    QByteArray resultBuffer;
-    QString urlStr = url.toString(QUrl::FullyEncoded);
+    updateMatcher();
 
-    for (const UserScript &script : m_model->m_scripts)
-    {
-        if (!script.m_isEnabled
-                || (injectionTime != script.m_injectionTime)
-                || (script.m_noSubFrames && !isMainFrame))
-            continue;
+    const QString cacheKey = QString("%1|%2|%3").arg(UserScriptMatcher::getOrigin(url))
+            .arg(static_cast<int>(injectionTime)).arg(isMainFrame ? 1 : 0);
+    auto it = m_scriptBundles.find(cacheKey);
+    if (it != m_scriptBundles.end() && !it->DependsOnPath)
+        return it->Bundle;
 
-        bool isExclude = false, isInclude = false;
-        for (const QRegularExpression &expr : script.m_excludes)
-        {
-            if (expr.match(urlStr).hasMatch())
-            {
-                isExclude = true;
-                break;
-            }
-        }
+    auto appliesToFrame = [this, injectionTime, isMainFrame](int scriptIndex) {
+        const UserScript &script = m_model->m_scripts.at(scriptIndex);
+        return script.m_isEnabled
+                && injectionTime == script.m_injectionTime
+                && (!script.m_noSubFrames || isMainFrame);
+    };
 
-        if (isExclude)
-            continue;
+    const UserScriptMatcher::Result match = m_matcher.match(url);
+    const std::vector<int> &pathDependentScripts = match.PathDependentScripts;
 
-        for (const QRegularExpression &expr : script.m_includes)
+    // The scripts that apply to every URL of the origin are cached together, leaving out those that depend on the path
+    if (it == m_scriptBundles.end())
+    {
+        QByteArray bundle;
+        for (int scriptIndex : match.Scripts)
         {
-            if (expr.match(urlStr).hasMatch())
-            {
-                isInclude = true;
-                break;
-            }
+            if (appliesToFrame(scriptIndex)
+                    && !std::binary_search(pathDependentScripts.begin(), pathDependentScripts.end(), scriptIndex))
+                appendToBundle(bundle, scriptIndex);
         }
 
-        if (isInclude)
-        {
-            resultBuffer.append(script.m_dependencyData);
-            resultBuffer.append('\n');
-            resultBuffer.append(script.m_scriptData.toUtf8());
-        }
+        if (m_scriptBundles.size() >= MaxCachedBundles)
+            m_scriptBundles.clear();
+        it = m_scriptBundles.insert(cacheKey, ScriptBundle { QString(bundle), match.DependsOnPath });
     }
 
-    return QString(resultBuffer);
+    if (std::none_of(pathDependentScripts.begin(), pathDependentScripts.end(), appliesToFrame))
+        return it->Bundle;
+
+    // Scripts are injected in the order they were installed, so the bundle is built again when a script that
+    // depends on the path applies to the URL
+    QByteArray bundle;
+    for (int scriptIndex : match.Scripts)
+    {
+        if (appliesToFrame(scriptIndex))
+            appendToBundle(bundle, scriptIndex);
+    }
+    return QString(bundle);
 }
 
 std::vector<QWebEngineScript> UserScriptManager::getAllScriptsFor(const QUrl &url)
@@ -87,43 +108,58 @@ std::vector<QWebEngineScript> UserScriptManager::getAllScriptsFor(const QUrl &ur
     if (!m_model->m_enabled)
         return result;
 
-    QString urlStr = url.toString(QUrl::FullyEncoded);
-    for (const UserScript &script : m_model->m_scripts)
-    {
-        if (!script.m_isEnabled)
-            continue;
+    updateMatcher();
 
-        bool isExclude = false, isInclude = false;
-        for (const QRegularExpression &expr : script.m_excludes)
-        {
-            if (expr.match(urlStr).hasMatch())
-            {
-                isExclude = true;
-                break;
-            }
-        }
+    const QString origin = UserScriptMatcher::getOrigin(url);
+    auto it = m_webEngineScripts.find(origin);
+    if (it != m_webEngineScripts.end() && !it->DependsOnPath)
+        return it->Scripts;
 
-        if (isExclude)
-            continue;
+    auto isEnabled = [this](int scriptIndex) {
+        return m_model->m_scripts.at(scriptIndex).m_isEnabled;
+    };
+    auto getScript = [this](int scriptIndex) {
+        WebEngineScriptAdapter scriptAdapter(m_model->m_scripts.at(scriptIndex));
+        return scriptAdapter.getScript();
+    };
 
-        for (const QRegularExpression &expr : script.m_includes)
-        {
-            if (expr.match(urlStr).hasMatch())
-            {
-                isInclude = true;
-                break;
-            }
-        }
+    const UserScriptMatcher::Result match = m_matcher.match(url);
+    const std::vector<int> &pathDependentScripts = match.PathDependentScripts;
 
-        if (isInclude)
+    if (it == m_webEngineScripts.end())
+    {
+        std::vector<QWebEngineScript> scripts;
+        for (int scriptIndex : match.Scripts)
         {
-            WebEngineScriptAdapter scriptAdapter(script);
-            result.push_back(scriptAdapter.getScript());
+            if (isEnabled(scriptIndex)
+                    && !std::binary_search(pathDependentScripts.begin(), pathDependentScripts.end(), scriptIndex))
+                scripts.push_back(getScript(scriptIndex));
         }
+
+        if (m_webEngineScripts.size() >= MaxCachedBundles)
+            m_webEngineScripts.clear();
+        it = m_webEngineScripts.insert(origin, WebEngineScripts { std::move(scripts), match.DependsOnPath });
+    }
+
+    if (std::none_of(pathDependentScripts.begin(), pathDependentScripts.end(), isEnabled))
+        return it->Scripts;
+
+    for (int scriptIndex : match.Scripts)
+    {
+        if (isEnabled(scriptIndex))
+            result.push_back(getScript(scriptIndex));
     }
     return result;
 }
 
+void UserScriptManager::appendToBundle(QByteArray &bundle, int scriptIndex) const
+{
+    const UserScript &script = m_model->m_scripts.at(scriptIndex);
+    bundle.append(script.m_dependencyData);
+    bundle.append('\n');
+    bundle.append(script.m_scriptData.toUtf8());
+}
+
 void UserScriptManager::installScript(const QUrl &url)
 {
     if (!url.isValid() || !m_downloadManager)
@@ -186,3 +222,26 @@ void UserScriptManager::onSettingChanged(BrowserSetting setting, const QVariant
     if (setting == BrowserSetting::UserScriptsEnabled)
         setEnabled(value.toBool());
 }
+
+void UserScriptManager::onScriptsChanged()
+{
+    m_isMatcherStale = true;
+}
+
+void UserScriptManager::updateMatcher()
+{
+    if (!m_isMatcherStale)
+        return;
+
+    m_isMatcherStale = false;
+    m_scriptBundles.clear();
+    m_webEngineScripts.clear();
+
+    m_matcher.clear();
+    const int numScripts = static_cast<int>(m_model->m_scripts.size());
+    for (int i = 0; i < numScripts; ++i)
+    {
+        const UserScript &script = m_model->m_scripts.at(i);
+        m_matcher.addScript(i, script.m_includeRules, script.m_excludeRules, script.m_matchRules);
+    }
+}
@@ -5,9 +5,12 @@
 #include "ISettingsObserver.h"
 
 #include "UserScript.h"
+#include "UserScriptMatcher.h"
 
 #include <memory>
 #include <vector>
+#include <QByteArray>
+#include <QHash>
 #include <QObject>
 #include <QString>
 #include <QUrl>
@@ -19,6 +22,11 @@ class UserScriptModel;
 /**
  * @class UserScriptManager
  * @brief Manages a collection of GreaseMonkey-style user scripts
+ *
+ * The rules of the scripts are compiled into a \ref UserScriptMatcher. The bundle of the scripts that apply to every
+ * URL of an origin is cached by origin, while the scripts whose rules depend on the path, such as regular expressions,
+ * are matched against each URL and only added to the bundle when they apply. The matcher and the cached bundles are
+ * rebuilt after any change to the scripts.
  */
 class UserScriptManager : public QObject, public ISettingsObserver
 {
@@ -78,12 +86,54 @@ private Q_SLOTS:
     /// Listens for any settings changes that affect the user script system
     void onSettingChanged(BrowserSetting setting, const QVariant &value) override;
 
+    /// Called when scripts were added, removed, reloaded, enabled or disabled
+    void onScriptsChanged();
+
 private:
+    /// Recompiles the rules of the scripts and drops the cached bundles, if the scripts changed since the last lookup
+    void updateMatcher();
+
+    /// Appends the dependencies and the source of the script with the given index to a bundle
+    void appendToBundle(QByteArray &bundle, int scriptIndex) const;
+
+private:
+    /// Concatenated scripts that apply to every URL of an origin
+    struct ScriptBundle
+    {
+        /// Concatenated scripts
+        QString Bundle;
+
+        /// True if the scripts of some URLs of the origin must be matched against their path as well
+        bool DependsOnPath;
+    };
+
+    /// Web engine scripts that apply to every URL of an origin
+    struct WebEngineScripts
+    {
+        /// Web engine scripts
+        std::vector<QWebEngineScript> Scripts;
+
+        /// True if the scripts of some URLs of the origin must be matched against their path as well
+        bool DependsOnPath;
+    };
+
     /// Network download manager
     DownloadManager *m_downloadManager;
 
     /// Pointer to the user scripts model
     UserScriptModel *m_model;
+
+    /// Index of the rules of the scripts
+    UserScriptMatcher m_matcher;
+
+    /// True if the scripts changed since the matcher was last built
+    bool m_isMatcherStale;
+
+    /// Concatenated scripts that apply to every URL of an origin, by origin, injection time and frame type
+    QHash<QString, ScriptBundle> m_scriptBundles;
+
+    /// Web engine scripts that apply to every URL of an origin, by origin
+    QHash<QString, WebEngineScripts> m_webEngineScripts;
 };
 
 #endif // USERSCRIPTMANAGER_H
@@ -0,0 +1,409 @@
+#include "CommonUtil.h"
+#include "UserScriptMatcher.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace
+{
+    /// Largest number of origins whose rules are cached at once
+    constexpr int MaxCachedOrigins = 256;
+
+    /// Flags of the schemes that a rule applies to
+    enum SchemeFlag
+    {
+        HttpScheme  = 0x01,
+        HttpsScheme = 0x02,
+        FtpScheme   = 0x04,
+        FileScheme  = 0x08,
+        OtherScheme = 0x10,
+        AnyScheme   = 0x1F
+    };
+
+    /// States of a script during a lookup
+    enum ScriptState : char
+    {
+        NotMatched = 0,
+        Included   = 1,
+        Excluded   = 2
+    };
+
+    /// Returns the flag of the given scheme
+    int getSchemeFlag(const QString &scheme)
+    {
+        if (scheme.compare(QLatin1String("http"), Qt::CaseInsensitive) == 0)
+            return HttpScheme;
+        if (scheme.compare(QLatin1String("https"), Qt::CaseInsensitive) == 0)
+            return HttpsScheme;
+        if (scheme.compare(QLatin1String("ftp"), Qt::CaseInsensitive) == 0)
+            return FtpScheme;
+        if (scheme.compare(QLatin1String("file"), Qt::CaseInsensitive) == 0)
+            return FileScheme;
+        return OtherScheme;
+    }
+
+    /// Converts the path of a glob into a regular expression anchored at the start of the path
+    QString getPathExpression(const QString &path)
+    {
+        QString converted = QRegularExpression::escape(path);
+        converted.replace(QLatin1String("\\*"), QLatin1String(".*"));
+        return converted.prepend(QLatin1Char('^'));
+    }
+}
+
+UserScriptMatcher::UserScriptMatcher() :
+    m_rules(),
+    m_exactHosts(),
+    m_domainSuffixes(),
+    m_catchAll(),
+    m_residue(),
+    m_originRules(),
+    m_numScripts(0)
+{
+}
+
+void UserScriptMatcher::clear()
+{
+    m_rules.clear();
+    m_exactHosts.clear();
+    m_domainSuffixes.clear();
+    m_catchAll.clear();
+    m_residue.clear();
+    m_originRules.clear();
+    m_numScripts = 0;
+}
+
+void UserScriptMatcher::addScript(int scriptIndex, const std::vector<QString> &includes, const std::vector<QString> &excludes, const std::vector<QString> &matches)
+{
+    if (scriptIndex < 0)
+        return;
+
+    m_numScripts = std::max(m_numScripts, scriptIndex + 1);
+    m_originRules.clear();
+
+    auto makeRule = [scriptIndex](bool isExclude) {
+        return Rule { scriptIndex, isExclude, AnyScheme, false, true, QRegularExpression() };
+    };
+
+    QString host;
+    for (const QString &include : includes)
+    {
+        Rule rule = makeRule(false);
+        const Bucket bucket = compileGlob(include, rule, host);
+        addRule(std::move(rule), bucket, host);
+    }
+
+    for (const QString &pattern : matches)
+    {
+        Rule rule = makeRule(false);
+        const Bucket bucket = compileMatchPattern(pattern, rule, host);
+        addRule(std::move(rule), bucket, host);
+    }
+
+    if (includes.empty() && matches.empty())
+        addRule(makeRule(false), Bucket::CatchAll, QString());
+
+    for (const QString &exclude : excludes)
+    {
+        Rule rule = makeRule(true);
+        const Bucket bucket = compileGlob(exclude, rule, host);
+        addRule(std::move(rule), bucket, host);
+    }
+}
+
+UserScriptMatcher::Result UserScriptMatcher::match(const QUrl &url)
+{
+    Result result { std::vector<int>(), std::vector<int>(), false };
+    if (m_rules.empty())
+        return result;
+
+    const OriginRules &originRules = getOriginRules(url);
+    result.DependsOnPath = !originRules.PathDependentScripts.empty();
+
+    // The path and the URL are only needed when some rule cannot be decided from the origin alone
+    QString path, urlString;
+    if (result.DependsOnPath)
+    {
+        path = url.toString(QUrl::FullyEncoded | QUrl::RemoveScheme | QUrl::RemoveAuthority | QUrl::RemoveFragment);
+        if (!path.startsWith(QLatin1Char('/')))
+            path.prepend(QLatin1Char('/'));
+
+        if (!m_residue.empty())
+            urlString = url.toString(QUrl::FullyEncoded);
+    }
+
+    // The @exclude rules are only evaluated for the scripts that one of their other rules included
+    std::vector<char> states(static_cast<std::size_t>(m_numScripts), NotMatched);
+    auto applyRules = [this, &states](const std::vector<std::size_t> &ruleIndices, const QString &subject, bool isExcludePass) {
+        const char expectedState = isExcludePass ? Included : NotMatched;
+        for (std::size_t ruleIndex : ruleIndices)
+        {
+            const Rule &rule = m_rules.at(ruleIndex);
+            char &state = states[static_cast<std::size_t>(rule.ScriptIndex)];
+            if (rule.IsExclude != isExcludePass || state != expectedState)
+                continue;
+
+            if (matches(rule, subject))
+                state = isExcludePass ? Excluded : Included;
+        }
+    };
+
+    applyRules(originRules.Rules, path, false);
+    applyRules(m_residue, urlString, false);
+    applyRules(originRules.Rules, path, true);
+    applyRules(m_residue, urlString, true);
+
+    const std::vector<int> &pathDependentScripts = originRules.PathDependentScripts;
+    for (int i = 0; i < m_numScripts; ++i)
+    {
+        if (states[static_cast<std::size_t>(i)] != Included)
+            continue;
+
+        result.Scripts.push_back(i);
+        if (std::binary_search(pathDependentScripts.begin(), pathDependentScripts.end(), i))
+            result.PathDependentScripts.push_back(i);
+    }
+
+    return result;
+}
+
+std::size_t UserScriptMatcher::getResidueSize() const
+{
+    return m_residue.size();
+}
+
+QString UserScriptMatcher::getOrigin(const QUrl &url)
+{
+    return url.adjusted(QUrl::RemoveUserInfo | QUrl::RemovePath | QUrl::RemoveQuery | QUrl::RemoveFragment).toString(QUrl::FullyEncoded);
+}
+
+QRegularExpression UserScriptMatcher::getRegExpForGlob(const QString &str)
+{
+    // Check if string is either a single '*' or empty, and if so, set regular expression to match everything
+    if (str.isEmpty() || (str.size() == 1 && str.at(0) == '*'))
+        return QRegularExpression(QStringLiteral(".*"));
+
+    QString converted;
+
+    // Check if rule is a regular expression
+    if (str.startsWith('/') && str.endsWith('/'))
+    {
+        converted = str.mid(1, str.size() - 2);
+        return QRegularExpression(converted);
+    }
+
+    // If the method has not returned at this point, replace each occurrence of a "*" with a ".*"
+    converted = str;
+    converted.replace(QStringLiteral("*"), QStringLiteral(".*"));
+    return QRegularExpression(converted);
+}
+
+UserScriptMatcher::Bucket UserScriptMatcher::compileGlob(const QString &glob, Rule &rule, QString &host) const
+{
+    // A single '*' or an empty rule matches everything
+    if (glob.isEmpty() || glob.compare(QLatin1String("*")) == 0)
+        return Bucket::CatchAll;
+
+    rule.MatchesAnyPath = false;
+    rule.Expression = getRegExpForGlob(glob);
+
+    // Regular expressions, and globs that do not start with a scheme, are left to the residue
+    const int schemeEnd = glob.indexOf(QLatin1String("://"));
+    if (glob.startsWith(QLatin1Char('/')) || schemeEnd <= 0)
+        return Bucket::Residue;
+
+    const QString scheme = glob.left(schemeEnd);
+    if (scheme.compare(QLatin1String("http*"), Qt::CaseInsensitive) == 0)
+        rule.Schemes = HttpScheme | HttpsScheme;
+    else if (scheme.compare(QLatin1String("*")) != 0)
+    {
+        rule.Schemes = getSchemeFlag(scheme);
+        if (rule.Schemes == OtherScheme)
+            return Bucket::Residue;
+    }
+
+    const int hostStart = schemeEnd + 3;
+    const int pathStart = glob.indexOf(QLatin1Char('/'), hostStart);
+    if (pathStart < 0)
+    {
+        // "http://*" applies to every host and path of its scheme
+        if (glob.size() == hostStart + 1 && glob.at(hostStart) == QLatin1Char('*'))
+        {
+            rule.MatchesAnyPath = true;
+            return Bucket::CatchAll;
+        }
+        return Bucket::Residue;
+    }
+
+    host = glob.mid(hostStart, pathStart - hostStart).toLower();
+    const Bucket bucket = getHostBucket(host);
+    if (bucket == Bucket::Residue)
+        return bucket;
+
+    // The expression of a glob is not anchored at its end, so the path of the rule is a prefix of the paths it applies to
+    const QString path = glob.mid(pathStart);
+    rule.MatchesAnyPath = path.compare(QLatin1String("/*")) == 0;
+    if (!rule.MatchesAnyPath)
+        rule.Expression = QRegularExpression(getPathExpression(path));
+
+    return bucket;
+}
+
+UserScriptMatcher::Bucket UserScriptMatcher::compileMatchPattern(const QString &pattern, Rule &rule, QString &host) const
+{
+    rule.Schemes = HttpScheme | HttpsScheme | FtpScheme | FileScheme;
+    rule.IncludesParentDomain = true;
+
+    if (pattern.compare(QLatin1String("<all_urls>")) == 0)
+        return Bucket::CatchAll;
+
+    rule.MatchesAnyPath = false;
+    rule.Expression = CommonUtil::getRegExpForMatchPattern(pattern);
+
+    const int schemeEnd = pattern.indexOf(QLatin1String("://"));
+    if (schemeEnd <= 0)
+        return Bucket::Residue;
+
+    const QString scheme = pattern.left(schemeEnd);
+    if (scheme.compare(QLatin1String("*")) == 0)
+        rule.Schemes = HttpScheme | HttpsScheme;
+    else
+    {
+        rule.Schemes = getSchemeFlag(scheme);
+        if (rule.Schemes == OtherScheme)
+            return Bucket::Residue;
+    }
+
+    const int hostStart = schemeEnd + 3;
+    const int pathStart = pattern.indexOf(QLatin1Char('/'), hostStart);
+    if (pathStart < 0)
+        return Bucket::Residue;
+
+    host = pattern.mid(hostStart, pathStart - hostStart).toLower();
+    const Bucket bucket = getHostBucket(host);
+    if (bucket == Bucket::Residue)
+        return bucket;
+
+    // The path of a match pattern must match the whole path of the URL
+    const QString path = pattern.mid(pathStart);
+    rule.MatchesAnyPath = path.compare(QLatin1String("/*")) == 0;
+    if (!rule.MatchesAnyPath)
+        rule.Expression = QRegularExpression(getPathExpression(path).append(QLatin1Char('$')));
+
+    return bucket;
+}
+
+UserScriptMatcher::Bucket UserScriptMatcher::getHostBucket(QString &host)
+{
+    if (host.compare(QLatin1String("*")) == 0)
+        return Bucket::CatchAll;
+
+    // Ports and user information cannot be told from the host of a URL alone
+    for (const QChar c : { QLatin1Char(':'), QLatin1Char('@'), QLatin1Char('?'), QLatin1Char('#') })
+    {
+        if (host.contains(c))
+            return Bucket::Residue;
+    }
+
+    if (host.size() > 2 && host.startsWith(QLatin1String("*.")) && host.indexOf(QLatin1Char('*'), 1) < 0)
+    {
+        host = host.mid(2);
+        return Bucket::DomainSuffix;
+    }
+
+    if (host.contains(QLatin1Char('*')))
+        return Bucket::Residue;
+
+    return Bucket::Exact;
+}
+
+void UserScriptMatcher::addRule(Rule &&rule, Bucket bucket, const QString &host)
+{
+    const std::size_t ruleIndex = m_rules.size();
+    m_rules.push_back(std::move(rule));
+
+    switch (bucket)
+    {
+        case Bucket::Exact:
+            m_exactHosts[host].push_back(ruleIndex);
+            break;
+        case Bucket::DomainSuffix:
+            m_domainSuffixes[host].push_back(ruleIndex);
+            break;
+        case Bucket::CatchAll:
+            m_catchAll.push_back(ruleIndex);
+            break;
+        case Bucket::Residue:
+            m_residue.push_back(ruleIndex);
+            break;
+    }
+}
+
+const UserScriptMatcher::OriginRules &UserScriptMatcher::getOriginRules(const QUrl &url)
+{
+    const QString origin = getOrigin(url);
+    auto it = m_originRules.find(origin);
+    if (it != m_originRules.end())
+        return it.value();
+
+    if (m_originRules.size() >= MaxCachedOrigins)
+        m_originRules.clear();
+
+    const int scheme = getSchemeFlag(url.scheme());
+    const QString host = url.host(QUrl::FullyEncoded).toLower();
+
+    OriginRules originRules { std::vector<std::size_t>(), std::vector<int>() };
+    auto addRules = [this, scheme, &originRules](const std::vector<std::size_t> &ruleIndices, bool isDomainItself) {
+        for (std::size_t ruleIndex : ruleIndices)
+        {
+            const Rule &rule = m_rules.at(ruleIndex);
+            if ((rule.Schemes & scheme) == 0 || (isDomainItself && !rule.IncludesParentDomain))
+                continue;
+
+            originRules.Rules.push_back(ruleIndex);
+            if (!rule.MatchesAnyPath)
+                originRules.PathDependentScripts.push_back(rule.ScriptIndex);
+        }
+    };
+
+    // Rules of the residue are matched against the whole URL, so only their own scripts depend on it
+    for (std::size_t ruleIndex : m_residue)
+        originRules.PathDependentScripts.push_back(m_rules.at(ruleIndex).ScriptIndex);
+
+    addRules(m_catchAll, false);
+
+    // Rules naming a host do not name a port, and so do not apply to URLs with an explicit port
+    if (url.port() < 0)
+    {
+        auto exactIt = m_exactHosts.find(host);
+        if (exactIt != m_exactHosts.end())
+            addRules(exactIt.value(), false);
+
+        // Look up the host itself, then each of its parent domains
+        QString domain = host;
+        int dotPos = -1;
+        while (true)
+        {
+            auto suffixIt = m_domainSuffixes.find(domain);
+            if (suffixIt != m_domainSuffixes.end())
+                addRules(suffixIt.value(), dotPos < 0);
+
+            dotPos = host.indexOf(QLatin1Char('.'), dotPos + 1);
+            if (dotPos < 0)
+                break;
+
+            domain = host.mid(dotPos + 1);
+        }
+    }
+
+    std::vector<int> &pathDependentScripts = originRules.PathDependentScripts;
+    std::sort(pathDependentScripts.begin(), pathDependentScripts.end());
+    pathDependentScripts.erase(std::unique(pathDependentScripts.begin(), pathDependentScripts.end()), pathDependentScripts.end());
+
+    return m_originRules.insert(origin, std::move(originRules)).value();
+}
+
+bool UserScriptMatcher::matches(const Rule &rule, const QString &subject) const
+{
+    return rule.MatchesAnyPath || rule.Expression.match(subject).hasMatch();
+}
@@ -0,0 +1,147 @@
+#ifndef USERSCRIPTMATCHER_H
+#define USERSCRIPTMATCHER_H
+
+#include <cstddef>
+#include <vector>
+
+#include <QHash>
+#include <QRegularExpression>
+#include <QString>
+#include <QUrl>
+
+/**
+ * @class UserScriptMatcher
+ * @brief Finds the user scripts whose @include, @exclude and @match rules apply to a URL
+ *
+ * Rules are compiled into an index keyed by host. Rules naming a single host go in the exact bucket, rules of the
+ * form *.example.com go in the wildcard suffix bucket, and rules that apply to any host go in the catch-all bucket.
+ * A lookup only visits the rules of the host of the URL, of each of its parent domains and of the catch-all bucket,
+ * and only evaluates a regular expression when the path of a rule is narrower than "/*". Rules whose host cannot be
+ * told from the pattern, such as regular expressions, form the residue and are evaluated against the whole URL.
+ *
+ * The rules that apply to each origin are cached until the matcher is cleared. Each lookup tells which of the scripts
+ * it found depend on more than the origin of the URL, so that callers can cache the others by origin.
+ */
+class UserScriptMatcher
+{
+public:
+    /// Scripts that apply to a URL
+    struct Result
+    {
+        /// Indices of the scripts, in ascending order
+        std::vector<int> Scripts;
+
+        /// Indices of the scripts that apply to this URL but not necessarily to every URL of the same origin,
+        /// in ascending order. The other scripts apply to every URL of the origin
+        std::vector<int> PathDependentScripts;
+
+        /// False if every URL of the same origin yields the same scripts, true if the path must be matched as well
+        bool DependsOnPath;
+    };
+
+    /// Constructs an empty matcher
+    UserScriptMatcher();
+
+    /// Removes every rule
+    void clear();
+
+    /// Compiles the rules of the script with the given index. A script without @include nor @match rules applies to every URL
+    void addScript(int scriptIndex, const std::vector<QString> &includes, const std::vector<QString> &excludes, const std::vector<QString> &matches);
+
+    /// Returns the scripts that apply to the given URL
+    Result match(const QUrl &url);
+
+    /// Returns the number of rules that are evaluated against every URL, as regular expressions
+    std::size_t getResidueSize() const;
+
+    /// Returns the origin of the URL, which is the key of the per-origin caches
+    static QString getOrigin(const QUrl &url);
+
+    /// Converts an @include or @exclude rule into a regular expression, matched anywhere in the URL
+    static QRegularExpression getRegExpForGlob(const QString &str);
+
+private:
+    /// Bucket of the index in which a rule is stored
+    enum class Bucket
+    {
+        Exact,
+        DomainSuffix,
+        CatchAll,
+        Residue
+    };
+
+    /// A compiled rule
+    struct Rule
+    {
+        /// Index of the script that the rule belongs to
+        int ScriptIndex;
+
+        /// True if the rule is an @exclude rule
+        bool IsExclude;
+
+        /// Schemes that the rule applies to, as a combination of scheme flags
+        int Schemes;
+
+        /// True if a rule of the form *.example.com also applies to example.com
+        bool IncludesParentDomain;
+
+        /// True if the rule applies to any path
+        bool MatchesAnyPath;
+
+        /// Expression matched against the path of a URL, or against the whole URL for rules of the residue
+        QRegularExpression Expression;
+    };
+
+    /// Rules of the index that apply to an origin
+    struct OriginRules
+    {
+        /// Indices of the rules
+        std::vector<std::size_t> Rules;
+
+        /// Indices of the scripts that have rules, here or in the residue, which must be matched against more than
+        /// the origin, in ascending order
+        std::vector<int> PathDependentScripts;
+    };
+
+    /// Compiles an @include or @exclude rule, returning the bucket and the host under which it must be stored
+    Bucket compileGlob(const QString &glob, Rule &rule, QString &host) const;
+
+    /// Compiles a @match rule, returning the bucket and the host under which it must be stored
+    Bucket compileMatchPattern(const QString &pattern, Rule &rule, QString &host) const;
+
+    /// Returns the bucket of a rule given the host of its pattern, removing the leading "*." of wildcard suffixes
+    static Bucket getHostBucket(QString &host);
+
+    /// Stores the rule in the given bucket
+    void addRule(Rule &&rule, Bucket bucket, const QString &host);
+
+    /// Returns the rules of the index that apply to the origin of the URL, computing them on first use
+    const OriginRules &getOriginRules(const QUrl &url);
+
+    /// Returns true if the rule applies to the given path, or to the given URL for rules of the residue
+    bool matches(const Rule &rule, const QString &subject) const;
+
+private:
+    /// Compiled rules
+    std::vector<Rule> m_rules;
+
+    /// Indices of the rules that apply to a single host, by host
+    QHash<QString, std::vector<std::size_t>> m_exactHosts;
+
+    /// Indices of the rules that apply to the subdomains of a domain, by domain
+    QHash<QString, std::vector<std::size_t>> m_domainSuffixes;
+
+    /// Indices of the rules that apply to any host
+    std::vector<std::size_t> m_catchAll;
+
+    /// Indices of the rules that are evaluated against the whole URL
+    std::vector<std::size_t> m_residue;
+
+    /// Rules that apply to each origin that was looked up since the matcher was last cleared
+    QHash<QString, OriginRules> m_originRules;
+
+    /// One more than the highest script index
+    int m_numScripts;
+};
+
+#endif // USERSCRIPTMATCHER_H
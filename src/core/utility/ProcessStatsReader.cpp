@@ -0,0 +1,113 @@
+#include "ProcessStatsReader.h"
+
+#include <QByteArray>
+#include <QFile>
+#include <QList>
+#include <QtGlobal>
+
+#if defined(Q_OS_UNIX)
+#include <unistd.h>
+#endif
+
+namespace
+{
+    /// Returns the contents of a small file, or an empty array if it cannot be read
+    QByteArray readFile(const QString &fileName)
+    {
+        QFile file(fileName);
+        if (!file.open(QIODevice::ReadOnly))
+            return QByteArray();
+
+        // Files of the proc filesystem report a size of zero, and must be read until the end
+        return file.readAll();
+    }
+}
+
+ProcessStatsReader::ProcessStatsReader(const QString &procPath) :
+    m_procPath(procPath),
+    m_pageSizeKiB(4),
+    m_ticksPerSecond(100)
+{
+#if defined(Q_OS_UNIX)
+    const long pageSize = sysconf(_SC_PAGESIZE);
+    if (pageSize > 0)
+        m_pageSizeKiB = pageSize / 1024;
+
+    const long ticksPerSecond = sysconf(_SC_CLK_TCK);
+    if (ticksPerSecond > 0)
+        m_ticksPerSecond = ticksPerSecond;
+#endif
+}
+
+ProcessStats ProcessStatsReader::read(int64_t pid, bool withProportionalMemory) const
+{
+    ProcessStats stats { -1, -1, -1 };
+    if (pid <= 0)
+        return stats;
+
+    const QString processPath = QStringLiteral("%1/%2/").arg(m_procPath).arg(pid);
+    stats.ResidentKiB = readResidentMemory(processPath);
+    stats.CpuTicks = readCpuTicks(processPath);
+    if (withProportionalMemory)
+        stats.ProportionalKiB = readProportionalMemory(processPath);
+    return stats;
+}
+
+int64_t ProcessStatsReader::getPageSizeKiB() const
+{
+    return m_pageSizeKiB;
+}
+
+int64_t ProcessStatsReader::getTicksPerSecond() const
+{
+    return m_ticksPerSecond;
+}
+
+int64_t ProcessStatsReader::readResidentMemory(const QString &processPath) const
+{
+    // statm holds the total program size, followed by the resident set size, in pages
+    const QList<QByteArray> fields = readFile(processPath + QStringLiteral("statm")).split(' ');
+    if (fields.size() < 2)
+        return -1;
+
+    bool ok = false;
+    const int64_t residentPages = fields.at(1).toLongLong(&ok);
+    return ok ? residentPages * m_pageSizeKiB : -1;
+}
+
+int64_t ProcessStatsReader::readProportionalMemory(const QString &processPath) const
+{
+    // Lines are of the form "Pss:                6543 kB"
+    const QByteArray contents = readFile(processPath + QStringLiteral("smaps_rollup"));
+    const int pssIndex = contents.indexOf("\nPss:");
+    if (pssIndex < 0)
+        return -1;
+
+    const int lineEnd = contents.indexOf('\n', pssIndex + 1);
+    const QList<QByteArray> fields = contents.mid(pssIndex + 1, lineEnd < 0 ? -1 : lineEnd - pssIndex - 1).simplified().split(' ');
+    if (fields.size() < 2)
+        return -1;
+
+    bool ok = false;
+    const int64_t pss = fields.at(1).toLongLong(&ok);
+    return ok ? pss : -1;
+}
+
+int64_t ProcessStatsReader::readCpuTicks(const QString &processPath) const
+{
+    // The name of the process is enclosed in parentheses and may contain spaces, so the fields are counted from
+    // the last closing parenthesis. utime and stime are the 14th and 15th fields, the 12th and 13th after the name
+    const QByteArray contents = readFile(processPath + QStringLiteral("stat"));
+    const int nameEnd = contents.lastIndexOf(')');
+    if (nameEnd < 0)
+        return -1;
+
+    const QList<QByteArray> fields = contents.mid(nameEnd + 1).simplified().split(' ');
+    if (fields.size() < 13)
+        return -1;
+
+    bool userOk = false, systemOk = false;
+    const int64_t userTicks = fields.at(11).toLongLong(&userOk);
+    const int64_t systemTicks = fields.at(12).toLongLong(&systemOk);
+    return userOk && systemOk ? userTicks + systemTicks : -1;
+}
@@ -0,0 +1,67 @@
+#ifndef PROCESSSTATSREADER_H
+#define PROCESSSTATSREADER_H
+
+#include <cstdint>
+
+#include <QString>
+
+/// Memory and CPU usage of a process. Values that could not be read are negative
+struct ProcessStats
+{
+    /// Resident set size, in kibibytes
+    int64_t ResidentKiB;
+
+    /// Proportional set size, in kibibytes. Pages shared with other processes are divided between them
+    int64_t ProportionalKiB;
+
+    /// Time the process has been scheduled in user and kernel mode, in clock ticks
+    int64_t CpuTicks;
+};
+
+/**
+ * @class ProcessStatsReader
+ * @brief Reads the memory and CPU usage of processes from the proc filesystem
+ *
+ * The resident set size is read from /proc/<pid>/statm, the proportional set size from /proc/<pid>/smaps_rollup
+ * and the CPU time from /proc/<pid>/stat. Each of these files is small, but the kernel has to walk the memory
+ * mappings of the process to produce smaps_rollup, so the proportional set size is only read on request.
+ * Nothing can be read on systems without a proc filesystem.
+ */
+class ProcessStatsReader
+{
+public:
+    /// Constructs a reader of the proc filesystem mounted at the given path
+    explicit ProcessStatsReader(const QString &procPath = QStringLiteral("/proc"));
+
+    /// Returns the usage of the process with the given identifier. The proportional set size is only read if
+    /// withProportionalMemory is true
+    ProcessStats read(int64_t pid, bool withProportionalMemory) const;
+
+    /// Returns the size of a memory page, in kibibytes
+    int64_t getPageSizeKiB() const;
+
+    /// Returns the number of clock ticks per second, in which CPU times are measured
+    int64_t getTicksPerSecond() const;
+
+private:
+    /// Returns the resident set size of a process in kibibytes, from its statm file
+    int64_t readResidentMemory(const QString &processPath) const;
+
+    /// Returns the proportional set size of a process in kibibytes, from its smaps_rollup file
+    int64_t readProportionalMemory(const QString &processPath) const;
+
+    /// Returns the CPU time of a process in clock ticks, from its stat file
+    int64_t readCpuTicks(const QString &processPath) const;
+
+private:
+    /// Mount point of the proc filesystem
+    QString m_procPath;
+
+    /// Size of a memory page, in kibibytes
+    int64_t m_pageSizeKiB;
+
+    /// Number of clock ticks per second
+    int64_t m_ticksPerSecond;
+};
+
+#endif // PROCESSSTATSREADER_H
@@ -1,8 +1,15 @@
 #ifndef SERVICELOCATOR_H
 #define SERVICELOCATOR_H
 
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <type_traits>
 #include <unordered_map>
+#include <vector>
 
 class QObject;
 
@@ -12,6 +19,13 @@ class QObject;
  *        This class does not own any of the services stored in its registry.
  *        For QObject-derived types, this would be instantiated with
  *        KeyType = QString, BaseServiceType = QObject
+ *
+ * Services can either be registered as instances with \ref addService, or as factories with
+ * \ref addFactory, in which case the service is only constructed the first time it is looked up.
+ * Registration and lookup may be performed from any thread. A factory is invoked once, even when
+ * several threads look up its service at the same time, and must not look up its own service.
+ * A factory may refuse to construct its service by returning a nullptr, in which case the lookup
+ * fails and the factory is invoked again by the next lookup.
  */
 template <class KeyType, class BaseServiceType>
 class ServiceLocator
@@ -24,8 +38,36 @@ class ServiceLocator
     ServiceLocator &operator=(const ServiceLocator&) = delete;
 
 public:
+    /// Constructs a service
+    using Factory = std::function<BaseServiceType*()>;
+
+    /// Describes when and how a registered service was created
+    struct CreationRecord
+    {
+        /// Unique identifier of the service
+        KeyType Key;
+
+        /// True if the service was registered with a factory
+        bool IsLazy;
+
+        /// True if the service has been created. Always true for services that were not registered with a factory
+        bool IsCreated;
+
+        /// Time at which the service was created or registered, relative to the construction of the locator
+        std::chrono::microseconds CreatedAt;
+
+        /// Time spent in the factory of the service, or zero if the service was not registered with a factory
+        std::chrono::microseconds Duration;
+    };
+
     /// Default constructor
-    ServiceLocator() = default;
+    ServiceLocator() :
+        m_entries(),
+        m_registrationOrder(),
+        m_mutex(),
+        m_createdAt(std::chrono::steady_clock::now())
+    {
+    }
 
     /// Default destructor
     ~ServiceLocator() = default;
@@ -34,30 +76,91 @@ class ServiceLocator
      * @brief addService Attempts to add the given service to the registry.
      * @param key Unique identifier of the service
      * @param service Pointer to the service.
-     * @return
+     * @return True on success, false if a service or factory with the same key has already been registered
      */
     bool addService(const KeyType &key, BaseServiceType *service)
     {
-        auto it = m_serviceMap.find(key);
-        if (it != m_serviceMap.end())
+        std::lock_guard<std::mutex> lock{m_mutex};
+
+        auto it = m_entries.find(key);
+        if (it != m_entries.end())
             return false;
 
-        m_serviceMap[key] = service;
+        std::unique_ptr<Entry> entry = std::make_unique<Entry>();
+        entry->Service.store(service);
+        entry->IsLazy = false;
+        entry->CreatedAt = getElapsedTime();
+        entry->Duration = std::chrono::microseconds(0);
+
+        m_entries[key] = std::move(entry);
+        m_registrationOrder.push_back(key);
         return true;
     }
 
     /**
-     * @brief getService Looks for and attempts to return a service with the given identifier.
+     * @brief addFactory Attempts to add a service to the registry, which will be constructed by the
+     *        given factory the first time it is looked up.
+     * @param key Unique identifier of the service
+     * @param factory Constructs the service. It is invoked on the thread of the first lookup.
+     * @return True on success, false if a service or factory with the same key has already been registered
+     */
+    bool addFactory(const KeyType &key, Factory &&factory)
+    {
+        std::lock_guard<std::mutex> lock{m_mutex};
+
+        auto it = m_entries.find(key);
+        if (it != m_entries.end() || !factory)
+            return false;
+
+        std::unique_ptr<Entry> entry = std::make_unique<Entry>();
+        entry->Construction = std::move(factory);
+        entry->IsLazy = true;
+
+        m_entries[key] = std::move(entry);
+        m_registrationOrder.push_back(key);
+        return true;
+    }
+
+    /**
+     * @brief getService Looks for and attempts to return a service with the given identifier,
+     *        constructing it first if it was registered with a factory.
      * @param key Unique identifier of the service
      * @return Pointer to the service if found, or a nullptr if not found
      */
     BaseServiceType *getService(const KeyType &key) const
     {
-        const auto it = m_serviceMap.find(key);
-        if (it == m_serviceMap.end())
+        Entry *entry = nullptr;
+        {
+            std::lock_guard<std::mutex> lock{m_mutex};
+            const auto it = m_entries.find(key);
+            if (it == m_entries.end())
+                return nullptr;
+
+            entry = it->second.get();
+        }
+
+        if (BaseServiceType *service = entry->Service.load(std::memory_order_acquire))
+            return service;
+
+        if (!entry->IsLazy)
             return nullptr;
 
-        return it->second;
+        // The factory is invoked without holding the registry lock, so that it can look up the services it depends on
+        std::lock_guard<std::mutex> constructionLock{entry->ConstructionMutex};
+        if (BaseServiceType *service = entry->Service.load(std::memory_order_acquire))
+            return service;
+
+        const std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+        BaseServiceType *service = entry->Construction();
+        const std::chrono::steady_clock::time_point endTime = std::chrono::steady_clock::now();
+        if (service == nullptr)
+            return nullptr;
+
+        std::lock_guard<std::mutex> lock{m_mutex};
+        entry->CreatedAt = std::chrono::duration_cast<std::chrono::microseconds>(startTime - m_createdAt);
+        entry->Duration = std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime);
+        entry->Service.store(service, std::memory_order_release);
+        return service;
     }
 
     /**
@@ -76,8 +179,73 @@ class ServiceLocator
         return nullptr;
     }
 
+    /// Returns true if a service with the given identifier has been registered and, if it was registered
+    /// with a factory, constructed. Never constructs the service
+    bool isCreated(const KeyType &key) const
+    {
+        std::lock_guard<std::mutex> lock{m_mutex};
+
+        const auto it = m_entries.find(key);
+        return it != m_entries.end() && it->second->Service.load(std::memory_order_acquire) != nullptr;
+    }
+
+    /// Returns a record of every registered service, in the order they were registered
+    std::vector<CreationRecord> getCreationReport() const
+    {
+        std::lock_guard<std::mutex> lock{m_mutex};
+
+        std::vector<CreationRecord> report;
+        report.reserve(m_registrationOrder.size());
+        for (const KeyType &key : m_registrationOrder)
+        {
+            const Entry &entry = *m_entries.at(key);
+            const bool isCreated = entry.Service.load(std::memory_order_acquire) != nullptr;
+            report.push_back({ key, entry.IsLazy, isCreated, entry.CreatedAt, entry.Duration });
+        }
+        return report;
+    }
+
+private:
+    /// Registered service
+    struct Entry
+    {
+        /// Constructs the service, if it is lazily instantiated
+        Factory Construction;
+
+        /// Ensures the factory is only invoked by one lookup at a time
+        std::mutex ConstructionMutex;
+
+        /// The service, or a nullptr if it has not been constructed yet
+        std::atomic<BaseServiceType*> Service { nullptr };
+
+        /// True if the service was registered with a factory
+        bool IsLazy { false };
+
+        /// Time at which the service was created or registered, relative to the construction of the locator
+        std::chrono::microseconds CreatedAt { 0 };
+
+        /// Time spent in the factory
+        std::chrono::microseconds Duration { 0 };
+    };
+
+    /// Returns the time elapsed since the locator was constructed
+    std::chrono::microseconds getElapsedTime() const
+    {
+        return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - m_createdAt);
+    }
+
 private:
-    std::unordered_map<KeyType, BaseServiceType*> m_serviceMap;
+    /// Registered services by their identifier. Entries are never removed, so pointers to them remain valid
+    std::unordered_map<KeyType, std::unique_ptr<Entry>> m_entries;
+
+    /// Identifiers of the services in the order they were registered
+    std::vector<KeyType> m_registrationOrder;
+
+    /// Guards the registry and the creation times of the services
+    mutable std::mutex m_mutex;
+
+    /// Time at which the locator was constructed
+    std::chrono::steady_clock::time_point m_createdAt;
 };
 
 using ViperServiceLocator = ServiceLocator<std::string, QObject>;
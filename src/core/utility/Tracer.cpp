@@ -0,0 +1,239 @@
+#include "Tracer.h"
+
+#include <cstdio>
+#include <fstream>
+#include <utility>
+
+std::atomic_bool Tracer::s_enabled { false };
+
+namespace
+{
+    /// Writes the given string as a JSON string literal
+    void writeJsonString(std::ostream &stream, const std::string &value)
+    {
+        stream << '"';
+        for (char c : value)
+        {
+            switch (c)
+            {
+                case '"':  stream << "\\\""; break;
+                case '\\': stream << "\\\\"; break;
+                case '\n': stream << "\\n"; break;
+                case '\r': stream << "\\r"; break;
+                case '\t': stream << "\\t"; break;
+                default:
+                    if (static_cast<unsigned char>(c) < 0x20)
+                    {
+                        char escaped[8];
+                        std::snprintf(escaped, sizeof(escaped), "\\u%04x", static_cast<unsigned int>(c));
+                        stream << escaped;
+                    }
+                    else
+                        stream << c;
+                    break;
+            }
+        }
+        stream << '"';
+    }
+
+    /// The browser is traced as a single process
+    constexpr int TraceProcessId = 1;
+}
+
+Tracer &Tracer::instance()
+{
+    static Tracer tracer;
+    return tracer;
+}
+
+Tracer::Tracer() :
+    m_mutex(),
+    m_threadBuffers(),
+    m_outputFile(),
+    m_startTime(std::chrono::steady_clock::now().time_since_epoch().count())
+{
+}
+
+void Tracer::start(const std::string &outputFile)
+{
+    std::lock_guard<std::mutex> lock{m_mutex};
+    for (auto &buffer : m_threadBuffers)
+    {
+        std::lock_guard<std::mutex> bufferLock{buffer->Mutex};
+        buffer->Events.clear();
+    }
+
+    m_outputFile = outputFile;
+    m_startTime.store(std::chrono::steady_clock::now().time_since_epoch().count());
+    s_enabled.store(true);
+}
+
+bool Tracer::stop()
+{
+    if (!s_enabled.exchange(false))
+        return false;
+
+    std::string outputFile;
+    {
+        std::lock_guard<std::mutex> lock{m_mutex};
+        outputFile = m_outputFile;
+    }
+
+    std::ofstream stream(outputFile, std::ios::out | std::ios::trunc);
+    if (!stream.is_open())
+        return false;
+
+    write(stream);
+    return static_cast<bool>(stream);
+}
+
+void Tracer::write(std::ostream &stream) const
+{
+    std::lock_guard<std::mutex> lock{m_mutex};
+
+    stream << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    stream << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":" << TraceProcessId << ",\"tid\":0,\"args\":{\"name\":\"Viper-Browser\"}}";
+
+    for (const auto &buffer : m_threadBuffers)
+    {
+        std::lock_guard<std::mutex> bufferLock{buffer->Mutex};
+
+        if (!buffer->ThreadName.empty())
+        {
+            stream << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" << TraceProcessId << ",\"tid\":" << buffer->ThreadId
+                   << ",\"args\":{\"name\":";
+            writeJsonString(stream, buffer->ThreadName);
+            stream << "}}";
+        }
+
+        for (const TraceEvent &event : buffer->Events)
+        {
+            stream << ",\n{\"name\":";
+            writeJsonString(stream, event.Name);
+            stream << ",\"cat\":\"" << event.Category << "\",\"ph\":\"" << event.Phase
+                   << "\",\"ts\":" << event.Timestamp << ",\"pid\":" << TraceProcessId << ",\"tid\":" << buffer->ThreadId;
+
+            switch (event.Phase)
+            {
+                case 'X':
+                    stream << ",\"dur\":" << event.Duration;
+                    break;
+                case 'b':
+                case 'e':
+                    stream << ",\"id\":\"0x" << std::hex << event.Id << std::dec << '"';
+                    break;
+                case 'i':
+                    stream << ",\"s\":\"t\"";
+                    break;
+                default:
+                    break;
+            }
+
+            if (event.Phase == 'C')
+            {
+                stream << ",\"args\":{\"value\":" << event.Value << '}';
+            }
+            else if (!event.Detail.empty())
+            {
+                stream << ",\"args\":{\"detail\":";
+                writeJsonString(stream, event.Detail);
+                stream << '}';
+            }
+
+            stream << '}';
+        }
+    }
+
+    stream << "]}\n";
+}
+
+size_t Tracer::getNumEvents() const
+{
+    std::lock_guard<std::mutex> lock{m_mutex};
+
+    size_t numEvents = 0;
+    for (const auto &buffer : m_threadBuffers)
+    {
+        std::lock_guard<std::mutex> bufferLock{buffer->Mutex};
+        numEvents += buffer->Events.size();
+    }
+    return numEvents;
+}
+
+int64_t Tracer::now() const
+{
+    const std::chrono::steady_clock::duration elapsed = std::chrono::steady_clock::now().time_since_epoch()
+            - std::chrono::steady_clock::duration(m_startTime.load(std::memory_order_relaxed));
+    return std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
+}
+
+void Tracer::addSpan(const char *category, const char *name, int64_t startTime, int64_t duration, const std::string &detail)
+{
+    if (!isEnabled())
+        return;
+
+    record({ 'X', category, name, detail, startTime, duration, 0, 0 });
+}
+
+void Tracer::beginAsyncSpan(const char *category, const char *name, uint64_t id, const std::string &detail)
+{
+    if (!isEnabled())
+        return;
+
+    record({ 'b', category, name, detail, now(), 0, id, 0 });
+}
+
+void Tracer::endAsyncSpan(const char *category, const char *name, uint64_t id)
+{
+    if (!isEnabled())
+        return;
+
+    record({ 'e', category, name, std::string(), now(), 0, id, 0 });
+}
+
+void Tracer::addInstantEvent(const char *category, const char *name, const std::string &detail)
+{
+    if (!isEnabled())
+        return;
+
+    record({ 'i', category, name, detail, now(), 0, 0, 0 });
+}
+
+void Tracer::setCounter(const char *category, const std::string &name, int64_t value)
+{
+    if (!isEnabled())
+        return;
+
+    record({ 'C', category, name, std::string(), now(), 0, 0, value });
+}
+
+void Tracer::setThreadName(const std::string &name)
+{
+    if (!isEnabled())
+        return;
+
+    ThreadBuffer &buffer = getThreadBuffer();
+    std::lock_guard<std::mutex> lock{buffer.Mutex};
+    buffer.ThreadName = name;
+}
+
+void Tracer::record(TraceEvent &&event)
+{
+    ThreadBuffer &buffer = getThreadBuffer();
+    std::lock_guard<std::mutex> lock{buffer.Mutex};
+    buffer.Events.push_back(std::move(event));
+}
+
+Tracer::ThreadBuffer &Tracer::getThreadBuffer()
+{
+    // Buffers are owned by the tracer, which lives until the end of the program
+    thread_local ThreadBuffer *threadBuffer = nullptr;
+    if (threadBuffer != nullptr)
+        return *threadBuffer;
+
+    std::lock_guard<std::mutex> lock{m_mutex};
+    m_threadBuffers.push_back(std::make_unique<ThreadBuffer>());
+    threadBuffer = m_threadBuffers.back().get();
+    threadBuffer->ThreadId = static_cast<int>(m_threadBuffers.size());
+    return *threadBuffer;
+}
@@ -0,0 +1,200 @@
+#ifndef TRACER_H
+#define TRACER_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/// Event recorded by the \ref Tracer, following the Chrome trace event format
+struct TraceEvent
+{
+    /// Event type: 'X' for a complete span, 'b' and 'e' for the beginning and end of an asynchronous
+    /// span, 'i' for an instant event and 'C' for a counter
+    char Phase;
+
+    /// Category of the event, used to filter events in the trace viewer
+    const char *Category;
+
+    /// Name of the event
+    std::string Name;
+
+    /// Optional description of the event, such as the URL of a navigation
+    std::string Detail;
+
+    /// Time of the event, in microseconds since tracing was started
+    int64_t Timestamp;
+
+    /// Duration of a complete span, in microseconds
+    int64_t Duration;
+
+    /// Identifier shared by the beginning and end of an asynchronous span
+    uint64_t Id;
+
+    /// Value of a counter
+    int64_t Value;
+};
+
+/**
+ * @class Tracer
+ * @brief Records spans, counters and thread names from any thread, and writes them as a
+ *        Chrome trace event JSON file that can be opened in about:tracing or Perfetto
+ *
+ * Tracing is disabled unless \ref start is called, in which case every recording call
+ * returns after a single atomic load. Each thread records its events into its own buffer,
+ * so threads only contend with each other when the trace is being written.
+ */
+class Tracer
+{
+public:
+    /// Returns the tracer of the application
+    static Tracer &instance();
+
+    /// Returns true if events are being recorded
+    static bool isEnabled()
+    {
+        return s_enabled.load(std::memory_order_relaxed);
+    }
+
+    /// Discards any previously recorded events and starts recording. The events are written
+    /// to the given file when \ref stop is called
+    void start(const std::string &outputFile);
+
+    /// Stops recording and writes the events to the file given to \ref start. Returns true on success,
+    /// or false if tracing was not started or the file could not be written
+    bool stop();
+
+    /// Writes the recorded events to the given stream as a trace event JSON document
+    void write(std::ostream &stream) const;
+
+    /// Returns the number of recorded events, excluding thread names
+    size_t getNumEvents() const;
+
+    /// Returns the time elapsed since tracing was started, in microseconds
+    int64_t now() const;
+
+    /// Records a span that started at the given time and lasted for the given duration, in microseconds
+    void addSpan(const char *category, const char *name, int64_t startTime, int64_t duration, const std::string &detail = std::string());
+
+    /// Records the beginning of an asynchronous span, which may end on another thread or after other spans have ended
+    void beginAsyncSpan(const char *category, const char *name, uint64_t id, const std::string &detail = std::string());
+
+    /// Records the end of the asynchronous span with the given category, name and identifier
+    void endAsyncSpan(const char *category, const char *name, uint64_t id);
+
+    /// Records an event without a duration
+    void addInstantEvent(const char *category, const char *name, const std::string &detail = std::string());
+
+    /// Records the current value of a counter
+    void setCounter(const char *category, const std::string &name, int64_t value);
+
+    /// Sets the name displayed for the calling thread in the trace viewer
+    void setThreadName(const std::string &name);
+
+private:
+    /// Events recorded by a single thread
+    struct ThreadBuffer
+    {
+        /// Protects the buffer while it is being written or cleared by another thread
+        std::mutex Mutex;
+
+        /// Small identifier of the thread, used as its tid in the trace
+        int ThreadId;
+
+        /// Name of the thread, if one was given
+        std::string ThreadName;
+
+        /// Events recorded by the thread
+        std::vector<TraceEvent> Events;
+    };
+
+    /// Constructs the tracer in a disabled state
+    Tracer();
+
+    /// Appends an event to the calling thread's buffer
+    void record(TraceEvent &&event);
+
+    /// Returns the buffer of the calling thread, creating it if needed
+    ThreadBuffer &getThreadBuffer();
+
+private:
+    /// True while events are being recorded
+    static std::atomic_bool s_enabled;
+
+    /// Protects the list of thread buffers and the output file
+    mutable std::mutex m_mutex;
+
+    /// Buffers of every thread that has recorded an event. Buffers are kept after their thread exits,
+    /// so that its events can still be written
+    std::vector<std::unique_ptr<ThreadBuffer>> m_threadBuffers;
+
+    /// File that the trace is written to
+    std::string m_outputFile;
+
+    /// Time at which tracing was started
+    std::atomic<std::chrono::steady_clock::rep> m_startTime;
+};
+
+/**
+ * @class TraceSpan
+ * @brief Records a span covering the lifetime of the object, if tracing is enabled when it is constructed
+ */
+class TraceSpan
+{
+public:
+    /// Starts the span. The category and name must outlive the span
+    TraceSpan(const char *category, const char *name) :
+        m_category(category),
+        m_name(name),
+        m_detail(),
+        m_startTime(Tracer::isEnabled() ? Tracer::instance().now() : -1)
+    {
+    }
+
+    /// Records the span
+    ~TraceSpan()
+    {
+        if (m_startTime >= 0)
+        {
+            Tracer &tracer = Tracer::instance();
+            tracer.addSpan(m_category, m_name, m_startTime, tracer.now() - m_startTime, m_detail);
+        }
+    }
+
+    /// Returns true if the span will be recorded. Used to avoid building a detail string that would not be used
+    bool isActive() const
+    {
+        return m_startTime >= 0;
+    }
+
+    /// Sets the description of the span
+    void setDetail(const std::string &detail)
+    {
+        m_detail = detail;
+    }
+
+private:
+    /// Category of the span
+    const char *m_category;
+
+    /// Name of the span
+    const char *m_name;
+
+    /// Description of the span
+    std::string m_detail;
+
+    /// Start time of the span, or -1 if tracing was disabled
+    int64_t m_startTime;
+};
+
+#define VIPER_TRACE_CONCAT_INNER(a, b) a##b
+#define VIPER_TRACE_CONCAT(a, b) VIPER_TRACE_CONCAT_INNER(a, b)
+
+/// Records a span covering the rest of the enclosing scope
+#define VIPER_TRACE_SCOPE(category, name) TraceSpan VIPER_TRACE_CONCAT(traceSpan, __LINE__)(category, name)
+
+#endif // TRACER_H
@@ -0,0 +1,129 @@
+#include "Settings.h"
+#include "SpeculativeLoader.h"
+
+#include <QTimer>
+#include <QWebEnginePage>
+#include <QWebEngineProfile>
+#include <QWebEngineSettings>
+
+namespace
+{
+    /// Time after which a prerendered page that was not navigated to is closed, in milliseconds
+    constexpr int PrerenderLifetime = 30000;
+}
+
+SpeculativeLoader::SpeculativeLoader(Settings *settings, QWebEngineProfile *profile, QObject *parent) :
+    QObject(parent),
+    m_settings(settings),
+    m_profile(profile),
+    m_policy(&SpeculationPolicy::getMonotonicTime),
+    m_hintPage(nullptr),
+    m_prerenderPage(nullptr),
+    m_prerenderTimer(new QTimer(this))
+{
+    setObjectName(QStringLiteral("SpeculativeLoader"));
+
+    m_prerenderTimer->setSingleShot(true);
+    m_prerenderTimer->setInterval(PrerenderLifetime);
+    connect(m_prerenderTimer, &QTimer::timeout, this, &SpeculativeLoader::cancel);
+
+    if (m_settings != nullptr)
+    {
+        connect(m_settings, &Settings::settingChanged, this, &SpeculativeLoader::onSettingChanged);
+        applySettings();
+    }
+}
+
+SpeculativeLoader::~SpeculativeLoader()
+{
+    // The pages must be destroyed before their profile
+    delete m_prerenderPage;
+    delete m_hintPage;
+}
+
+void SpeculativeLoader::preconnect(const QUrl &url)
+{
+    if (!url.isValid() || url.host().isEmpty())
+        return;
+
+    if (m_hintPage == nullptr)
+    {
+        m_hintPage = new QWebEnginePage(m_profile, this);
+        m_hintPage->settings()->setAttribute(QWebEngineSettings::JavascriptEnabled, false);
+        m_hintPage->settings()->setAttribute(QWebEngineSettings::DnsPrefetchEnabled, true);
+    }
+
+    const QString origin = url.adjusted(QUrl::RemoveUserInfo | QUrl::RemovePath | QUrl::RemoveQuery | QUrl::RemoveFragment)
+                              .toString(QUrl::FullyEncoded);
+    const QString hints = QStringLiteral("<!DOCTYPE html><html><head>"
+                                         "<link rel=\"dns-prefetch\" href=\"//%1\">"
+                                         "<link rel=\"preconnect\" href=\"%2\">"
+                                         "<link rel=\"preconnect\" href=\"%2\" crossorigin>"
+                                         "</head></html>")
+                                .arg(url.host(QUrl::FullyEncoded).toHtmlEscaped(), origin.toHtmlEscaped());
+    m_hintPage->setHtml(hints);
+}
+
+void SpeculativeLoader::prerender(const QUrl &url)
+{
+    if (!url.isValid())
+        return;
+
+    if (m_prerenderPage == nullptr)
+    {
+        m_prerenderPage = new QWebEnginePage(m_profile, this);
+        m_prerenderPage->setAudioMuted(true);
+        m_prerenderPage->settings()->setAttribute(QWebEngineSettings::JavascriptCanOpenWindows, false);
+        m_prerenderPage->settings()->setAttribute(QWebEngineSettings::PlaybackRequiresUserGesture, true);
+    }
+
+    m_prerenderPage->load(url);
+    m_prerenderTimer->start();
+}
+
+void SpeculativeLoader::speculate(const QString &input, const std::vector<URLSuggestion> &suggestions)
+{
+    const SpeculationPolicy::Decision decision = m_policy.evaluate(input, suggestions);
+    switch (decision.Kind)
+    {
+        case SpeculationPolicy::Action::Preconnect:
+            preconnect(decision.Url);
+            break;
+        case SpeculationPolicy::Action::Prerender:
+            if (m_policy.isPreconnectEnabled())
+                preconnect(decision.Url);
+            prerender(decision.Url);
+            break;
+        case SpeculationPolicy::Action::None:
+            break;
+    }
+}
+
+void SpeculativeLoader::cancel()
+{
+    m_prerenderTimer->stop();
+    m_policy.reset();
+
+    // Destroying the page releases its renderer, rather than keeping a blank page around
+    if (m_prerenderPage != nullptr)
+    {
+        m_prerenderPage->triggerAction(QWebEnginePage::Stop);
+        m_prerenderPage->deleteLater();
+        m_prerenderPage = nullptr;
+    }
+}
+
+void SpeculativeLoader::onSettingChanged(BrowserSetting setting, const QVariant &/*value*/)
+{
+    if (setting == BrowserSetting::EnableSpeculativeConnections || setting == BrowserSetting::EnableSpeculativePrerender)
+        applySettings();
+}
+
+void SpeculativeLoader::applySettings()
+{
+    m_policy.setPreconnectEnabled(m_settings->getValue(BrowserSetting::EnableSpeculativeConnections).toBool());
+    m_policy.setPrerenderEnabled(m_settings->getValue(BrowserSetting::EnableSpeculativePrerender).toBool());
+
+    if (!m_settings->getValue(BrowserSetting::EnableSpeculativePrerender).toBool())
+        cancel();
+}
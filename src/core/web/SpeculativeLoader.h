@@ -0,0 +1,85 @@
+#ifndef SPECULATIVELOADER_H
+#define SPECULATIVELOADER_H
+
+#include "BrowserSetting.h"
+#include "SpeculationPolicy.h"
+#include "URLSuggestion.h"
+
+#include <vector>
+
+#include <QObject>
+#include <QString>
+#include <QUrl>
+#include <QVariant>
+
+class Settings;
+
+class QTimer;
+class QWebEnginePage;
+class QWebEngineProfile;
+
+/**
+ * @class SpeculativeLoader
+ * @brief Connects to, or loads, the site the user is most likely typing into the URL bar, before they press enter
+ *
+ * The suggestions found for the input of the URL bar are passed to a \ref SpeculationPolicy . When it is confident
+ * enough, the loader sets a hidden page of the browsing profile to a document holding dns-prefetch and preconnect
+ * hints for the site, so the web engine resolves its host and opens a connection that the navigation then reuses.
+ * When prerendering is enabled and the policy is more confident, the page itself is loaded into a second hidden,
+ * muted page, which warms up the connection and the HTTP cache of the profile. The prerendered page is not shown
+ * to the user: it is closed once the input is abandoned, or after a short while.
+ */
+class SpeculativeLoader : public QObject
+{
+    Q_OBJECT
+
+public:
+    /// Constructs the loader for the given browsing profile. Speculation follows the browser settings, or only opens
+    /// connections if the settings are null
+    SpeculativeLoader(Settings *settings, QWebEngineProfile *profile, QObject *parent = nullptr);
+
+    /// Destroys the hidden pages of the loader
+    ~SpeculativeLoader();
+
+    /// Resolves the host of the URL and opens a connection to its origin
+    void preconnect(const QUrl &url);
+
+    /// Loads the URL into a hidden page, replacing any page that was being prerendered
+    void prerender(const QUrl &url);
+
+public Q_SLOTS:
+    /// Decides whether to connect to, or to load, the top suggestion found for the input of the URL bar
+    void speculate(const QString &input, const std::vector<URLSuggestion> &suggestions);
+
+    /// Closes the page being prerendered, if any
+    void cancel();
+
+private Q_SLOTS:
+    /// Applies the speculation settings when they have changed
+    void onSettingChanged(BrowserSetting setting, const QVariant &value);
+
+private:
+    /// Reads the speculation settings
+    void applySettings();
+
+private:
+    /// Browser settings
+    Settings *m_settings;
+
+    /// Profile in which connections are opened and pages are loaded
+    QWebEngineProfile *m_profile;
+
+    /// Decides when and what to speculate on
+    SpeculationPolicy m_policy;
+
+    /// Hidden page holding the resource hints of the last preconnected site
+    QWebEnginePage *m_hintPage;
+
+    /// Hidden page in which the most likely site is loaded, if prerendering
+    QWebEnginePage *m_prerenderPage;
+
+    /// Closes the prerendered page after a while
+    QTimer *m_prerenderTimer;
+};
+
+#endif // SPECULATIVELOADER_H
@@ -0,0 +1,230 @@
+#include "TabHibernationPolicy.h"
+
+#include <algorithm>
+#include <utility>
+
+#include <QByteArray>
+#include <QFile>
+#include <QList>
+
+namespace
+{
+    /// Under memory pressure, at least this share of the background tabs that can be hibernated is hibernated
+    /// at each evaluation, until enough memory is available again
+    constexpr int MemoryPressureShare = 4;
+}
+
+TabHibernationPolicy::TabHibernationPolicy(Clock clock, MemorySource memorySource) :
+    m_clock(std::move(clock)),
+    m_memorySource(std::move(memorySource)),
+    m_idleTimeout(0),
+    m_tabBudget(0),
+    m_memoryPressureThreshold(0),
+    m_nextSequence(0),
+    m_tabs()
+{
+}
+
+void TabHibernationPolicy::setIdleTimeout(std::chrono::minutes timeout)
+{
+    m_idleTimeout = timeout;
+}
+
+void TabHibernationPolicy::setTabBudget(int maxAwakeTabs)
+{
+    m_tabBudget = std::max(0, maxAwakeTabs);
+}
+
+void TabHibernationPolicy::setMemoryPressureThreshold(int percent)
+{
+    m_memoryPressureThreshold = std::clamp(percent, 0, 100);
+}
+
+void TabHibernationPolicy::addTab(uintptr_t tabId, bool hibernating)
+{
+    TabState &tab = m_tabs[tabId];
+    tab.LastUsed = m_clock();
+    tab.Sequence = m_nextSequence++;
+    tab.IsActive = false;
+    tab.IsHibernating = hibernating;
+    tab.IsPinned = false;
+    tab.IsPlayingAudio = false;
+    tab.HasFormInput = false;
+}
+
+void TabHibernationPolicy::removeTab(uintptr_t tabId)
+{
+    m_tabs.erase(tabId);
+}
+
+void TabHibernationPolicy::setTabActive(uintptr_t tabId, bool active)
+{
+    TabState *tab = getTab(tabId);
+    if (tab == nullptr || tab->IsActive == active)
+        return;
+
+    tab->IsActive = active;
+    tab->LastUsed = m_clock();
+}
+
+void TabHibernationPolicy::setTabHibernating(uintptr_t tabId, bool hibernating)
+{
+    TabState *tab = getTab(tabId);
+    if (tab == nullptr || tab->IsHibernating == hibernating)
+        return;
+
+    tab->IsHibernating = hibernating;
+    if (!hibernating)
+        tab->LastUsed = m_clock();
+}
+
+void TabHibernationPolicy::setTabPinned(uintptr_t tabId, bool pinned)
+{
+    if (TabState *tab = getTab(tabId))
+        tab->IsPinned = pinned;
+}
+
+void TabHibernationPolicy::setTabPlayingAudio(uintptr_t tabId, bool playingAudio)
+{
+    if (TabState *tab = getTab(tabId))
+        tab->IsPlayingAudio = playingAudio;
+}
+
+void TabHibernationPolicy::setTabHasFormInput(uintptr_t tabId, bool hasFormInput)
+{
+    if (TabState *tab = getTab(tabId))
+        tab->HasFormInput = hasFormInput;
+}
+
+int TabHibernationPolicy::getNumAwakeTabs() const
+{
+    return static_cast<int>(std::count_if(m_tabs.begin(), m_tabs.end(), [](const auto &it) {
+        return !it.second.IsHibernating;
+    }));
+}
+
+bool TabHibernationPolicy::isUnderMemoryPressure() const
+{
+    if (m_memoryPressureThreshold == 0)
+        return false;
+
+    const SystemMemory memory = m_memorySource();
+    if (memory.TotalKiB <= 0 || memory.AvailableKiB < 0)
+        return false;
+
+    return memory.AvailableKiB * 100 < memory.TotalKiB * m_memoryPressureThreshold;
+}
+
+std::vector<TabHibernationPolicy::Decision> TabHibernationPolicy::evaluate() const
+{
+    const std::chrono::milliseconds now = m_clock();
+
+    // Background tabs that are awake, least recently used first
+    std::vector<std::pair<uintptr_t, const TabState*>> candidates;
+    int numAwake = 0, numEligible = 0;
+    for (const auto &it : m_tabs)
+    {
+        const TabState &tab = it.second;
+        if (tab.IsHibernating)
+            continue;
+
+        ++numAwake;
+        if (tab.IsActive)
+            continue;
+
+        candidates.emplace_back(it.first, &tab);
+        if (getExemption(tab) == nullptr)
+            ++numEligible;
+    }
+
+    std::sort(candidates.begin(), candidates.end(), [](const auto &a, const auto &b) {
+        if (a.second->LastUsed != b.second->LastUsed)
+            return a.second->LastUsed < b.second->LastUsed;
+        return a.second->Sequence < b.second->Sequence;
+    });
+
+    int pressureQuota = 0;
+    if (numEligible > 0 && isUnderMemoryPressure())
+        pressureQuota = std::max(1, numEligible / MemoryPressureShare);
+
+    std::vector<Decision> decisions;
+    for (const auto &candidate : candidates)
+    {
+        const TabState &tab = *candidate.second;
+
+        Reason reason;
+        if (m_idleTimeout.count() > 0 && now - tab.LastUsed >= m_idleTimeout)
+            reason = Reason::IdleTimeout;
+        else if (m_tabBudget > 0 && numAwake > m_tabBudget)
+            reason = Reason::TabBudget;
+        else if (pressureQuota > 0)
+            reason = Reason::MemoryPressure;
+        else
+            continue;
+
+        // Exempt tabs are evaluated again on every check, so they are skipped silently
+        if (getExemption(tab) != nullptr)
+            continue;
+
+        decisions.push_back(Decision{ candidate.first, reason });
+        --numAwake;
+        if (pressureQuota > 0)
+            --pressureQuota;
+    }
+
+    return decisions;
+}
+
+std::chrono::milliseconds TabHibernationPolicy::getMonotonicTime()
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch());
+}
+
+TabHibernationPolicy::SystemMemory TabHibernationPolicy::getSystemMemory()
+{
+    SystemMemory memory { -1, -1 };
+
+#if defined(Q_OS_LINUX)
+    QFile meminfo(QStringLiteral("/proc/meminfo"));
+    if (!meminfo.open(QIODevice::ReadOnly))
+        return memory;
+
+    // Lines are of the form "MemTotal:       16318412 kB"
+    const QList<QByteArray> lines = meminfo.readAll().split('\n');
+    for (const QByteArray &line : lines)
+    {
+        const QList<QByteArray> fields = line.simplified().split(' ');
+        if (fields.size() < 2)
+            continue;
+
+        bool ok = false;
+        const int64_t value = fields.at(1).toLongLong(&ok);
+        if (!ok)
+            continue;
+
+        if (fields.at(0) == "MemTotal:")
+            memory.TotalKiB = value;
+        else if (fields.at(0) == "MemAvailable:")
+            memory.AvailableKiB = value;
+    }
+#endif
+
+    return memory;
+}
+
+TabHibernationPolicy::TabState *TabHibernationPolicy::getTab(uintptr_t tabId)
+{
+    auto it = m_tabs.find(tabId);
+    return it != m_tabs.end() ? &it->second : nullptr;
+}
+
+const char *TabHibernationPolicy::getExemption(const TabState &tab)
+{
+    if (tab.IsPinned)
+        return "pinned";
+    if (tab.IsPlayingAudio)
+        return "playing audio";
+    if (tab.HasFormInput)
+        return "holding unsaved form input";
+    return nullptr;
+}
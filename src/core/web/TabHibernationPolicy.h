@@ -0,0 +1,169 @@
+#ifndef TABHIBERNATIONPOLICY_H
+#define TABHIBERNATIONPOLICY_H
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @class TabHibernationPolicy
+ * @brief Decides which background tabs should be hibernated to save memory
+ *
+ * The policy keeps track of when each tab was last active, and of the tabs that must stay awake. Tabs are
+ * chosen least recently used first, for one of three reasons: the tab has not been active for longer than
+ * the idle timeout, more tabs are awake than the tab budget allows, or the system is running low on memory.
+ * Active tabs, pinned tabs, tabs playing audio and tabs with unsaved form input are never chosen.
+ *
+ * The current time and the state of the system memory are read through the functions given to the policy,
+ * so that its decisions only depend on its inputs.
+ */
+class TabHibernationPolicy
+{
+public:
+    /// Reasons for which a tab is hibernated
+    enum class Reason
+    {
+        /// The tab has not been active for longer than the idle timeout
+        IdleTimeout,
+
+        /// More tabs are awake than the tab budget allows
+        TabBudget,
+
+        /// The available system memory is below the memory pressure threshold
+        MemoryPressure
+    };
+
+    /// A tab that should be hibernated, and the reason why
+    struct Decision
+    {
+        /// Identifier of the tab
+        uintptr_t TabId;
+
+        /// Reason for which the tab should be hibernated
+        Reason Cause;
+    };
+
+    /// State of the system memory. Values are negative when they cannot be determined
+    struct SystemMemory
+    {
+        /// Total physical memory, in kibibytes
+        int64_t TotalKiB;
+
+        /// Memory that can be used without swapping, in kibibytes
+        int64_t AvailableKiB;
+    };
+
+    /// Returns the current time, relative to an arbitrary but fixed point
+    using Clock = std::function<std::chrono::milliseconds()>;
+
+    /// Returns the current state of the system memory
+    using MemorySource = std::function<SystemMemory()>;
+
+    /// Constructs the policy with the given time and memory sources. Every limit is disabled by default
+    TabHibernationPolicy(Clock clock, MemorySource memorySource);
+
+    /// Sets the time after which an inactive tab is hibernated. A timeout of zero disables it
+    void setIdleTimeout(std::chrono::minutes timeout);
+
+    /// Sets the maximum number of tabs that are kept awake. A budget of zero means that there is no limit
+    void setTabBudget(int maxAwakeTabs);
+
+    /// Sets the percentage of the system memory below which the available memory is considered to be under
+    /// pressure. A threshold of zero disables it
+    void setMemoryPressureThreshold(int percent);
+
+    /// Starts tracking a tab, which is considered to have been active just now
+    void addTab(uintptr_t tabId, bool hibernating);
+
+    /// Stops tracking a tab
+    void removeTab(uintptr_t tabId);
+
+    /// Sets whether the tab is the active tab of its window. Tabs count as used when they are activated and
+    /// when they stop being active
+    void setTabActive(uintptr_t tabId, bool active);
+
+    /// Sets whether the tab is hibernating. Tabs that wake up count as used
+    void setTabHibernating(uintptr_t tabId, bool hibernating);
+
+    /// Sets whether the tab is pinned
+    void setTabPinned(uintptr_t tabId, bool pinned);
+
+    /// Sets whether the tab is playing audio
+    void setTabPlayingAudio(uintptr_t tabId, bool playingAudio);
+
+    /// Sets whether the page of the tab has form input that has not been submitted
+    void setTabHasFormInput(uintptr_t tabId, bool hasFormInput);
+
+    /// Returns the number of tracked tabs that are not hibernating
+    int getNumAwakeTabs() const;
+
+    /// Returns true if the available system memory is below the memory pressure threshold
+    bool isUnderMemoryPressure() const;
+
+    /// Returns the tabs that should be hibernated now, least recently used first, logging each decision
+    std::vector<Decision> evaluate() const;
+
+    /// Returns the time elapsed on a monotonic clock
+    static std::chrono::milliseconds getMonotonicTime();
+
+    /// Returns the state of the system memory, as reported by the operating system
+    static SystemMemory getSystemMemory();
+
+private:
+    /// State of a tracked tab
+    struct TabState
+    {
+        /// Time at which the tab was last used
+        std::chrono::milliseconds LastUsed;
+
+        /// Order in which the tab was added, used to break ties between tabs used at the same time
+        uint64_t Sequence;
+
+        /// True if the tab is the active tab of its window
+        bool IsActive;
+
+        /// True if the tab is hibernating
+        bool IsHibernating;
+
+        /// True if the tab is pinned
+        bool IsPinned;
+
+        /// True if the tab is playing audio
+        bool IsPlayingAudio;
+
+        /// True if the page of the tab has unsubmitted form input
+        bool HasFormInput;
+    };
+
+    /// Returns a pointer to the state of the given tab, or a null pointer if it is not tracked
+    TabState *getTab(uintptr_t tabId);
+
+    /// Returns the reason for which a tab must stay awake, or a null pointer if it can be hibernated
+    static const char *getExemption(const TabState &tab);
+
+private:
+    /// Source of the current time
+    Clock m_clock;
+
+    /// Source of the state of the system memory
+    MemorySource m_memorySource;
+
+    /// Time after which an inactive tab is hibernated, or zero
+    std::chrono::minutes m_idleTimeout;
+
+    /// Maximum number of tabs that are kept awake, or zero
+    int m_tabBudget;
+
+    /// Percentage of the system memory below which memory is under pressure, or zero
+    int m_memoryPressureThreshold;
+
+    /// Sequence number of the next tab to be added
+    uint64_t m_nextSequence;
+
+    /// State of each tracked tab, by tab identifier
+    std::unordered_map<uintptr_t, TabState> m_tabs;
+};
+
+#endif // TABHIBERNATIONPOLICY_H
@@ -0,0 +1,20 @@
+#ifndef TABLIFECYCLE_H
+#define TABLIFECYCLE_H
+
+/// Stages of the lifecycle of a tab, from the one that uses the most resources to the one that uses the least
+enum class TabLifecycle
+{
+    /// The page runs normally
+    Active = 0,
+
+    /// The page stays loaded, but its timers and scripts are suspended. It resumes instantly when shown
+    Frozen = 1,
+
+    /// The renderer has released the page, which is reloaded when shown
+    Discarded = 2,
+
+    /// The web view of the tab has been destroyed, and is recreated from the saved state of the tab when woken up
+    Hibernated = 3
+};
+
+#endif // TABLIFECYCLE_H
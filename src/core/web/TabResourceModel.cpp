@@ -0,0 +1,277 @@
+#include "TabResourceModel.h"
+
+#include <algorithm>
+#include <utility>
+
+#include <QLocale>
+#include <QTimer>
+
+namespace
+{
+    /// Interval between two samples when the model is started, in milliseconds
+    constexpr int DefaultSamplingInterval = 2000;
+
+    /// Longest interval between two samples, in milliseconds
+    constexpr int MaxSamplingInterval = 32000;
+
+    /// Largest share of the sampling interval that a sample can take, in percent
+    constexpr double MaxSamplingOverhead = 0.1;
+
+    /// Returns a memory size in kibibytes as a human-readable string
+    QString formatMemory(int64_t kibibytes)
+    {
+        return QLocale().formattedDataSize(kibibytes * 1024);
+    }
+}
+
+TabResourceModel::TabResourceModel(TabSource tabSource, Clock clock, const QString &procPath, QObject *parent) :
+    QAbstractTableModel(parent),
+    m_reader(procPath),
+    m_tabSource(std::move(tabSource)),
+    m_clock(std::move(clock)),
+    m_timer(new QTimer(this)),
+    m_tabs(),
+    m_processes(),
+    m_numSamples(0),
+    m_samplingOverhead(0.0)
+{
+    m_timer->setInterval(DefaultSamplingInterval);
+    connect(m_timer, &QTimer::timeout, this, &TabResourceModel::onSamplingTimeout);
+}
+
+QVariant TabResourceModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (orientation != Qt::Horizontal || role != Qt::DisplayRole)
+        return QVariant();
+
+    switch (section)
+    {
+        case TitleColumn:              return tr("Tab");
+        case LifecycleColumn:          return tr("State");
+        case ProcessColumn:            return tr("Process");
+        case MemoryColumn:             return tr("Memory");
+        case ProportionalMemoryColumn: return tr("Proportional Memory");
+        case CpuColumn:                return tr("CPU");
+    }
+
+    return QVariant();
+}
+
+int TabResourceModel::rowCount(const QModelIndex &parent) const
+{
+    if (parent.isValid())
+        return 0;
+
+    return static_cast<int>(m_tabs.size());
+}
+
+int TabResourceModel::columnCount(const QModelIndex &parent) const
+{
+    if (parent.isValid())
+        return 0;
+
+    return NumColumns;
+}
+
+QVariant TabResourceModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= static_cast<int>(m_tabs.size()))
+        return QVariant();
+
+    const Tab &tab = m_tabs.at(static_cast<std::size_t>(index.row()));
+    const int column = index.column();
+
+    if (role == Qt::UserRole)
+        return getRawValue(tab, column);
+
+    if (role == Qt::DecorationRole && column == TitleColumn)
+        return tab.Icon;
+
+    const ProcessUsage *usage = getProcessUsage(tab);
+    if (role == Qt::ToolTipRole && usage != nullptr && usage->NumTabs > 1 && column >= ProcessColumn)
+    {
+        return tr("Renderer process %1 is shared by %2 tabs, and uses %3 of memory in total")
+                .arg(tab.ProcessId).arg(usage->NumTabs).arg(formatMemory(usage->ResidentKiB));
+    }
+
+    if (role != Qt::DisplayRole)
+        return QVariant();
+
+    if (column == TitleColumn)
+        return tab.Title;
+
+    if (column == LifecycleColumn)
+    {
+        switch (tab.Lifecycle)
+        {
+            case TabLifecycle::Active:     return tr("Active");
+            case TabLifecycle::Frozen:     return tr("Frozen");
+            case TabLifecycle::Discarded:  return tr("Discarded");
+            case TabLifecycle::Hibernated: return tr("Hibernated");
+        }
+    }
+
+    if (usage == nullptr)
+        return QString();
+
+    const QVariant value = getRawValue(tab, column);
+    switch (column)
+    {
+        case ProcessColumn:
+            if (usage->NumTabs > 1)
+                return tr("%1 (shared by %2 tabs)").arg(tab.ProcessId).arg(usage->NumTabs);
+            return QString::number(tab.ProcessId);
+        case MemoryColumn:
+        case ProportionalMemoryColumn:
+            return value.toLongLong() < 0 ? QString() : formatMemory(value.toLongLong());
+        case CpuColumn:
+            return value.toDouble() < 0.0 ? QString() : QStringLiteral("%1%").arg(value.toDouble(), 0, 'f', 1);
+    }
+
+    return QVariant();
+}
+
+void TabResourceModel::start()
+{
+    if (m_timer->isActive())
+        return;
+
+    m_samplingOverhead = 0.0;
+    m_timer->setInterval(DefaultSamplingInterval);
+    m_timer->start();
+
+    // The first sample is not preceded by an interval, so it does not count towards the overhead
+    sample();
+}
+
+void TabResourceModel::stop()
+{
+    m_timer->stop();
+}
+
+void TabResourceModel::sample()
+{
+    const std::chrono::nanoseconds now = m_clock();
+    const bool readProportionalMemory = (m_numSamples % ProportionalMemoryInterval) == 0;
+    ++m_numSamples;
+
+    std::vector<Tab> tabs = m_tabSource();
+
+    // Processes that no tab uses anymore are forgotten
+    std::unordered_map<int64_t, ProcessUsage> processes;
+    for (const Tab &tab : tabs)
+    {
+        if (tab.ProcessId <= 0)
+            continue;
+
+        auto it = processes.find(tab.ProcessId);
+        if (it == processes.end())
+            processes.emplace(tab.ProcessId, ProcessUsage { 1, -1, -1, -1, now, -1.0 });
+        else
+            ++it->second.NumTabs;
+    }
+
+    for (auto &it : processes)
+    {
+        ProcessUsage &usage = it.second;
+        auto previous = m_processes.find(it.first);
+        const bool isNewProcess = previous == m_processes.end();
+
+        const ProcessStats stats = m_reader.read(it.first, readProportionalMemory || isNewProcess);
+        usage.ResidentKiB = stats.ResidentKiB;
+        usage.CpuTicks = stats.CpuTicks;
+        usage.ProportionalKiB = (readProportionalMemory || isNewProcess) ? stats.ProportionalKiB : previous->second.ProportionalKiB;
+
+        // CPU usage is measured between two samples of the same process
+        if (!isNewProcess
+                && stats.CpuTicks >= 0
+                && previous->second.CpuTicks >= 0
+                && stats.CpuTicks >= previous->second.CpuTicks
+                && now > previous->second.SampleTime)
+        {
+            const double cpuSeconds = static_cast<double>(stats.CpuTicks - previous->second.CpuTicks) / m_reader.getTicksPerSecond();
+            const double elapsedSeconds = std::chrono::duration<double>(now - previous->second.SampleTime).count();
+            usage.CpuPercent = 100.0 * cpuSeconds / elapsedSeconds;
+        }
+    }
+
+    m_processes = std::move(processes);
+
+    // The rows are only reset when tabs were opened, closed or moved to another process
+    const bool sameTabs = tabs.size() == m_tabs.size()
+            && std::equal(tabs.begin(), tabs.end(), m_tabs.begin(), [](const Tab &a, const Tab &b) {
+                   return a.ProcessId == b.ProcessId;
+               });
+
+    if (sameTabs)
+    {
+        m_tabs = std::move(tabs);
+        if (!m_tabs.empty())
+            Q_EMIT dataChanged(index(0, 0), index(rowCount() - 1, NumColumns - 1));
+    }
+    else
+    {
+        beginResetModel();
+        m_tabs = std::move(tabs);
+        endResetModel();
+    }
+
+    Q_EMIT sampled();
+}
+
+int TabResourceModel::getSamplingInterval() const
+{
+    return m_timer->interval();
+}
+
+double TabResourceModel::getSamplingOverhead() const
+{
+    return m_samplingOverhead;
+}
+
+void TabResourceModel::onSamplingTimeout()
+{
+    const std::chrono::nanoseconds startTime = m_clock();
+
+    sample();
+
+    const int interval = m_timer->interval();
+    const std::chrono::nanoseconds samplingTime = m_clock() - startTime;
+    m_samplingOverhead = 100.0 * static_cast<double>(samplingTime.count()) / (interval * 1000000.0);
+    if (m_samplingOverhead > MaxSamplingOverhead && interval < MaxSamplingInterval)
+        m_timer->setInterval(std::min(interval * 2, MaxSamplingInterval));
+}
+
+const TabResourceModel::ProcessUsage *TabResourceModel::getProcessUsage(const Tab &tab) const
+{
+    auto it = m_processes.find(tab.ProcessId);
+    return it != m_processes.end() ? &it->second : nullptr;
+}
+
+QVariant TabResourceModel::getRawValue(const Tab &tab, int column) const
+{
+    if (column == TitleColumn)
+        return tab.Title;
+
+    if (column == LifecycleColumn)
+        return static_cast<int>(tab.Lifecycle);
+
+    if (column == ProcessColumn)
+        return static_cast<qlonglong>(tab.ProcessId);
+
+    const ProcessUsage *usage = getProcessUsage(tab);
+    if (usage == nullptr)
+        return column == CpuColumn ? QVariant(-1.0) : QVariant(qlonglong{-1});
+
+    switch (column)
+    {
+        case MemoryColumn:
+            return usage->ResidentKiB < 0 ? qlonglong{-1} : static_cast<qlonglong>(usage->ResidentKiB / usage->NumTabs);
+        case ProportionalMemoryColumn:
+            return usage->ProportionalKiB < 0 ? qlonglong{-1} : static_cast<qlonglong>(usage->ProportionalKiB / usage->NumTabs);
+        case CpuColumn:
+            return usage->CpuPercent < 0.0 ? -1.0 : usage->CpuPercent / usage->NumTabs;
+    }
+
+    return QVariant();
+}
@@ -0,0 +1,181 @@
+#ifndef TABRESOURCEMODEL_H
+#define TABRESOURCEMODEL_H
+
+#include "ProcessStatsReader.h"
+#include "TabLifecycle.h"
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+#include <QAbstractTableModel>
+#include <QIcon>
+#include <QString>
+
+class QTimer;
+
+/**
+ * @class TabResourceModel
+ * @brief Lists the memory and CPU usage of the renderer process of each tab, like a task manager
+ *
+ * The model periodically asks its tab source for the open tabs and the identifiers of their renderer processes,
+ * and reads the usage of each process with a \ref ProcessStatsReader. A renderer process can be shared by several
+ * tabs, in which case its usage is divided evenly between them and the tabs are shown as sharing the process.
+ * The lifecycle stage of each tab is shown as well, so the usage of frozen and active background tabs can be compared.
+ *
+ * Sampling only happens while the model is started. The proportional set size is more expensive to read than the
+ * rest, and is read every few samples. The time spent on each periodic sample is measured against the clock, and
+ * the sampling interval is doubled whenever a sample takes more than a tenth of a percent of the interval that preceded it.
+ */
+class TabResourceModel : public QAbstractTableModel
+{
+    Q_OBJECT
+
+public:
+    /// Columns of the model
+    enum Column
+    {
+        /// Title and icon of the tab
+        TitleColumn = 0,
+
+        /// Stage of the lifecycle of the tab
+        LifecycleColumn,
+
+        /// Identifier of the renderer process
+        ProcessColumn,
+
+        /// Share of the resident set size of the renderer process
+        MemoryColumn,
+
+        /// Share of the proportional set size of the renderer process
+        ProportionalMemoryColumn,
+
+        /// Share of the CPU usage of the renderer process
+        CpuColumn,
+
+        /// Number of columns
+        NumColumns
+    };
+
+    /// A tab, and the renderer process of its page
+    struct Tab
+    {
+        /// Title of the tab
+        QString Title;
+
+        /// Icon of the tab
+        QIcon Icon;
+
+        /// Identifier of the renderer process, or zero if the page has none
+        int64_t ProcessId;
+
+        /// Stage of the lifecycle of the tab. Hibernated tabs have no renderer process
+        TabLifecycle Lifecycle;
+    };
+
+    /// Returns the tabs that are currently open
+    using TabSource = std::function<std::vector<Tab>()>;
+
+    /// Returns the current time, relative to an arbitrary but fixed point
+    using Clock = std::function<std::chrono::nanoseconds()>;
+
+    /// Number of samples between two reads of the proportional set size of a process
+    static constexpr int ProportionalMemoryInterval = 5;
+
+    /// Constructs the model with the source of its tabs, the clock against which CPU usage and the time spent on
+    /// sampling are measured, and the mount point of the proc filesystem
+    TabResourceModel(TabSource tabSource, Clock clock, const QString &procPath = QStringLiteral("/proc"), QObject *parent = nullptr);
+
+    /// Returns the header data of the given section
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+    /// Returns the number of tabs
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+
+    /// Returns the number of columns
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+
+    /// Returns the data at the given index. The Qt::UserRole holds the raw value of each column, for sorting
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+
+    /// Samples the tabs right away, and then periodically until the model is stopped
+    void start();
+
+    /// Stops sampling the tabs
+    void stop();
+
+    /// Reads the open tabs, and the usage of their renderer processes
+    void sample();
+
+    /// Returns the interval between two samples, in milliseconds
+    int getSamplingInterval() const;
+
+    /// Returns the time taken by the last periodic sample, in percent of the sampling interval
+    double getSamplingOverhead() const;
+
+Q_SIGNALS:
+    /// Emitted after each sample
+    void sampled();
+
+private Q_SLOTS:
+    /// Takes a periodic sample, and slows down sampling if it takes too much time
+    void onSamplingTimeout();
+
+private:
+    /// Usage of a renderer process
+    struct ProcessUsage
+    {
+        /// Number of tabs sharing the process
+        int NumTabs;
+
+        /// Resident set size, in kibibytes
+        int64_t ResidentKiB;
+
+        /// Proportional set size, in kibibytes
+        int64_t ProportionalKiB;
+
+        /// CPU time, in clock ticks
+        int64_t CpuTicks;
+
+        /// Time at which the CPU time was read
+        std::chrono::nanoseconds SampleTime;
+
+        /// CPU usage since the previous sample, in percent of one core
+        double CpuPercent;
+    };
+
+    /// Returns the usage of the renderer process of a tab, or a null pointer if it has none
+    const ProcessUsage *getProcessUsage(const Tab &tab) const;
+
+    /// Returns the value of a column for a tab, divided by the number of tabs sharing its process
+    QVariant getRawValue(const Tab &tab, int column) const;
+
+private:
+    /// Reads the usage of renderer processes
+    ProcessStatsReader m_reader;
+
+    /// Source of the open tabs
+    TabSource m_tabSource;
+
+    /// Source of the current time
+    Clock m_clock;
+
+    /// Triggers periodic samples
+    QTimer *m_timer;
+
+    /// Tabs as of the last sample
+    std::vector<Tab> m_tabs;
+
+    /// Usage of each renderer process, by process identifier
+    std::unordered_map<int64_t, ProcessUsage> m_processes;
+
+    /// Number of samples taken
+    int m_numSamples;
+
+    /// Time taken by the last periodic sample, in percent of the sampling interval
+    double m_samplingOverhead;
+};
+
+#endif // TABRESOURCEMODEL_H
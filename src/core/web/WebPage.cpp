@@ -5,14 +5,13 @@
 #include "BrowserApplication.h"
 #include "BrowserTabWidget.h"
 #include "CommonUtil.h"
-#include "ExtStorage.h"
 #include "FaviconManager.h"
 #include "FaviconStoreBridge.h"
-#include "FavoritePagesManager.h"
 #include "MainWindow.h"
 #include "RequestInterceptor.h"
 #include "SecurityManager.h"
 #include "Settings.h"
+#include "Tracer.h"
 #include "URL.h"
 #include "UserScriptManager.h"
 #include "WebDialog.h"
@@ -32,11 +31,14 @@
 #include <QtWebEngineCoreVersion>
 
 #include <algorithm>
+#include <cstdint>
 #include <iostream>
 #include <iterator>
 
 WebPage::WebPage(const ViperServiceLocator &serviceLocator, QObject *parent) :
     QWebEnginePage(parent),
+    m_serviceLocator(serviceLocator),
+    m_webChannel(nullptr),
     m_adBlockManager(serviceLocator.getServiceAs<adblock::AdBlockManager>("AdBlockManager")),
     m_userScriptManager(serviceLocator.getServiceAs<UserScriptManager>("UserScriptManager")),
     m_history(new WebHistory(serviceLocator, this)),
@@ -46,13 +48,15 @@ WebPage::WebPage(const ViperServiceLocator &serviceLocator, QObject *parent) :
     m_permissionsAllowed(),
     m_permissionsDenied()
 {
-    QTimer::singleShot(0, this, [this, &serviceLocator](){
-        setupSlots(serviceLocator);
+    QTimer::singleShot(0, this, [this](){
+        setupSlots();
     });
 }
 
 WebPage::WebPage(const ViperServiceLocator &serviceLocator, QWebEngineProfile *profile, QObject *parent) :
     QWebEnginePage(profile, parent),
+    m_serviceLocator(serviceLocator),
+    m_webChannel(nullptr),
     m_adBlockManager(serviceLocator.getServiceAs<adblock::AdBlockManager>("AdBlockManager")),
     m_userScriptManager(serviceLocator.getServiceAs<UserScriptManager>("UserScriptManager")),
     m_history(new WebHistory(serviceLocator, this)),
@@ -62,32 +66,38 @@ WebPage::WebPage(const ViperServiceLocator &serviceLocator, QWebEngineProfile *p
     m_permissionsAllowed(),
     m_permissionsDenied()
 {
-    QTimer::singleShot(0, this, [this, &serviceLocator](){
-        setupSlots(serviceLocator);
+    QTimer::singleShot(0, this, [this](){
+        setupSlots();
     });
 }
 
-void WebPage::setupSlots(const ViperServiceLocator &serviceLocator)
+void WebPage::setupSlots()
 {
-    setUrlRequestInterceptor(new RequestInterceptor(serviceLocator, this));
+    setUrlRequestInterceptor(new RequestInterceptor(m_serviceLocator, this));
 
-    AutoFill *autoFillManager = serviceLocator.getServiceAs<AutoFill>("AutoFill");
-
-    QWebChannel *channel = new QWebChannel(this);
-    channel->registerObject(QLatin1String("extStorage"), serviceLocator.getServiceAs<ExtStorage>("storage"));
-    channel->registerObject(QLatin1String("favoritePageManager"), serviceLocator.getServiceAs<FavoritePagesManager>("favoritePageManager"));
-    channel->registerObject(QLatin1String("autofill"), new AutoFillBridge(autoFillManager, this));
-    channel->registerObject(QLatin1String("favicons"), new FaviconStoreBridge(serviceLocator.getServiceAs<FaviconManager>("FaviconManager"), this));
-    setWebChannel(channel, QWebEngineScript::ApplicationWorld);
+    // The storage and favorite page services are registered by acceptNavigationRequest, once a page needs them
+    m_webChannel = new QWebChannel(this);
+    m_webChannel->registerObject(QLatin1String("autofill"), new AutoFillBridge(m_serviceLocator, this));
+    m_webChannel->registerObject(QLatin1String("favicons"), new FaviconStoreBridge(m_serviceLocator.getServiceAs<FaviconManager>("FaviconManager"), this));
+    setWebChannel(m_webChannel, QWebEngineScript::ApplicationWorld);
 
     connect(this, &WebPage::authenticationRequired,      this, &WebPage::onAuthenticationRequired);
     connect(this, &WebPage::certificateError,            this, &WebPage::onCertificateError);
     connect(this, &WebPage::proxyAuthenticationRequired, this, &WebPage::onProxyAuthenticationRequired);
     connect(this, &WebPage::loadFinished,                this, &WebPage::onLoadFinished);
-    connect(this, &WebPage::loadFinished,     autoFillManager, &AutoFill::onPageLoaded);
     connect(this, &WebPage::featurePermissionRequested,  this, &WebPage::onFeaturePermissionRequested);
     connect(this, &WebPage::renderProcessTerminated,     this, &WebPage::onRenderProcessTerminated);
 
+    // Page loads are traced as asynchronous spans, as several pages may be loading at the same time
+    connect(this, &WebPage::loadStarted, this, [this]() {
+        if (Tracer::isEnabled())
+            Tracer::instance().beginAsyncSpan("navigation", "PageLoad", reinterpret_cast<std::uintptr_t>(this),
+                                              requestedUrl().toString().toStdString());
+    });
+    connect(this, &WebPage::loadFinished, this, [this]() {
+        Tracer::instance().endAsyncSpan("navigation", "PageLoad", reinterpret_cast<std::uintptr_t>(this));
+    });
+
     connect(this, &WebPage::loadProgress, this, [this](int progress) {
         if (!m_injectedAdblock && progress >= 22 && progress < 100)
         {
@@ -101,6 +111,15 @@ void WebPage::setupSlots(const ViperServiceLocator &serviceLocator)
     connect(this, &WebPage::registerProtocolHandlerRequested, this, &WebPage::onRegisterProtocolHandlerRequested);
 }
 
+void WebPage::registerChannelService(const QString &objectName, const std::string &serviceName)
+{
+    if (!m_webChannel || m_webChannel->registeredObjects().contains(objectName))
+        return;
+
+    if (QObject *service = m_serviceLocator.getService(serviceName))
+        m_webChannel->registerObject(objectName, service);
+}
+
 WebHistory *WebPage::getHistory() const
 {
     return m_history;
@@ -126,6 +145,10 @@ bool WebPage::acceptNavigationRequest(const QUrl &url, QWebEnginePage::Navigatio
     if (!isMainFrame)
         return QWebEnginePage::acceptNavigationRequest(url, type, isMainFrame);
 
+    TraceSpan traceSpan("navigation", "WebPage::acceptNavigationRequest");
+    if (traceSpan.isActive())
+        traceSpan.setDetail(url.toString().toStdString());
+
     m_injectedAdblock = false;
     m_originalUrl = QUrl();
 
@@ -171,6 +194,12 @@ bool WebPage::acceptNavigationRequest(const QUrl &url, QWebEnginePage::Navigatio
         for (auto &script : pageScripts)
             scriptCollection.insert(script);
 
+        // User scripts keep their values in the extension storage, and the new tab page shows the favorite pages
+        if (!pageScripts.empty())
+            registerChannelService(QLatin1String("extStorage"), "storage");
+        if (url.scheme().compare(QLatin1String("viper")) == 0)
+            registerChannelService(QLatin1String("favoritePageManager"), "favoritePageManager");
+
         if (!m_mainFrameAdBlockScript.isEmpty())
         {
             QWebEngineScript adBlockScript;
@@ -447,6 +476,13 @@ void WebPage::onLoadFinished(bool ok)
 
     if (!m_mainFrameAdBlockScript.isEmpty())
         runJavaScript(m_mainFrameAdBlockScript, QWebEngineScript::ApplicationWorld);
+
+    // The auto fill manager is not created until it is enabled and a page has finished loading
+    if (sBrowserApplication->getSettings()->getValue(BrowserSetting::EnableAutoFill).toBool())
+    {
+        if (AutoFill *autoFill = m_serviceLocator.getServiceAs<AutoFill>("AutoFill"))
+            autoFill->onPageLoaded(this);
+    }
 }
 
 void WebPage::onQuotaRequested(QWebEngineQuotaRequest quotaRequest)
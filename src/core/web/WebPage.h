@@ -18,6 +18,7 @@ namespace adblock {
     class AdBlockManager;
 }
 
+class QWebChannel;
 class UserScriptManager;
 class WebHistory;
 
@@ -103,7 +104,11 @@ private Q_SLOTS:
 
 private:
     /// Connects web engine page signals to their handlers
-    void setupSlots(const ViperServiceLocator &serviceLocator);
+    void setupSlots();
+
+    /// Registers the service with the given name on the web channel of the page, creating the service if it was
+    /// not used yet. Services are registered the first time a page needs them, and stay registered
+    void registerChannelService(const QString &objectName, const std::string &serviceName);
 
     /// Returns true if the web feature is permitted for the given origin, false if not explicitly
     /// allowed (does not imply that a permission has been denied).
@@ -115,6 +120,12 @@ private Q_SLOTS:
     bool isPermissionDenied(const QUrl &securityOrigin, WebPage::Feature feature) const;
 
 private:
+    /// Service locator of the application
+    const ViperServiceLocator &m_serviceLocator;
+
+    /// Web channel of the page, or a nullptr until the page is set up
+    QWebChannel *m_webChannel;
+
     /// Advertisement blocking system manager
     adblock::AdBlockManager *m_adBlockManager;
 
@@ -1,9 +1,12 @@
 #include "BookmarkMenu.h"
 #include "BookmarkManager.h"
 #include "BookmarkNode.h"
+#include "FaviconPixmapCache.h"
 
 #include <deque>
 
+#include <QStyle>
+
 BookmarkMenu::BookmarkMenu(QWidget *parent) :
     QMenu(parent),
     m_addPageBookmarks(new QAction(tr("Bookmark this page"), parent)),
@@ -53,6 +56,11 @@ void BookmarkMenu::resetMenu()
     if (m_bookmarkManager->getRoot() == nullptr)
         return;
 
+    // Menus draw the pre-rasterized icons as-is instead of scaling them on every paint
+    FaviconPixmapCache &pixmapCache = FaviconPixmapCache::instance();
+    const int iconSize = style()->pixelMetric(QStyle::PM_SmallIconSize, nullptr, this);
+    const qreal pixelRatio = devicePixelRatioF();
+
     // Iteratively load bookmark data into menu
     std::deque< std::pair<BookmarkNode*, QMenu*> > folders;
     folders.push_back({ m_bookmarkManager->getRoot(), this });
@@ -69,13 +77,13 @@ void BookmarkMenu::resetMenu()
             BookmarkNode *n = currentNode->getNode(i);
             if (n->getType() == BookmarkNode::Folder)
             {
-                QMenu *subMenu = currentMenu->addMenu(n->getIcon(), n->getName());
+                QMenu *subMenu = currentMenu->addMenu(pixmapCache.rasterizedIcon(n->getIcon(), iconSize, pixelRatio), n->getName());
                 folders.push_back({n, subMenu});
                 continue;
             }
 
             QUrl link(n->getURL());
-            QAction *item = currentMenu->addAction(n->getIcon(), n->getName());
+            QAction *item = currentMenu->addAction(pixmapCache.rasterizedIcon(n->getIcon(), iconSize, pixelRatio), n->getName());
             item->setIconVisibleInMenu(true);
             currentMenu->addAction(item);
             connect(item, &QAction::triggered, [this, link](){
@@ -1,10 +1,12 @@
 #include "HistoryMenu.h"
 #include "FaviconManager.h"
+#include "FaviconPixmapCache.h"
 #include "HistoryManager.h"
 
 #include <QAction>
 #include <QList>
 #include <QKeySequence>
+#include <QStyle>
 #include <QDebug>
 #include <QTimer>
 
@@ -41,7 +43,7 @@ void HistoryMenu::setServiceLocator(const ViperServiceLocator &serviceLocator)
 void HistoryMenu::addHistoryItem(const QUrl &url, const QString &title, const QIcon &favicon)
 {
     QAction *historyItem = new QAction(title);
-    historyItem->setIcon(favicon);
+    historyItem->setIcon(getMenuIcon(favicon));
     connect(historyItem, &QAction::triggered, this, [this, url](){
         emit loadUrl(url);
     });
@@ -60,7 +62,7 @@ void HistoryMenu::prependHistoryItem(const QUrl &url, const QString &title, cons
         beforeItem = menuActions[3];
 
     QAction *historyItem = new QAction(title);
-    historyItem->setIcon(favicon);
+    historyItem->setIcon(getMenuIcon(favicon));
     connect(historyItem, &QAction::triggered, this, [this, url](){
         emit loadUrl(url);
     });
@@ -139,3 +141,9 @@ void HistoryMenu::clearOldestEntries()
         --menuSize;
     }
 }
+
+QIcon HistoryMenu::getMenuIcon(const QIcon &favicon) const
+{
+    const int iconSize = style()->pixelMetric(QStyle::PM_SmallIconSize, nullptr, this);
+    return FaviconPixmapCache::instance().rasterizedIcon(favicon, iconSize, devicePixelRatioF());
+}
@@ -62,6 +62,9 @@ private Q_SLOTS:
     /// Clears any entries at the bottom of the history menu, if
     void clearOldestEntries();
 
+    /// Returns the favicon rasterized at the menu's icon size, through the \ref FaviconPixmapCache
+    QIcon getMenuIcon(const QIcon &favicon) const;
+
 protected:
     /// History manager
     HistoryManager *m_historyManager;
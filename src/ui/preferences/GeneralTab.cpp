@@ -22,6 +22,13 @@ GeneralTab::GeneralTab(QWidget *parent) :
     // Disable download directory line edit when "always ask where to save files" is activated
     connect(ui->radioButtonAskForDir, &QRadioButton::clicked, this, &GeneralTab::toggleLineEditDownloadDir);
     connect(ui->radioButtonSaveToDir, &QRadioButton::clicked, this, &GeneralTab::toggleLineEditDownloadDir);
+
+    // Tabs can only be loaded in the background if they are not all loaded at startup
+    connect(ui->checkBoxLazyRestore, &QCheckBox::toggled, ui->spinBoxRestoreLoadLimit, &QSpinBox::setEnabled);
+
+    // The hibernation limits only apply while tabs are hibernated automatically
+    connect(ui->checkBoxAutoHibernate, &QCheckBox::toggled, ui->spinBoxHibernationIdleTime, &QSpinBox::setEnabled);
+    connect(ui->checkBoxAutoHibernate, &QCheckBox::toggled, ui->spinBoxHibernationBudget, &QSpinBox::setEnabled);
 }
 
 GeneralTab::~GeneralTab()
@@ -98,6 +105,59 @@ void GeneralTab::setAllTabsOpenInBackground(bool value)
     ui->checkBoxNewTabsInBackground->setChecked(value);
 }
 
+bool GeneralTab::isSessionRestoreLazy() const
+{
+    return ui->checkBoxLazyRestore->isChecked();
+}
+
+void GeneralTab::setSessionRestoreLazy(bool value)
+{
+    ui->checkBoxLazyRestore->setChecked(value);
+    ui->spinBoxRestoreLoadLimit->setEnabled(value);
+}
+
+int GeneralTab::getSessionRestoreLoadLimit() const
+{
+    return ui->spinBoxRestoreLoadLimit->value();
+}
+
+void GeneralTab::setSessionRestoreLoadLimit(int value)
+{
+    ui->spinBoxRestoreLoadLimit->setValue(value);
+}
+
+bool GeneralTab::isAutoHibernationEnabled() const
+{
+    return ui->checkBoxAutoHibernate->isChecked();
+}
+
+void GeneralTab::setAutoHibernationEnabled(bool value)
+{
+    ui->checkBoxAutoHibernate->setChecked(value);
+    ui->spinBoxHibernationIdleTime->setEnabled(value);
+    ui->spinBoxHibernationBudget->setEnabled(value);
+}
+
+int GeneralTab::getHibernationIdleTime() const
+{
+    return ui->spinBoxHibernationIdleTime->value();
+}
+
+void GeneralTab::setHibernationIdleTime(int minutes)
+{
+    ui->spinBoxHibernationIdleTime->setValue(minutes);
+}
+
+int GeneralTab::getHibernationBudget() const
+{
+    return ui->spinBoxHibernationBudget->value();
+}
+
+void GeneralTab::setHibernationBudget(int value)
+{
+    ui->spinBoxHibernationBudget->setValue(value);
+}
+
 void GeneralTab::toggleLineEditDownloadDir()
 {
     ui->lineEditDownloadDir->setEnabled(!ui->lineEditDownloadDir->isEnabled());
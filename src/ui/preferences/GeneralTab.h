@@ -70,6 +70,36 @@ class GeneralTab : public QWidget
     /// some tabs will take focus when opened.
     void setAllTabsOpenInBackground(bool value);
 
+    /// Returns true if only the active tabs of a restored session should be loaded at startup, false if every tab should be loaded
+    bool isSessionRestoreLazy() const;
+
+    /// Sets whether only the active tabs of a restored session are loaded at startup, the other tabs being loaded when selected
+    void setSessionRestoreLazy(bool value);
+
+    /// Returns the number of tabs of a restored session that can be loaded in the background at the same time
+    int getSessionRestoreLoadLimit() const;
+
+    /// Sets the number of tabs of a restored session that can be loaded in the background at the same time
+    void setSessionRestoreLoadLimit(int value);
+
+    /// Returns true if background tabs should be hibernated automatically, false if else
+    bool isAutoHibernationEnabled() const;
+
+    /// Sets whether background tabs are hibernated automatically
+    void setAutoHibernationEnabled(bool value);
+
+    /// Returns the number of minutes after which a background tab is hibernated, or zero if tabs are not hibernated for being inactive
+    int getHibernationIdleTime() const;
+
+    /// Sets the number of minutes after which a background tab is hibernated
+    void setHibernationIdleTime(int minutes);
+
+    /// Returns the maximum number of tabs that are kept loaded, or zero if there is no limit
+    int getHibernationBudget() const;
+
+    /// Sets the maximum number of tabs that are kept loaded
+    void setHibernationBudget(int value);
+
 private Q_SLOTS:
     /// Toggles the active/inactive state of the line edit associated with the download directory
     void toggleLineEditDownloadDir();
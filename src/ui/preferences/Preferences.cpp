@@ -43,6 +43,11 @@ void Preferences::loadSettings()
     ui->tabGeneral->setStartupIndex(m_settings->getValue(BrowserSetting::StartupMode).toInt());
     ui->tabGeneral->setNewTabPageType(static_cast<NewTabType>(m_settings->getValue(BrowserSetting::NewTabPage).toInt()));
     ui->tabGeneral->setAllTabsOpenInBackground(m_settings->getValue(BrowserSetting::OpenAllTabsInBackground).toBool());
+    ui->tabGeneral->setSessionRestoreLazy(m_settings->getValue(BrowserSetting::LazySessionRestore).toBool());
+    ui->tabGeneral->setSessionRestoreLoadLimit(m_settings->getValue(BrowserSetting::SessionRestoreLoadLimit).toInt());
+    ui->tabGeneral->setAutoHibernationEnabled(m_settings->getValue(BrowserSetting::AutoHibernateTabs).toBool());
+    ui->tabGeneral->setHibernationIdleTime(m_settings->getValue(BrowserSetting::TabHibernationIdleTime).toInt());
+    ui->tabGeneral->setHibernationBudget(m_settings->getValue(BrowserSetting::TabHibernationBudget).toInt());
 
     ui->tabContent->toggleAdBlock(m_settings->getValue(BrowserSetting::AdBlockPlusEnabled).toBool());
     ui->tabContent->toggleAnimatedScrolling(m_settings->getValue(BrowserSetting::ScrollAnimatorEnabled).toBool());
@@ -66,6 +71,8 @@ void Preferences::loadSettings()
     ui->tabPrivacy->setCookiesDeleteWithSession(m_settings->getValue(BrowserSetting::CookiesDeleteWithSession).toBool());
     ui->tabPrivacy->setThirdPartyCookiesEnabled(m_settings->getValue(BrowserSetting::EnableThirdPartyCookies).toBool());
     ui->tabPrivacy->setDoNotTrackEnabled(m_settings->getValue(BrowserSetting::SendDoNotTrack).toBool());
+    ui->tabPrivacy->setSpeculativeConnectionsEnabled(m_settings->getValue(BrowserSetting::EnableSpeculativeConnections).toBool());
+    ui->tabPrivacy->setSpeculativePrerenderEnabled(m_settings->getValue(BrowserSetting::EnableSpeculativePrerender).toBool());
 
     AppInitSettings initSettings;
     if (initSettings.hasSetting(AppInitKey::ProcessModel))
@@ -93,6 +100,11 @@ void Preferences::onCloseWithSave()
     m_settings->setValue(BrowserSetting::StartupMode, ui->tabGeneral->getStartupIndex());
     m_settings->setValue(BrowserSetting::NewTabPage, static_cast<int>(ui->tabGeneral->getNewTabPageType()));
     m_settings->setValue(BrowserSetting::OpenAllTabsInBackground, ui->tabGeneral->openAllTabsInBackground());
+    m_settings->setValue(BrowserSetting::LazySessionRestore, ui->tabGeneral->isSessionRestoreLazy());
+    m_settings->setValue(BrowserSetting::SessionRestoreLoadLimit, ui->tabGeneral->getSessionRestoreLoadLimit());
+    m_settings->setValue(BrowserSetting::AutoHibernateTabs, ui->tabGeneral->isAutoHibernationEnabled());
+    m_settings->setValue(BrowserSetting::TabHibernationIdleTime, ui->tabGeneral->getHibernationIdleTime());
+    m_settings->setValue(BrowserSetting::TabHibernationBudget, ui->tabGeneral->getHibernationBudget());
 
     // Save preferences in Content tab
     m_settings->setValue(BrowserSetting::AdBlockPlusEnabled, ui->tabContent->isAdBlockEnabled());
@@ -121,6 +133,8 @@ void Preferences::onCloseWithSave()
     m_settings->setValue(BrowserSetting::CookiesDeleteWithSession, ui->tabPrivacy->areCookiesDeletedWithSession());
     m_settings->setValue(BrowserSetting::EnableThirdPartyCookies, ui->tabPrivacy->areThirdPartyCookiesEnabled());
     m_settings->setValue(BrowserSetting::SendDoNotTrack, ui->tabPrivacy->isDoNotTrackEnabled());
+    m_settings->setValue(BrowserSetting::EnableSpeculativeConnections, ui->tabPrivacy->areSpeculativeConnectionsEnabled());
+    m_settings->setValue(BrowserSetting::EnableSpeculativePrerender, ui->tabPrivacy->isSpeculativePrerenderEnabled());
 
     // Application initialization-related settings (requires restart to take effect)
     AppInitSettings initSettings;
@@ -68,6 +68,16 @@ bool PrivacyTab::isDoNotTrackEnabled() const
     return ui->checkBoxDoNotTrack->isChecked();
 }
 
+bool PrivacyTab::areSpeculativeConnectionsEnabled() const
+{
+    return ui->checkBoxSpeculativeConnections->isChecked();
+}
+
+bool PrivacyTab::isSpeculativePrerenderEnabled() const
+{
+    return ui->checkBoxSpeculativePrerender->isChecked();
+}
+
 void PrivacyTab::setAutoFillEnabled(bool value)
 {
     ui->checkBoxEnableAutoFill->setChecked(value);
@@ -106,6 +116,16 @@ void PrivacyTab::setDoNotTrackEnabled(bool value)
     ui->checkBoxDoNotTrack->setChecked(value);
 }
 
+void PrivacyTab::setSpeculativeConnectionsEnabled(bool value)
+{
+    ui->checkBoxSpeculativeConnections->setChecked(value);
+}
+
+void PrivacyTab::setSpeculativePrerenderEnabled(bool value)
+{
+    ui->checkBoxSpeculativePrerender->setChecked(value);
+}
+
 void PrivacyTab::onManageCookieExceptionsClicked()
 {
     ExemptThirdPartyCookieDialog *dialog = new ExemptThirdPartyCookieDialog(m_cookieJar);
@@ -48,6 +48,12 @@ class PrivacyTab : public QWidget
     /// Returns true if the setting to pass a 'Do Not Track' header is enabled, false if disabled
     bool isDoNotTrackEnabled() const;
 
+    /// Returns true if connections are opened to the site being typed into the URL bar, false if else
+    bool areSpeculativeConnectionsEnabled() const;
+
+    /// Returns true if the site being typed into the URL bar is loaded in the background, false if else
+    bool isSpeculativePrerenderEnabled() const;
+
 Q_SIGNALS:
     /// Emitted when the user requests to clear their browsing history.
     void clearHistoryRequested();
@@ -83,6 +89,12 @@ public Q_SLOTS:
     /// otherwise will not send any DNT header
     void setDoNotTrackEnabled(bool value);
 
+    /// Sets whether connections are opened to the site being typed into the URL bar
+    void setSpeculativeConnectionsEnabled(bool value);
+
+    /// Sets whether the site being typed into the URL bar is loaded in the background
+    void setSpeculativePrerenderEnabled(bool value);
+
 private Q_SLOTS:
     /// Called when the push button to manage third party cookie exceptions is clicked
     void onManageCookieExceptionsClicked();
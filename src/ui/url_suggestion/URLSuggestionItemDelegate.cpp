@@ -1,4 +1,5 @@
 #include "BrowserApplication.h"
+#include "FaviconPixmapCache.h"
 #include "URLSuggestionItemDelegate.h"
 #include "URLSuggestionListModel.h"
 
@@ -35,7 +36,7 @@ void URLSuggestionItemDelegate::paint(QPainter *painter, const QStyleOptionViewI
     // Draw favicon
     QRect faviconRect(itemRect.left() + m_padding, cy - 8, 16, 16);
     QIcon favicon = index.data(URLSuggestionListModel::Favicon).value<QIcon>();
-    painter->drawPixmap(faviconRect, favicon.pixmap(16, 16));
+    painter->drawPixmap(faviconRect, FaviconPixmapCache::instance().pixmap(favicon, 16, painter->device()->devicePixelRatioF()));
 
     // Draw title
     QFont titleFont = itemOption.font;
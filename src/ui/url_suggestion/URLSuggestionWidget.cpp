@@ -1,4 +1,6 @@
 #include "BrowserApplication.h"
+#include "MainWindow.h"
+#include "SpeculativeLoader.h"
 #include "URLSuggestionItemDelegate.h"
 #include "URLSuggestionListModel.h"
 #include "URLSuggestionWidget.h"
@@ -19,6 +21,8 @@ URLSuggestionWidget::URLSuggestionWidget(QWidget *parent) :
     m_suggestionList(nullptr),
     m_model(nullptr),
     m_worker(nullptr),
+    m_serviceLocator(nullptr),
+    m_speculativeLoader(nullptr),
     m_lineEdit(nullptr),
     m_searchTerm(),
     m_workerThread()
@@ -47,6 +51,7 @@ URLSuggestionWidget::URLSuggestionWidget(QWidget *parent) :
     connect(&m_workerThread, &QThread::finished, m_worker, &QObject::deleteLater);
     connect(this, &URLSuggestionWidget::determineSuggestions, m_worker, &URLSuggestionWorker::findSuggestionsFor);
     connect(m_worker, &URLSuggestionWorker::finishedSearch, m_model, &URLSuggestionListModel::setSuggestions);
+    connect(m_worker, &URLSuggestionWorker::finishedSearch, this, &URLSuggestionWidget::onSuggestionsFound);
 
     // Setup layout
     auto vboxLayout = new QVBoxLayout(this);
@@ -100,6 +105,9 @@ bool URLSuggestionWidget::eventFilter(QObject *watched, QEvent *event)
             {
                 case Qt::Key_Escape:
                 {
+                    if (m_speculativeLoader)
+                        m_speculativeLoader->cancel();
+
                     close();
                     emit noSuggestionChosen(m_searchTerm);
                     return true;
@@ -223,6 +231,9 @@ void URLSuggestionWidget::suggestForInput(const QString &text)
 
     if (text.isEmpty())
     {
+        if (m_speculativeLoader)
+            m_speculativeLoader->cancel();
+
         close();
         m_searchTerm = text;
         return;
@@ -246,6 +257,7 @@ void URLSuggestionWidget::setURLLineEdit(URLLineEdit *lineEdit)
 void URLSuggestionWidget::setServiceLocator(const ViperServiceLocator &serviceLocator)
 {
     m_worker->setServiceLocator(serviceLocator);
+    m_serviceLocator = &serviceLocator;
 }
 
 QSize URLSuggestionWidget::sizeHint() const
@@ -271,3 +283,22 @@ void URLSuggestionWidget::onSuggestionClicked(const QModelIndex &index)
         emit urlChosen(QUrl(index.data(URLSuggestionListModel::Link).toString()));
     }
 }
+
+void URLSuggestionWidget::onSuggestionsFound(const std::vector<URLSuggestion> &results)
+{
+    if (m_serviceLocator == nullptr || m_lineEdit == nullptr || m_searchTerm.isEmpty())
+        return;
+
+    // Private windows must not leave traces of their input in the regular browsing profile
+    MainWindow *window = qobject_cast<MainWindow*>(m_lineEdit->window());
+    if (window == nullptr || window->isPrivate())
+        return;
+
+    // The speculative loader is created when the user first types into the URL bar
+    if (!m_speculativeLoader)
+        m_speculativeLoader = m_serviceLocator->getServiceAs<SpeculativeLoader>("SpeculativeLoader");
+    if (!m_speculativeLoader)
+        return;
+
+    m_speculativeLoader->speculate(m_searchTerm, results);
+}
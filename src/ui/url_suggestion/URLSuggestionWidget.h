@@ -2,11 +2,15 @@
 #define URLSUGGESTIONWIDGET_H
 
 #include "ServiceLocator.h"
+#include "URLSuggestion.h"
+
+#include <vector>
 
 #include <QString>
 #include <QThread>
 #include <QWidget>
 
+class SpeculativeLoader;
 class URLLineEdit;
 class URLSuggestionListModel;
 class URLSuggestionWorker;
@@ -41,7 +45,8 @@ class URLSuggestionWidget final : public QWidget
     /// Sets the pointer to the URL line edit
     void setURLLineEdit(URLLineEdit *lineEdit);
 
-    /// Sets the reference to the service locator, which is passed on to the \ref URLSuggestionWorker
+    /// Sets the reference to the service locator, which is passed on to the \ref URLSuggestionWorker , and used to
+    /// find the \ref SpeculativeLoader
     void setServiceLocator(const ViperServiceLocator &serviceLocator);
 
     /// Returns the suggested size of the widget
@@ -67,6 +72,9 @@ private Q_SLOTS:
     /// Called when an item in the suggestion list at the given index is clicked
     void onSuggestionClicked(const QModelIndex &index);
 
+    /// Called when the worker has found suggestions for the input, to connect to the most likely site early
+    void onSuggestionsFound(const std::vector<URLSuggestion> &results);
+
 private:
     /// List view containing suggested URLs
     QListView *m_suggestionList;
@@ -77,6 +85,12 @@ private Q_SLOTS:
     /// Worker that fetches the suggestions
     URLSuggestionWorker *m_worker;
 
+    /// Service locator of the application, from which the speculative loader is looked up on first use
+    const ViperServiceLocator *m_serviceLocator;
+
+    /// Connects to, or loads, the most likely suggestion before the input is submitted. Null until first used
+    SpeculativeLoader *m_speculativeLoader;
+
     /// Pointer to the URL line edit
     URLLineEdit *m_lineEdit;
 
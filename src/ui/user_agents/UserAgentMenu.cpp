@@ -8,6 +8,7 @@
 
 UserAgentMenu::UserAgentMenu(QWidget *parent) :
     QMenu(parent),
+    m_serviceLocator(nullptr),
     m_settings(nullptr),
     m_userAgentManager(nullptr),
     m_userAgentGroup(new QActionGroup(this))
@@ -16,6 +17,7 @@ UserAgentMenu::UserAgentMenu(QWidget *parent) :
 
 UserAgentMenu::UserAgentMenu(const QString &title, QWidget *parent) :
     QMenu(title, parent),
+    m_serviceLocator(nullptr),
     m_settings(nullptr),
     m_userAgentManager(nullptr),
     m_userAgentGroup(new QActionGroup(this))
@@ -28,12 +30,22 @@ UserAgentMenu::~UserAgentMenu()
 
 void UserAgentMenu::setServiceLocator(const ViperServiceLocator &serviceLocator)
 {
-    if (m_settings != nullptr || m_userAgentManager != nullptr)
+    if (m_serviceLocator != nullptr)
         return;
 
+    m_serviceLocator = &serviceLocator;
     m_settings = serviceLocator.getServiceAs<Settings>("Settings");
-    m_userAgentManager = serviceLocator.getServiceAs<UserAgentManager>("UserAgentManager");
 
+    // The user agent manager is not needed until the menu is opened
+    connect(this, &QMenu::aboutToShow, this, &UserAgentMenu::onAboutToShow);
+}
+
+void UserAgentMenu::onAboutToShow()
+{
+    if (m_userAgentManager != nullptr || m_serviceLocator == nullptr)
+        return;
+
+    m_userAgentManager = m_serviceLocator->getServiceAs<UserAgentManager>("UserAgentManager");
     if (m_userAgentManager != nullptr)
     {
         setup();
@@ -31,19 +31,26 @@ class UserAgentMenu : public QMenu
 
 protected:
     /// Passes a reference to the service locator, which allows the menu
-    /// to fetch the instance of the User Agent manager as well as the
-    /// application settings
+    /// to fetch the application settings, and the instance of the User Agent
+    /// manager once the menu is first shown
     void setServiceLocator(const ViperServiceLocator &serviceLocator);
 
 public Q_SLOTS:
     /// Resets the items belonging to the user agent menu
     void resetItems();
 
+private Q_SLOTS:
+    /// Fetches the user agent manager and populates the menu, the first time the menu is about to be shown
+    void onAboutToShow();
+
 private:
     /// Connects signals from the user agent manager to the appropriate UI update calls in the menu
     void setup();
 
 private:
+    /// Service locator, which creates the user agent manager on first use
+    const ViperServiceLocator *m_serviceLocator;
+
     /// Application settings
     Settings *m_settings;
 
@@ -40,8 +40,7 @@ WebView::WebView(bool privateView, QWidget *parent) :
     m_privateView(privateView),
     m_contextMenuHelper(),
     m_jsCallbackResult(),
-    m_viewFocusProxy(nullptr),
-    m_thumbnail()
+    m_viewFocusProxy(nullptr)
 {
     setAcceptDrops(true);
     setObjectName(QStringLiteral("webView"));
@@ -100,11 +99,25 @@ QString WebView::getTitle() const
     return pageUrl.host();
 }
 
-const QPixmap &WebView::getThumbnail()
+QImage WebView::grabThumbnailSource()
 {
-    if (m_thumbnail.isNull())
-        makeThumbnailOfPage();
-    return m_thumbnail;
+    QQuickWidget *qQuickChild = qobject_cast<QQuickWidget*>(focusProxy());
+    if (!qQuickChild)
+    {
+        QList<QQuickWidget*> children = findChildren<QQuickWidget*>();
+        for (int i = children.size() - 1; i >= 0; --i)
+        {
+            QQuickWidget *w = children.at(i);
+            if (w && w->isVisible())
+            {
+                qQuickChild = w;
+                break;
+            }
+        }
+    }
+
+    // Read back the rendered frame directly, rather than grabbing a QPixmap of the widget and converting it
+    return (qQuickChild != nullptr) ? qQuickChild->grabFramebuffer() : QImage();
 }
 
 void WebView::load(const QUrl &url)
@@ -345,39 +358,11 @@ void WebView::onFullScreenRequested(QWebEngineFullScreenRequest request)
     request.accept();
 }
 
-void WebView::onLoadFinished(bool ok)
+void WebView::onLoadFinished(bool /*ok*/)
 {
     m_progress = 100;
 
     Q_EMIT iconChanged(icon());
-
-    if (ok && !isOnBlankPage())
-        makeThumbnailOfPage();
-    else
-        m_thumbnail = QPixmap();
-}
-
-void WebView::makeThumbnailOfPage()
-{
-    QQuickWidget *qQuickChild = qobject_cast<QQuickWidget*>(focusProxy());
-    if (qQuickChild)
-    {
-        m_thumbnail = qQuickChild->grab().scaled(QSize(375, 500));
-        return;
-    }
-
-    QList<QQuickWidget*> children = findChildren<QQuickWidget*>();
-    for (int i = children.size() - 1; i >= 0; --i)
-    {
-        QQuickWidget *w = children.at(i);
-        if (w && w->isVisible())
-        {
-            qQuickChild = w;
-            break;
-        }
-    }
-
-    m_thumbnail = (qQuickChild != nullptr) ? qQuickChild->grab().scaled(QSize(375, 500)) : QPixmap();
 }
 
 void WebView::setViewFocusProxy(QWidget *w)
@@ -3,6 +3,7 @@
 
 #include "ServiceLocator.h"
 
+#include <QImage>
 #include <QPointer>
 #include <QWebEngineContextMenuRequest>
 #include <QWebEngineFullScreenRequest>
@@ -65,8 +66,9 @@ class WebView : public QWebEngineView
     /// Returns a pointer to the \ref WebPage
     WebPage *getPage() const;
 
-    /// Returns a thumbnail of the current page, or a null QPixmap if the thumbnail could not be obtained
-    const QPixmap &getThumbnail();
+    /// Returns the framebuffer of the page's renderer widget, to be turned into a thumbnail
+    /// by the \ref ThumbnailCapturePipeline . Returns a null image if it could not be obtained.
+    QImage grabThumbnailSource();
 
 public Q_SLOTS:
     /// Resets the zoom factor to its base value
@@ -141,10 +143,6 @@ private Q_SLOTS:
     /// Emitted when the page of the view has requested full screen to be enabled if on is true, or disabled if on is false
     void fullScreenRequested(bool on);
 
-private:
-    /// Generates a thumbnail of the current web page
-    void makeThumbnailOfPage();
-
 private:
     /// Web page behind this view
     WebPage *m_page;
@@ -166,9 +164,6 @@ private Q_SLOTS:
 
     /// Pointer to the WebView's focus proxy
     QPointer<QWidget> m_viewFocusProxy;
-
-    /// Thumbnail of the current page
-    QPixmap m_thumbnail;
 };
 
 #endif // WEBVIEW_H
@@ -24,7 +24,35 @@
 
 #include <QDebug>
 
+#if (QTWEBENGINECORE_VERSION >= QT_VERSION_CHECK(5, 14, 0))
+namespace
+{
+    using namespace std::chrono_literals;
+
+    /// Time for which a tab is hidden before its page is frozen
+    constexpr std::chrono::seconds LifecycleFreezeDelay = 60s;
+
+    /// Time for which a page stays frozen before it is discarded
+    constexpr std::chrono::minutes LifecycleDiscardDelay = 45min;
+
+    /// Delay before trying again to freeze or discard a page that the engine recommended to keep as it was,
+    /// because it is playing audio, being inspected or holding form input
+    constexpr std::chrono::seconds LifecycleRetryDelay = 60s;
+}
+#endif
+
 WebWidget::WebWidget(const ViperServiceLocator &serviceLocator, bool privateMode, QWidget *parent) :
+    WebWidget(serviceLocator, privateMode, false, parent)
+{
+}
+
+WebWidget::WebWidget(const ViperServiceLocator &serviceLocator, bool privateMode, WebState &&state, QWidget *parent) :
+    WebWidget(serviceLocator, privateMode, true, parent)
+{
+    m_savedState = std::move(state);
+}
+
+WebWidget::WebWidget(const ViperServiceLocator &serviceLocator, bool privateMode, bool hibernating, QWidget *parent) :
     QWidget(parent),
     m_serviceLocator(serviceLocator),
     m_adBlockManager(serviceLocator.getServiceAs<adblock::AdBlockManager>("AdBlockManager")),
@@ -42,7 +70,8 @@ WebWidget::WebWidget(const ViperServiceLocator &serviceLocator, bool privateMode
     m_contextMenuPosGlobal(),
     m_contextMenuPosRelative(),
     m_viewFocusProxy(nullptr),
-    m_hibernating(false),
+    m_hibernating(hibernating),
+    m_wakeOnActivation(false),
     m_savedState(),
     m_lastTypedUrl()
 {
@@ -50,15 +79,22 @@ WebWidget::WebWidget(const ViperServiceLocator &serviceLocator, bool privateMode
 
     m_mainWindow = qobject_cast<MainWindow*>(window());
 
-    setupWebView();
-
     QVBoxLayout *vLayout = new QVBoxLayout(this);
     vLayout->setContentsMargins(0, 0, 0, 0);
     vLayout->setSpacing(0);
-    vLayout->addWidget(m_view);
     setLayout(vLayout);
 
-    setFocusProxy(m_view);
+    if (m_hibernating)
+    {
+        setCursor(Qt::PointingHandCursor);
+        setAutoFillBackground(true);
+    }
+    else
+    {
+        setupWebView();
+        vLayout->addWidget(m_view);
+        setFocusProxy(m_view);
+    }
 
     if (BrowserTabWidget *tabWidget = qobject_cast<BrowserTabWidget*>(parentWidget()))
     {
@@ -103,6 +139,36 @@ bool WebWidget::isHibernating() const
     return m_hibernating;
 }
 
+TabLifecycle WebWidget::getLifecycle() const
+{
+    if (m_hibernating || m_page == nullptr)
+        return TabLifecycle::Hibernated;
+
+#if (QTWEBENGINECORE_VERSION >= QT_VERSION_CHECK(5, 14, 0))
+    switch (m_page->lifecycleState())
+    {
+        case WebPage::LifecycleState::Frozen:
+            return TabLifecycle::Frozen;
+        case WebPage::LifecycleState::Discarded:
+            return TabLifecycle::Discarded;
+        default:
+            break;
+    }
+#endif
+
+    return TabLifecycle::Active;
+}
+
+bool WebWidget::wakesOnActivation() const
+{
+    return m_wakeOnActivation;
+}
+
+void WebWidget::setWakeOnActivation(bool value)
+{
+    m_wakeOnActivation = value && m_hibernating;
+}
+
 bool WebWidget::isOnBlankPage() const
 {
     if (m_hibernating)
@@ -189,6 +255,8 @@ void WebWidget::setHibernation(bool on)
     if (m_hibernating == on)
         return;
 
+    m_wakeOnActivation = false;
+
     if (on)
     {
         emit aboutToHibernate();
@@ -232,6 +300,8 @@ void WebWidget::setHibernation(bool on)
     }
 
     m_hibernating = on;
+
+    emit lifecycleChanged(getLifecycle());
 }
 
 void WebWidget::setWebState(WebState &&state)
@@ -348,14 +418,13 @@ void WebWidget::mousePressEvent(QMouseEvent *event)
 
 void WebWidget::hideEvent(QHideEvent *event)
 {
-    using namespace std::chrono_literals;
     QWidget::hideEvent(event);
 
     if (!m_hibernating && m_view)
         m_view->hideEvent(event);
 
     if (m_lifecycleFreezeTimerId == -1 && m_lifecycleDiscardTimerId == -1)
-        m_lifecycleFreezeTimerId = startTimer(60s);
+        m_lifecycleFreezeTimerId = startTimer(LifecycleFreezeDelay);
 }
 
 void WebWidget::showEvent(QShowEvent *event)
@@ -418,17 +487,23 @@ void WebWidget::timerEvent(QTimerEvent *event)
             return;
         }
 
-        if (m_inspector != nullptr
-                && m_inspector->page()->inspectedPage() == static_cast<QWebEnginePage*>(m_page))
+        // The engine recommends keeping pages that play audio, are being inspected or hold form input active,
+        // and pages with form input undiscarded. Such pages are checked again later rather than forced
+        const bool isInspected = m_inspector != nullptr
+                && m_inspector->page()->inspectedPage() == static_cast<QWebEnginePage*>(m_page);
+        if (isInspected || static_cast<int>(m_page->recommendedState()) < static_cast<int>(targetState))
+        {
+            if (targetState == WebPage::LifecycleState::Frozen)
+                m_lifecycleFreezeTimerId = startTimer(LifecycleRetryDelay);
+            else
+                m_lifecycleDiscardTimerId = startTimer(LifecycleRetryDelay);
             return;
+        }
 
         m_page->setLifecycleState(targetState);
 
         if (targetState == WebPage::LifecycleState::Frozen)
-        {
-            using namespace std::chrono_literals;
-            m_lifecycleDiscardTimerId = startTimer(45min);
-        }
+            m_lifecycleDiscardTimerId = startTimer(LifecycleDiscardDelay);
     }
     else
         QWidget::timerEvent(event);
@@ -487,6 +562,12 @@ void WebWidget::setupWebView()
     connect(m_page, &WebPage::windowCloseRequested, this, &WebWidget::closeRequest);
     connect(m_page, &WebPage::urlChanged,           this, &WebWidget::urlChanged);
 
+#if (QTWEBENGINECORE_VERSION >= QT_VERSION_CHECK(5, 14, 0))
+    connect(m_page, &WebPage::lifecycleStateChanged, this, [this](){
+        emit lifecycleChanged(getLifecycle());
+    });
+#endif
+
     connect(m_page, &WebPage::loadStarted, this, [this](){
         m_adBlockManager->loadStarted(m_page->url().adjusted(QUrl::RemoveFragment));
     });
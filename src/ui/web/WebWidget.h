@@ -2,6 +2,7 @@
 #define WEBWIDGET_H
 
 #include "ServiceLocator.h"
+#include "TabLifecycle.h"
 #include "WebState.h"
 
 #include <QIcon>
@@ -51,6 +52,15 @@ class WebWidget : public QWidget
      */
     explicit WebWidget(const ViperServiceLocator &serviceLocator, bool privateMode, QWidget *parent = nullptr);
 
+    /**
+     * @brief Constructs the WebWidget in hibernation mode, without creating its web view until it wakes up
+     * @param serviceLocator Web browser service registry / locator
+     * @param privateMode Set to true if the web view should be off-the-record, false if a regular web view
+     * @param state State of the web page to be loaded when the widget wakes up
+     * @param parent Pointer to the parent widget
+     */
+    WebWidget(const ViperServiceLocator &serviceLocator, bool privateMode, WebState &&state, QWidget *parent = nullptr);
+
     /// WebWidget destructor
     ~WebWidget();
 
@@ -63,6 +73,17 @@ class WebWidget : public QWidget
     /// Returns true if the web widget is in hibernation mode, false if else
     bool isHibernating() const;
 
+    /// Returns the stage of the lifecycle of the tab, from active to hibernated
+    TabLifecycle getLifecycle() const;
+
+    /// Returns true if the widget will wake up from hibernation as soon as its tab is activated, false if
+    /// the user has to click on it first
+    bool wakesOnActivation() const;
+
+    /// Sets whether the widget wakes up from hibernation as soon as its tab is activated. This is used by tabs
+    /// of a restored session that have not been loaded yet, and is reset when the hibernation state changes
+    void setWakeOnActivation(bool value);
+
     /// Returns true if the view's page is blank, with no resources being loaded
     bool isOnBlankPage() const;
 
@@ -149,6 +170,9 @@ public Q_SLOTS:
     /// Emitted when the widget is about to wake up from its hibernated state
     void aboutToWake();
 
+    /// Emitted when the page has been frozen, discarded, hibernated or made active again
+    void lifecycleChanged(TabLifecycle lifecycle);
+
     /// Emitted when the web view should be closed
     void closeRequest();
 
@@ -214,6 +238,9 @@ private Q_SLOTS:
     void onTabPinned(int index, bool value);
 
 private:
+    /// Constructs the WebWidget, creating its web view unless it starts in hibernation mode
+    WebWidget(const ViperServiceLocator &serviceLocator, bool privateMode, bool hibernating, QWidget *parent);
+
     /// Forces a repaint of the inner web page
     void forceRepaint();
 
@@ -268,6 +295,9 @@ private Q_SLOTS:
     /// True if the widget is in hibernation mode, false if else
     bool m_hibernating;
 
+    /// True if the widget wakes up from hibernation when its tab is activated
+    bool m_wakeOnActivation;
+
     /// Current state of the web page (icon, page title, url, etc.) in order to transition in and out of hibernation mode, close and re-open a tab, etc
     WebState m_savedState;
 
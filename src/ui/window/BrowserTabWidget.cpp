@@ -2,15 +2,18 @@
 #include "BrowserTabWidget.h"
 #include "BrowserTabBar.h"
 #include "FaviconManager.h"
+#include "FaviconPixmapCache.h"
 #include "MainWindow.h"
 #include "WebPage.h"
 #include "WebView.h"
 
 #include <algorithm>
+#include <QColor>
 #include <QEvent>
 #include <QKeyEvent>
 #include <QMouseEvent>
 #include <QMenu>
+#include <QPalette>
 #include <QTimer>
 
 BrowserTabWidget::BrowserTabWidget(const ViperServiceLocator &serviceLocator, bool privateMode, QWidget *parent) :
@@ -127,8 +130,8 @@ void BrowserTabWidget::reopenLastTab()
     WebWidget *ww = newBackgroundTabAtIndex(tabInfo.index);
     m_tabBar->setTabPinned(tabInfo.index, tabInfo.isPinned);
     setTabText(tabInfo.index, tabInfo.title);
-    setTabToolTip(tabInfo.index, tabInfo.title);
-    setTabIcon(tabInfo.index, tabInfo.icon);
+    updateTabToolTip(tabInfo.index, ww->getLifecycle());
+    setTabFavicon(tabInfo.index, tabInfo.icon);
     ww->setWebState(std::move(tabInfo));
 
     m_closedTabs.pop_front();
@@ -200,10 +203,32 @@ void BrowserTabWidget::duplicateTab(int index)
 WebWidget *BrowserTabWidget::createWebWidget()
 {
     WebWidget *ww = new WebWidget(m_serviceLocator, m_privateBrowsing, this);
+    setupWebWidget(ww);
+
+    auto newTabPage = static_cast<NewTabType>(m_settings->getValue(BrowserSetting::NewTabPage).toInt());
+    switch (newTabPage)
+    {
+        case NewTabType::HomePage:
+            ww->load(QUrl::fromUserInput(m_settings->getValue(BrowserSetting::HomePage).toString()));
+            break;
+        case NewTabType::BlankPage:
+            ww->loadBlankPage();
+            break;
+        case NewTabType::FavoritesPage:
+            ww->load(QUrl(QLatin1String("viper://newtab")));
+            break;
+    }
+
+    return ww;
+}
+
+void BrowserTabWidget::setupWebWidget(WebWidget *ww)
+{
     if (m_mainWindow)
     {
         ww->setMaximumWidth(m_mainWindow->maximumWidth());
-        ww->view()->setMaximumWidth(m_mainWindow->maximumWidth());
+        if (ww->view())
+            ww->view()->setMaximumWidth(m_mainWindow->maximumWidth());
     }
 
     // Connect web view signals to functionalty
@@ -217,6 +242,7 @@ WebWidget *BrowserTabWidget::createWebWidget()
     connect(ww, &WebWidget::titleChanged,           this, &BrowserTabWidget::onTitleChanged);
     connect(ww, &WebWidget::urlChanged,             this, &BrowserTabWidget::onUrlChanged);
     connect(ww, &WebWidget::closeRequest,           this, &BrowserTabWidget::onViewCloseRequested);
+    connect(ww, &WebWidget::lifecycleChanged,       this, &BrowserTabWidget::onLifecycleChanged);
 
     connect(ww, &WebWidget::openHttpRequestInBackgroundTab, this, &BrowserTabWidget::openHttpRequestInBackgroundTab);
 
@@ -233,26 +259,16 @@ WebWidget *BrowserTabWidget::createWebWidget()
 
     if (!m_privateBrowsing)
     {
+        // The icon URL is reported before the engine has loaded the icon, so only pass the icon
+        // along once the engine has it. The favicon manager will wait on it before downloading.
         connect(ww, &WebWidget::iconUrlChanged, this, [this, ww](const QUrl &url) {
-            m_faviconManager->updateIcon(url, ww->url(), ww->getIcon());
+            m_faviconManager->updateIcon(url, ww->url(), QIcon());
+        });
+        connect(ww, &WebWidget::iconChanged, this, [this, ww](const QIcon &icon) {
+            if (!icon.isNull())
+                m_faviconManager->updateIcon(ww->getIconUrl(), ww->url(), icon);
         });
     }
-
-    auto newTabPage = static_cast<NewTabType>(m_settings->getValue(BrowserSetting::NewTabPage).toInt());
-    switch (newTabPage)
-    {
-        case NewTabType::HomePage:
-            ww->load(QUrl::fromUserInput(m_settings->getValue(BrowserSetting::HomePage).toString()));
-            break;
-        case NewTabType::BlankPage:
-            ww->loadBlankPage();
-            break;
-        case NewTabType::FavoritesPage:
-            ww->load(QUrl(QLatin1String("viper://newtab")));
-            break;
-    }
-
-    return ww;
 }
 
 WebWidget *BrowserTabWidget::newTab()
@@ -263,18 +279,7 @@ WebWidget *BrowserTabWidget::newTab()
 WebWidget *BrowserTabWidget::newTabAtIndex(int index)
 {
     WebWidget *ww = createWebWidget();
-
-    if (index >= 0)
-    {
-        if (index > count())
-            index = count();
-
-        index = insertTab(index, ww, QLatin1String("New Tab"));
-        if (index <= m_nextTabIndex)
-            ++m_nextTabIndex;
-    }
-    else
-        m_nextTabIndex = insertTab(m_nextTabIndex, ww, QLatin1String("New Tab")) + 1;
+    insertWebWidget(index, ww);
 
     m_activeView = ww;
     setCurrentWidget(ww);
@@ -294,7 +299,37 @@ WebWidget *BrowserTabWidget::newBackgroundTab()
 WebWidget *BrowserTabWidget::newBackgroundTabAtIndex(int index)
 {
     WebWidget *ww = createWebWidget();
+    insertWebWidget(index, ww);
+
+    ww->resize(currentWidget()->size());
+    ww->view()->resize(ww->size());
+    //ww->show();
+
+    emit newTabCreated(ww);
+    return ww;
+}
+
+WebWidget *BrowserTabWidget::newHibernatedTabAtIndex(int index, WebState &&state)
+{
+    const QString title = state.title;
+    const QIcon icon = state.icon;
+
+    WebWidget *ww = new WebWidget(m_serviceLocator, m_privateBrowsing, std::move(state), this);
+    setupWebWidget(ww);
+    index = insertWebWidget(index, ww);
 
+    setTabText(index, title);
+    setTabFavicon(index, icon);
+    setTabLifecycle(index, TabLifecycle::Hibernated);
+
+    ww->resize(currentWidget()->size());
+
+    emit newTabCreated(ww);
+    return ww;
+}
+
+int BrowserTabWidget::insertWebWidget(int index, WebWidget *ww)
+{
     if (index >= 0)
     {
         if (index > count())
@@ -303,16 +338,12 @@ WebWidget *BrowserTabWidget::newBackgroundTabAtIndex(int index)
         index = insertTab(index, ww, QLatin1String("New Tab"));
         if (index <= m_nextTabIndex)
             ++m_nextTabIndex;
+        return index;
     }
-    else
-        m_nextTabIndex = insertTab(m_nextTabIndex, ww, QLatin1String("New Tab")) + 1;
-
-    ww->resize(currentWidget()->size());
-    ww->view()->resize(ww->size());
-    //ww->show();
 
-    emit newTabCreated(ww);
-    return ww;
+    index = insertTab(m_nextTabIndex, ww, QLatin1String("New Tab"));
+    m_nextTabIndex = index + 1;
+    return index;
 }
 
 void BrowserTabWidget::onIconChanged(const QIcon &icon)
@@ -323,9 +354,9 @@ void BrowserTabWidget::onIconChanged(const QIcon &icon)
         return;
 
     if (icon.isNull())
-        setTabIcon(tabIndex, m_faviconManager->getFavicon(ww->url()));
+        setTabFavicon(tabIndex, m_faviconManager->getFavicon(ww->url()));
     else
-        setTabIcon(tabIndex, icon);
+        setTabFavicon(tabIndex, icon);
 }
 
 
@@ -400,6 +431,10 @@ void BrowserTabWidget::onCurrentChanged(int index)
     if (m_activeView && m_activeView != ww && getWebWidget(m_lastTabIndex) != nullptr)
         m_activeView->hide();
 
+    // Tabs of a restored session are loaded when they are first activated
+    if (ww->wakesOnActivation())
+        ww->setHibernation(false);
+
     ww->show();
 
     m_activeView = ww;
@@ -426,8 +461,8 @@ void BrowserTabWidget::onLoadFinished(bool ok)
 
     const QString pageTitle = ww->getTitle();
     setTabText(tabIndex, pageTitle);
-    setTabToolTip(tabIndex, pageTitle);
-    setTabIcon(tabIndex, ww->getIcon());
+    updateTabToolTip(tabIndex, ww->getLifecycle());
+    setTabFavicon(tabIndex, ww->getIcon());
 
     if (ok && ww == m_activeView)
         emit loadFinished();
@@ -447,7 +482,7 @@ void BrowserTabWidget::onTitleChanged(const QString &title)
     if (viewTabIndex >= 0)
     {
         setTabText(viewTabIndex, title);
-        setTabToolTip(viewTabIndex, title);
+        updateTabToolTip(viewTabIndex, ww->getLifecycle());
 
         if (ww == m_activeView)
             emit titleChanged(title);
@@ -461,7 +496,7 @@ void BrowserTabWidget::onUrlChanged(const QUrl &url)
         emit urlChanged(url);
 
     if (!url.isEmpty())
-        setTabIcon(indexOf(ww), m_faviconManager->getFavicon(url));
+        setTabFavicon(indexOf(ww), m_faviconManager->getFavicon(url));
 }
 
 void BrowserTabWidget::onViewCloseRequested()
@@ -469,3 +504,41 @@ void BrowserTabWidget::onViewCloseRequested()
     WebWidget *ww = qobject_cast<WebWidget*>(sender());
     closeTab(indexOf(ww));
 }
+
+void BrowserTabWidget::onLifecycleChanged(TabLifecycle lifecycle)
+{
+    WebWidget *ww = qobject_cast<WebWidget*>(sender());
+    const int tabIndex = indexOf(ww);
+    if (tabIndex >= 0)
+        setTabLifecycle(tabIndex, lifecycle);
+}
+
+void BrowserTabWidget::setTabFavicon(int index, const QIcon &icon)
+{
+    // The tab bar draws the pre-rasterized icon as-is instead of scaling it on every paint
+    const int iconSize = tabBar()->iconSize().width();
+    setTabIcon(index, FaviconPixmapCache::instance().rasterizedIcon(icon, iconSize, devicePixelRatioF()));
+}
+
+void BrowserTabWidget::setTabLifecycle(int index, TabLifecycle lifecycle)
+{
+    // An invalid color restores the default text color of the tab
+    const bool isActive = lifecycle == TabLifecycle::Active;
+    m_tabBar->setTabTextColor(index, isActive ? QColor() : palette().color(QPalette::Disabled, QPalette::WindowText));
+    updateTabToolTip(index, lifecycle);
+}
+
+void BrowserTabWidget::updateTabToolTip(int index, TabLifecycle lifecycle)
+{
+    QString state;
+    switch (lifecycle)
+    {
+        case TabLifecycle::Active:     break;
+        case TabLifecycle::Frozen:     state = tr("Frozen"); break;
+        case TabLifecycle::Discarded:  state = tr("Discarded"); break;
+        case TabLifecycle::Hibernated: state = tr("Hibernated"); break;
+    }
+
+    const QString title = tabText(index);
+    setTabToolTip(index, state.isEmpty() ? title : QStringLiteral("%1 (%2)").arg(title, state));
+}
@@ -113,6 +113,15 @@ public Q_SLOTS:
      */
     WebWidget *newBackgroundTabAtIndex(int index);
 
+    /**
+     * @brief Creates a new tab in the background, with a hibernating \ref WebWidget at the given index. The web page
+     *        described by the given state is loaded when the widget wakes up
+     * @param index The index at which, if valid, the tab will be inserted.
+     * @param state State of the web page, including its title and icon which are shown on the tab
+     * @return A pointer to the tab's WebWidget
+     */
+    WebWidget *newHibernatedTabAtIndex(int index, WebState &&state);
+
     /// Called when the icon for a web view has changed
     void onIconChanged(const QIcon &icon);
 
@@ -162,14 +171,34 @@ private Q_SLOTS:
     /// Emitted when a view requests that it be closed
     void onViewCloseRequested();
 
+    /// Called when a web widget has been frozen, discarded, hibernated or made active again
+    void onLifecycleChanged(TabLifecycle lifecycle);
+
 private:
     /// Creates a new \ref WebWidget, binding its signals to the appropriate handlers, setting up properties of the widget, etc.
     /// and returning a pointer to the widget. Used during creation of a new tab
     WebWidget *createWebWidget();
 
+    /// Binds the signals of a new \ref WebWidget to the appropriate handlers, and sets up its properties
+    void setupWebWidget(WebWidget *ww);
+
+    /// Inserts the tab of a new web widget at the given index, or after the current tab if the index is negative.
+    /// Returns the index of the new tab
+    int insertWebWidget(int index, WebWidget *ww);
+
     /// Saves the tab at the given index before closing it
     void saveTab(int index);
 
+    /// Sets the icon of the tab at the given index, rasterized at the tab bar's icon size
+    void setTabFavicon(int index, const QIcon &icon);
+
+    /// Shows the lifecycle stage of the tab at the given index, dimming tabs whose page is not active
+    void setTabLifecycle(int index, TabLifecycle lifecycle);
+
+    /// Sets the tool tip of the tab at the given index to its title, followed by the given lifecycle stage
+    /// unless the page is active
+    void updateTabToolTip(int index, TabLifecycle lifecycle);
+
 private:
     /// Browser settings
     Settings *m_settings;
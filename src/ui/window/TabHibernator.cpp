@@ -0,0 +1,202 @@
+#include "BrowserTabWidget.h"
+#include "MainWindow.h"
+#include "Settings.h"
+#include "TabHibernator.h"
+#include "Tracer.h"
+#include "WebPage.h"
+#include "WebWidget.h"
+
+#include <algorithm>
+#include <chrono>
+
+#include <QFile>
+#include <QTimer>
+#include <QWebEngineScript>
+
+namespace
+{
+    /// Delay between two evaluations of the hibernation policy, in milliseconds
+    constexpr int EvaluationInterval = 30000;
+
+    /// Returns the identifier of a tab in the hibernation policy
+    uintptr_t getTabId(const QObject *tab)
+    {
+        return reinterpret_cast<uintptr_t>(tab);
+    }
+}
+
+TabHibernator::TabHibernator(Settings *settings, QObject *parent) :
+    QObject(parent),
+    m_settings(settings),
+    m_policy(&TabHibernationPolicy::getMonotonicTime, &TabHibernationPolicy::getSystemMemory),
+    m_timer(new QTimer(this)),
+    m_windows(),
+    m_tabs(),
+    m_formInputScript()
+{
+    setObjectName(QStringLiteral("TabHibernator"));
+
+    QFile scriptFile(QStringLiteral(":/HasUnsavedFormInput.js"));
+    if (scriptFile.open(QIODevice::ReadOnly))
+        m_formInputScript = scriptFile.readAll();
+    scriptFile.close();
+
+    m_timer->setInterval(EvaluationInterval);
+    connect(m_timer, &QTimer::timeout, this, &TabHibernator::hibernateTabs);
+    connect(settings, &Settings::settingChanged, this, &TabHibernator::onSettingChanged);
+
+    applySettings();
+}
+
+void TabHibernator::trackWindow(MainWindow *window)
+{
+    if (window == nullptr)
+        return;
+
+    m_windows.push_back(window);
+
+    BrowserTabWidget *tabWidget = window->getTabWidget();
+    connect(tabWidget, &BrowserTabWidget::newTabCreated, this, &TabHibernator::trackTab);
+    connect(tabWidget, &BrowserTabWidget::currentChanged, this, [this, tabWidget](){
+        onCurrentTabChanged(tabWidget);
+    });
+
+    for (int i = 0; i < tabWidget->count(); ++i)
+    {
+        if (WebWidget *ww = tabWidget->getWebWidget(i))
+            trackTab(ww);
+    }
+    onCurrentTabChanged(tabWidget);
+}
+
+void TabHibernator::hibernateTabs()
+{
+    VIPER_TRACE_SCOPE("tabs", "TabHibernator::hibernateTabs");
+
+    updateTabStates();
+
+    for (const TabHibernationPolicy::Decision &decision : m_policy.evaluate())
+    {
+        auto it = m_tabs.find(decision.TabId);
+        if (it != m_tabs.end() && !it->second.isNull())
+            hibernateTab(it->second.data());
+    }
+}
+
+void TabHibernator::trackTab(WebWidget *webWidget)
+{
+    const uintptr_t tabId = getTabId(webWidget);
+    if (m_tabs.find(tabId) != m_tabs.end())
+        return;
+
+    m_tabs[tabId] = webWidget;
+    m_policy.addTab(tabId, webWidget->isHibernating());
+
+    connect(webWidget, &WebWidget::aboutToHibernate, this, [this, tabId](){
+        m_policy.setTabHibernating(tabId, true);
+    });
+    connect(webWidget, &WebWidget::aboutToWake, this, [this, tabId](){
+        m_policy.setTabHibernating(tabId, false);
+    });
+
+    // Form input is lost when the page is left, so the tab can be hibernated again
+    connect(webWidget, &WebWidget::urlChanged, this, [this, tabId](){
+        m_policy.setTabHasFormInput(tabId, false);
+    });
+    connect(webWidget, &WebWidget::destroyed, this, [this, tabId](){
+        m_policy.removeTab(tabId);
+        m_tabs.erase(tabId);
+    });
+}
+
+void TabHibernator::onSettingChanged(BrowserSetting setting, const QVariant &/*value*/)
+{
+    switch (setting)
+    {
+        case BrowserSetting::AutoHibernateTabs:
+        case BrowserSetting::TabHibernationIdleTime:
+        case BrowserSetting::TabHibernationBudget:
+        case BrowserSetting::TabHibernationMemoryThreshold:
+            applySettings();
+            break;
+        default:
+            break;
+    }
+}
+
+void TabHibernator::applySettings()
+{
+    m_policy.setIdleTimeout(std::chrono::minutes(m_settings->getValue(BrowserSetting::TabHibernationIdleTime).toInt()));
+    m_policy.setTabBudget(m_settings->getValue(BrowserSetting::TabHibernationBudget).toInt());
+    m_policy.setMemoryPressureThreshold(m_settings->getValue(BrowserSetting::TabHibernationMemoryThreshold).toInt());
+
+    if (!m_settings->getValue(BrowserSetting::AutoHibernateTabs).toBool())
+        m_timer->stop();
+    else if (!m_timer->isActive())
+        m_timer->start();
+}
+
+void TabHibernator::onCurrentTabChanged(BrowserTabWidget *tabWidget)
+{
+    const int currentIndex = tabWidget->currentIndex();
+    for (int i = 0; i < tabWidget->count(); ++i)
+    {
+        if (WebWidget *ww = tabWidget->getWebWidget(i))
+            m_policy.setTabActive(getTabId(ww), i == currentIndex);
+    }
+}
+
+void TabHibernator::updateTabStates()
+{
+    m_windows.erase(std::remove_if(m_windows.begin(), m_windows.end(), [](const QPointer<MainWindow> &win) {
+        return win.isNull();
+    }), m_windows.end());
+
+    // Pinned and audible states are read when they are needed, rather than followed through every tab's signals
+    for (const QPointer<MainWindow> &win : m_windows)
+    {
+        BrowserTabWidget *tabWidget = win->getTabWidget();
+        onCurrentTabChanged(tabWidget);
+
+        for (int i = 0; i < tabWidget->count(); ++i)
+        {
+            WebWidget *ww = tabWidget->getWebWidget(i);
+            if (ww == nullptr)
+                continue;
+
+            const uintptr_t tabId = getTabId(ww);
+            WebPage *page = ww->page();
+            m_policy.setTabPinned(tabId, tabWidget->isTabPinned(i));
+            m_policy.setTabPlayingAudio(tabId, page != nullptr && page->recentlyAudible());
+        }
+    }
+}
+
+void TabHibernator::hibernateTab(WebWidget *webWidget)
+{
+    WebPage *page = webWidget->page();
+    if (webWidget->isHibernating() || page == nullptr)
+        return;
+
+    QPointer<WebWidget> tab = webWidget;
+    const uintptr_t tabId = getTabId(webWidget);
+    auto onFormInputChecked = [this, tab, tabId](const QVariant &hasFormInput) {
+        // The tab may have been closed or selected while its page was being checked
+        if (tab.isNull() || tab->isHibernating() || tab->isVisible())
+            return;
+
+        if (hasFormInput.toBool())
+        {
+            m_policy.setTabHasFormInput(tabId, true);
+            return;
+        }
+
+        tab->setHibernation(true);
+        tab->setWakeOnActivation(true);
+    };
+
+    if (m_formInputScript.isEmpty())
+        onFormInputChecked(QVariant(false));
+    else
+        page->runJavaScript(m_formInputScript, QWebEngineScript::ApplicationWorld, onFormInputChecked);
+}
@@ -0,0 +1,86 @@
+#ifndef TABHIBERNATOR_H
+#define TABHIBERNATOR_H
+
+#include "BrowserSetting.h"
+#include "TabHibernationPolicy.h"
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include <QObject>
+#include <QPointer>
+#include <QString>
+#include <QVariant>
+
+class BrowserTabWidget;
+class MainWindow;
+class Settings;
+class WebWidget;
+
+class QTimer;
+
+/**
+ * @class TabHibernator
+ * @brief Hibernates background tabs automatically, as decided by a \ref TabHibernationPolicy
+ *
+ * The hibernator follows the tabs of every browser window, and periodically asks its policy which tabs should
+ * be hibernated. Before a tab is hibernated, its page is checked for form input that has not been submitted,
+ * in which case the tab is kept awake until it navigates to another page. Tabs hibernated automatically wake
+ * up as soon as they are selected.
+ */
+class TabHibernator : public QObject
+{
+    Q_OBJECT
+
+public:
+    /// Constructs the tab hibernator, configured by the given browser settings
+    explicit TabHibernator(Settings *settings, QObject *parent = nullptr);
+
+    /// Starts following the tabs of the given window
+    void trackWindow(MainWindow *window);
+
+private Q_SLOTS:
+    /// Hibernates the tabs chosen by the policy
+    void hibernateTabs();
+
+    /// Starts following the given tab
+    void trackTab(WebWidget *webWidget);
+
+    /// Applies changes to the hibernation settings
+    void onSettingChanged(BrowserSetting setting, const QVariant &value);
+
+private:
+    /// Reads the hibernation settings, and starts or stops the periodic evaluation of the policy
+    void applySettings();
+
+    /// Marks the current tab of the tab widget as active, and its other tabs as inactive
+    void onCurrentTabChanged(BrowserTabWidget *tabWidget);
+
+    /// Updates the state of every tab that the policy does not get notified of
+    void updateTabStates();
+
+    /// Hibernates the given tab, unless its page has unsaved form input
+    void hibernateTab(WebWidget *webWidget);
+
+private:
+    /// Browser settings
+    Settings *m_settings;
+
+    /// Decides which tabs to hibernate
+    TabHibernationPolicy m_policy;
+
+    /// Triggers the periodic evaluation of the policy
+    QTimer *m_timer;
+
+    /// Windows whose tabs are followed
+    std::vector<QPointer<MainWindow>> m_windows;
+
+    /// Followed tabs, by their identifier in the policy
+    std::unordered_map<uintptr_t, QPointer<WebWidget>> m_tabs;
+
+    /// Script that returns true if a page has form input that has not been submitted
+    QString m_formInputScript;
+};
+
+#endif // TABHIBERNATOR_H
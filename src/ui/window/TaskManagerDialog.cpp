@@ -0,0 +1,93 @@
+#include "BrowserTabWidget.h"
+#include "MainWindow.h"
+#include "TaskManagerDialog.h"
+#include "WebPage.h"
+#include "WebWidget.h"
+
+#include <chrono>
+
+#include <QApplication>
+#include <QHeaderView>
+#include <QLabel>
+#include <QSortFilterProxyModel>
+#include <QTableView>
+#include <QVBoxLayout>
+
+TaskManagerDialog::TaskManagerDialog(QWidget *parent) :
+    QDialog(parent),
+    m_model(nullptr),
+    m_proxyModel(new QSortFilterProxyModel(this)),
+    m_tableView(new QTableView(this)),
+    m_labelOverhead(new QLabel(this))
+{
+    setAttribute(Qt::WA_DeleteOnClose);
+    setWindowTitle(tr("Task Manager"));
+    resize(720, 400);
+
+    m_model = new TabResourceModel(&TaskManagerDialog::getTabs, [](){
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch());
+    }, QStringLiteral("/proc"), this);
+
+    m_proxyModel->setSourceModel(m_model);
+    m_proxyModel->setSortRole(Qt::UserRole);
+
+    m_tableView->setModel(m_proxyModel);
+    m_tableView->setSortingEnabled(true);
+    m_tableView->sortByColumn(TabResourceModel::MemoryColumn, Qt::DescendingOrder);
+    m_tableView->setSelectionBehavior(QAbstractItemView::SelectRows);
+    m_tableView->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_tableView->verticalHeader()->hide();
+    m_tableView->horizontalHeader()->setSectionResizeMode(TabResourceModel::TitleColumn, QHeaderView::Stretch);
+
+    QVBoxLayout *layout = new QVBoxLayout(this);
+    layout->addWidget(m_tableView);
+    layout->addWidget(m_labelOverhead);
+
+    connect(m_model, &TabResourceModel::sampled, this, &TaskManagerDialog::onSampled);
+}
+
+void TaskManagerDialog::showEvent(QShowEvent *event)
+{
+    QDialog::showEvent(event);
+    m_model->start();
+}
+
+void TaskManagerDialog::hideEvent(QHideEvent *event)
+{
+    m_model->stop();
+    QDialog::hideEvent(event);
+}
+
+void TaskManagerDialog::onSampled()
+{
+    m_labelOverhead->setText(tr("Updated every %1 seconds, using %2% of the time")
+                             .arg(m_model->getSamplingInterval() / 1000)
+                             .arg(m_model->getSamplingOverhead(), 0, 'f', 3));
+}
+
+std::vector<TabResourceModel::Tab> TaskManagerDialog::getTabs()
+{
+    std::vector<TabResourceModel::Tab> tabs;
+
+    for (QWidget *widget : QApplication::topLevelWidgets())
+    {
+        MainWindow *window = qobject_cast<MainWindow*>(widget);
+        if (window == nullptr)
+            continue;
+
+        BrowserTabWidget *tabWidget = window->getTabWidget();
+        for (int i = 0; i < tabWidget->count(); ++i)
+        {
+            WebWidget *ww = tabWidget->getWebWidget(i);
+            if (ww == nullptr)
+                continue;
+
+            // Hibernating tabs have no page, and therefore no renderer process
+            WebPage *page = ww->page();
+            const int64_t processId = (page != nullptr && !ww->isHibernating()) ? static_cast<int64_t>(page->renderProcessPid()) : 0;
+            tabs.push_back(TabResourceModel::Tab { ww->getTitle(), ww->getIcon(), processId, ww->getLifecycle() });
+        }
+    }
+
+    return tabs;
+}
@@ -0,0 +1,58 @@
+#ifndef TASKMANAGERDIALOG_H
+#define TASKMANAGERDIALOG_H
+
+#include "TabResourceModel.h"
+
+#include <vector>
+
+#include <QDialog>
+
+class QHideEvent;
+class QLabel;
+class QShowEvent;
+class QSortFilterProxyModel;
+class QTableView;
+
+/**
+ * @class TaskManagerDialog
+ * @brief Shows the memory and CPU usage of the renderer process of each open tab. The usage is only
+ *        sampled while the dialog is visible
+ */
+class TaskManagerDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    /// Constructs the task manager dialog
+    explicit TaskManagerDialog(QWidget *parent = nullptr);
+
+protected:
+    /// Starts sampling the tabs when the dialog is shown
+    void showEvent(QShowEvent *event) override;
+
+    /// Stops sampling the tabs when the dialog is hidden
+    void hideEvent(QHideEvent *event) override;
+
+private Q_SLOTS:
+    /// Shows the time spent sampling the tabs
+    void onSampled();
+
+private:
+    /// Returns the tabs of every browser window, with the renderer processes of their pages
+    static std::vector<TabResourceModel::Tab> getTabs();
+
+private:
+    /// Usage of each tab
+    TabResourceModel *m_model;
+
+    /// Sorts the usage of each tab by any column
+    QSortFilterProxyModel *m_proxyModel;
+
+    /// Table of the tabs
+    QTableView *m_tableView;
+
+    /// Shows the time spent sampling the tabs
+    QLabel *m_labelOverhead;
+};
+
+#endif // TASKMANAGERDIALOG_H
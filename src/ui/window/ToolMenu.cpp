@@ -2,6 +2,7 @@
 #include "AdBlockWidget.h"
 #include "CookieWidget.h"
 #include "DownloadManager.h"
+#include "TaskManagerDialog.h"
 #include "ToolMenu.h"
 #include "UserAgentMenu.h"
 #include "UserScriptManager.h"
@@ -17,7 +18,8 @@ ToolMenu::ToolMenu(QWidget *parent) :
     m_actionManageCookies(nullptr),
     m_actionManageUserScripts(nullptr),
     m_userAgentMenu(nullptr),
-    m_actionViewDownloads(nullptr)
+    m_actionViewDownloads(nullptr),
+    m_actionTaskManager(nullptr)
 {
     setup();
 }
@@ -32,7 +34,8 @@ ToolMenu::ToolMenu(const QString &title, QWidget *parent) :
     m_actionManageCookies(nullptr),
     m_actionManageUserScripts(nullptr),
     m_userAgentMenu(nullptr),
-    m_actionViewDownloads(nullptr)
+    m_actionViewDownloads(nullptr),
+    m_actionTaskManager(nullptr)
 {
     setup();
 }
@@ -94,6 +97,14 @@ void ToolMenu::openDownloadManager()
     m_downloadManager->activateWindow();
 }
 
+void ToolMenu::openTaskManager()
+{
+    TaskManagerDialog *taskManager = new TaskManagerDialog;
+    taskManager->show();
+    taskManager->raise();
+    taskManager->activateWindow();
+}
+
 void ToolMenu::setup()
 {
     // Create menu items
@@ -107,10 +118,12 @@ void ToolMenu::setup()
     addSeparator();
 
     m_actionViewDownloads = addAction(tr("View Downloads"));
+    m_actionTaskManager   = addAction(tr("Task Manager"));
 
     // Bind action triggered signals to their respective handlers
     connect(m_actionManageAdBlocker,   &QAction::triggered, this, &ToolMenu::openAdBlockManager);
     connect(m_actionManageCookies,     &QAction::triggered, this, &ToolMenu::openCookieManager);
     connect(m_actionManageUserScripts, &QAction::triggered, this, &ToolMenu::openUserScriptManager);
     connect(m_actionViewDownloads,     &QAction::triggered, this, &ToolMenu::openDownloadManager);
+    connect(m_actionTaskManager,       &QAction::triggered, this, &ToolMenu::openTaskManager);
 }
@@ -51,6 +51,9 @@ public Q_SLOTS:
     /// Opens the download management window
     void openDownloadManager();
 
+    /// Opens the task manager, which shows the memory and CPU usage of each tab
+    void openTaskManager();
+
 private:
     /// Initializes the actions belonging to the tool menu
     void setup();
@@ -85,6 +88,9 @@ public Q_SLOTS:
 
     /// Downloads window opener action (see \ref DownloadManager )
     QAction *m_actionViewDownloads;
+
+    /// Task manager opener action (see \ref TaskManagerDialog )
+    QAction *m_actionTaskManager;
 };
 
 #endif // TOOLMENU_H
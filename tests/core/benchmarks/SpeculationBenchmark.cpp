@@ -0,0 +1,305 @@
+#include "SpeculativeLoader.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <map>
+#include <memory>
+#include <vector>
+
+#include <QApplication>
+#include <QCommandLineParser>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QFile>
+#include <QHostAddress>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QPointer>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTimer>
+#include <QWebEnginePage>
+#include <QWebEngineProfile>
+
+/**
+ * @class DelayedHttpServer
+ * @brief Local HTTP server that delays the first response of every connection, as the DNS lookup and the TCP
+ *        and TLS handshakes with a distant server would. Connections that were opened early enough, such as
+ *        speculative ones, are served right away
+ */
+class DelayedHttpServer : public QObject
+{
+public:
+    /// Constructs the server, given the delay charged to each new connection and the clock against which the
+    /// first byte of each page is timed
+    DelayedHttpServer(int connectionDelayMs, const QElapsedTimer &clock) :
+        QObject(nullptr),
+        m_server(new QTcpServer(this)),
+        m_connectionDelayMs(connectionDelayMs),
+        m_clock(clock),
+        m_readyTimes(),
+        m_pendingRequests(),
+        m_firstByteNs(-1)
+    {
+        connect(m_server, &QTcpServer::newConnection, this, &DelayedHttpServer::onNewConnection);
+    }
+
+    /// Starts listening on a free local port
+    bool listen()
+    {
+        return m_server->listen(QHostAddress::LocalHost);
+    }
+
+    /// Returns the URL of the page served
+    QUrl getPageUrl() const
+    {
+        return QUrl(QStringLiteral("http://127.0.0.1:%1/page").arg(m_server->serverPort()));
+    }
+
+    /// Returns the time at which the first byte of the page was last sent, in nanoseconds of the clock, or -1 if
+    /// the page was not requested since the last call
+    qint64 takeFirstByteTime()
+    {
+        const qint64 result = m_firstByteNs;
+        m_firstByteNs = -1;
+        return result;
+    }
+
+private:
+    /// Starts timing the setup of a new connection
+    void onNewConnection()
+    {
+        while (QTcpSocket *socket = m_server->nextPendingConnection())
+        {
+            m_readyTimes[socket] = m_clock.nsecsElapsed() + static_cast<qint64>(m_connectionDelayMs) * 1000000;
+            connect(socket, &QTcpSocket::readyRead, this, [this, socket](){ onReadyRead(socket); });
+            connect(socket, &QTcpSocket::disconnected, this, [this, socket](){
+                m_readyTimes.erase(socket);
+                m_pendingRequests.erase(socket);
+                socket->deleteLater();
+            });
+        }
+    }
+
+    /// Answers each complete request once the connection is set up
+    void onReadyRead(QTcpSocket *socket)
+    {
+        QByteArray &pending = m_pendingRequests[socket];
+        pending.append(socket->readAll());
+
+        int headerEnd = pending.indexOf("\r\n\r\n");
+        while (headerEnd >= 0)
+        {
+            const QByteArray requestLine = pending.left(pending.indexOf("\r\n"));
+            pending.remove(0, headerEnd + 4);
+            headerEnd = pending.indexOf("\r\n\r\n");
+
+            const QByteArray path = requestLine.split(' ').value(1);
+            const qint64 waitNs = std::max<qint64>(0, m_readyTimes[socket] - m_clock.nsecsElapsed());
+
+            QPointer<QTcpSocket> target = socket;
+            QTimer::singleShot(static_cast<int>(waitNs / 1000000), this, [this, target, path](){
+                if (!target.isNull())
+                    respond(target.data(), path);
+            });
+        }
+    }
+
+    /// Sends the page, or an empty response for any other path
+    void respond(QTcpSocket *socket, const QByteArray &path)
+    {
+        const bool isPage = path == "/page";
+        const QByteArray body = isPage ? QByteArray("<!DOCTYPE html><html><head><title>Page</title></head><body>Page</body></html>")
+                                       : QByteArray();
+
+        if (isPage)
+            m_firstByteNs = m_clock.nsecsElapsed();
+
+        socket->write(QByteArray(isPage ? "HTTP/1.1 200 OK\r\n" : "HTTP/1.1 404 Not Found\r\n")
+                      + "Content-Type: text/html\r\n"
+                      + "Cache-Control: no-store\r\n"
+                      + "Connection: keep-alive\r\n"
+                      + "Content-Length: " + QByteArray::number(body.size()) + "\r\n\r\n"
+                      + body);
+    }
+
+private:
+    /// Listening socket
+    QTcpServer *m_server;
+
+    /// Delay charged to each new connection, in milliseconds
+    int m_connectionDelayMs;
+
+    /// Clock of the benchmark
+    const QElapsedTimer &m_clock;
+
+    /// Time at which each connection is set up, in nanoseconds of the clock
+    std::map<QTcpSocket*, qint64> m_readyTimes;
+
+    /// Partial request of each connection
+    std::map<QTcpSocket*, QByteArray> m_pendingRequests;
+
+    /// Time at which the first byte of the page was last sent
+    qint64 m_firstByteNs;
+};
+
+/// Runs the event loop for the given time
+void wait(int milliseconds)
+{
+    QEventLoop loop;
+    QTimer::singleShot(milliseconds, &loop, &QEventLoop::quit);
+    loop.exec();
+}
+
+/// Timings of a navigation to the page
+struct NavigationResult
+{
+    /// Time between the start of the navigation and the first byte of the page, in milliseconds
+    double TimeToFirstByteMs;
+
+    /// Time between the start of the navigation and the end of the load, in milliseconds
+    double LoadMs;
+};
+
+/// Navigates to the page of the server in a new profile, after speculating on it if asked to, and returns the
+/// timings of the navigation
+NavigationResult navigate(DelayedHttpServer &server, const QElapsedTimer &clock, bool speculate, int leadTimeMs)
+{
+    // Each navigation uses a new off-the-record profile, so no connection is left over from the previous one
+    std::unique_ptr<QWebEngineProfile> profile = std::make_unique<QWebEngineProfile>();
+    std::unique_ptr<SpeculativeLoader> loader = std::make_unique<SpeculativeLoader>(nullptr, profile.get());
+    std::unique_ptr<QWebEnginePage> page = std::make_unique<QWebEnginePage>(profile.get());
+
+    const QUrl url = server.getPageUrl();
+    if (speculate)
+        loader->preconnect(url);
+
+    // The lead time stands for the time the user takes to finish typing and press enter
+    wait(leadTimeMs);
+    server.takeFirstByteTime();
+
+    QEventLoop loop;
+    QObject::connect(page.get(), &QWebEnginePage::loadFinished, &loop, &QEventLoop::quit);
+    QTimer::singleShot(30000, &loop, &QEventLoop::quit);
+
+    const qint64 startNs = clock.nsecsElapsed();
+    page->load(url);
+    loop.exec();
+    const qint64 endNs = clock.nsecsElapsed();
+
+    const qint64 firstByteNs = server.takeFirstByteTime();
+    NavigationResult result;
+    result.TimeToFirstByteMs = firstByteNs >= 0 ? static_cast<double>(firstByteNs - startNs) / 1.0e6 : -1.0;
+    result.LoadMs = static_cast<double>(endNs - startNs) / 1.0e6;
+
+    // The pages must be destroyed before their profile
+    page.reset();
+    loader.reset();
+    return result;
+}
+
+/// Returns the median of the given values
+double getMedian(std::vector<double> values)
+{
+    if (values.empty())
+        return 0.0;
+
+    std::sort(values.begin(), values.end());
+    return values.at(values.size() / 2);
+}
+
+/// Returns the timings of a series of navigations as a JSON object
+QJsonObject toJson(const std::vector<NavigationResult> &results)
+{
+    std::vector<double> timesToFirstByte, loadTimes;
+    QJsonArray timesToFirstByteArray, loadTimesArray;
+    for (const NavigationResult &result : results)
+    {
+        timesToFirstByte.push_back(result.TimeToFirstByteMs);
+        loadTimes.push_back(result.LoadMs);
+        timesToFirstByteArray.append(result.TimeToFirstByteMs);
+        loadTimesArray.append(result.LoadMs);
+    }
+
+    QJsonObject json;
+    json.insert(QStringLiteral("timeToFirstByteMs"), timesToFirstByteArray);
+    json.insert(QStringLiteral("loadMs"), loadTimesArray);
+    json.insert(QStringLiteral("medianTimeToFirstByteMs"), getMedian(timesToFirstByte));
+    json.insert(QStringLiteral("medianLoadMs"), getMedian(loadTimes));
+    return json;
+}
+
+int main(int argc, char *argv[])
+{
+    QApplication app(argc, argv);
+    QApplication::setApplicationName(QStringLiteral("SpeculationBenchmark"));
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QStringLiteral("Times the first byte of a page on a local server, with and without a "
+                                                    "speculative connection to it"));
+    parser.addHelpOption();
+
+    QCommandLineOption outputOption({ QStringLiteral("o"), QStringLiteral("output") },
+                                    QStringLiteral("Path of the JSON report."), QStringLiteral("file"),
+                                    QStringLiteral("SpeculationBenchmark.json"));
+    QCommandLineOption delayOption(QStringLiteral("connection-delay"),
+                                   QStringLiteral("Time charged by the server to set up each connection, in milliseconds."),
+                                   QStringLiteral("ms"), QStringLiteral("300"));
+    QCommandLineOption leadTimeOption(QStringLiteral("lead-time"),
+                                      QStringLiteral("Time between the speculation and the navigation, in milliseconds."),
+                                      QStringLiteral("ms"), QStringLiteral("500"));
+    QCommandLineOption repetitionOption(QStringLiteral("repetitions"), QStringLiteral("Number of navigations of each kind."),
+                                        QStringLiteral("count"), QStringLiteral("5"));
+    parser.addOptions({ outputOption, delayOption, leadTimeOption, repetitionOption });
+    parser.process(app);
+
+    const int connectionDelayMs = parser.value(delayOption).toInt();
+    const int leadTimeMs = parser.value(leadTimeOption).toInt();
+    const int repetitions = std::max(1, parser.value(repetitionOption).toInt());
+
+    QElapsedTimer clock;
+    clock.start();
+
+    DelayedHttpServer server(connectionDelayMs, clock);
+    if (!server.listen())
+    {
+        std::fprintf(stderr, "Could not start the local HTTP server\n");
+        return 1;
+    }
+
+    // Navigations with and without speculation alternate, so that both see the same conditions
+    std::vector<NavigationResult> withoutSpeculation, withSpeculation;
+    for (int i = 0; i < repetitions; ++i)
+    {
+        withoutSpeculation.push_back(navigate(server, clock, false, leadTimeMs));
+        withSpeculation.push_back(navigate(server, clock, true, leadTimeMs));
+    }
+
+    const QJsonObject without = toJson(withoutSpeculation);
+    const QJsonObject with = toJson(withSpeculation);
+    std::printf("Median time to first byte: %.1f ms without speculation, %.1f ms with a speculative connection\n",
+                without.value(QStringLiteral("medianTimeToFirstByteMs")).toDouble(),
+                with.value(QStringLiteral("medianTimeToFirstByteMs")).toDouble());
+
+    QJsonObject report;
+    report.insert(QStringLiteral("benchmark"), QStringLiteral("SpeculationBenchmark"));
+    report.insert(QStringLiteral("timestamp"), QDateTime::currentDateTimeUtc().toString(Qt::ISODate));
+    report.insert(QStringLiteral("qtVersion"), QString::fromLatin1(qVersion()));
+    report.insert(QStringLiteral("connectionDelayMs"), connectionDelayMs);
+    report.insert(QStringLiteral("leadTimeMs"), leadTimeMs);
+    report.insert(QStringLiteral("repetitions"), repetitions);
+    report.insert(QStringLiteral("withoutSpeculation"), without);
+    report.insert(QStringLiteral("withPreconnect"), with);
+
+    QFile outputFile(parser.value(outputOption));
+    if (!outputFile.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+        std::fprintf(stderr, "Could not write the report to %s\n", qPrintable(outputFile.fileName()));
+        return 1;
+    }
+
+    outputFile.write(QJsonDocument(report).toJson(QJsonDocument::Indented));
+    return 0;
+}
@@ -0,0 +1,480 @@
+#include "SyntheticProfile.h"
+
+#include "BookmarkNode.h"
+#include "BookmarkStore.h"
+#include "DatabaseFactory.h"
+#include "ExtStorage.h"
+#include "FaviconStore.h"
+#include "HistoryStore.h"
+#include "ServiceLocator.h"
+#include "WebPageThumbnailStore.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <vector>
+
+#include <QApplication>
+#include <QCommandLineParser>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTemporaryDir>
+#include <QtGlobal>
+
+/// Timings of one benchmarked operation of a store
+struct BenchmarkResult
+{
+    /// Name of the store
+    QString Store;
+
+    /// Name of the operation
+    QString Name;
+
+    /// Number of calls made to the store in each repetition
+    int Operations;
+
+    /// Duration of each repetition, in milliseconds
+    std::vector<double> DurationsMs;
+
+    /// Returns the timings as a JSON object
+    QJsonObject toJson() const
+    {
+        std::vector<double> sorted = DurationsMs;
+        std::sort(sorted.begin(), sorted.end());
+
+        const double median = sorted.empty() ? 0.0 : sorted.at(sorted.size() / 2);
+        const double mean = sorted.empty() ? 0.0 : std::accumulate(sorted.begin(), sorted.end(), 0.0) / sorted.size();
+
+        QJsonObject result;
+        result.insert(QStringLiteral("store"), Store);
+        result.insert(QStringLiteral("name"), Name);
+        result.insert(QStringLiteral("operations"), Operations);
+        result.insert(QStringLiteral("repetitions"), static_cast<int>(sorted.size()));
+        result.insert(QStringLiteral("minMs"), sorted.empty() ? 0.0 : sorted.front());
+        result.insert(QStringLiteral("medianMs"), median);
+        result.insert(QStringLiteral("meanMs"), mean);
+        result.insert(QStringLiteral("maxMs"), sorted.empty() ? 0.0 : sorted.back());
+        result.insert(QStringLiteral("medianPerOperationUs"), Operations > 0 ? median * 1000.0 / Operations : 0.0);
+        return result;
+    }
+};
+
+/**
+ * @class StoreBenchmark
+ * @brief Times the load, common queries and write bursts of the database-backed stores
+ *        against a synthetic browser profile
+ */
+class StoreBenchmark
+{
+public:
+    /// Constructs the benchmark, given the generated profile and the number of times each operation is repeated
+    StoreBenchmark(const SyntheticProfile &profile, int repetitions, uint32_t seed) :
+        m_profile(profile),
+        m_repetitions(std::max(1, repetitions)),
+        m_rng(seed),
+        m_results()
+    {
+    }
+
+    /// Runs the benchmarks of every store
+    void run()
+    {
+        benchmarkHistory();
+        benchmarkBookmarks();
+        benchmarkFavicons();
+        benchmarkThumbnails();
+        benchmarkExtensionStorage();
+    }
+
+    /// Returns the results of every benchmarked operation
+    QJsonArray getResults() const
+    {
+        QJsonArray results;
+        for (const BenchmarkResult &result : m_results)
+            results.append(result.toJson());
+        return results;
+    }
+
+private:
+    /**
+     * @brief Times an operation
+     * @param store Name of the store
+     * @param name Name of the operation
+     * @param operations Number of calls made to the store by each invocation of fn
+     * @param fn Operation, called once per repetition with the index of the repetition
+     * @param afterRepetition Optional callback invoked after each repetition, outside of the timed section
+     */
+    void measure(const QString &store, const QString &name, int operations, const std::function<void(int)> &fn,
+                 const std::function<void()> &afterRepetition = std::function<void()>())
+    {
+        BenchmarkResult result { store, name, operations, std::vector<double>() };
+        for (int repetition = 0; repetition < m_repetitions; ++repetition)
+        {
+            QElapsedTimer timer;
+            timer.start();
+            fn(repetition);
+            result.DurationsMs.push_back(static_cast<double>(timer.nsecsElapsed()) / 1.0e6);
+
+            if (afterRepetition)
+                afterRepetition();
+        }
+
+        const QJsonObject summary = result.toJson();
+        std::printf("%-22s %-34s %12.3f ms (median of %d, %d ops)\n", qPrintable(store), qPrintable(name),
+                    summary.value(QStringLiteral("medianMs")).toDouble(), m_repetitions, operations);
+        std::fflush(stdout);
+
+        m_results.push_back(std::move(result));
+    }
+
+    /// Returns a random index in the range [0, count)
+    int randomIndex(int count)
+    {
+        return static_cast<int>(m_rng() % static_cast<uint32_t>(std::max(1, count)));
+    }
+
+    void benchmarkHistory()
+    {
+        const QString store = QStringLiteral("HistoryStore");
+        const SyntheticProfileSize &size = m_profile.getSize();
+        std::unique_ptr<HistoryStore> historyStore;
+
+        measure(store, QStringLiteral("load"), 1, [&](int) {
+            historyStore = DatabaseFactory::createWorker<HistoryStore>(m_profile.getHistoryFile());
+        }, [&]() { historyStore.reset(); });
+
+        historyStore = DatabaseFactory::createWorker<HistoryStore>(m_profile.getHistoryFile());
+
+        measure(store, QStringLiteral("contains"), 1000, [&](int) {
+            for (int i = 0; i < 1000; ++i)
+            {
+                const QUrl url = (i % 2 == 0) ? m_profile.getHistoryUrl(randomIndex(size.HistoryEntries))
+                                              : QUrl(QStringLiteral("https://missing.example/%1").arg(i));
+                historyStore->contains(url);
+            }
+        });
+
+        measure(store, QStringLiteral("getEntry"), 20, [&](int) {
+            for (int i = 0; i < 20; ++i)
+                historyStore->getEntry(m_profile.getHistoryUrl(randomIndex(size.HistoryEntries)));
+        });
+
+        measure(store, QStringLiteral("getTimesVisitedHost"), 100, [&](int) {
+            for (int i = 0; i < 100; ++i)
+                historyStore->getTimesVisitedHost(m_profile.getHistoryUrl(randomIndex(size.HistoryEntries)));
+        });
+
+        measure(store, QStringLiteral("getRecentItems"), 1, [&](int) {
+            historyStore->getRecentItems();
+        });
+
+        measure(store, QStringLiteral("getHistoryFrom (1 day)"), 1, [&](int) {
+            historyStore->getHistoryFrom(QDateTime::currentDateTime().addDays(-1));
+        });
+
+        measure(store, QStringLiteral("loadMostVisitedEntries"), 1, [&](int) {
+            historyStore->loadMostVisitedEntries(10);
+        });
+
+        measure(store, QStringLiteral("getWords"), 1, [&](int) {
+            historyStore->getWords();
+        });
+
+        measure(store, QStringLiteral("getEntryWordMapping"), 1, [&](int) {
+            historyStore->getEntryWordMapping();
+        });
+
+        // Half of the visits are to pages that are already in the history
+        measure(store, QStringLiteral("addVisit burst"), 500, [&](int repetition) {
+            const QDateTime now = QDateTime::currentDateTime();
+            for (int i = 0; i < 500; ++i)
+            {
+                const QUrl url = (i % 2 == 0) ? m_profile.getHistoryUrl(randomIndex(size.HistoryEntries))
+                                              : QUrl(QStringLiteral("https://new-page.example/%1/%2").arg(repetition).arg(i));
+                historyStore->addVisit(url, QStringLiteral("Visited page %1").arg(i), now.addMSecs(i), url, false);
+            }
+        });
+    }
+
+    void benchmarkBookmarks()
+    {
+        const QString store = QStringLiteral("BookmarkStore");
+        const SyntheticProfileSize &size = m_profile.getSize();
+        std::unique_ptr<BookmarkStore> bookmarkStore;
+
+        measure(store, QStringLiteral("load"), 1, [&](int) {
+            bookmarkStore = DatabaseFactory::createWorker<BookmarkStore>(m_profile.getBookmarkFile());
+        }, [&]() { bookmarkStore.reset(); });
+
+        bookmarkStore = DatabaseFactory::createWorker<BookmarkStore>(m_profile.getBookmarkFile());
+
+        measure(store, QStringLiteral("getMaxUniqueId"), 1, [&](int) {
+            bookmarkStore->getMaxUniqueId();
+        });
+
+        // Each repetition inserts, updates and then removes its own bookmarks
+        constexpr int burstSize = 200;
+        auto nodeId = [&](int repetition, int i) {
+            return size.BookmarkFolders + size.Bookmarks + 1 + repetition * burstSize + i;
+        };
+
+        measure(store, QStringLiteral("insertNode burst"), burstSize, [&](int repetition) {
+            for (int i = 0; i < burstSize; ++i)
+            {
+                const QUrl url = m_profile.getHistoryUrl(randomIndex(size.HistoryEntries));
+                bookmarkStore->insertNode(nodeId(repetition, i), 1 + i % size.BookmarkFolders, static_cast<int>(BookmarkNode::Bookmark),
+                                          QStringLiteral("New bookmark %1").arg(i), url, 0);
+            }
+        });
+
+        measure(store, QStringLiteral("updateNode burst"), burstSize, [&](int repetition) {
+            for (int i = 0; i < burstSize; ++i)
+            {
+                const QUrl url = m_profile.getHistoryUrl(randomIndex(size.HistoryEntries));
+                bookmarkStore->updateNode(nodeId(repetition, i), 1 + i % size.BookmarkFolders,
+                                          QStringLiteral("Renamed bookmark %1").arg(i), url, QString(), 1);
+            }
+        });
+
+        measure(store, QStringLiteral("removeNode burst"), burstSize, [&](int repetition) {
+            for (int i = 0; i < burstSize; ++i)
+                bookmarkStore->removeNode(nodeId(repetition, i), 1 + i % size.BookmarkFolders, 1);
+        });
+    }
+
+    void benchmarkFavicons()
+    {
+        const QString store = QStringLiteral("FaviconStore");
+        const SyntheticProfileSize &size = m_profile.getSize();
+        std::unique_ptr<FaviconStore> faviconStore;
+
+        measure(store, QStringLiteral("load"), 1, [&](int) {
+            faviconStore = DatabaseFactory::createWorker<FaviconStore>(m_profile.getFaviconFile());
+        }, [&]() { faviconStore.reset(); });
+
+        faviconStore = DatabaseFactory::createWorker<FaviconStore>(m_profile.getFaviconFile());
+
+        const int numMappedPages = std::min(size.FaviconMappings, size.HistoryEntries);
+        measure(store, QStringLiteral("getFaviconId (mapped page)"), 1000, [&](int) {
+            for (int i = 0; i < 1000; ++i)
+                faviconStore->getFaviconId(m_profile.getHistoryUrl(randomIndex(numMappedPages)));
+        });
+
+        measure(store, QStringLiteral("getFaviconId (unmapped page)"), 20, [&](int) {
+            for (int i = 0; i < 20; ++i)
+                faviconStore->getFaviconId(QUrl(QStringLiteral("https://unmapped%1.example/page").arg(i)));
+        });
+
+        measure(store, QStringLiteral("getFaviconIdForIconUrl"), 50, [&](int) {
+            for (int i = 0; i < 50; ++i)
+                faviconStore->getFaviconIdForIconUrl(m_profile.getFaviconUrl(randomIndex(size.Favicons)));
+        });
+
+        measure(store, QStringLiteral("getIconData"), 1000, [&](int) {
+            for (int i = 0; i < 1000; ++i)
+                faviconStore->getIconData(1 + randomIndex(size.Favicons));
+        });
+
+        // Each repetition stores the data and page mapping of its own new favicons
+        constexpr int burstSize = 200;
+        measure(store, QStringLiteral("save icon burst"), burstSize, [&](int repetition) {
+            for (int i = 0; i < burstSize; ++i)
+            {
+                const int faviconId = size.Favicons + 1 + repetition * burstSize + i;
+                FaviconData &record = faviconStore->getDataRecord(faviconId);
+                record.iconData = SyntheticProfile::makeImageData(m_rng, 1024, false);
+                faviconStore->saveDataRecord(record);
+                faviconStore->addPageMapping(QUrl(QStringLiteral("https://icon-page.example/%1").arg(faviconId)), faviconId);
+            }
+        });
+    }
+
+    void benchmarkThumbnails()
+    {
+        const QString store = QStringLiteral("WebPageThumbnailStore");
+        const SyntheticProfileSize &size = m_profile.getSize();
+        ViperServiceLocator serviceLocator;
+        std::unique_ptr<WebPageThumbnailStore> thumbnailStore;
+
+        auto openStore = [&]() {
+            thumbnailStore = DatabaseFactory::createWorker<WebPageThumbnailStore>(serviceLocator, m_profile.getThumbnailFile());
+        };
+
+        measure(store, QStringLiteral("load"), 1, [&](int) { openStore(); }, [&]() { thumbnailStore.reset(); });
+
+        // Thumbnails are kept in memory after their first lookup, so the store is reopened after each repetition
+        const int numLookups = std::min(100, size.Thumbnails);
+        openStore();
+        measure(store, QStringLiteral("getThumbnailData (cold)"), numLookups, [&](int) {
+            for (int i = 0; i < numLookups; ++i)
+                thumbnailStore->getThumbnailData(QStringLiteral("www.%1").arg(m_profile.getHost(i)));
+        }, openStore);
+
+        measure(store, QStringLiteral("getThumbnailData (warm)"), 1000, [&](int) {
+            for (int i = 0; i < 1000; ++i)
+                thumbnailStore->getThumbnailData(QStringLiteral("www.%1").arg(m_profile.getHost(i % numLookups)));
+        });
+
+        // Saving through the store requires the history and bookmark managers, so the write burst issues
+        // the same statement as WebPageThumbnailStore::save, in chunks of the same size
+        thumbnailStore.reset();
+        measure(store, QStringLiteral("save burst"), 100, [&](int repetition) {
+            sqlite::Database db(m_profile.getThumbnailFile().toStdString());
+            sqlite::BatchWriter writer(db, R"(INSERT OR REPLACE INTO Thumbnails(Host, Thumbnail) VALUES (?, ?))", 25);
+            for (int i = 0; i < 100; ++i)
+            {
+                const QString host = QStringLiteral("new-thumbnail%1-%2.example").arg(repetition).arg(i);
+                const QByteArray data = SyntheticProfile::makeImageData(m_rng, 16 * 1024, true);
+                writer.add(host, data);
+            }
+            writer.flush();
+        });
+    }
+
+    void benchmarkExtensionStorage()
+    {
+        const QString store = QStringLiteral("ExtStorage");
+        const SyntheticProfileSize &size = m_profile.getSize();
+        std::unique_ptr<ExtStorage> extStorage;
+
+        measure(store, QStringLiteral("load"), 1, [&](int) {
+            extStorage = DatabaseFactory::createWorker<ExtStorage>(m_profile.getExtensionStorageFile());
+        }, [&]() { extStorage.reset(); });
+
+        extStorage = DatabaseFactory::createWorker<ExtStorage>(m_profile.getExtensionStorageFile());
+
+        measure(store, QStringLiteral("getItem"), 1000, [&](int) {
+            for (int i = 0; i < 1000; ++i)
+            {
+                const QString extensionId = m_profile.getExtensionId(randomIndex(size.Extensions));
+                extStorage->getItem(extensionId, QStringLiteral("setting%1").arg(randomIndex(size.ItemsPerExtension)));
+            }
+        });
+
+        measure(store, QStringLiteral("getResult (10 keys)"), 100, [&](int) {
+            for (int i = 0; i < 100; ++i)
+            {
+                QVariantMap keys;
+                for (int k = 0; k < 10; ++k)
+                    keys.insert(QStringLiteral("setting%1").arg(randomIndex(size.ItemsPerExtension)), QVariant());
+                extStorage->getResult(m_profile.getExtensionId(randomIndex(size.Extensions)), keys);
+            }
+        });
+
+        measure(store, QStringLiteral("listKeys"), 20, [&](int) {
+            for (int i = 0; i < 20; ++i)
+                extStorage->listKeys(m_profile.getExtensionId(i % size.Extensions));
+        });
+
+        measure(store, QStringLiteral("setItem burst"), 1000, [&](int repetition) {
+            for (int i = 0; i < 1000; ++i)
+            {
+                const QString extensionId = m_profile.getExtensionId(i % size.Extensions);
+                extStorage->setItem(extensionId, QStringLiteral("new-setting%1-%2").arg(repetition).arg(i),
+                                    QStringLiteral("{\"enabled\":true,\"count\":%1}").arg(i));
+            }
+        });
+
+        measure(store, QStringLiteral("removeItem burst"), 200, [&](int repetition) {
+            for (int i = 0; i < 200; ++i)
+                extStorage->removeItem(m_profile.getExtensionId(i % size.Extensions),
+                                       QStringLiteral("new-setting%1-%2").arg(repetition).arg(i));
+        });
+    }
+
+private:
+    /// Profile that the stores are loaded from
+    const SyntheticProfile &m_profile;
+
+    /// Number of times each operation is repeated
+    int m_repetitions;
+
+    /// Random number generator for lookup keys, seeded for reproducibility
+    std::mt19937 m_rng;
+
+    /// Timings of the benchmarked operations, in the order they were run
+    std::vector<BenchmarkResult> m_results;
+};
+
+int main(int argc, char *argv[])
+{
+    QApplication app(argc, argv);
+    QApplication::setApplicationName(QStringLiteral("StoreBenchmark"));
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QStringLiteral("Times the database-backed stores against a synthetic browser profile"));
+    parser.addHelpOption();
+
+    QCommandLineOption outputOption({ QStringLiteral("o"), QStringLiteral("output") },
+                                    QStringLiteral("Path of the JSON report."), QStringLiteral("file"),
+                                    QStringLiteral("StoreBenchmark.json"));
+    QCommandLineOption scaleOption(QStringLiteral("scale"),
+                                   QStringLiteral("Size of the profile, relative to 200k history entries and 2M visits."),
+                                   QStringLiteral("factor"), QStringLiteral("1.0"));
+    QCommandLineOption seedOption(QStringLiteral("seed"), QStringLiteral("Random seed of the profile."),
+                                  QStringLiteral("seed"), QStringLiteral("1"));
+    QCommandLineOption repetitionOption(QStringLiteral("repetitions"), QStringLiteral("Number of times each operation is timed."),
+                                        QStringLiteral("count"), QStringLiteral("5"));
+    QCommandLineOption directoryOption(QStringLiteral("directory"),
+                                       QStringLiteral("Directory to generate the profile in. It is kept after the run. "
+                                                      "Defaults to a temporary directory."),
+                                       QStringLiteral("path"));
+    parser.addOptions({ outputOption, scaleOption, seedOption, repetitionOption, directoryOption });
+    parser.process(app);
+
+    const double scale = parser.value(scaleOption).toDouble();
+    const uint32_t seed = parser.value(seedOption).toUInt();
+    const int repetitions = parser.value(repetitionOption).toInt();
+
+    QTemporaryDir temporaryDirectory;
+    const QString directory = parser.isSet(directoryOption) ? parser.value(directoryOption) : temporaryDirectory.path();
+    if (directory.isEmpty() || scale <= 0.0)
+    {
+        std::fprintf(stderr, "Invalid profile directory or scale\n");
+        return 1;
+    }
+
+    SyntheticProfile profile(directory, SyntheticProfileSize().scaled(scale), seed);
+
+    QElapsedTimer generationTimer;
+    generationTimer.start();
+    if (!profile.generate())
+    {
+        std::fprintf(stderr, "Could not generate the synthetic profile in %s\n", qPrintable(directory));
+        return 1;
+    }
+    const double generationMs = static_cast<double>(generationTimer.nsecsElapsed()) / 1.0e6;
+    std::printf("Generated profile in %.0f ms\n", generationMs);
+
+    StoreBenchmark benchmark(profile, repetitions, seed);
+    benchmark.run();
+
+    QJsonObject report;
+    report.insert(QStringLiteral("benchmark"), QStringLiteral("StoreBenchmark"));
+    report.insert(QStringLiteral("timestamp"), QDateTime::currentDateTimeUtc().toString(Qt::ISODate));
+    report.insert(QStringLiteral("qtVersion"), QString::fromLatin1(qVersion()));
+    report.insert(QStringLiteral("sqliteVersion"), QString::fromLatin1(sqlite3_libversion()));
+    report.insert(QStringLiteral("seed"), static_cast<qint64>(seed));
+    report.insert(QStringLiteral("scale"), scale);
+    report.insert(QStringLiteral("repetitions"), repetitions);
+    report.insert(QStringLiteral("profile"), profile.getSize().toJson());
+    report.insert(QStringLiteral("generationMs"), generationMs);
+    report.insert(QStringLiteral("results"), benchmark.getResults());
+
+    QFile outputFile(parser.value(outputOption));
+    if (!outputFile.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+        std::fprintf(stderr, "Could not write the report to %s\n", qPrintable(outputFile.fileName()));
+        return 1;
+    }
+
+    outputFile.write(QJsonDocument(report).toJson(QJsonDocument::Indented));
+    return 0;
+}
@@ -0,0 +1,440 @@
+#include "SyntheticProfile.h"
+
+#include "BookmarkNode.h"
+#include "BookmarkStore.h"
+#include "DatabaseFactory.h"
+#include "ExtStorage.h"
+#include "FaviconStore.h"
+#include "HistoryStore.h"
+#include "ServiceLocator.h"
+#include "WebPageThumbnailStore.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <set>
+
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+
+namespace
+{
+    /// Number of rows inserted per transaction while generating the profile
+    constexpr std::size_t RowsPerTransaction = 20000;
+
+    /// Number of distinct pseudo-words in the vocabulary of a profile
+    constexpr std::size_t VocabularySize = 5000;
+
+    /// Number of history entries per web site
+    constexpr int EntriesPerHost = 20;
+
+    /// Visits are spread over the last seven weeks, as the history store purges visits older than eight weeks
+    constexpr qint64 VisitPeriodMs = qint64{7} * 7 * 24 * 60 * 60 * 1000;
+
+    /// Returns a well-mixed hash of the index, used to derive stable attributes of a record from its index
+    uint32_t mix(uint32_t value)
+    {
+        value ^= value >> 16;
+        value *= 0x7feb352dU;
+        value ^= value >> 15;
+        value *= 0x846ca68bU;
+        value ^= value >> 16;
+        return value;
+    }
+
+    /// Returns the word with its first letter in upper case
+    QString capitalize(const std::string &word)
+    {
+        QString result = QString::fromStdString(word);
+        if (!result.isEmpty())
+            result[0] = result.at(0).toUpper();
+        return result;
+    }
+}
+
+SyntheticProfileSize SyntheticProfileSize::scaled(double factor) const
+{
+    auto scale = [factor](int count) {
+        return std::max(1, static_cast<int>(std::lround(count * factor)));
+    };
+
+    SyntheticProfileSize result;
+    result.HistoryEntries = scale(HistoryEntries);
+    result.Visits = std::max(result.HistoryEntries, scale(Visits));
+    result.BookmarkFolders = scale(BookmarkFolders);
+    result.Bookmarks = scale(Bookmarks);
+    result.Favicons = scale(Favicons);
+    result.FaviconMappings = scale(FaviconMappings);
+    result.Thumbnails = scale(Thumbnails);
+    result.Extensions = Extensions;
+    result.ItemsPerExtension = scale(ItemsPerExtension);
+    return result;
+}
+
+QJsonObject SyntheticProfileSize::toJson() const
+{
+    QJsonObject result;
+    result.insert(QStringLiteral("historyEntries"), HistoryEntries);
+    result.insert(QStringLiteral("visits"), Visits);
+    result.insert(QStringLiteral("bookmarkFolders"), BookmarkFolders);
+    result.insert(QStringLiteral("bookmarks"), Bookmarks);
+    result.insert(QStringLiteral("favicons"), Favicons);
+    result.insert(QStringLiteral("faviconMappings"), FaviconMappings);
+    result.insert(QStringLiteral("thumbnails"), Thumbnails);
+    result.insert(QStringLiteral("extensions"), Extensions);
+    result.insert(QStringLiteral("itemsPerExtension"), ItemsPerExtension);
+    return result;
+}
+
+SyntheticProfile::SyntheticProfile(const QString &directory, const SyntheticProfileSize &size, uint32_t seed) :
+    m_directory(directory),
+    m_size(size),
+    m_seed(seed),
+    m_vocabulary()
+{
+    static const std::array<const char*, 20> syllables {
+        "ka", "lo", "mi", "ne", "ra", "to", "vi", "zu", "an", "el",
+        "or", "is", "ub", "en", "ta", "pe", "so", "du", "gar", "lin"
+    };
+
+    std::mt19937 rng(m_seed);
+    std::set<std::string> words;
+    m_vocabulary.reserve(VocabularySize);
+    while (m_vocabulary.size() < VocabularySize)
+    {
+        std::string word;
+        const int numSyllables = 2 + static_cast<int>(rng() % 3);
+        for (int i = 0; i < numSyllables; ++i)
+            word.append(syllables.at(rng() % syllables.size()));
+
+        if (words.insert(word).second)
+            m_vocabulary.push_back(word);
+    }
+}
+
+bool SyntheticProfile::generate()
+{
+    if (!QDir().mkpath(m_directory))
+    {
+        qWarning() << "SyntheticProfile - could not create directory " << m_directory;
+        return false;
+    }
+
+    return generateHistory()
+            && generateBookmarks()
+            && generateFavicons()
+            && generateThumbnails()
+            && generateExtensionStorage();
+}
+
+const SyntheticProfileSize &SyntheticProfile::getSize() const
+{
+    return m_size;
+}
+
+QString SyntheticProfile::getHistoryFile() const
+{
+    return QDir(m_directory).filePath(QStringLiteral("History.db"));
+}
+
+QString SyntheticProfile::getBookmarkFile() const
+{
+    return QDir(m_directory).filePath(QStringLiteral("Bookmarks.db"));
+}
+
+QString SyntheticProfile::getFaviconFile() const
+{
+    return QDir(m_directory).filePath(QStringLiteral("Favicons.db"));
+}
+
+QString SyntheticProfile::getThumbnailFile() const
+{
+    return QDir(m_directory).filePath(QStringLiteral("Thumbnails.db"));
+}
+
+QString SyntheticProfile::getExtensionStorageFile() const
+{
+    return QDir(m_directory).filePath(QStringLiteral("ExtStorage.db"));
+}
+
+QUrl SyntheticProfile::getHistoryUrl(int index) const
+{
+    const uint32_t hash = mix(static_cast<uint32_t>(index) ^ m_seed);
+    return QUrl(QStringLiteral("https://www.%1/%2/%3/%4")
+                .arg(getHost(index % getNumHosts()),
+                     QString::fromStdString(getWord(static_cast<int>(hash % VocabularySize))),
+                     QString::fromStdString(getWord(static_cast<int>((hash >> 12) % VocabularySize))),
+                     QString::number(index)));
+}
+
+QString SyntheticProfile::getHost(int index) const
+{
+    return QStringLiteral("%1%2.com").arg(QString::fromStdString(getWord(index))).arg(index);
+}
+
+QUrl SyntheticProfile::getFaviconUrl(int index) const
+{
+    return QUrl(QStringLiteral("https://www.%1/favicon.ico").arg(getHost(index)));
+}
+
+QString SyntheticProfile::getExtensionId(int index) const
+{
+    return QStringLiteral("extension-%1-").arg(index);
+}
+
+int SyntheticProfile::getNumHosts() const
+{
+    return std::max(1, m_size.HistoryEntries / EntriesPerHost);
+}
+
+QByteArray SyntheticProfile::makeImageData(std::mt19937 &rng, int size, bool jpeg)
+{
+    QByteArray data = jpeg ? QByteArray("\xFF\xD8\xFF\xE0", 4) : QByteArray("\x89PNG\r\n\x1A\n", 8);
+    data.reserve(size);
+    while (data.size() < size)
+        data.append(static_cast<char>(rng() & 0xFF));
+    return data;
+}
+
+void SyntheticProfile::removeDatabase(const QString &path) const
+{
+    for (const QString &suffix : { QString(), QStringLiteral("-wal"), QStringLiteral("-shm") })
+    {
+        if (QFile::exists(path + suffix))
+            QFile::remove(path + suffix);
+    }
+}
+
+const std::string &SyntheticProfile::getWord(int index) const
+{
+    return m_vocabulary.at(static_cast<std::size_t>(index) % m_vocabulary.size());
+}
+
+bool SyntheticProfile::generateHistory()
+{
+    const QString fileName = getHistoryFile();
+    removeDatabase(fileName);
+    DatabaseFactory::createWorker<HistoryStore>(fileName).reset();
+
+    sqlite::Database db(fileName.toStdString());
+    std::mt19937 rng(m_seed ^ 0x48495354U);
+
+    // Words are stored in upper case by the history store, and each word of the vocabulary gets a known ID
+    {
+        sqlite::BatchWriter writer(db, R"(INSERT INTO Words(WordID, Word) VALUES (?, ?))", RowsPerTransaction);
+        for (std::size_t i = 0; i < m_vocabulary.size(); ++i)
+        {
+            const QString word = QString::fromStdString(m_vocabulary.at(i)).toUpper();
+            writer.add(static_cast<int>(i) + 1, word);
+        }
+        if (!writer.flush())
+            return false;
+    }
+
+    // Each entry is associated with the words of its host, path and title. Writers on the same connection
+    // cannot be interleaved, as their transactions would be nested, so the words are written in a second pass
+    auto getEntryWords = [this](int index) {
+        const uint32_t pathHash = mix(static_cast<uint32_t>(index) ^ m_seed);
+        const uint32_t titleHash = mix(pathHash);
+        return std::array<int, 6> {
+            static_cast<int>((index % getNumHosts()) % VocabularySize),
+            static_cast<int>(pathHash % VocabularySize),
+            static_cast<int>((pathHash >> 12) % VocabularySize),
+            static_cast<int>(titleHash % VocabularySize),
+            static_cast<int>((titleHash >> 8) % VocabularySize),
+            static_cast<int>((titleHash >> 16) % VocabularySize)
+        };
+    };
+
+    {
+        sqlite::BatchWriter writer(db, R"(INSERT INTO History(VisitID, URL, Title, URLTypedCount) VALUES (?, ?, ?, ?))",
+                                   RowsPerTransaction);
+        for (int i = 0; i < m_size.HistoryEntries; ++i)
+        {
+            const std::array<int, 6> wordIds = getEntryWords(i);
+            const QString title = QStringLiteral("%1 %2 - %3").arg(capitalize(getWord(wordIds[3])),
+                                                                  capitalize(getWord(wordIds[4])),
+                                                                  capitalize(getWord(wordIds[5])));
+            const QUrl url = getHistoryUrl(i);
+            const int typedCount = (i % 17 == 0) ? static_cast<int>(rng() % 5) : 0;
+            writer.add(i + 1, url, title, typedCount);
+        }
+        if (!writer.flush())
+            return false;
+    }
+
+    {
+        sqlite::BatchWriter writer(db, R"(INSERT OR IGNORE INTO URLWords(HistoryID, WordID) VALUES (?, ?))", RowsPerTransaction);
+        for (int i = 0; i < m_size.HistoryEntries; ++i)
+        {
+            for (int wordId : getEntryWords(i))
+                writer.add(i + 1, wordId + 1);
+        }
+        if (!writer.flush())
+            return false;
+    }
+
+    // Every entry is visited at least once, and the remaining visits are skewed towards the first entries
+    {
+        const qint64 now = QDateTime::currentMSecsSinceEpoch();
+        std::uniform_int_distribution<qint64> dateDistribution(0, VisitPeriodMs);
+        std::uniform_real_distribution<double> entryDistribution(0.0, 1.0);
+
+        sqlite::BatchWriter writer(db, R"(INSERT OR IGNORE INTO Visits(VisitID, Date) VALUES (?, ?))", RowsPerTransaction);
+        for (int i = 0; i < m_size.Visits; ++i)
+        {
+            int entryId = i;
+            if (i >= m_size.HistoryEntries)
+                entryId = static_cast<int>(m_size.HistoryEntries * std::pow(entryDistribution(rng), 3.0));
+
+            entryId = std::min(entryId, m_size.HistoryEntries - 1);
+            writer.add(entryId + 1, now - dateDistribution(rng));
+        }
+        if (!writer.flush())
+            return false;
+    }
+
+    return db.execute("ANALYZE");
+}
+
+bool SyntheticProfile::generateBookmarks()
+{
+    const QString fileName = getBookmarkFile();
+    removeDatabase(fileName);
+    DatabaseFactory::createWorker<BookmarkStore>(fileName).reset();
+
+    sqlite::Database db(fileName.toStdString());
+    std::mt19937 rng(m_seed ^ 0x424D524BU);
+
+    // Keep the root folder, and replace the default contents
+    if (!db.execute("DELETE FROM Bookmarks WHERE ID > 0"))
+        return false;
+
+    std::vector<int> nextPosition(static_cast<std::size_t>(m_size.BookmarkFolders) + 1, 0);
+    const QUrl emptyUrl;
+    const QString emptyShortcut;
+
+    sqlite::BatchWriter writer(db, R"(INSERT INTO Bookmarks(ID, ParentID, Type, Name, URL, Shortcut, Position) VALUES (?, ?, ?, ?, ?, ?, ?))",
+                               RowsPerTransaction);
+
+    // Folder n is placed in the root folder or in one of the folders created before it
+    for (int folderId = 1; folderId <= m_size.BookmarkFolders; ++folderId)
+    {
+        const int parentId = static_cast<int>(rng() % static_cast<uint32_t>(std::min(folderId, 50)));
+        const QString name = capitalize(getWord(static_cast<int>(rng() % VocabularySize)));
+        writer.add(folderId, parentId, static_cast<int>(BookmarkNode::Folder), name, emptyUrl, emptyShortcut,
+                   nextPosition[static_cast<std::size_t>(parentId)]++);
+    }
+
+    for (int i = 0; i < m_size.Bookmarks; ++i)
+    {
+        const int nodeId = m_size.BookmarkFolders + 1 + i;
+        const int parentId = static_cast<int>(rng() % static_cast<uint32_t>(m_size.BookmarkFolders + 1));
+        const QString name = QStringLiteral("%1 %2").arg(capitalize(getWord(static_cast<int>(rng() % VocabularySize))),
+                                                         capitalize(getWord(static_cast<int>(rng() % VocabularySize))));
+        const QUrl url = getHistoryUrl(static_cast<int>(rng() % static_cast<uint32_t>(m_size.HistoryEntries)));
+        const QString shortcut = (i % 100 == 0) ? QString::fromStdString(getWord(i)) : QString();
+        writer.add(nodeId, parentId, static_cast<int>(BookmarkNode::Bookmark), name, url, shortcut,
+                   nextPosition[static_cast<std::size_t>(parentId)]++);
+    }
+
+    return writer.flush();
+}
+
+bool SyntheticProfile::generateFavicons()
+{
+    const QString fileName = getFaviconFile();
+    removeDatabase(fileName);
+    DatabaseFactory::createWorker<FaviconStore>(fileName).reset();
+
+    sqlite::Database db(fileName.toStdString());
+    std::mt19937 rng(m_seed ^ 0x49434F4EU);
+    std::uniform_int_distribution<int> sizeDistribution(200, 4000);
+
+    {
+        sqlite::BatchWriter writer(db, R"(INSERT INTO Favicons(FaviconID, URL) VALUES (?, ?))", RowsPerTransaction);
+        for (int i = 0; i < m_size.Favicons; ++i)
+        {
+            const QUrl iconUrl = getFaviconUrl(i);
+            writer.add(i + 1, iconUrl);
+        }
+        if (!writer.flush())
+            return false;
+    }
+
+    {
+        sqlite::BatchWriter writer(db, R"(INSERT INTO FaviconData(DataID, FaviconID, Data) VALUES (?, ?, ?))", RowsPerTransaction);
+        for (int i = 0; i < m_size.Favicons; ++i)
+        {
+            const QByteArray data = makeImageData(rng, sizeDistribution(rng), false);
+            writer.add(i + 1, i + 1, data);
+        }
+        if (!writer.flush())
+            return false;
+    }
+
+    // Pages use the favicon of their web site
+    sqlite::BatchWriter mapWriter(db, R"(INSERT OR IGNORE INTO FaviconMap(PageURL, FaviconID) VALUES (?, ?))", RowsPerTransaction);
+    for (int i = 0; i < m_size.FaviconMappings; ++i)
+    {
+        const QUrl pageUrl = getHistoryUrl(i % m_size.HistoryEntries);
+        const int faviconId = ((i % m_size.HistoryEntries) % getNumHosts()) % m_size.Favicons + 1;
+        mapWriter.add(pageUrl, faviconId);
+    }
+    return mapWriter.flush();
+}
+
+bool SyntheticProfile::generateThumbnails()
+{
+    const QString fileName = getThumbnailFile();
+    removeDatabase(fileName);
+    {
+        ViperServiceLocator serviceLocator;
+        DatabaseFactory::createWorker<WebPageThumbnailStore>(serviceLocator, fileName).reset();
+    }
+
+    sqlite::Database db(fileName.toStdString());
+    std::mt19937 rng(m_seed ^ 0x54484D42U);
+    std::uniform_int_distribution<int> sizeDistribution(8 * 1024, 32 * 1024);
+
+    sqlite::BatchWriter writer(db, R"(INSERT INTO Thumbnails(Host, Thumbnail) VALUES (?, ?))", RowsPerTransaction);
+    for (int i = 0; i < m_size.Thumbnails; ++i)
+    {
+        const QString host = QStringLiteral("www.%1").arg(getHost(i));
+        const QByteArray data = makeImageData(rng, sizeDistribution(rng), true);
+        writer.add(host, data);
+    }
+    return writer.flush();
+}
+
+bool SyntheticProfile::generateExtensionStorage()
+{
+    const QString fileName = getExtensionStorageFile();
+    removeDatabase(fileName);
+    DatabaseFactory::createWorker<ExtStorage>(fileName).reset();
+
+    sqlite::Database db(fileName.toStdString());
+    std::mt19937 rng(m_seed ^ 0x45585453U);
+    std::uniform_int_distribution<int> lengthDistribution(16, 1024);
+
+    sqlite::BatchWriter writer(db, R"(INSERT INTO ItemTable(key, value) VALUES (?, ?))", RowsPerTransaction);
+    for (int extension = 0; extension < m_size.Extensions; ++extension)
+    {
+        const QString extensionId = getExtensionId(extension);
+        for (int i = 0; i < m_size.ItemsPerExtension; ++i)
+        {
+            const QString key = QStringLiteral("%1setting%2").arg(extensionId).arg(i);
+
+            std::string text;
+            const int length = lengthDistribution(rng);
+            while (static_cast<int>(text.size()) < length)
+                text.append(getWord(static_cast<int>(rng() % VocabularySize))).append(" ");
+
+            const sqlite::Blob value { text };
+            writer.add(key, value);
+        }
+    }
+    return writer.flush();
+}
@@ -0,0 +1,158 @@
+#ifndef SYNTHETICPROFILE_H
+#define SYNTHETICPROFILE_H
+
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <QByteArray>
+#include <QJsonObject>
+#include <QString>
+#include <QUrl>
+
+/// Number of records of each kind in a synthetic browser profile
+struct SyntheticProfileSize
+{
+    /// Number of unique URLs in the browsing history
+    int HistoryEntries;
+
+    /// Number of visits, spread over the history entries with a skew towards frequently visited pages
+    int Visits;
+
+    /// Number of bookmark folders
+    int BookmarkFolders;
+
+    /// Number of bookmarks, spread over the folders
+    int Bookmarks;
+
+    /// Number of favicons, each with its own icon data
+    int Favicons;
+
+    /// Number of web pages mapped to a favicon
+    int FaviconMappings;
+
+    /// Number of stored web page thumbnails
+    int Thumbnails;
+
+    /// Number of extensions with data in the extension storage
+    int Extensions;
+
+    /// Number of key-value pairs stored by each extension
+    int ItemsPerExtension;
+
+    /// Default constructor, describing a profile after several years of heavy use
+    SyntheticProfileSize() :
+        HistoryEntries(200000),
+        Visits(2000000),
+        BookmarkFolders(1000),
+        Bookmarks(20000),
+        Favicons(50000),
+        FaviconMappings(100000),
+        Thumbnails(500),
+        Extensions(20),
+        ItemsPerExtension(1000)
+    {
+    }
+
+    /// Returns the size with every record count multiplied by the given factor, keeping at least one record of each kind
+    SyntheticProfileSize scaled(double factor) const;
+
+    /// Returns the record counts as a JSON object
+    QJsonObject toJson() const;
+};
+
+/**
+ * @class SyntheticProfile
+ * @brief Generates the database files of a browser profile, filled with synthetic records.
+ *
+ * The records only depend on the size of the profile and on the random seed, so that the
+ * same profile can be recreated on another machine or after a change to the stores. Dates
+ * of visits are the only exception, as they are relative to the time of generation so that
+ * they are not purged as old history when the profile is loaded.
+ *
+ * The tables are created by the stores themselves, and are filled directly through the sqlite
+ * wrapper so that generating millions of records only takes a few seconds.
+ */
+class SyntheticProfile
+{
+public:
+    /// Constructs the profile, given the directory that its database files are written to, its size and the random seed
+    SyntheticProfile(const QString &directory, const SyntheticProfileSize &size, uint32_t seed);
+
+    /// Writes all of the database files, replacing any existing files. Returns true on success
+    bool generate();
+
+    /// Returns the size of the profile
+    const SyntheticProfileSize &getSize() const;
+
+    /// Returns the path of the history database
+    QString getHistoryFile() const;
+
+    /// Returns the path of the bookmark database
+    QString getBookmarkFile() const;
+
+    /// Returns the path of the favicon database
+    QString getFaviconFile() const;
+
+    /// Returns the path of the thumbnail database
+    QString getThumbnailFile() const;
+
+    /// Returns the path of the extension storage database
+    QString getExtensionStorageFile() const;
+
+    /// Returns the URL of the history entry with the given index
+    QUrl getHistoryUrl(int index) const;
+
+    /// Returns the hostname of the web site with the given index
+    QString getHost(int index) const;
+
+    /// Returns the URL of the favicon with the given index
+    QUrl getFaviconUrl(int index) const;
+
+    /// Returns the unique identifier of the extension with the given index
+    QString getExtensionId(int index) const;
+
+    /// Returns the number of distinct web sites that the history entries belong to
+    int getNumHosts() const;
+
+    /// Returns random encoded image data of the given size. The data begins with a PNG or JPEG signature
+    static QByteArray makeImageData(std::mt19937 &rng, int size, bool jpeg);
+
+private:
+    /// Removes the database file with the given path, along with its write-ahead log
+    void removeDatabase(const QString &path) const;
+
+    /// Returns a pseudo-word from the vocabulary of the profile
+    const std::string &getWord(int index) const;
+
+    /// Fills the history database
+    bool generateHistory();
+
+    /// Fills the bookmark database
+    bool generateBookmarks();
+
+    /// Fills the favicon database
+    bool generateFavicons();
+
+    /// Fills the thumbnail database
+    bool generateThumbnails();
+
+    /// Fills the extension storage database
+    bool generateExtensionStorage();
+
+private:
+    /// Directory containing the database files
+    QString m_directory;
+
+    /// Number of records of each kind
+    SyntheticProfileSize m_size;
+
+    /// Random seed
+    uint32_t m_seed;
+
+    /// Pseudo-words used for page titles and URL paths
+    std::vector<std::string> m_vocabulary;
+};
+
+#endif // SYNTHETICPROFILE_H
@@ -0,0 +1,243 @@
+#include "sqlite/SQLiteWrapper.h"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <QFile>
+#include <QObject>
+#include <QString>
+#include <QTest>
+
+/// Tests the connection profiles and the read-only connection pool of the SQLite wrapper,
+/// and measures their effect on a workload that mixes reads and writes
+class DatabaseProfileTest : public QObject
+{
+    Q_OBJECT
+
+public:
+    DatabaseProfileTest() : QObject(nullptr), m_dbFile(QLatin1String("DatabaseProfileTest.db")) {}
+
+private:
+    /// Number of rows in the table before the mixed workload starts
+    static constexpr int InitialRowCount = 20000;
+
+    /// Number of threads that read from the database during the mixed workload
+    static constexpr int ReaderCount = 4;
+
+    /// Returns the value of an integer PRAGMA on the given connection
+    int64_t getPragma(sqlite::Database &db, const std::string &name)
+    {
+        auto stmt = db.prepare("PRAGMA " + name);
+        int64_t value = -1;
+        if (stmt.next())
+            stmt >> value;
+        return value;
+    }
+
+    /// Creates the table used by the tests, with the initial rows
+    void createTable(sqlite::Database &db)
+    {
+        QVERIFY(db.execute("CREATE TABLE IF NOT EXISTS Pages(Id INTEGER PRIMARY KEY, URL TEXT, Title TEXT, Visits INTEGER)"));
+        QVERIFY(db.execute("CREATE INDEX IF NOT EXISTS Pages_Visits_Index ON Pages(Visits)"));
+
+        db.beginTransaction();
+        auto stmt = db.prepare(R"(INSERT INTO Pages(URL, Title, Visits) VALUES (?, ?, ?))");
+        for (int i = 0; i < InitialRowCount; ++i)
+        {
+            // Strings are bound without being copied, so they must outlive the execution of the statement
+            const std::string url = "https://site" + std::to_string(i) + ".example/";
+            const std::string title = "Page " + std::to_string(i);
+            stmt << url
+                 << title
+                 << (i % 97);
+            stmt.execute();
+        }
+        db.commitTransaction();
+    }
+
+    /// Runs a query resembling a URL suggestion search
+    int runSuggestionQuery(sqlite::Database &db, int i)
+    {
+        auto stmt = db.prepare(R"(SELECT URL, Title, Visits FROM Pages WHERE URL LIKE ? ORDER BY Visits DESC LIMIT 25)");
+        const std::string pattern = "%site" + std::to_string(i % 1000) + "%";
+        stmt << pattern;
+
+        int rows = 0;
+        while (stmt.next())
+            ++rows;
+        return rows;
+    }
+
+    /// Runs a query resembling a history visit, in its own transaction
+    void runVisitWrite(sqlite::Database &db, int i)
+    {
+        db.beginTransaction();
+        auto stmt = db.prepare(R"(UPDATE Pages SET Visits = Visits + 1 WHERE Id = ?)");
+        stmt << (i % InitialRowCount) + 1;
+        stmt.execute();
+        db.commitTransaction();
+    }
+
+private slots:
+    void init()
+    {
+        cleanup();
+    }
+
+    void cleanup()
+    {
+        for (const QString &suffix : { QString(), QStringLiteral("-wal"), QStringLiteral("-shm") })
+        {
+            if (QFile::exists(m_dbFile + suffix))
+                QFile::remove(m_dbFile + suffix);
+        }
+    }
+
+    /// Verifies that the settings of the performance profile are applied to the connection
+    void testPerformanceProfileIsApplied()
+    {
+        sqlite::Database db(m_dbFile.toStdString());
+        QVERIFY(db.applyProfile(sqlite::DatabaseProfile::performance()));
+
+        auto journalStmt = db.prepare("PRAGMA journal_mode");
+        std::string journalMode;
+        QVERIFY(journalStmt.next());
+        journalStmt >> journalMode;
+
+        QCOMPARE(QString::fromStdString(journalMode).toLower(), QStringLiteral("wal"));
+        QCOMPARE(getPragma(db, "synchronous"), int64_t{1});
+        QCOMPARE(getPragma(db, "cache_size"), int64_t{-8 * 1024});
+        QCOMPARE(getPragma(db, "temp_store"), int64_t{2});
+    }
+
+    /// Verifies that read-only connections can read, but not write
+    void testReadOnlyConnection()
+    {
+        {
+            sqlite::Database db(m_dbFile.toStdString());
+            db.applyProfile(sqlite::DatabaseProfile::performance());
+            createTable(db);
+        }
+
+        sqlite::Database reader(m_dbFile.toStdString(), sqlite::OpenMode::ReadOnly);
+        QVERIFY(reader.isValid());
+        QVERIFY(reader.isReadOnly());
+        QVERIFY(reader.applyProfile(sqlite::DatabaseProfile::reader()));
+
+        QCOMPARE(runSuggestionQuery(reader, 5), 25);
+        QVERIFY(!reader.execute("DELETE FROM Pages"));
+
+        sqlite::Database missing("DatabaseProfileTest-missing.db", sqlite::OpenMode::ReadOnly);
+        QVERIFY(!missing.isValid());
+        QVERIFY(!QFile::exists(QLatin1String("DatabaseProfileTest-missing.db")));
+    }
+
+    /// Verifies that the pool opens no more than its maximum number of connections, and reuses them
+    void testConnectionPool()
+    {
+        {
+            sqlite::Database db(m_dbFile.toStdString());
+            db.applyProfile(sqlite::DatabaseProfile::performance());
+            createTable(db);
+        }
+
+        sqlite::ConnectionPool pool(m_dbFile.toStdString(), 2);
+        {
+            auto first = pool.acquire();
+            auto second = pool.acquire();
+            QVERIFY(first && second);
+            QVERIFY(first.get() != second.get());
+            QVERIFY(first->isReadOnly());
+            QCOMPARE(pool.getOpenCount(), size_t{2});
+
+            // A third reader waits until one of the connections is returned
+            std::atomic_bool acquired { false };
+            std::thread waiter([&](){
+                auto third = pool.acquire();
+                acquired = third != nullptr;
+            });
+
+            QTest::qWait(50);
+            QVERIFY(!acquired);
+            first.reset();
+            waiter.join();
+
+            QVERIFY(acquired);
+            QCOMPARE(pool.getWaitCount(), size_t{1});
+        }
+
+        auto reused = pool.acquire();
+        QVERIFY(reused);
+        QCOMPARE(pool.getOpenCount(), size_t{2});
+    }
+
+    /// Measures a workload where a writer records visits while several threads run suggestion queries. With the
+    /// default settings, readers share the writer's connection, as they did when every query went through a
+    /// single database thread. With the performance profile, readers use the read-only connection pool.
+    void benchmarkMixedReadWrite_data()
+    {
+        QTest::addColumn<bool>("usePerformanceProfile");
+
+        QTest::newRow("default settings, shared connection") << false;
+        QTest::newRow("performance profile, reader pool") << true;
+    }
+
+    void benchmarkMixedReadWrite()
+    {
+        QFETCH(bool, usePerformanceProfile);
+
+        sqlite::Database writer(m_dbFile.toStdString());
+        writer.applyProfile(usePerformanceProfile ? sqlite::DatabaseProfile::performance() : sqlite::DatabaseProfile::defaults());
+        createTable(writer);
+
+        sqlite::ConnectionPool pool(m_dbFile.toStdString(), ReaderCount);
+        std::mutex writerMutex;
+
+        QBENCHMARK {
+            std::vector<std::thread> threads;
+
+            threads.emplace_back([&](){
+                for (int i = 0; i < 200; ++i)
+                {
+                    std::lock_guard<std::mutex> lock{writerMutex};
+                    runVisitWrite(writer, i);
+                }
+            });
+
+            for (int r = 0; r < ReaderCount; ++r)
+            {
+                threads.emplace_back([&, r](){
+                    for (int i = 0; i < 50; ++i)
+                    {
+                        if (usePerformanceProfile)
+                        {
+                            auto reader = pool.acquire();
+                            runSuggestionQuery(*reader, r * 50 + i);
+                        }
+                        else
+                        {
+                            std::lock_guard<std::mutex> lock{writerMutex};
+                            runSuggestionQuery(writer, r * 50 + i);
+                        }
+                    }
+                });
+            }
+
+            for (std::thread &t : threads)
+                t.join();
+        }
+    }
+
+private:
+    /// Database file used by the tests
+    const QString m_dbFile;
+};
+
+QTEST_GUILESS_MAIN(DatabaseProfileTest)
+
+#include "DatabaseProfileTest.moc"
@@ -0,0 +1,207 @@
+#include "sqlite/SQLiteWrapper.h"
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <QFile>
+#include <QObject>
+#include <QString>
+#include <QTest>
+
+/// Tests the statement profiling of the SQLite wrapper
+class QueryProfilerTest : public QObject
+{
+    Q_OBJECT
+
+public:
+    QueryProfilerTest() : QObject(nullptr), m_dbFile(QLatin1String("QueryProfilerTest.db")) {}
+
+private:
+    /// Creates a table with the given number of rows
+    void createTable(sqlite::Database &db, int numRows)
+    {
+        QVERIFY(db.execute("CREATE TABLE Items(ID INTEGER PRIMARY KEY, Name TEXT, Category INTEGER)"));
+
+        sqlite::BatchWriter writer(db, R"(INSERT INTO Items(ID, Name, Category) VALUES (?, ?, ?))");
+        for (int i = 0; i < numRows; ++i)
+        {
+            const std::string name = "Item " + std::to_string(i);
+            writer.add(i, name, i % 10);
+        }
+    }
+
+    /// Returns the statistics of the statement with the given normalized text
+    sqlite::QueryStats findStats(const sqlite::QueryProfiler &profiler, const std::string &sql)
+    {
+        for (const sqlite::QueryStats &stats : profiler.getStats())
+        {
+            if (stats.sql == sql)
+                return stats;
+        }
+        return sqlite::QueryStats();
+    }
+
+private slots:
+    void init()
+    {
+        cleanup();
+    }
+
+    void cleanup()
+    {
+        if (QFile::exists(m_dbFile))
+            QFile::remove(m_dbFile);
+    }
+
+    void testNormalize_data()
+    {
+        QTest::addColumn<QString>("sql");
+        QTest::addColumn<QString>("expected");
+
+        QTest::newRow("whitespace") << QString("SELECT  a,\n      b FROM t ;") << QString("SELECT a, b FROM t");
+        QTest::newRow("literals") << QString("SELECT * FROM t WHERE id = 42 AND name = 'it''s' AND x > 1.5e-3")
+                                  << QString("SELECT * FROM t WHERE id = ? AND name = ? AND x > ?");
+        QTest::newRow("identifiers") << QString("SELECT col2 FROM \"table 1\" WHERE v1 = ?")
+                                     << QString("SELECT col2 FROM \"table 1\" WHERE v1 = ?");
+    }
+
+    void testNormalize()
+    {
+        QFETCH(QString, sql);
+        QFETCH(QString, expected);
+
+        QCOMPARE(QString::fromStdString(sqlite::QueryProfiler::normalize(sql.toStdString())), expected);
+    }
+
+    void testStatisticsAreAggregated()
+    {
+        sqlite::Database db(m_dbFile.toStdString());
+        createTable(db, 100);
+
+        sqlite::QueryProfiler &profiler = db.enableProfiling();
+        profiler.setSlowQueryThreshold(std::chrono::seconds(10));
+
+        for (int category = 0; category < 3; ++category)
+        {
+            auto stmt = db.prepareCached(R"(SELECT Name FROM Items WHERE Category = ?)");
+            *stmt << category;
+            while (stmt->next()) {}
+        }
+
+        // Statements with different literals are counted together
+        QVERIFY(db.execute("SELECT COUNT(*) FROM Items WHERE ID < 10"));
+        QVERIFY(db.execute("SELECT COUNT(*) FROM Items WHERE ID < 20"));
+
+        const sqlite::QueryStats select = findStats(profiler, "SELECT Name FROM Items WHERE Category = ?");
+        QCOMPARE(select.count, uint64_t{3});
+        QCOMPARE(select.rowsStepped, uint64_t{30});
+        QCOMPARE(select.slowCount, uint64_t{0});
+        QVERIFY(select.totalTime.count() > 0);
+        QVERIFY(select.maxTime <= select.totalTime);
+
+        const sqlite::QueryStats count = findStats(profiler, "SELECT COUNT(*) FROM Items WHERE ID < ?");
+        QCOMPARE(count.count, uint64_t{2});
+
+        profiler.reset();
+        QVERIFY(profiler.getStats().empty());
+
+        db.disableProfiling();
+        QVERIFY(db.getProfiler() == nullptr);
+        QVERIFY(db.execute("SELECT COUNT(*) FROM Items"));
+    }
+
+    void testManyDistinctStatementsAreAggregated()
+    {
+        sqlite::Database db(m_dbFile.toStdString());
+        createTable(db, 10);
+
+        sqlite::QueryProfiler &profiler = db.enableProfiling();
+        profiler.setSlowQueryThreshold(std::chrono::seconds(10));
+
+        // Each statement has its own text, so the cache of normalized text is cleared along the way
+        const int numStatements = static_cast<int>(sqlite::QueryProfiler::MaxNormalizedSqlCacheSize) * 2 + 1;
+        for (int i = 0; i < numStatements; ++i)
+            QVERIFY(db.execute("SELECT COUNT(*) FROM Items WHERE ID < " + std::to_string(i)));
+
+        const sqlite::QueryStats count = findStats(profiler, "SELECT COUNT(*) FROM Items WHERE ID < ?");
+        QCOMPARE(count.count, static_cast<uint64_t>(numStatements));
+    }
+
+    void testSlowQueryIsLoggedWithPlan()
+    {
+        sqlite::Database db(m_dbFile.toStdString());
+        createTable(db, 100);
+
+        std::vector<std::string> messages;
+        sqlite::QueryProfiler &profiler = db.enableProfiling();
+        profiler.setSlowQueryThreshold(std::chrono::microseconds(0));
+        profiler.setLogger([&messages](const std::string &message) { messages.push_back(message); });
+
+        auto stmt = db.prepare(R"(SELECT Name FROM Items WHERE Category = 3)");
+        while (stmt.next()) {}
+
+        QCOMPARE(messages.size(), size_t{1});
+        QVERIFY(messages.front().find("SELECT Name FROM Items WHERE Category = ?") != std::string::npos);
+        QVERIFY(messages.front().find("SCAN") != std::string::npos);
+
+        const sqlite::QueryStats stats = findStats(profiler, "SELECT Name FROM Items WHERE Category = ?");
+        QCOMPARE(stats.slowCount, uint64_t{1});
+        QVERIFY(stats.queryPlan.find("SCAN") != std::string::npos);
+    }
+
+    void testBusyWaitsAreCounted()
+    {
+        sqlite::Database db(m_dbFile.toStdString());
+        createTable(db, 10);
+
+        sqlite::Database other(m_dbFile.toStdString());
+        QVERIFY(other.execute("BEGIN IMMEDIATE"));
+
+        sqlite::QueryProfiler &profiler = db.enableProfiling();
+        profiler.setSlowQueryThreshold(std::chrono::seconds(10));
+
+        std::thread releaseLock([&other](){
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            other.commitTransaction();
+        });
+
+        const bool result = db.execute("INSERT INTO Items(ID, Name, Category) VALUES (100, 'Item', 0)");
+        releaseLock.join();
+
+        QVERIFY(result);
+        const sqlite::QueryStats stats = findStats(profiler, "INSERT INTO Items(ID, Name, Category) VALUES (?, ?, ?)");
+        QCOMPARE(stats.count, uint64_t{1});
+        QVERIFY(stats.busyWaits > 0);
+    }
+
+    void testJsonExport()
+    {
+        sqlite::Database db(m_dbFile.toStdString());
+        createTable(db, 10);
+
+        sqlite::QueryProfiler &profiler = db.enableProfiling();
+        profiler.setSlowQueryThreshold(std::chrono::seconds(10));
+        QVERIFY(db.execute("SELECT Name FROM Items WHERE Name = 'Item \"1\"'"));
+
+        const std::string json = profiler.toJson();
+        QVERIFY(json.find("\"queries\": [") != std::string::npos);
+        QVERIFY(json.find("\"sql\": \"SELECT Name FROM Items WHERE Name = ?\"") != std::string::npos);
+        QVERIFY(json.find("\"count\": 1") != std::string::npos);
+        QVERIFY(json.find("\"totalTimeNs\": ") != std::string::npos);
+        QVERIFY(json.find("\"busyWaits\": 0") != std::string::npos);
+
+        profiler.reset();
+        QCOMPARE(profiler.toJson(), std::string("{\n  \"queries\": []\n}\n"));
+    }
+
+private:
+    /// Database file used by the tests
+    const QString m_dbFile;
+};
+
+QTEST_APPLESS_MAIN(QueryProfilerTest)
+
+#include "QueryProfilerTest.moc"
@@ -0,0 +1,223 @@
+#include "sqlite/SQLiteWrapper.h"
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+
+#include <QFile>
+#include <QObject>
+#include <QString>
+#include <QTest>
+
+/// Tests the borrowed text and blob views of a statement's current row
+class RowViewTest : public QObject
+{
+    Q_OBJECT
+
+public:
+    RowViewTest() : QObject(nullptr), m_dbFile(QLatin1String("RowViewTest.db")) {}
+
+private:
+    /// Creates a table of favicon-like blobs, each of the given size
+    void createIconTable(sqlite::Database &db, int numRows, int blobSize)
+    {
+        QVERIFY(db.execute("CREATE TABLE FaviconData(DataID INTEGER PRIMARY KEY, FaviconID INTEGER, Data BLOB)"));
+
+        sqlite::Transaction transaction(db);
+        auto stmt = db.prepare(R"(INSERT INTO FaviconData(DataID, FaviconID, Data) VALUES (?, ?, ?))");
+        for (int i = 0; i < numRows; ++i)
+        {
+            const sqlite::Blob data { std::string(static_cast<std::size_t>(blobSize), static_cast<char>('a' + i % 26)) };
+            stmt << i
+                 << i
+                 << data;
+            stmt.execute();
+        }
+        QVERIFY(transaction.commit());
+    }
+
+    /// Creates a table of history-like records
+    void createHistoryTable(sqlite::Database &db, int numRows)
+    {
+        QVERIFY(db.execute("CREATE TABLE History(VisitID INTEGER PRIMARY KEY, URL TEXT, Title TEXT, Visits INTEGER)"));
+
+        sqlite::Transaction transaction(db);
+        auto stmt = db.prepare(R"(INSERT INTO History(VisitID, URL, Title, Visits) VALUES (?, ?, ?, ?))");
+        for (int i = 0; i < numRows; ++i)
+        {
+            const std::string url = "https://www.example" + std::to_string(i) + ".com/some/path/to/a/page?query=" + std::to_string(i);
+            const std::string title = "Example page number " + std::to_string(i) + " - a reasonably long page title";
+            stmt << i
+                 << url
+                 << title
+                 << i % 50;
+            stmt.execute();
+        }
+        QVERIFY(transaction.commit());
+    }
+
+private slots:
+    void init()
+    {
+        cleanup();
+    }
+
+    void cleanup()
+    {
+        if (QFile::exists(m_dbFile))
+            QFile::remove(m_dbFile);
+    }
+
+    void testTextAndBlobViews()
+    {
+        sqlite::Database db(m_dbFile.toStdString());
+        QVERIFY(db.execute("CREATE TABLE Items(Name TEXT, Data BLOB)"));
+
+        // The blob contains a null byte, to ensure views are sized by SQLite rather than by strlen
+        const std::string name = "first item";
+        const sqlite::Blob data { std::string("ab\0cd", 5) };
+        auto insert = db.prepare(R"(INSERT INTO Items(Name, Data) VALUES (?, ?))");
+        insert << name
+               << data;
+        QVERIFY(insert.execute());
+
+        auto stmt = db.prepare(R"(SELECT Name, Data FROM Items)");
+        QVERIFY(stmt.next());
+
+        std::string_view nameView;
+        sqlite::BlobView dataView;
+        stmt >> nameView
+             >> dataView;
+
+        QVERIFY(nameView == name);
+        QCOMPARE(dataView.data.size(), std::size_t{5});
+        QVERIFY(dataView.data == data.data);
+
+        QVERIFY(stmt.getTextView(0) == name);
+        QVERIFY(stmt.getBlobView(1) == data.data);
+    }
+
+    void testNullAndOutOfRangeColumnsAreEmpty()
+    {
+        sqlite::Database db(m_dbFile.toStdString());
+        QVERIFY(db.execute("CREATE TABLE Items(Name TEXT, Data BLOB)"));
+        QVERIFY(db.execute("INSERT INTO Items(Name, Data) VALUES (NULL, NULL)"));
+
+        auto stmt = db.prepare(R"(SELECT Name, Data FROM Items)");
+        QVERIFY(stmt.next());
+
+        QVERIFY(stmt.getTextView(0).empty());
+        QVERIFY(stmt.getBlobView(1).empty());
+        QVERIFY(stmt.getTextView(5).empty());
+
+        std::string name = "not empty";
+        sqlite::Blob data { "not empty" };
+        stmt >> name
+             >> data;
+        QVERIFY(name.empty());
+        QVERIFY(data.data.empty());
+    }
+
+    void testViewsCanBeBound()
+    {
+        sqlite::Database db(m_dbFile.toStdString());
+        QVERIFY(db.execute("CREATE TABLE Items(Name TEXT, Data BLOB)"));
+
+        const std::string source = "some text and some bytes";
+        const std::string_view name(source.data(), 9);
+        const sqlite::BlobView data { std::string_view(source).substr(14) };
+
+        auto insert = db.prepare(R"(INSERT INTO Items(Name, Data) VALUES (?, ?))");
+        insert << name
+               << data;
+        QVERIFY(insert.execute());
+
+        auto stmt = db.prepare(R"(SELECT typeof(Name), typeof(Data), Name, Data FROM Items)");
+        QVERIFY(stmt.next());
+
+        std::string nameType, dataType, nameCopy;
+        sqlite::Blob dataCopy;
+        stmt >> nameType
+             >> dataType
+             >> nameCopy
+             >> dataCopy;
+
+        QCOMPARE(nameType, std::string("text"));
+        QCOMPARE(dataType, std::string("blob"));
+        QCOMPARE(nameCopy, std::string("some text"));
+        QCOMPARE(dataCopy.data, std::string("some bytes"));
+    }
+
+    /// Compares bulk loads of favicon-like blobs and history-like rows, when each value is copied into
+    /// an owned object before being hashed, against hashing a view of the value
+    void benchmarkBulkLoad_data()
+    {
+        QTest::addColumn<bool>("loadIcons");
+        QTest::addColumn<bool>("useViews");
+
+        QTest::newRow("favicons, copied") << true << false;
+        QTest::newRow("favicons, viewed") << true << true;
+        QTest::newRow("history, copied") << false << false;
+        QTest::newRow("history, viewed") << false << true;
+    }
+
+    void benchmarkBulkLoad()
+    {
+        QFETCH(bool, loadIcons);
+        QFETCH(bool, useViews);
+
+        sqlite::Database db(m_dbFile.toStdString());
+        if (loadIcons)
+            createIconTable(db, 2000, 4096);
+        else
+            createHistoryTable(db, 10000);
+
+        auto stmt = loadIcons ? db.prepare(R"(SELECT DataID, FaviconID, Data FROM FaviconData)")
+                              : db.prepare(R"(SELECT VisitID, URL, Title, Visits FROM History)");
+
+        std::hash<std::string_view> hasher;
+        std::size_t checksum = 0;
+
+        QBENCHMARK {
+            while (stmt.next())
+            {
+                int id = 0, otherId = 0;
+                if (loadIcons && useViews)
+                {
+                    sqlite::BlobView data;
+                    stmt >> id >> otherId >> data;
+                    checksum += hasher(data.data);
+                }
+                else if (loadIcons)
+                {
+                    sqlite::Blob data;
+                    stmt >> id >> otherId >> data;
+                    checksum += hasher(data.data);
+                }
+                else if (useViews)
+                {
+                    std::string_view url, title;
+                    stmt >> id >> url >> title >> otherId;
+                    checksum += hasher(url) ^ hasher(title);
+                }
+                else
+                {
+                    std::string url, title;
+                    stmt >> id >> url >> title >> otherId;
+                    checksum += hasher(url) ^ hasher(title);
+                }
+            }
+        }
+
+        QVERIFY(checksum != 0);
+    }
+
+private:
+    /// Path of the database file used by each test
+    const QString m_dbFile;
+};
+
+QTEST_APPLESS_MAIN(RowViewTest)
+
+#include "RowViewTest.moc"
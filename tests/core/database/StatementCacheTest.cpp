@@ -0,0 +1,254 @@
+#include "sqlite/SQLiteWrapper.h"
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+
+#include <QFile>
+#include <QObject>
+#include <QString>
+#include <QTest>
+
+/// Tests the per-connection cache of prepared statements
+class StatementCacheTest : public QObject
+{
+    Q_OBJECT
+
+public:
+    StatementCacheTest() : QObject(nullptr), m_dbFile(QLatin1String("StatementCacheTest.db")) {}
+
+private:
+    /// Creates a table with a few rows, keyed by their ID
+    void createTable(sqlite::Database &db, int numRows)
+    {
+        QVERIFY(db.execute("CREATE TABLE Items(ID INTEGER PRIMARY KEY, Name TEXT)"));
+
+        db.beginTransaction();
+        auto stmt = db.prepare(R"(INSERT INTO Items(ID, Name) VALUES (?, ?))");
+        for (int i = 0; i < numRows; ++i)
+        {
+            const std::string name = "Item " + std::to_string(i);
+            stmt << i
+                 << name;
+            stmt.execute();
+        }
+        db.commitTransaction();
+    }
+
+private slots:
+    void init()
+    {
+        cleanup();
+    }
+
+    void cleanup()
+    {
+        if (QFile::exists(m_dbFile))
+            QFile::remove(m_dbFile);
+    }
+
+    void testStatementIsReused()
+    {
+        sqlite::Database db(m_dbFile.toStdString());
+        createTable(db, 10);
+
+        const sqlite::PreparedStatement *first = nullptr;
+        {
+            auto stmt = db.prepareCached(R"(SELECT Name FROM Items WHERE ID = ?)");
+            first = stmt.get();
+            *stmt << 3;
+            QVERIFY(stmt->next());
+        }
+
+        auto stmt = db.prepareCached(R"(SELECT Name FROM Items WHERE ID = ?)");
+        QCOMPARE(stmt.get(), first);
+
+        *stmt << 4;
+        QVERIFY(stmt->next());
+
+        std::string name;
+        *stmt >> name;
+        QCOMPARE(name, std::string("Item 4"));
+
+        const sqlite::StatementCacheStats stats = db.getStatementCache().getStats();
+        QCOMPARE(stats.hits, uint64_t{1});
+        QCOMPARE(stats.misses, uint64_t{1});
+        QCOMPARE(stats.size, size_t{1});
+    }
+
+    void testBindingsAreClearedOnCheckout()
+    {
+        sqlite::Database db(m_dbFile.toStdString());
+        createTable(db, 10);
+
+        {
+            // Leave the statement bound and in the middle of its result set
+            auto stmt = db.prepareCached(R"(SELECT Name FROM Items WHERE ID >= ?)");
+            *stmt << 2;
+            QVERIFY(stmt->next());
+        }
+
+        // Unbound parameters are NULL, which match no rows
+        auto stmt = db.prepareCached(R"(SELECT Name FROM Items WHERE ID >= ?)");
+        QVERIFY(!stmt->next());
+    }
+
+    void testReturnedStatementReleasesLock()
+    {
+        sqlite::Database db(m_dbFile.toStdString());
+        createTable(db, 10);
+
+        {
+            auto stmt = db.prepareCached(R"(SELECT Name FROM Items)");
+            QVERIFY(stmt->next());
+        }
+
+        // An unfinished SELECT would keep the table locked, causing the DROP to fail
+        QVERIFY(db.execute("DROP TABLE Items"));
+    }
+
+    void testNestedCheckoutIsNotCached()
+    {
+        sqlite::Database db(m_dbFile.toStdString());
+        createTable(db, 10);
+
+        const std::string sql = R"(SELECT Name FROM Items WHERE ID = ?)";
+        auto outer = db.prepareCached(sql);
+        {
+            auto inner = db.prepareCached(sql);
+            QVERIFY(inner.get() != outer.get());
+            QVERIFY(inner->isValid());
+        }
+
+        QCOMPARE(db.getStatementCache().getStats().size, size_t{1});
+        QCOMPARE(db.getStatementCache().getStats().misses, uint64_t{2});
+    }
+
+    void testLeastRecentlyUsedIsEvicted()
+    {
+        sqlite::Database db(m_dbFile.toStdString());
+        createTable(db, 10);
+
+        sqlite::StatementCache &cache = db.getStatementCache();
+        cache.setCapacity(2);
+
+        db.prepareCached("SELECT 1");
+        db.prepareCached("SELECT 2");
+        db.prepareCached("SELECT 1");
+        db.prepareCached("SELECT 3");
+
+        QCOMPARE(cache.getStats().size, size_t{2});
+        QCOMPARE(cache.getStats().evictions, uint64_t{1});
+
+        // "SELECT 2" was the least recently used statement
+        db.prepareCached("SELECT 1");
+        QCOMPARE(cache.getStats().misses, uint64_t{3});
+        db.prepareCached("SELECT 2");
+        QCOMPARE(cache.getStats().misses, uint64_t{4});
+
+        cache.setCapacity(0);
+        QCOMPARE(cache.getStats().size, size_t{0});
+    }
+
+    void testInvalidStatementIsNotCached()
+    {
+        sqlite::Database db(m_dbFile.toStdString());
+
+        auto stmt = db.prepareCached("SELECT * FROM MissingTable");
+        QVERIFY(!stmt->isValid());
+        QCOMPARE(db.getStatementCache().getStats().size, size_t{0});
+    }
+
+    /// Runs the same cached lookups from two threads at once, as the favicon store does from the GUI thread and
+    /// from the URL suggestion worker
+    void testConcurrentLookups()
+    {
+        sqlite::Database db(m_dbFile.toStdString());
+        createTable(db, 100);
+
+        std::atomic<int> numFailures { 0 };
+        auto lookup = [&db, &numFailures](int offset) {
+            for (int i = 0; i < 2000; ++i)
+            {
+                const int id = (i + offset) % 100;
+                auto stmt = db.prepareCached(R"(SELECT Name FROM Items WHERE ID = ?)");
+                *stmt << id;
+
+                std::string name;
+                if (!stmt->next())
+                {
+                    ++numFailures;
+                    continue;
+                }
+
+                *stmt >> name;
+                if (name != "Item " + std::to_string(id))
+                    ++numFailures;
+            }
+        };
+
+        std::thread first(lookup, 0);
+        std::thread second(lookup, 50);
+        first.join();
+        second.join();
+
+        QCOMPARE(numFailures.load(), 0);
+
+        const sqlite::StatementCacheStats stats = db.getStatementCache().getStats();
+        QCOMPARE(stats.hits + stats.misses, uint64_t{4000});
+        QCOMPARE(stats.size, size_t{1});
+    }
+
+    /// Measures the cost of a point lookup that prepares its statement on every call, as the
+    /// stores used to do, against one that takes its statement from the cache
+    void benchmarkPointLookup_data()
+    {
+        QTest::addColumn<bool>("useCache");
+
+        QTest::newRow("prepared per call") << false;
+        QTest::newRow("statement cache") << true;
+    }
+
+    void benchmarkPointLookup()
+    {
+        QFETCH(bool, useCache);
+
+        sqlite::Database db(m_dbFile.toStdString());
+        createTable(db, 1000);
+
+        const std::string sql = R"(SELECT h.ID, h.Name FROM Items AS h
+                                   INNER JOIN (SELECT ID, COUNT(ID) AS NumItems FROM Items GROUP BY ID) AS v
+                                   ON h.ID = v.ID WHERE h.ID = ?)";
+        int id = 0;
+        std::string name;
+
+        QBENCHMARK {
+            for (int i = 0; i < 100; ++i)
+            {
+                if (useCache)
+                {
+                    auto stmt = db.prepareCached(sql);
+                    *stmt << i;
+                    if (stmt->next())
+                        *stmt >> id >> name;
+                }
+                else
+                {
+                    auto stmt = db.prepare(sql);
+                    stmt << i;
+                    if (stmt.next())
+                        stmt >> id >> name;
+                }
+            }
+        }
+    }
+
+private:
+    /// Database file used by the tests
+    const QString m_dbFile;
+};
+
+QTEST_APPLESS_MAIN(StatementCacheTest)
+
+#include "StatementCacheTest.moc"
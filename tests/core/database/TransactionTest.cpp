@@ -0,0 +1,280 @@
+#include "sqlite/SQLiteWrapper.h"
+
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+
+#include <QFile>
+#include <QObject>
+#include <QString>
+#include <QTest>
+
+/// Tests the scoped transactions and the batch writer of the SQLite wrapper
+class TransactionTest : public QObject
+{
+    Q_OBJECT
+
+public:
+    TransactionTest() : QObject(nullptr), m_dbFile(QLatin1String("TransactionTest.db")) {}
+
+private:
+    /// Number of rows written by the throughput benchmark
+    static constexpr int BenchmarkRowCount = 500;
+
+    /// Creates the table used by the tests
+    void createTable(sqlite::Database &db)
+    {
+        QVERIFY(db.execute("CREATE TABLE Items(ID INTEGER PRIMARY KEY, Name TEXT NOT NULL)"));
+    }
+
+    /// Inserts a single row into the table
+    bool insertItem(sqlite::Database &db, int id)
+    {
+        const std::string name = "Item " + std::to_string(id);
+        auto stmt = db.prepare(R"(INSERT INTO Items(ID, Name) VALUES (?, ?))");
+        stmt << id
+             << name;
+        return stmt.execute();
+    }
+
+    /// Returns the number of rows in the table
+    int countItems(sqlite::Database &db)
+    {
+        auto stmt = db.prepare(R"(SELECT COUNT(*) FROM Items)");
+        int count = -1;
+        if (stmt.next())
+            stmt >> count;
+        return count;
+    }
+
+private slots:
+    void init()
+    {
+        cleanup();
+    }
+
+    void cleanup()
+    {
+        if (QFile::exists(m_dbFile))
+            QFile::remove(m_dbFile);
+    }
+
+    void testCommit()
+    {
+        sqlite::Database db(m_dbFile.toStdString());
+        createTable(db);
+
+        sqlite::Transaction transaction(db);
+        QVERIFY(transaction.isActive());
+        QVERIFY(!transaction.isSavepoint());
+        QVERIFY(db.isInTransaction());
+
+        QVERIFY(insertItem(db, 1));
+        QVERIFY(transaction.commit());
+
+        QVERIFY(!transaction.isActive());
+        QVERIFY(!db.isInTransaction());
+        QCOMPARE(countItems(db), 1);
+    }
+
+    void testRollbackWhenNotCommitted()
+    {
+        sqlite::Database db(m_dbFile.toStdString());
+        createTable(db);
+
+        {
+            sqlite::Transaction transaction(db);
+            QVERIFY(insertItem(db, 1));
+        }
+
+        QVERIFY(!db.isInTransaction());
+        QCOMPARE(countItems(db), 0);
+    }
+
+    void testRollbackOnException()
+    {
+        sqlite::Database db(m_dbFile.toStdString());
+        createTable(db);
+
+        try
+        {
+            sqlite::Transaction transaction(db);
+            insertItem(db, 1);
+            throw std::runtime_error("Failure while writing");
+        }
+        catch (const std::runtime_error &)
+        {
+        }
+
+        QVERIFY(!db.isInTransaction());
+        QCOMPARE(countItems(db), 0);
+    }
+
+    void testNestedRollbackKeepsOuterChanges()
+    {
+        sqlite::Database db(m_dbFile.toStdString());
+        createTable(db);
+
+        sqlite::Transaction outer(db);
+        QVERIFY(insertItem(db, 1));
+
+        {
+            sqlite::Transaction inner(db);
+            QVERIFY(inner.isActive());
+            QVERIFY(inner.isSavepoint());
+            QVERIFY(insertItem(db, 2));
+            QVERIFY(inner.rollback());
+        }
+
+        QVERIFY(db.isInTransaction());
+        {
+            sqlite::Transaction inner(db);
+            QVERIFY(insertItem(db, 3));
+            QVERIFY(inner.commit());
+        }
+
+        QVERIFY(outer.commit());
+        QCOMPARE(countItems(db), 2);
+
+        auto stmt = db.prepare(R"(SELECT COUNT(*) FROM Items WHERE ID = 2)");
+        int count = -1;
+        QVERIFY(stmt.next());
+        stmt >> count;
+        QCOMPARE(count, 0);
+    }
+
+    void testOuterRollbackRevertsCommittedSavepoint()
+    {
+        sqlite::Database db(m_dbFile.toStdString());
+        createTable(db);
+
+        {
+            sqlite::Transaction outer(db);
+            {
+                sqlite::Transaction inner(db);
+                QVERIFY(insertItem(db, 1));
+                QVERIFY(inner.commit());
+            }
+        }
+
+        QCOMPARE(countItems(db), 0);
+    }
+
+    void testBatchWriterCommitsInChunks()
+    {
+        sqlite::Database db(m_dbFile.toStdString());
+        createTable(db);
+
+        {
+            sqlite::BatchWriter writer(db, R"(INSERT INTO Items(ID, Name) VALUES (?, ?))", 10);
+            QVERIFY(writer.isValid());
+
+            for (int i = 0; i < 25; ++i)
+            {
+                const std::string name = "Item " + std::to_string(i);
+                QVERIFY(writer.add(i, name));
+            }
+
+            QCOMPARE(writer.getChunksCommitted(), uint64_t{2});
+            QVERIFY(db.isInTransaction());
+
+            QVERIFY(writer.flush());
+            QCOMPARE(writer.getChunksCommitted(), uint64_t{3});
+            QCOMPARE(writer.getRowsWritten(), uint64_t{25});
+            QVERIFY(!db.isInTransaction());
+        }
+
+        QCOMPARE(countItems(db), 25);
+    }
+
+    void testBatchWriterSkipsFailedRows()
+    {
+        sqlite::Database db(m_dbFile.toStdString());
+        createTable(db);
+
+        {
+            sqlite::BatchWriter writer(db, R"(INSERT INTO Items(ID, Name) VALUES (?, ?))", 10);
+            const std::string name("Item");
+
+            QVERIFY(writer.add(1, name));
+            QVERIFY(!writer.add(1, name));
+            QVERIFY(writer.add(2, name));
+
+            QCOMPARE(writer.getFailedRows(), uint64_t{1});
+            QCOMPARE(writer.getRowsWritten(), uint64_t{2});
+        }
+
+        // The pending chunk is committed when the writer is destroyed
+        QCOMPARE(countItems(db), 2);
+    }
+
+    void testBatchWriterRollsBackOnException()
+    {
+        sqlite::Database db(m_dbFile.toStdString());
+        createTable(db);
+
+        try
+        {
+            sqlite::BatchWriter writer(db, R"(INSERT INTO Items(ID, Name) VALUES (?, ?))", 10);
+            const std::string name("Item");
+            for (int i = 0; i < 15; ++i)
+                writer.add(i, name);
+
+            throw std::runtime_error("Failure while writing");
+        }
+        catch (const std::runtime_error &)
+        {
+        }
+
+        // Only the first, complete chunk was committed
+        QVERIFY(!db.isInTransaction());
+        QCOMPARE(countItems(db), 10);
+    }
+
+    /// Measures the time taken to insert rows one at a time in autocommit mode, as the stores
+    /// used to do, against inserting them through the batch writer
+    void benchmarkInsertThroughput_data()
+    {
+        QTest::addColumn<bool>("useBatchWriter");
+
+        QTest::newRow("autocommit") << false;
+        QTest::newRow("batch writer") << true;
+    }
+
+    void benchmarkInsertThroughput()
+    {
+        QFETCH(bool, useBatchWriter);
+
+        sqlite::Database db(m_dbFile.toStdString());
+        QVERIFY(db.execute("CREATE TABLE Items(ID INTEGER PRIMARY KEY AUTOINCREMENT, Name TEXT NOT NULL)"));
+
+        const std::string sql = R"(INSERT INTO Items(Name) VALUES (?))";
+        const std::string name("Item");
+
+        QBENCHMARK {
+            if (useBatchWriter)
+            {
+                sqlite::BatchWriter writer(db, sql);
+                for (int i = 0; i < BenchmarkRowCount; ++i)
+                    writer.add(name);
+            }
+            else
+            {
+                auto stmt = db.prepare(sql);
+                for (int i = 0; i < BenchmarkRowCount; ++i)
+                {
+                    stmt << name;
+                    stmt.execute();
+                }
+            }
+        }
+    }
+
+private:
+    /// Database file used by the tests
+    const QString m_dbFile;
+};
+
+QTEST_APPLESS_MAIN(TransactionTest)
+
+#include "TransactionTest.moc"
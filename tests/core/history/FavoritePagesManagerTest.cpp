@@ -0,0 +1,222 @@
+#include "DatabaseFactory.h"
+#include "DatabaseWorker.h"
+#include "FavoritePagesManager.h"
+#include "ServiceLocator.h"
+#include "ThumbnailCapturePipeline.h"
+#include "WebPageThumbnailStore.h"
+
+#include <memory>
+
+#include <QBuffer>
+#include <QByteArray>
+#include <QColor>
+#include <QDebug>
+#include <QFile>
+#include <QImage>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QObject>
+#include <QPainter>
+#include <QString>
+#include <QTest>
+#include <QUrl>
+#include <QVariantList>
+#include <QVariantMap>
+
+/// Test cases for the new tab page data provided by the \ref FavoritePagesManager
+class FavoritePagesManagerTest : public QObject
+{
+    Q_OBJECT
+
+public:
+    FavoritePagesManagerTest() :
+        QObject(nullptr),
+        m_dbFile(QLatin1String("FavoritePagesManagerTest.db")),
+        m_dataFile(QLatin1String("FavoritePagesManagerTest.json")),
+        m_serviceLocator(),
+        m_thumbnailStore(nullptr),
+        m_favoritePagesManager(nullptr)
+    {
+    }
+
+private:
+    /// Number of pages shown on the new tab page
+    static constexpr int PageCount = 8;
+
+    /// Returns the URL of the n-th favorite page
+    QUrl getPageUrl(int n) const
+    {
+        return QUrl(QStringLiteral("https://site%1.example/").arg(n));
+    }
+
+    /// Returns a thumbnail with some content drawn on it
+    QImage makeThumbnail(const QColor &color) const
+    {
+        QImage image(ThumbnailCapturePipeline::ThumbnailSize, QImage::Format_RGB32);
+        image.fill(Qt::white);
+
+        QPainter painter(&image);
+        painter.fillRect(20, 20, 200, 300, color);
+        painter.fillRect(100, 350, 250, 100, Qt::black);
+        return image;
+    }
+
+    /// Returns the payload sent to the new tab page, serialized the same way the web channel does
+    QByteArray serializePayload(const QVariantList &favorites) const
+    {
+        return QJsonDocument(QJsonArray::fromVariantList(favorites)).toJson(QJsonDocument::Compact);
+    }
+
+private slots:
+    /// Creates a thumbnail database and a favorite pages file, with a thumbnail for each favorite page except the last one
+    void initTestCase()
+    {
+        cleanupTestCase();
+
+        {
+            sqlite::Database db(m_dbFile.toStdString());
+            QVERIFY(db.execute("CREATE TABLE IF NOT EXISTS Thumbnails(Id INTEGER PRIMARY KEY, Host TEXT UNIQUE, Thumbnail BLOB)"));
+
+            auto stmt = db.prepare(R"(INSERT INTO Thumbnails(Host, Thumbnail) VALUES (?, ?))");
+            for (int i = 0; i < PageCount - 1; ++i)
+            {
+                stmt << getPageUrl(i).host()
+                     << ThumbnailCapturePipeline::encode(makeThumbnail(QColor::fromHsv(i * 40, 255, 255)));
+                QVERIFY(stmt.execute());
+            }
+        }
+
+        QJsonArray favorites;
+        for (int i = 0; i < PageCount; ++i)
+        {
+            QJsonObject page;
+            page.insert(QLatin1String("position"), i);
+            page.insert(QLatin1String("url"), getPageUrl(i).toString());
+            page.insert(QLatin1String("title"), QStringLiteral("Site %1").arg(i));
+            favorites.append(page);
+        }
+
+        QJsonObject rootObject;
+        rootObject.insert(QLatin1String("version"), QLatin1String("1.1"));
+        rootObject.insert(QLatin1String("favorites"), favorites);
+
+        QFile dataFile(m_dataFile);
+        QVERIFY(dataFile.open(QIODevice::WriteOnly));
+        dataFile.write(QJsonDocument(rootObject).toJson());
+        dataFile.close();
+
+        m_thumbnailStore = DatabaseFactory::createWorker<WebPageThumbnailStore>(m_serviceLocator, m_dbFile);
+        m_favoritePagesManager = std::make_unique<FavoritePagesManager>(nullptr, m_thumbnailStore.get(), m_dataFile);
+    }
+
+    /// Removes the files created by the test case
+    void cleanupTestCase()
+    {
+        m_favoritePagesManager.reset();
+        m_thumbnailStore.reset();
+
+        for (const QString &fileName : { m_dbFile, m_dataFile })
+        {
+            if (QFile::exists(fileName))
+                QFile::remove(fileName);
+        }
+    }
+
+    /// Verifies that pages reference their thumbnail and favicon by URL, instead of carrying the image data
+    void testPagesReferenceImagesByUrl()
+    {
+        const QVariantList favorites = m_favoritePagesManager->getFavorites();
+        QCOMPARE(favorites.size(), PageCount);
+
+        for (int i = 0; i < PageCount; ++i)
+        {
+            const QVariantMap item = favorites.at(i).toMap();
+            const QString thumbnail = item.value(QLatin1String("thumbnail")).toString();
+            const QString favicon = item.value(QLatin1String("favicon")).toString();
+
+            QVERIFY(favicon.startsWith(QLatin1String("viper://favicon/")));
+
+            if (i == PageCount - 1)
+            {
+                QVERIFY(thumbnail.isEmpty());
+                continue;
+            }
+
+            QVERIFY(thumbnail.startsWith(QStringLiteral("viper://thumbnail/%1?v=").arg(getPageUrl(i).host())));
+        }
+    }
+
+    /// Verifies that the thumbnail data served by the store is the stored binary image
+    void testThumbnailDataIsServedWithoutDecoding()
+    {
+        const QByteArray data = m_thumbnailStore->getThumbnailData(getPageUrl(0).host());
+        QVERIFY(!data.isEmpty());
+
+        QImage image;
+        QVERIFY(image.loadFromData(data));
+        QCOMPARE(image.size(), ThumbnailCapturePipeline::ThumbnailSize);
+
+        QVERIFY(m_thumbnailStore->getThumbnailData(getPageUrl(PageCount - 1).host()).isEmpty());
+        QCOMPARE(m_thumbnailStore->getThumbnailTag(getPageUrl(0)), m_thumbnailStore->getThumbnailTag(getPageUrl(0)));
+        QVERIFY(m_thumbnailStore->getThumbnailTag(getPageUrl(0)) != m_thumbnailStore->getThumbnailTag(getPageUrl(1)));
+    }
+
+    /// Compares the cost of building and serializing the new tab page payload when thumbnails were
+    /// embedded as base-64 encoded PNGs, as was done previously, against referencing them by URL
+    void benchmarkNewTabPayload_data()
+    {
+        QTest::addColumn<bool>("embedThumbnails");
+
+        QTest::newRow("embedded base-64 thumbnails") << true;
+        QTest::newRow("thumbnail urls") << false;
+    }
+
+    void benchmarkNewTabPayload()
+    {
+        QFETCH(bool, embedThumbnails);
+
+        QByteArray payload;
+        QBENCHMARK {
+            QVariantList favorites = m_favoritePagesManager->getFavorites();
+            if (embedThumbnails)
+            {
+                for (QVariant &favorite : favorites)
+                {
+                    QVariantMap item = favorite.toMap();
+
+                    QByteArray data;
+                    QBuffer buffer(&data);
+                    m_thumbnailStore->getThumbnail(item.value(QLatin1String("url")).toUrl()).save(&buffer, "PNG");
+
+                    item[QLatin1String("thumbnail")] = data.isEmpty() ? QString()
+                                                                      : QLatin1String("data:image/png;base64, ") + QString::fromLatin1(data.toBase64());
+                    favorite = item;
+                }
+            }
+            payload = serializePayload(favorites);
+        }
+
+        qDebug() << "New tab page payload size:" << payload.size() << "bytes";
+    }
+
+private:
+    /// Thumbnail database file
+    const QString m_dbFile;
+
+    /// Favorite pages data file
+    const QString m_dataFile;
+
+    /// Service locator, without any services registered
+    ViperServiceLocator m_serviceLocator;
+
+    /// Thumbnail store
+    std::unique_ptr<WebPageThumbnailStore> m_thumbnailStore;
+
+    /// Favorite pages manager
+    std::unique_ptr<FavoritePagesManager> m_favoritePagesManager;
+};
+
+QTEST_MAIN(FavoritePagesManagerTest)
+
+#include "FavoritePagesManagerTest.moc"
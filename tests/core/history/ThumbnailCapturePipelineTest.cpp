@@ -0,0 +1,130 @@
+#include "ThumbnailCapturePipeline.h"
+
+#include <QColor>
+#include <QImage>
+#include <QObject>
+#include <QPainter>
+#include <QSignalSpy>
+#include <QString>
+#include <QStringList>
+#include <QTest>
+
+class ThumbnailCapturePipelineTest : public QObject
+{
+    Q_OBJECT
+
+public:
+    ThumbnailCapturePipelineTest() : QObject(nullptr) {}
+
+private:
+    /// Returns an image the size of a maximized high-DPI browser window, with some content drawn on it
+    QImage makePageImage(const QColor &color) const
+    {
+        QImage image(3840, 2160, QImage::Format_ARGB32_Premultiplied);
+        image.fill(Qt::white);
+
+        QPainter painter(&image);
+        painter.fillRect(200, 200, 1600, 900, color);
+        painter.fillRect(2000, 1200, 1200, 600, Qt::black);
+        return image;
+    }
+
+private slots:
+    void testProcessProducesEncodedThumbnail()
+    {
+        ThumbnailCaptureResult result = ThumbnailCapturePipeline::process({ QStringLiteral("example.com") }, makePageImage(Qt::red));
+
+        QCOMPARE(result.Thumbnail.size(), ThumbnailCapturePipeline::ThumbnailSize);
+        QVERIFY(!result.EncodedData.isEmpty());
+        QVERIFY(result.ContentHash != 0);
+
+        QImage decoded;
+        QVERIFY(decoded.loadFromData(result.EncodedData));
+        QCOMPARE(decoded.size(), ThumbnailCapturePipeline::ThumbnailSize);
+    }
+
+    void testBlankPageIsIgnored()
+    {
+        QImage blank(1920, 1080, QImage::Format_ARGB32_Premultiplied);
+        blank.fill(Qt::white);
+
+        ThumbnailCaptureResult result = ThumbnailCapturePipeline::process({ QStringLiteral("example.com") }, blank);
+        QVERIFY(result.Thumbnail.isNull());
+        QVERIFY(result.EncodedData.isEmpty());
+    }
+
+    void testCapturesAreThrottledPerHost()
+    {
+        ThumbnailCapturePipeline pipeline;
+        QSignalSpy spy(&pipeline, &ThumbnailCapturePipeline::thumbnailReady);
+
+        const QStringList hosts { QStringLiteral("example.com") };
+        QVERIFY(pipeline.shouldCapture(hosts));
+
+        pipeline.submit(hosts, makePageImage(Qt::red));
+        QVERIFY(!pipeline.shouldCapture(hosts));
+        QVERIFY(pipeline.shouldCapture({ QStringLiteral("example.org") }));
+
+        QVERIFY(spy.wait(5000));
+        QVERIFY(!pipeline.shouldCapture(hosts));
+
+        pipeline.setHostCaptureInterval(0);
+        QVERIFY(pipeline.shouldCapture(hosts));
+    }
+
+    void testUnchangedPageIsDropped()
+    {
+        ThumbnailCapturePipeline pipeline;
+        pipeline.setHostCaptureInterval(0);
+        QSignalSpy spy(&pipeline, &ThumbnailCapturePipeline::thumbnailReady);
+
+        const QStringList hosts { QStringLiteral("example.com") };
+        pipeline.submit(hosts, makePageImage(Qt::red));
+        QVERIFY(spy.wait(5000));
+
+        pipeline.submit(hosts, makePageImage(Qt::red));
+        QTRY_COMPARE_WITH_TIMEOUT(pipeline.getUnchangedCount(), 1, 5000);
+        QCOMPARE(spy.count(), 1);
+
+        pipeline.submit(hosts, makePageImage(Qt::blue));
+        QVERIFY(spy.wait(5000));
+        QCOMPARE(spy.count(), 2);
+    }
+
+    /// Compares the time spent on the GUI thread when processing a capture synchronously,
+    /// as was done before the pipeline existed, against submitting it to the pipeline
+    void benchmarkGuiThreadCost_data()
+    {
+        QTest::addColumn<bool>("useWorker");
+
+        QTest::newRow("synchronous") << false;
+        QTest::newRow("worker thread") << true;
+    }
+
+    void benchmarkGuiThreadCost()
+    {
+        QFETCH(bool, useWorker);
+
+        ThumbnailCapturePipeline pipeline;
+        pipeline.setHostCaptureInterval(0);
+        QSignalSpy spy(&pipeline, &ThumbnailCapturePipeline::thumbnailReady);
+
+        const QImage page = makePageImage(Qt::green);
+        const QStringList hosts { QStringLiteral("example.com") };
+
+        QBENCHMARK {
+            if (useWorker)
+                pipeline.submit(hosts, page);
+            else
+                ThumbnailCapturePipeline::process(hosts, page);
+        }
+
+        // Let the worker finish before the pipeline is destroyed
+        if (useWorker)
+            QTest::qWait(500);
+    }
+};
+
+QTEST_MAIN(ThumbnailCapturePipelineTest)
+
+#include "ThumbnailCapturePipelineTest.moc"
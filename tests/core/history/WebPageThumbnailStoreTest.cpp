@@ -0,0 +1,124 @@
+#include "BookmarkManager.h"
+#include "DatabaseFactory.h"
+#include "DatabaseTaskScheduler.h"
+#include "HistoryManager.h"
+#include "HistoryStore.h"
+#include "ServiceLocator.h"
+#include "ThumbnailCapturePipeline.h"
+#include "WebPageThumbnailStore.h"
+
+#include <functional>
+#include <memory>
+
+#include <QColor>
+#include <QDateTime>
+#include <QFile>
+#include <QImage>
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QTest>
+#include <QUrl>
+
+/// Test cases for the saving of thumbnails by the \ref WebPageThumbnailStore
+class WebPageThumbnailStoreTest : public QObject
+{
+    Q_OBJECT
+
+public:
+    WebPageThumbnailStoreTest() :
+        QObject(nullptr),
+        m_historyDbFile(QLatin1String("WebPageThumbnailStoreTest-History.db")),
+        m_thumbnailDbFile(QLatin1String("WebPageThumbnailStoreTest-Thumbnails.db"))
+    {
+    }
+
+private:
+    /// Returns an encoded thumbnail of the given color
+    QByteArray makeThumbnail(const QColor &color) const
+    {
+        QImage image(ThumbnailCapturePipeline::ThumbnailSize, QImage::Format_RGB32);
+        image.fill(color);
+        return ThumbnailCapturePipeline::encode(image);
+    }
+
+    /// Stores a thumbnail for the given host, as if the capture pipeline had produced it
+    void captureThumbnail(WebPageThumbnailStore &store, const QString &host, const QColor &color)
+    {
+        ThumbnailCaptureResult result;
+        result.Hosts = QStringList { host };
+        result.EncodedData = makeThumbnail(color);
+        store.onThumbnailReady(result);
+    }
+
+    /// Removes the database files of the test
+    void removeFiles()
+    {
+        for (const QString &fileName : { m_historyDbFile, m_thumbnailDbFile })
+        {
+            if (QFile::exists(fileName))
+                QFile::remove(fileName);
+        }
+    }
+
+private slots:
+    void initTestCase()
+    {
+        removeFiles();
+    }
+
+    void cleanupTestCase()
+    {
+        removeFiles();
+    }
+
+    /// Verifies that only thumbnails of visited pages are written, and that a save with no new thumbnail neither
+    /// writes nor looks up the most visited pages, even while other thumbnails wait for their page to qualify
+    void testSaveWithoutChangesDoesNothing()
+    {
+        DatabaseTaskScheduler taskScheduler;
+        taskScheduler.addWorker("HistoryStore", std::bind(DatabaseFactory::createDBWorker<HistoryStore>, m_historyDbFile));
+
+        ViperServiceLocator serviceLocator;
+        HistoryManager historyManager(serviceLocator, taskScheduler);
+        BookmarkManager bookmarkManager(serviceLocator, taskScheduler, nullptr);
+        QVERIFY(serviceLocator.addService("HistoryManager", &historyManager));
+        QVERIFY(serviceLocator.addService("BookmarkManager", &bookmarkManager));
+
+        taskScheduler.run();
+
+        const QUrl visitedUrl(QStringLiteral("https://visited.example/"));
+        historyManager.addVisit(visitedUrl, QStringLiteral("Visited"), QDateTime::currentDateTime(), visitedUrl, true);
+        QTRY_VERIFY(!historyManager.loadMostVisitedEntries(10).result().empty());
+
+        auto store = DatabaseFactory::createWorker<WebPageThumbnailStore>(serviceLocator, m_thumbnailDbFile);
+        captureThumbnail(*store, QStringLiteral("visited.example"), Qt::red);
+        captureThumbnail(*store, QStringLiteral("unvisited.example"), Qt::blue);
+
+        store->save();
+        QCOMPARE(store->getSaveQueryCount(), 1);
+        QTRY_COMPARE(store->getLastSaveWriteCount(), 1);
+        QVERIFY(!store->getThumbnailData(QStringLiteral("unvisited.example")).isEmpty());
+
+        store->save();
+        QCOMPARE(store->getLastSaveWriteCount(), 0);
+        QCOMPARE(store->getSaveQueryCount(), 1);
+
+        // A new thumbnail is a change, which checks the waiting thumbnails again
+        captureThumbnail(*store, QStringLiteral("visited.example"), Qt::green);
+        store->save();
+        QCOMPARE(store->getSaveQueryCount(), 2);
+        QTRY_COMPARE(store->getLastSaveWriteCount(), 1);
+    }
+
+private:
+    /// History database file
+    const QString m_historyDbFile;
+
+    /// Thumbnail database file
+    const QString m_thumbnailDbFile;
+};
+
+QTEST_MAIN(WebPageThumbnailStoreTest)
+
+#include "WebPageThumbnailStoreTest.moc"
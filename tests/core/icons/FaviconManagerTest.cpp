@@ -6,6 +6,7 @@
 #include <QCryptographicHash>
 #include <QDateTime>
 #include <QFile>
+#include <QImage>
 #include <QObject>
 #include <QSignalSpy>
 #include <QString>
@@ -73,6 +74,42 @@ private slots:
         m_faviconManager->setNetworkAccessManager(nullptr);
     }
 
+    void testEngineIconIsPreferredOverDownload()
+    {
+        NetworkAccessManager accessManager;
+
+        m_faviconManager = new FaviconManager(m_dbFile);
+        m_faviconManager->setNetworkAccessManager(&accessManager);
+
+        QImage img(16, 16, QImage::Format_ARGB32);
+        img.fill(Qt::red);
+        QIcon icon(QPixmap::fromImage(img));
+
+        QUrl iconUrl(QLatin1String("http://127.0.0.1:1/favicon.ico"));
+        QUrl firstPage(QLatin1String("http://127.0.0.1:1/first.html"));
+        QUrl secondPage(QLatin1String("http://127.0.0.1:1/second.html"));
+
+        // Both pages reference the icon before the engine has loaded it, so they should share one fetch
+        m_faviconManager->updateIcon(iconUrl, firstPage, QIcon());
+        m_faviconManager->updateIcon(iconUrl, secondPage, QIcon());
+        QCOMPARE(m_faviconManager->getFetchStats().coalescedRequests, uint64_t{1});
+
+        // The engine then provides the icon, which should cancel the pending download
+        m_faviconManager->updateIcon(iconUrl, firstPage, icon);
+        QCOMPARE(m_faviconManager->getFetchStats().engineIcons, uint64_t{1});
+
+        QTest::qWait(2000);
+        QCOMPARE(m_faviconManager->getFetchStats().networkFetches, uint64_t{0});
+
+        // Known icons are not fetched again
+        m_faviconManager->updateIcon(iconUrl, secondPage, QIcon());
+        QCOMPARE(m_faviconManager->getFetchStats().freshnessHits, uint64_t{1});
+        QCOMPARE(m_faviconManager->getFetchStats().fetchesSaved(), uint64_t{3});
+        QVERIFY(!m_faviconManager->getFavicon(secondPage).isNull());
+
+        m_faviconManager->setNetworkAccessManager(nullptr);
+    }
+
     void testCanDownloadIconFromUrl()
     {
         //todo: this
@@ -0,0 +1,137 @@
+#include "FaviconPixmapCache.h"
+
+#include <vector>
+
+#include <QAction>
+#include <QColor>
+#include <QIcon>
+#include <QImage>
+#include <QMenu>
+#include <QObject>
+#include <QPainter>
+#include <QPixmap>
+#include <QStyle>
+#include <QTest>
+
+class FaviconPixmapCacheTest : public QObject
+{
+    Q_OBJECT
+
+public:
+    FaviconPixmapCacheTest() : QObject(nullptr) {}
+
+private:
+    /// Returns a 64x64 icon filled with the given color, so that it has to be scaled down when drawn
+    QIcon makeIcon(const QColor &color) const
+    {
+        QPixmap pixmap(64, 64);
+        pixmap.fill(color);
+        return QIcon(pixmap);
+    }
+
+private slots:
+    void testPixmapIsRasterizedOnce()
+    {
+        FaviconPixmapCache cache;
+        QIcon icon = makeIcon(Qt::red);
+
+        QPixmap first = cache.pixmap(icon, 16, 1.0);
+        QPixmap second = cache.pixmap(icon, 16, 1.0);
+
+        QCOMPARE(first.size(), QSize(16, 16));
+        QCOMPARE(first.cacheKey(), second.cacheKey());
+        QCOMPARE(cache.getMissCount(), uint64_t{1});
+        QCOMPARE(cache.getHitCount(), uint64_t{1});
+        QCOMPARE(cache.size(), size_t{1});
+    }
+
+    void testSizeAndPixelRatioAreSeparateEntries()
+    {
+        FaviconPixmapCache cache;
+        QIcon icon = makeIcon(Qt::green);
+
+        QPixmap normal = cache.pixmap(icon, 16, 1.0);
+        QPixmap hiDpi = cache.pixmap(icon, 16, 2.0);
+        QPixmap large = cache.pixmap(icon, 32, 1.0);
+
+        QCOMPARE(normal.size(), QSize(16, 16));
+        QCOMPARE(hiDpi.size(), QSize(32, 32));
+        QCOMPARE(hiDpi.devicePixelRatio(), 2.0);
+        QCOMPARE(large.size(), QSize(32, 32));
+        QCOMPARE(cache.size(), size_t{3});
+        QCOMPARE(cache.getMissCount(), uint64_t{3});
+    }
+
+    void testByteBudgetEvictsLeastRecentlyUsed()
+    {
+        // Each 16x16 32-bit pixmap costs 1 KiB, so only two fit in the budget
+        FaviconPixmapCache cache(2 * 1024);
+        QIcon red = makeIcon(Qt::red), green = makeIcon(Qt::green), blue = makeIcon(Qt::blue);
+
+        cache.pixmap(red, 16, 1.0);
+        cache.pixmap(green, 16, 1.0);
+        cache.pixmap(red, 16, 1.0);
+        cache.pixmap(blue, 16, 1.0);
+
+        QCOMPARE(cache.size(), size_t{2});
+        QVERIFY(cache.getBytesUsed() <= cache.getByteBudget());
+
+        // Green was the least recently used, so it must be rasterized again
+        const uint64_t misses = cache.getMissCount();
+        cache.pixmap(red, 16, 1.0);
+        QCOMPARE(cache.getMissCount(), misses);
+        cache.pixmap(green, 16, 1.0);
+        QCOMPARE(cache.getMissCount(), misses + 1);
+
+        cache.setByteBudget(1024);
+        QCOMPARE(cache.size(), size_t{1});
+    }
+
+    void testNullIconIsNotCached()
+    {
+        FaviconPixmapCache cache;
+        QVERIFY(cache.pixmap(QIcon(), 16, 1.0).isNull());
+        QVERIFY(cache.rasterizedIcon(QIcon(), 16, 1.0).isNull());
+        QCOMPARE(cache.size(), size_t{0});
+    }
+
+    void benchmarkBookmarkMenuPaint_data()
+    {
+        QTest::addColumn<bool>("useCache");
+
+        QTest::newRow("scaled on paint") << false;
+        QTest::newRow("pre-rasterized") << true;
+    }
+
+    void benchmarkBookmarkMenuPaint()
+    {
+        QFETCH(bool, useCache);
+
+        FaviconPixmapCache cache;
+        std::vector<QIcon> icons;
+        for (int i = 0; i < 50; ++i)
+            icons.push_back(makeIcon(QColor::fromHsv((i * 7) % 360, 255, 255)));
+
+        QMenu menu;
+        const int iconSize = menu.style()->pixelMetric(QStyle::PM_SmallIconSize, nullptr, &menu);
+        for (int i = 0; i < 500; ++i)
+        {
+            const QIcon &icon = icons.at(i % icons.size());
+            QAction *action = menu.addAction(useCache ? cache.rasterizedIcon(icon, iconSize, menu.devicePixelRatioF()) : icon,
+                                             QStringLiteral("Bookmark %1").arg(i));
+            action->setIconVisibleInMenu(true);
+        }
+        menu.ensurePolished();
+        menu.resize(menu.sizeHint());
+
+        QImage target(menu.size(), QImage::Format_ARGB32_Premultiplied);
+        QBENCHMARK {
+            QPainter painter(&target);
+            menu.render(&painter);
+        }
+    }
+};
+
+QTEST_MAIN(FaviconPixmapCacheTest)
+
+#include "FaviconPixmapCacheTest.moc"
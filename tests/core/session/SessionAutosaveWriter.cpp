@@ -0,0 +1,58 @@
+#include "SessionAutosaver.h"
+
+#include <QByteArray>
+#include <QCoreApplication>
+#include <QRect>
+#include <QString>
+#include <QUrl>
+
+/// Number of tabs in each snapshot written by the helper
+constexpr int NumTabs = 200;
+
+/// Size of the navigation history of each tab, so that each snapshot takes a while to write
+constexpr int HistorySize = 64 * 1024;
+
+/// Returns the state of the n-th tab, as of the given snapshot
+SessionTab makeTab(int n, int snapshot)
+{
+    SessionTab tab;
+    tab.Url = QUrl(QStringLiteral("https://site%1.example/page/%2").arg(n % 3).arg(n));
+    tab.Title = QStringLiteral("Page %1, snapshot %2").arg(n).arg(snapshot);
+    tab.History = QByteArray(HistorySize, static_cast<char>('a' + n % 26));
+    tab.IsPinned = false;
+    tab.IsHibernating = true;
+    return tab;
+}
+
+/// Helper for the autosave tests, which writes snapshots of a session to the file given as its only
+/// argument until it is killed. A tenth of the tabs change between two snapshots
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    if (argc < 2)
+        return 1;
+
+    SessionAutosaver autosaver(QString::fromLocal8Bit(argv[1]));
+    for (int snapshot = 0;; ++snapshot)
+    {
+        SessionWindow window;
+        window.Geometry = QRect(0, 0, 800, 600);
+        window.IsMaximized = false;
+        window.CurrentTab = 0;
+        autosaver.addWindow(window);
+
+        for (int n = 0; n < NumTabs; ++n)
+        {
+            if (n % 10 == snapshot % 10)
+                autosaver.invalidateTab(static_cast<uintptr_t>(n));
+
+            if (!autosaver.addCachedTab(static_cast<uintptr_t>(n)))
+                autosaver.addTab(static_cast<uintptr_t>(n), makeTab(n, snapshot));
+        }
+
+        autosaver.save();
+        autosaver.waitForDone();
+    }
+
+    return 0;
+}
@@ -0,0 +1,225 @@
+#include "SessionAutosaver.h"
+#include "SessionStream.h"
+
+#include <vector>
+
+#include <QByteArray>
+#include <QColor>
+#include <QFile>
+#include <QIcon>
+#include <QObject>
+#include <QPixmap>
+#include <QProcess>
+#include <QRect>
+#include <QString>
+#include <QTemporaryDir>
+#include <QTest>
+#include <QUrl>
+
+/// Test cases for the \ref SessionAutosaver class
+class SessionAutosaverTest : public QObject
+{
+    Q_OBJECT
+
+public:
+    SessionAutosaverTest() : QObject(nullptr) {}
+
+private:
+    /// Returns the state of the n-th tab of a test session, as of the given version of the tab.
+    /// Tabs share one of three favicons
+    SessionTab makeTab(int n, int version) const
+    {
+        static const QColor colors[] = { Qt::red, Qt::green, Qt::blue };
+
+        QPixmap pixmap(16, 16);
+        pixmap.fill(colors[n % 3]);
+
+        SessionTab tab;
+        tab.Url = QUrl(QStringLiteral("https://site%1.example/page/%2").arg(n % 3).arg(n));
+        tab.Title = QStringLiteral("Page %1, version %2").arg(n).arg(version);
+        tab.IconUrl = QUrl(QStringLiteral("https://site%1.example/favicon.ico").arg(n % 3));
+        tab.Icon = QIcon(pixmap);
+        tab.History = QByteArray(2048, static_cast<char>('a' + n % 26));
+        tab.IsPinned = (n == 0);
+        tab.IsHibernating = (n % 2 == 1);
+        return tab;
+    }
+
+    /// Builds a snapshot of a window holding the given tabs, at the given versions, and saves it
+    void saveSnapshot(SessionAutosaver &autosaver, const std::vector<int> &tabs, const std::vector<int> &versions)
+    {
+        SessionWindow window;
+        window.Geometry = QRect(10, 20, 800, 600);
+        window.IsMaximized = false;
+        window.CurrentTab = 0;
+        autosaver.addWindow(window);
+
+        for (int n : tabs)
+        {
+            const uintptr_t tabId = static_cast<uintptr_t>(n);
+            if (!autosaver.addCachedTab(tabId))
+                autosaver.addTab(tabId, makeTab(n, versions.at(static_cast<std::size_t>(n))));
+        }
+
+        autosaver.save();
+    }
+
+    /// Reads the session file, and verifies that it holds the given tabs at the given versions, with their favicons
+    void verifySession(const QString &fileName, const std::vector<int> &tabs, const std::vector<int> &versions)
+    {
+        QFile file(fileName);
+        QVERIFY(file.open(QIODevice::ReadOnly));
+
+        SessionReader reader(&file);
+        QVERIFY(reader.isValid());
+        QVERIFY(reader.readNext() == SessionReader::Item::Window);
+
+        for (int n : tabs)
+        {
+            QVERIFY(reader.readNext() == SessionReader::Item::Tab);
+
+            const SessionTab expected = makeTab(n, versions.at(static_cast<std::size_t>(n)));
+            const SessionTab &tab = reader.getTab();
+            QCOMPARE(tab.Url, expected.Url);
+            QCOMPARE(tab.Title, expected.Title);
+            QCOMPARE(tab.History, expected.History);
+            QVERIFY(!tab.Icon.isNull());
+            QCOMPARE(tab.Icon.pixmap(16, 16).toImage().pixelColor(8, 8), expected.Icon.pixmap(16, 16).toImage().pixelColor(8, 8));
+        }
+
+        QVERIFY(reader.readNext() == SessionReader::Item::End);
+    }
+
+    /// Returns the number of tabs in a session file, or -1 if it is not a valid session
+    int countTabs(const QString &fileName)
+    {
+        QFile file(fileName);
+        if (!file.open(QIODevice::ReadOnly))
+            return -1;
+
+        SessionReader reader(&file);
+        if (!reader.isValid())
+            return -1;
+
+        int numTabs = 0;
+        for (SessionReader::Item item = reader.readNext(); item != SessionReader::Item::End; item = reader.readNext())
+        {
+            if (item == SessionReader::Item::Tab)
+                ++numTabs;
+        }
+        return numTabs;
+    }
+
+private slots:
+    /// Verifies that only the tabs invalidated since the last snapshot are encoded again, and that the tabs
+    /// which were not keep their records and favicons
+    void testOnlyChangedTabsAreEncoded()
+    {
+        QTemporaryDir dir;
+        QVERIFY(dir.isValid());
+        const QString fileName = dir.filePath(QStringLiteral("session.dat"));
+
+        SessionAutosaver autosaver(fileName);
+        const std::vector<int> tabs { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+        std::vector<int> versions(tabs.size(), 0);
+
+        saveSnapshot(autosaver, tabs, versions);
+        autosaver.waitForDone();
+        QCOMPARE(autosaver.getNumEncodedTabs(), 10);
+        QCOMPARE(autosaver.getNumWrites(), 1);
+        verifySession(fileName, tabs, versions);
+
+        // Tabs that were not invalidated keep the state they had when they were encoded
+        versions[2] = versions[5] = 1;
+        versions[7] = 1;
+        autosaver.invalidateTab(2);
+        autosaver.invalidateTab(5);
+
+        saveSnapshot(autosaver, tabs, versions);
+        autosaver.waitForDone();
+        QCOMPARE(autosaver.getNumEncodedTabs(), 2);
+        QCOMPARE(autosaver.getNumWrites(), 2);
+
+        versions[7] = 0;
+        verifySession(fileName, tabs, versions);
+    }
+
+    /// Verifies that each snapshot holds the tabs added to it, in the order they were added, so that closed
+    /// and moved tabs are saved as such
+    void testSnapshotFollowsTabOrder()
+    {
+        QTemporaryDir dir;
+        QVERIFY(dir.isValid());
+        const QString fileName = dir.filePath(QStringLiteral("session.dat"));
+
+        SessionAutosaver autosaver(fileName);
+        const std::vector<int> versions(6, 0);
+
+        saveSnapshot(autosaver, { 0, 1, 2, 3, 4, 5 }, versions);
+        autosaver.invalidateTab(3);
+        saveSnapshot(autosaver, { 5, 0, 1, 2, 4 }, versions);
+        autosaver.waitForDone();
+
+        QCOMPARE(autosaver.getNumEncodedTabs(), 0);
+        verifySession(fileName, { 5, 0, 1, 2, 4 }, versions);
+    }
+
+    /// Verifies that the records of closed tabs, and of the favicons only they used, are discarded after a save
+    void testClosedTabsAreDiscarded()
+    {
+        QTemporaryDir dir;
+        QVERIFY(dir.isValid());
+        const QString fileName = dir.filePath(QStringLiteral("session.dat"));
+
+        SessionAutosaver autosaver(fileName);
+        const std::vector<int> versions(6, 0);
+
+        saveSnapshot(autosaver, { 0, 1, 2, 3, 4, 5 }, versions);
+        QCOMPARE(autosaver.getNumCachedTabs(), 6);
+        QCOMPARE(autosaver.getNumCachedIcons(), 3);
+
+        // Tabs 0 and 3 share the first favicon
+        saveSnapshot(autosaver, { 3, 0 }, versions);
+        QCOMPARE(autosaver.getNumEncodedTabs(), 0);
+        QCOMPARE(autosaver.getNumCachedTabs(), 2);
+        QCOMPARE(autosaver.getNumCachedIcons(), 1);
+
+        // A tab that was discarded is encoded again, along with its favicon
+        saveSnapshot(autosaver, { 3, 0, 1 }, versions);
+        autosaver.waitForDone();
+        QCOMPARE(autosaver.getNumEncodedTabs(), 1);
+        QCOMPARE(autosaver.getNumCachedTabs(), 3);
+        QCOMPARE(autosaver.getNumCachedIcons(), 2);
+        verifySession(fileName, { 3, 0, 1 }, versions);
+    }
+
+    /// Verifies that the session file always holds the latest complete snapshot when the process writing it
+    /// is killed, wherever the write was interrupted
+    void testSessionSurvivesKilledWriter()
+    {
+        QTemporaryDir dir;
+        QVERIFY(dir.isValid());
+        const QString fileName = dir.filePath(QStringLiteral("session.dat"));
+
+        for (int attempt = 0; attempt < 8; ++attempt)
+        {
+            QProcess writer;
+            writer.start(QStringLiteral(SESSION_AUTOSAVE_WRITER), { fileName });
+            QVERIFY(writer.waitForStarted());
+
+            // Kill the writer at a different point of its current write each time
+            QTRY_VERIFY_WITH_TIMEOUT(QFile::exists(fileName), 10000);
+            QTest::qSleep(15 + attempt * 35);
+
+            writer.kill();
+            QVERIFY(writer.waitForFinished());
+            QCOMPARE(writer.exitStatus(), QProcess::CrashExit);
+
+            QCOMPARE(countTabs(fileName), 200);
+        }
+    }
+};
+
+QTEST_MAIN(SessionAutosaverTest)
+
+#include "SessionAutosaverTest.moc"
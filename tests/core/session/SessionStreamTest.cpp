@@ -0,0 +1,268 @@
+#include "CommonUtil.h"
+#include "SessionStream.h"
+
+#include <QBuffer>
+#include <QByteArray>
+#include <QColor>
+#include <QIcon>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QObject>
+#include <QPixmap>
+#include <QRect>
+#include <QString>
+#include <QTest>
+#include <QUrl>
+
+/// Test cases for the binary session format written by \ref SessionWriter and read by \ref SessionReader
+class SessionStreamTest : public QObject
+{
+    Q_OBJECT
+
+public:
+    SessionStreamTest() : QObject(nullptr) {}
+
+private:
+    /// Returns a favicon filled with the given color
+    QIcon makeIcon(const QColor &color) const
+    {
+        QPixmap pixmap(16, 16);
+        pixmap.fill(color);
+        return QIcon(pixmap);
+    }
+
+    /// Returns the state of the n-th tab of a test session. Tabs share one of three favicons
+    SessionTab makeTab(int n) const
+    {
+        static const QColor colors[] = { Qt::red, Qt::green, Qt::blue };
+
+        SessionTab tab;
+        tab.Url = QUrl(QStringLiteral("https://site%1.example/page/%2").arg(n % 3).arg(n));
+        tab.Title = QStringLiteral("Page %1").arg(n);
+        tab.IconUrl = QUrl(QStringLiteral("https://site%1.example/favicon.ico").arg(n % 3));
+        tab.Icon = makeIcon(colors[n % 3]);
+        tab.History = QByteArray(2048, static_cast<char>('a' + n % 26));
+        tab.IsPinned = (n == 0);
+        tab.IsHibernating = (n % 2 == 1);
+        return tab;
+    }
+
+    /// Writes a session made of the given number of windows, each with the given number of tabs
+    QByteArray writeSession(int numWindows, int numTabs) const
+    {
+        QByteArray data;
+        QBuffer buffer(&data);
+        buffer.open(QIODevice::WriteOnly);
+
+        SessionWriter writer(&buffer);
+        for (int w = 0; w < numWindows; ++w)
+        {
+            SessionWindow window;
+            window.Geometry = QRect(10 * w, 20, 800, 600);
+            window.IsMaximized = (w == 1);
+            window.CurrentTab = w;
+            writer.addWindow(window);
+
+            for (int t = 0; t < numTabs; ++t)
+                writer.addTab(makeTab(t));
+        }
+
+        if (!writer.finish())
+            qWarning() << "Could not write session";
+        return data;
+    }
+
+    /// Writes the given session in the JSON format of previous versions
+    QByteArray writeLegacySession(int numWindows, int numTabs) const
+    {
+        QJsonArray windowArray;
+        for (int w = 0; w < numWindows; ++w)
+        {
+            QJsonArray tabArray;
+            for (int t = 0; t < numTabs; ++t)
+            {
+                const SessionTab tab = makeTab(t);
+
+                QJsonObject tabInfoObj;
+                tabInfoObj.insert(QLatin1String("url"), tab.Url.toString());
+                tabInfoObj.insert(QLatin1String("is_pinned"), tab.IsPinned);
+                tabInfoObj.insert(QLatin1String("is_hibernating"), tab.IsHibernating);
+                tabInfoObj.insert(QLatin1String("title"), tab.Title);
+                tabInfoObj.insert(QLatin1String("icon"), QLatin1String(CommonUtil::iconToBase64(tab.Icon)));
+                tabInfoObj.insert(QLatin1String("icon_url"), tab.IconUrl.toString());
+                tabInfoObj.insert(QLatin1String("history"), QLatin1String(tab.History.toBase64()));
+                tabArray.append(tabInfoObj);
+            }
+
+            QJsonObject winObj;
+            winObj.insert(QLatin1String("tabs"), tabArray);
+            winObj.insert(QLatin1String("current_tab"), w);
+            winObj.insert(QLatin1String("geom_x"), 10 * w);
+            winObj.insert(QLatin1String("geom_y"), 20);
+            winObj.insert(QLatin1String("geom_width"), 800);
+            winObj.insert(QLatin1String("geom_height"), 600);
+            winObj.insert(QLatin1String("is_maximized"), w == 1);
+            windowArray.append(winObj);
+        }
+
+        QJsonObject sessionObj;
+        sessionObj.insert(QLatin1String("windows"), windowArray);
+        return QJsonDocument(sessionObj).toJson();
+    }
+
+    /// Reads every window and tab of a session, verifying them against the test session
+    void verifySession(SessionReader &reader, int numWindows, int numTabs)
+    {
+        int windowCount = 0, tabCount = 0;
+        for (SessionReader::Item item = reader.readNext(); item != SessionReader::Item::End; item = reader.readNext())
+        {
+            if (item == SessionReader::Item::Window)
+            {
+                QCOMPARE(tabCount, windowCount * numTabs);
+
+                const SessionWindow &window = reader.getWindow();
+                QCOMPARE(window.Geometry, QRect(10 * windowCount, 20, 800, 600));
+                QCOMPARE(window.IsMaximized, windowCount == 1);
+                QCOMPARE(window.CurrentTab, windowCount);
+                ++windowCount;
+                continue;
+            }
+
+            const int n = tabCount++ % numTabs;
+            const SessionTab expected = makeTab(n);
+            const SessionTab &tab = reader.getTab();
+            QCOMPARE(tab.Url, expected.Url);
+            QCOMPARE(tab.Title, expected.Title);
+            QCOMPARE(tab.IconUrl, expected.IconUrl);
+            QCOMPARE(tab.History, expected.History);
+            QCOMPARE(tab.IsPinned, expected.IsPinned);
+            QCOMPARE(tab.IsHibernating, expected.IsHibernating);
+            QVERIFY(!tab.Icon.isNull());
+            QCOMPARE(tab.Icon.pixmap(16, 16).toImage().pixelColor(8, 8), expected.Icon.pixmap(16, 16).toImage().pixelColor(8, 8));
+        }
+
+        QCOMPARE(windowCount, numWindows);
+        QCOMPARE(tabCount, numWindows * numTabs);
+    }
+
+private slots:
+    /// Verifies that windows and tabs are read back in the order and with the state they were written
+    void testRoundTrip()
+    {
+        QByteArray data = writeSession(2, 10);
+
+        QBuffer buffer(&data);
+        QVERIFY(buffer.open(QIODevice::ReadOnly));
+
+        SessionReader reader(&buffer);
+        QVERIFY(reader.isValid());
+        QVERIFY(!reader.isLegacyFormat());
+        verifySession(reader, 2, 10);
+        QVERIFY(reader.readNext() == SessionReader::Item::End);
+    }
+
+    /// Verifies that each favicon is stored once, no matter how many tabs use it
+    void testIconsAreStoredOnce()
+    {
+        const QByteArray fewTabs = writeSession(1, 3);
+        const QByteArray manyTabs = writeSession(1, 300);
+
+        // Every tab after the first three only adds its own URL, title and history
+        const QByteArray tabWithoutIcon = [this](){
+            SessionTab tab = makeTab(3);
+            tab.Icon = QIcon();
+            QByteArray data;
+            QBuffer buffer(&data);
+            buffer.open(QIODevice::WriteOnly);
+            SessionWriter writer(&buffer);
+            writer.addTab(tab);
+            return data;
+        }();
+        QVERIFY(manyTabs.size() < fewTabs.size() + 297 * tabWithoutIcon.size());
+
+        // The JSON format stored each icon and history in base64, inline
+        QVERIFY(manyTabs.size() < writeLegacySession(1, 300).size() * 3 / 4);
+    }
+
+    /// Verifies that a session cut short while it was being written yields the tabs that were complete
+    void testTruncatedSession()
+    {
+        const QByteArray data = writeSession(1, 10);
+
+        QByteArray truncated = data.left(data.size() / 2);
+        QBuffer buffer(&truncated);
+        QVERIFY(buffer.open(QIODevice::ReadOnly));
+
+        SessionReader reader(&buffer);
+        QVERIFY(reader.isValid());
+
+        int numTabs = 0;
+        for (SessionReader::Item item = reader.readNext(); item != SessionReader::Item::End; item = reader.readNext())
+        {
+            if (item == SessionReader::Item::Tab)
+            {
+                QCOMPARE(reader.getTab().Url, makeTab(numTabs).Url);
+                ++numTabs;
+            }
+        }
+        QVERIFY(numTabs > 0);
+        QVERIFY(numTabs < 10);
+    }
+
+    /// Verifies that files which are neither binary nor JSON sessions are rejected
+    void testInvalidSession()
+    {
+        QByteArray data("not a session file");
+        QBuffer buffer(&data);
+        QVERIFY(buffer.open(QIODevice::ReadOnly));
+
+        SessionReader reader(&buffer);
+        QVERIFY(!reader.isValid());
+        QVERIFY(reader.readNext() == SessionReader::Item::End);
+    }
+
+    /// Verifies that sessions saved as JSON by previous versions are read as if they were binary sessions
+    void testLegacySessionMigration()
+    {
+        QByteArray legacy = writeLegacySession(2, 5);
+
+        QBuffer buffer(&legacy);
+        QVERIFY(buffer.open(QIODevice::ReadOnly));
+
+        SessionReader reader(&buffer);
+        QVERIFY(reader.isValid());
+        QVERIFY(reader.isLegacyFormat());
+        verifySession(reader, 2, 5);
+    }
+
+    /// Measures the time taken to write and read a session with 500 tabs in the binary format
+    void benchmarkBinarySession()
+    {
+        QBENCHMARK {
+            QByteArray data = writeSession(5, 100);
+            QBuffer buffer(&data);
+            buffer.open(QIODevice::ReadOnly);
+
+            SessionReader reader(&buffer);
+            while (reader.readNext() != SessionReader::Item::End) {}
+        }
+    }
+
+    /// Measures the time taken to write and read the same session in the JSON format of previous versions
+    void benchmarkLegacySession()
+    {
+        QBENCHMARK {
+            QByteArray data = writeLegacySession(5, 100);
+            QBuffer buffer(&data);
+            buffer.open(QIODevice::ReadOnly);
+
+            SessionReader reader(&buffer);
+            while (reader.readNext() != SessionReader::Item::End) {}
+        }
+    }
+};
+
+QTEST_MAIN(SessionStreamTest)
+
+#include "SessionStreamTest.moc"
@@ -0,0 +1,170 @@
+#include "TabRestoreQueue.h"
+
+#include <memory>
+#include <vector>
+
+#include <QObject>
+#include <QSignalSpy>
+#include <QTest>
+
+/// Test cases for the \ref TabRestoreQueue class
+class TabRestoreQueueTest : public QObject
+{
+    Q_OBJECT
+
+public:
+    TabRestoreQueueTest() : QObject(nullptr) {}
+
+private:
+    /// Creates the given number of tabs, and queues them so that each load is recorded in the given container
+    std::vector<std::unique_ptr<QObject>> makeTabs(TabRestoreQueue &queue, int numTabs, std::vector<QObject*> &loaded)
+    {
+        std::vector<std::unique_ptr<QObject>> tabs;
+        for (int i = 0; i < numTabs; ++i)
+        {
+            tabs.push_back(std::make_unique<QObject>(nullptr));
+            QObject *tab = tabs.back().get();
+            queue.enqueue(tab, [tab, &loaded](){ loaded.push_back(tab); });
+        }
+        return tabs;
+    }
+
+private slots:
+    /// Verifies that nothing is loaded until the queue is started, and that tabs are then loaded in order,
+    /// no more than the limit at a time
+    void testLoadsAreThrottled()
+    {
+        TabRestoreQueue queue(2);
+        QSignalSpy spy(&queue, &TabRestoreQueue::finished);
+        std::vector<QObject*> loaded;
+        auto tabs = makeTabs(queue, 5, loaded);
+
+        QVERIFY(loaded.empty());
+        QCOMPARE(queue.getNumPending(), 5);
+
+        queue.start();
+        QCOMPARE(loaded.size(), size_t{2});
+        QCOMPARE(loaded[0], tabs[0].get());
+        QCOMPARE(loaded[1], tabs[1].get());
+        QCOMPARE(queue.getNumLoading(), 2);
+        QCOMPARE(queue.getNumPending(), 3);
+
+        // Finishing a tab that is not being loaded has no effect
+        queue.onLoadFinished(tabs[4].get());
+        QCOMPARE(loaded.size(), size_t{2});
+
+        queue.onLoadFinished(tabs[1].get());
+        QCOMPARE(loaded.size(), size_t{3});
+        QCOMPARE(loaded[2], tabs[2].get());
+
+        queue.onLoadFinished(tabs[0].get());
+        queue.onLoadFinished(tabs[2].get());
+        QCOMPARE(loaded.size(), size_t{5});
+        QCOMPARE(spy.count(), 0);
+
+        queue.onLoadFinished(tabs[3].get());
+        queue.onLoadFinished(tabs[4].get());
+        QVERIFY(queue.isEmpty());
+        QCOMPARE(spy.count(), 1);
+    }
+
+    /// Verifies that tabs removed from the queue, such as tabs activated by the user, are not loaded again
+    void testRemovedTabsAreSkipped()
+    {
+        TabRestoreQueue queue(1);
+        std::vector<QObject*> loaded;
+        auto tabs = makeTabs(queue, 3, loaded);
+
+        queue.remove(tabs[1].get());
+        queue.start();
+        QCOMPARE(loaded.size(), size_t{1});
+
+        // Removing a tab that is being loaded does not free its place
+        queue.remove(tabs[0].get());
+        QCOMPARE(queue.getNumLoading(), 1);
+
+        queue.onLoadFinished(tabs[0].get());
+        QCOMPARE(loaded.size(), size_t{2});
+        QCOMPARE(loaded[1], tabs[2].get());
+    }
+
+    /// Verifies that destroyed tabs are forgotten, and that a destroyed tab frees its place
+    void testDestroyedTabsAreForgotten()
+    {
+        TabRestoreQueue queue(1);
+        QSignalSpy spy(&queue, &TabRestoreQueue::finished);
+        std::vector<QObject*> loaded;
+        auto tabs = makeTabs(queue, 3, loaded);
+
+        tabs[1].reset();
+        queue.start();
+        QCOMPARE(queue.getNumPending(), 1);
+
+        tabs[0].reset();
+        QCOMPARE(loaded.size(), size_t{2});
+        QCOMPARE(loaded[1], tabs[2].get());
+
+        queue.onLoadFinished(tabs[2].get());
+        QVERIFY(queue.isEmpty());
+        QCOMPARE(spy.count(), 1);
+    }
+
+    /// Verifies that a tab which finishes loading as soon as its load is started frees its place immediately
+    void testSynchronousLoads()
+    {
+        TabRestoreQueue queue(1);
+        QSignalSpy spy(&queue, &TabRestoreQueue::finished);
+        std::vector<std::unique_ptr<QObject>> tabs;
+        int numLoaded = 0;
+        for (int i = 0; i < 4; ++i)
+        {
+            tabs.push_back(std::make_unique<QObject>(nullptr));
+            QObject *tab = tabs.back().get();
+            queue.enqueue(tab, [&queue, tab, &numLoaded](){
+                ++numLoaded;
+                queue.onLoadFinished(tab);
+            });
+        }
+
+        queue.start();
+        QCOMPARE(numLoaded, 4);
+        QVERIFY(queue.isEmpty());
+        QCOMPARE(spy.count(), 1);
+    }
+
+    /// Verifies that without a limit greater than zero, tabs are left for the user to activate, and that the queue
+    /// does not report having finished loads it never started
+    void testNoBackgroundLoads()
+    {
+        TabRestoreQueue queue(0);
+        QSignalSpy spy(&queue, &TabRestoreQueue::finished);
+        std::vector<QObject*> loaded;
+        auto tabs = makeTabs(queue, 3, loaded);
+
+        queue.start();
+        QVERIFY(loaded.empty());
+        QCOMPARE(queue.getNumPending(), 3);
+        QCOMPARE(spy.count(), 0);
+
+        queue.remove(tabs[0].get());
+        tabs[1].reset();
+        queue.remove(tabs[2].get());
+        QVERIFY(queue.isEmpty());
+        QCOMPARE(spy.count(), 0);
+    }
+
+    /// Verifies that starting an empty queue does not emit the finished signal
+    void testEmptyQueue()
+    {
+        TabRestoreQueue queue(2);
+        QSignalSpy spy(&queue, &TabRestoreQueue::finished);
+
+        queue.start();
+        QVERIFY(queue.isEmpty());
+        QCOMPARE(spy.count(), 0);
+    }
+};
+
+QTEST_APPLESS_MAIN(TabRestoreQueueTest)
+
+#include "TabRestoreQueueTest.moc"
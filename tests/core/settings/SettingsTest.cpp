@@ -0,0 +1,138 @@
+#include "Settings.h"
+
+#include <QFile>
+#include <QObject>
+#include <QSettings>
+#include <QSignalSpy>
+#include <QString>
+#include <QTest>
+#include <QVariant>
+
+/// Test cases for the in-memory cache and batched persistence of the \ref Settings class
+class SettingsTest : public QObject
+{
+    Q_OBJECT
+
+public:
+    SettingsTest() : QObject(nullptr), m_settingsFile(QLatin1String("SettingsTest.ini")) {}
+
+private slots:
+    void init()
+    {
+        if (QFile::exists(m_settingsFile))
+            QFile::remove(m_settingsFile);
+    }
+
+    void cleanup()
+    {
+        if (QFile::exists(m_settingsFile))
+            QFile::remove(m_settingsFile);
+    }
+
+    /// Verifies that defaults are written on the first run and loaded with the type of each setting
+    void testDefaultsAreLoadedWithTheirTypes()
+    {
+        Settings settings(nullptr, m_settingsFile, QSettings::IniFormat);
+        QVERIFY(settings.firstRun());
+
+        const QVariant javascript = settings.getValue(BrowserSetting::EnableJavascript);
+        QCOMPARE(javascript.metaType(), QMetaType(QMetaType::Bool));
+        QVERIFY(javascript.toBool());
+
+        const QVariant startupMode = settings.getValue(BrowserSetting::StartupMode);
+        QCOMPARE(startupMode.metaType(), QMetaType(QMetaType::Int));
+        QCOMPARE(startupMode.toInt(), static_cast<int>(StartupMode::LoadHomePage));
+
+        QVERIFY(settings.getPathValue(BrowserSetting::HistoryPath).endsWith(QLatin1String("history.db")));
+
+        // Settings without a default remain invalid
+        QVERIFY(!settings.getValue(BrowserSetting::EnableAutoFill).isValid());
+    }
+
+    /// Verifies that changes are visible immediately, and notify observers only when the value changes
+    void testChangesNotifyObservers()
+    {
+        Settings settings(nullptr, m_settingsFile, QSettings::IniFormat);
+        QSignalSpy spy(&settings, &Settings::settingChanged);
+
+        settings.setValue(BrowserSetting::HomePage, QLatin1String("https://example.com/"));
+        QCOMPARE(settings.getValue(BrowserSetting::HomePage).toString(), QLatin1String("https://example.com/"));
+        QCOMPARE(spy.count(), 1);
+
+        settings.setValue(BrowserSetting::HomePage, QLatin1String("https://example.com/"));
+        QCOMPARE(spy.count(), 1);
+
+        // Values are converted to the type of the setting, so an equivalent value is not a change
+        settings.setValue(BrowserSetting::EnableJavascript, QLatin1String("true"));
+        QCOMPARE(spy.count(), 1);
+        settings.setValue(BrowserSetting::EnableJavascript, false);
+        QCOMPARE(spy.count(), 2);
+        QCOMPARE(settings.getValue(BrowserSetting::EnableJavascript).metaType(), QMetaType(QMetaType::Bool));
+    }
+
+    /// Verifies that changes are written to the settings file after a delay, together, and that
+    /// pending changes are written when the settings are destroyed
+    void testChangesAreWrittenInBatches()
+    {
+        {
+            Settings settings(nullptr, m_settingsFile, QSettings::IniFormat);
+            settings.sync();
+
+            settings.setValue(BrowserSetting::HomePage, QLatin1String("https://example.com/"));
+            settings.setValue(BrowserSetting::SendDoNotTrack, true);
+
+            // Nothing is written until the batch is flushed
+            QCOMPARE(QSettings(m_settingsFile, QSettings::IniFormat).value(QLatin1String("SendDoNotTrack")).toBool(), false);
+
+            QTRY_COMPARE_WITH_TIMEOUT(QSettings(m_settingsFile, QSettings::IniFormat).value(QLatin1String("SendDoNotTrack")).toBool(), true, 5000);
+            QCOMPARE(QSettings(m_settingsFile, QSettings::IniFormat).value(QLatin1String("HomePage")).toString(), QLatin1String("https://example.com/"));
+
+            settings.setValue(BrowserSetting::StartupMode, static_cast<int>(StartupMode::RestoreSession));
+        }
+
+        QCOMPARE(QSettings(m_settingsFile, QSettings::IniFormat).value(QLatin1String("StartupMode")).toInt(), static_cast<int>(StartupMode::RestoreSession));
+
+        Settings reloaded(nullptr, m_settingsFile, QSettings::IniFormat);
+        QVERIFY(!reloaded.firstRun());
+        QCOMPARE(reloaded.getValue(BrowserSetting::HomePage).toString(), QLatin1String("https://example.com/"));
+        QCOMPARE(reloaded.getValue(BrowserSetting::SendDoNotTrack).toBool(), true);
+        QCOMPARE(reloaded.getValue(BrowserSetting::StartupMode).toInt(), static_cast<int>(StartupMode::RestoreSession));
+    }
+
+    /// Measures the cost of reading settings through the in-memory cache
+    void benchmarkCachedRead()
+    {
+        Settings settings(nullptr, m_settingsFile, QSettings::IniFormat);
+
+        QBENCHMARK {
+            for (int i = 0; i < 1000; ++i)
+            {
+                settings.getValue(BrowserSetting::SendDoNotTrack).toBool();
+                settings.getValue(BrowserSetting::OpenAllTabsInBackground).toBool();
+            }
+        }
+    }
+
+    /// Measures the cost of reading the same settings through QSettings, as was done before the cache was added
+    void benchmarkQSettingsRead()
+    {
+        Settings settings(nullptr, m_settingsFile, QSettings::IniFormat);
+        QSettings store(m_settingsFile, QSettings::IniFormat);
+
+        QBENCHMARK {
+            for (int i = 0; i < 1000; ++i)
+            {
+                store.value(QLatin1String("SendDoNotTrack")).toBool();
+                store.value(QLatin1String("OpenAllTabsInBackground")).toBool();
+            }
+        }
+    }
+
+private:
+    /// Path of the settings file used by the tests
+    const QString m_settingsFile;
+};
+
+QTEST_GUILESS_MAIN(SettingsTest)
+
+#include "SettingsTest.moc"
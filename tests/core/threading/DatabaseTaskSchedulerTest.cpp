@@ -0,0 +1,416 @@
+#include "DatabaseTaskScheduler.h"
+#include "DatabaseWorker.h"
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <QCoreApplication>
+#include <QFuture>
+#include <QObject>
+#include <QTest>
+#include <QThread>
+
+/// Test cases for the \ref DatabaseTaskScheduler class
+class DatabaseTaskSchedulerTest : public QObject
+{
+    Q_OBJECT
+
+public:
+    DatabaseTaskSchedulerTest() : QObject(nullptr) {}
+
+private:
+    /// Registers a worker without a database with the scheduler
+    void addEmptyWorker(DatabaseTaskScheduler &scheduler, const std::string &name)
+    {
+        scheduler.addWorker(name, [](){ return std::unique_ptr<DatabaseWorker>(); });
+    }
+
+private slots:
+    /// Verifies that the tasks posted to the same lane of a worker are executed in order
+    void testTasksRunInPostedOrder()
+    {
+        DatabaseTaskScheduler scheduler;
+        addEmptyWorker(scheduler, "Store");
+
+        std::vector<int> executed;
+        for (int i = 0; i < 100; ++i)
+            scheduler.post("Store", DatabaseTaskPriority::Interactive, [&executed, i](){ executed.push_back(i); });
+
+        scheduler.run();
+        scheduler.stop();
+
+        QCOMPARE(executed.size(), size_t{100});
+        for (int i = 0; i < 100; ++i)
+            QCOMPARE(executed.at(i), i);
+    }
+
+    /// Verifies that the init callbacks are executed after every worker has been created, and before any task
+    void testInitCallbacksRunBeforeTasks()
+    {
+        DatabaseTaskScheduler scheduler;
+        addEmptyWorker(scheduler, "First");
+        addEmptyWorker(scheduler, "Second");
+
+        std::atomic_bool initialized { false };
+        std::atomic_int tasksBeforeInit { 0 };
+        scheduler.onInit([&initialized](){ initialized = true; });
+
+        for (const std::string &name : { std::string("First"), std::string("Second") })
+        {
+            scheduler.post(name, DatabaseTaskPriority::Interactive, [&](){
+                if (!initialized)
+                    ++tasksBeforeInit;
+            });
+        }
+
+        scheduler.run();
+        scheduler.stop();
+
+        QVERIFY(initialized);
+        QCOMPARE(tasksBeforeInit.load(), 0);
+    }
+
+    /// Verifies that queued interactive tasks are executed before queued background tasks, while
+    /// each lane keeps its own order
+    void testInteractiveTasksOvertakeBackgroundTasks()
+    {
+        DatabaseTaskScheduler scheduler;
+        addEmptyWorker(scheduler, "Store");
+        scheduler.run();
+
+        std::promise<void> gate;
+        std::shared_future<void> gateFuture = gate.get_future().share();
+        scheduler.post("Store", DatabaseTaskPriority::Background, [gateFuture](){ gateFuture.wait(); });
+
+        std::mutex executedMutex;
+        std::vector<std::string> executed;
+        auto record = [&](const std::string &name) {
+            return [&executedMutex, &executed, name](){
+                std::lock_guard<std::mutex> lock{executedMutex};
+                executed.push_back(name);
+            };
+        };
+
+        scheduler.post("Store", DatabaseTaskPriority::Background, record("b1"));
+        scheduler.post("Store", DatabaseTaskPriority::Background, record("b2"));
+        scheduler.post("Store", DatabaseTaskPriority::Interactive, record("i1"));
+        scheduler.post("Store", DatabaseTaskPriority::Background, record("b3"));
+        scheduler.post("Store", DatabaseTaskPriority::Interactive, record("i2"));
+
+        gate.set_value();
+        scheduler.stop();
+
+        const std::vector<std::string> expected { "i1", "i2", "b1", "b2", "b3" };
+        QVERIFY(executed == expected);
+    }
+
+    /// Verifies that a long running task on one database does not delay the tasks of another database
+    void testDatabasesDoNotBlockEachOther()
+    {
+        DatabaseTaskScheduler scheduler;
+        addEmptyWorker(scheduler, "HistoryStore");
+        addEmptyWorker(scheduler, "FaviconStore");
+        scheduler.run();
+
+        std::promise<void> gate;
+        std::shared_future<void> gateFuture = gate.get_future().share();
+        scheduler.post("HistoryStore", DatabaseTaskPriority::Background, [gateFuture](){ gateFuture.wait(); });
+
+        std::promise<void> lookupDone;
+        std::future<void> lookupFuture = lookupDone.get_future();
+        scheduler.post("FaviconStore", DatabaseTaskPriority::Interactive, [&lookupDone](){ lookupDone.set_value(); });
+
+        const bool finishedWhileBlocked = lookupFuture.wait_for(std::chrono::seconds(5)) == std::future_status::ready;
+
+        gate.set_value();
+        scheduler.stop();
+
+        QVERIFY(finishedWhileBlocked);
+    }
+
+    /// Verifies the queue depth and wait time statistics of each lane
+    void testLaneMetrics()
+    {
+        DatabaseTaskScheduler scheduler;
+        addEmptyWorker(scheduler, "Store");
+        scheduler.run();
+
+        std::promise<void> gate;
+        std::shared_future<void> gateFuture = gate.get_future().share();
+        scheduler.post("Store", DatabaseTaskPriority::Interactive, [gateFuture](){ gateFuture.wait(); });
+
+        // Wait for the blocking task to be started
+        QTRY_COMPARE(scheduler.getLaneMetrics("Store", DatabaseTaskPriority::Interactive).TasksStarted, uint64_t{1});
+
+        for (int i = 0; i < 3; ++i)
+            scheduler.post("Store", DatabaseTaskPriority::Background, [](){});
+
+        DatabaseLaneMetrics background = scheduler.getLaneMetrics("Store", DatabaseTaskPriority::Background);
+        QCOMPARE(background.QueueDepth, size_t{3});
+        QCOMPARE(background.TasksStarted, uint64_t{0});
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        gate.set_value();
+        scheduler.stop();
+
+        background = scheduler.getLaneMetrics("Store", DatabaseTaskPriority::Background);
+        QCOMPARE(background.QueueDepth, size_t{0});
+        QCOMPARE(background.MaxQueueDepth, size_t{3});
+        QCOMPARE(background.TasksStarted, uint64_t{3});
+        QVERIFY(background.MaxWaitTime >= std::chrono::milliseconds(20));
+        QVERIFY(background.getAverageWaitTime() <= background.MaxWaitTime);
+
+        const DatabaseLaneMetrics interactive = scheduler.getLaneMetrics("Store", DatabaseTaskPriority::Interactive);
+        QCOMPARE(interactive.MaxQueueDepth, size_t{1});
+        QCOMPARE(interactive.TasksStarted, uint64_t{1});
+
+        const DatabaseLaneMetrics unknown = scheduler.getLaneMetrics("Unknown", DatabaseTaskPriority::Interactive);
+        QCOMPARE(unknown.TasksStarted, uint64_t{0});
+    }
+
+    /// Verifies that tasks posted for a database that was not registered are rejected, and that their futures are cancelled
+    void testTasksForUnregisteredDatabaseAreRejected()
+    {
+        DatabaseTaskScheduler scheduler;
+        addEmptyWorker(scheduler, "Store");
+        scheduler.run();
+
+        std::atomic_bool executed { false };
+        scheduler.post("Other", DatabaseTaskPriority::Interactive, [&executed](){ executed = true; });
+        QFuture<int> future = scheduler.schedule("Other", DatabaseTaskPriority::Interactive, [](){ return 1; });
+        QFuture<int> coalescedFuture = scheduler.scheduleCoalesced("Other", DatabaseTaskPriority::Interactive, "key", [](){ return 1; });
+        scheduler.stop();
+
+        QVERIFY(!executed);
+        QVERIFY(future.isCanceled());
+        QVERIFY(coalescedFuture.isCanceled());
+        QVERIFY(scheduler.getWorker("Other") == nullptr);
+    }
+
+    /// Verifies that a steady stream of interactive tasks does not prevent the background lane from making progress
+    void testBackgroundTasksAreNotStarved()
+    {
+        DatabaseTaskScheduler scheduler;
+        addEmptyWorker(scheduler, "Store");
+        scheduler.run();
+
+        std::promise<void> gate;
+        std::shared_future<void> gateFuture = gate.get_future().share();
+        scheduler.post("Store", DatabaseTaskPriority::Interactive, [gateFuture](){ gateFuture.wait(); });
+
+        // Wait for the blocking task to be started
+        QTRY_COMPARE(scheduler.getLaneMetrics("Store", DatabaseTaskPriority::Interactive).TasksStarted, uint64_t{1});
+
+        std::mutex executedMutex;
+        std::vector<std::string> executed;
+        auto record = [&](const std::string &name) {
+            return [&executedMutex, &executed, name](){
+                std::lock_guard<std::mutex> lock{executedMutex};
+                executed.push_back(name);
+            };
+        };
+
+        const size_t burst = DatabaseTaskScheduler::InteractiveTasksPerBackgroundTask;
+        scheduler.post("Store", DatabaseTaskPriority::Background, record("b1"));
+        scheduler.post("Store", DatabaseTaskPriority::Background, record("b2"));
+        for (size_t i = 0; i < 2 * burst + 1; ++i)
+            scheduler.post("Store", DatabaseTaskPriority::Interactive, record("i"));
+
+        gate.set_value();
+        scheduler.stop();
+
+        QCOMPARE(executed.size(), 2 * burst + 3);
+        QCOMPARE(executed.at(burst), std::string("b1"));
+        QCOMPARE(executed.at(2 * burst + 1), std::string("b2"));
+    }
+
+    /// Verifies that the result of a scheduled task is delivered to the continuation on the context object's thread
+    void testScheduledResultIsDeliveredOnContextThread()
+    {
+        DatabaseTaskScheduler scheduler;
+        addEmptyWorker(scheduler, "Store");
+        scheduler.run();
+
+        std::atomic<std::thread::id> taskThread;
+        QFuture<int> future = scheduler.schedule("Store", DatabaseTaskPriority::Interactive, [&taskThread](){
+            taskThread = std::this_thread::get_id();
+            return 42;
+        });
+
+        int result = 0;
+        QThread *continuationThread = nullptr;
+        future.then(this, [&](int value){
+            result = value;
+            continuationThread = QThread::currentThread();
+        });
+
+        QTRY_COMPARE(result, 42);
+        QCOMPARE(continuationThread, thread());
+        QVERIFY(taskThread.load() != std::this_thread::get_id());
+
+        scheduler.stop();
+    }
+
+    /// Verifies that scheduled tasks keep their order relative to posted tasks in the same lane
+    void testScheduledTasksKeepOrder()
+    {
+        DatabaseTaskScheduler scheduler;
+        addEmptyWorker(scheduler, "Store");
+
+        std::vector<int> executed;
+        std::vector<QFuture<int>> futures;
+        for (int i = 0; i < 20; ++i)
+        {
+            if (i % 2 == 0)
+                scheduler.post("Store", DatabaseTaskPriority::Interactive, [&executed, i](){ executed.push_back(i); });
+            else
+                futures.push_back(scheduler.schedule("Store", DatabaseTaskPriority::Interactive, [&executed, i](){
+                    executed.push_back(i);
+                    return i;
+                }));
+        }
+
+        scheduler.run();
+        scheduler.stop();
+
+        QCOMPARE(executed.size(), size_t{20});
+        for (int i = 0; i < 20; ++i)
+            QCOMPARE(executed.at(i), i);
+
+        for (size_t i = 0; i < futures.size(); ++i)
+            QCOMPARE(futures.at(i).result(), static_cast<int>(i * 2 + 1));
+    }
+
+    /// Verifies that cancelled tasks are not executed, and that their continuations are not invoked
+    void testCancellation()
+    {
+        DatabaseTaskScheduler scheduler;
+        addEmptyWorker(scheduler, "Store");
+
+        std::atomic_int executedCount { 0 };
+
+        CancellationToken token;
+        QFuture<void> cancelledByToken = scheduler.schedule("Store", DatabaseTaskPriority::Interactive,
+                                                            [&executedCount](){ ++executedCount; }, token);
+        QFuture<void> cancelledByFuture = scheduler.schedule("Store", DatabaseTaskPriority::Interactive,
+                                                             [&executedCount](){ ++executedCount; });
+        QFuture<void> notCancelled = scheduler.schedule("Store", DatabaseTaskPriority::Interactive,
+                                                        [&executedCount](){ ++executedCount; });
+
+        bool continuationInvoked = false;
+        cancelledByToken.then(this, [&continuationInvoked](){ continuationInvoked = true; });
+
+        token.cancel();
+        cancelledByFuture.cancel();
+
+        scheduler.run();
+        scheduler.stop();
+
+        QCOMPARE(executedCount.load(), 1);
+        QVERIFY(cancelledByToken.isCanceled());
+        QVERIFY(cancelledByFuture.isCanceled());
+        QVERIFY(notCancelled.isFinished() && !notCancelled.isCanceled());
+
+        QCoreApplication::processEvents();
+        QVERIFY(!continuationInvoked);
+    }
+
+    /// Verifies that tasks with the same key collapse into the latest one while they are waiting,
+    /// and that the latest task keeps the position of the first one
+    void testCoalescing()
+    {
+        DatabaseTaskScheduler scheduler;
+        addEmptyWorker(scheduler, "Store");
+
+        std::vector<std::string> executed;
+        auto record = [&executed](const std::string &name) {
+            return [&executed, name](){
+                executed.push_back(name);
+                return name;
+            };
+        };
+
+        QFuture<std::string> first = scheduler.scheduleCoalesced("Store", DatabaseTaskPriority::Interactive, "session", record("session-1"));
+        scheduler.schedule("Store", DatabaseTaskPriority::Interactive, record("other"));
+        QFuture<std::string> second = scheduler.scheduleCoalesced("Store", DatabaseTaskPriority::Interactive, "session", record("session-2"));
+        QFuture<std::string> icon = scheduler.scheduleCoalesced("Store", DatabaseTaskPriority::Interactive, "icon", record("icon"));
+        QFuture<std::string> latest = scheduler.scheduleCoalesced("Store", DatabaseTaskPriority::Interactive, "session", record("session-3"));
+
+        scheduler.run();
+        scheduler.stop();
+
+        const std::vector<std::string> expected { "session-3", "other", "icon" };
+        QVERIFY(executed == expected);
+
+        QVERIFY(first.isCanceled());
+        QVERIFY(second.isCanceled());
+        QCOMPARE(latest.result(), std::string("session-3"));
+        QCOMPARE(icon.result(), std::string("icon"));
+        QCOMPARE(scheduler.getLaneMetrics("Store", DatabaseTaskPriority::Interactive).TasksCoalesced, uint64_t{2});
+    }
+
+    /// Verifies that a task with the same key as a task that has already started is queued separately
+    void testCoalescingAfterTaskStarted()
+    {
+        DatabaseTaskScheduler scheduler;
+        addEmptyWorker(scheduler, "Store");
+        scheduler.run();
+
+        std::promise<void> gate;
+        std::shared_future<void> gateFuture = gate.get_future().share();
+        std::atomic_int executedCount { 0 };
+
+        QFuture<void> running = scheduler.scheduleCoalesced("Store", DatabaseTaskPriority::Interactive, "session", [&, gateFuture](){
+            ++executedCount;
+            gateFuture.wait();
+        });
+        QTRY_COMPARE(executedCount.load(), 1);
+
+        QFuture<void> queued = scheduler.scheduleCoalesced("Store", DatabaseTaskPriority::Interactive, "session", [&executedCount](){
+            ++executedCount;
+        });
+
+        gate.set_value();
+        scheduler.stop();
+
+        QCOMPARE(executedCount.load(), 2);
+        QVERIFY(!running.isCanceled());
+        QVERIFY(!queued.isCanceled());
+    }
+
+    /// Verifies that an exception thrown by a task is stored in its future
+    void testExceptionIsPropagated()
+    {
+        DatabaseTaskScheduler scheduler;
+        addEmptyWorker(scheduler, "Store");
+
+        QFuture<int> future = scheduler.schedule("Store", DatabaseTaskPriority::Interactive, []() -> int {
+            throw std::runtime_error("query failed");
+        });
+
+        scheduler.run();
+        scheduler.stop();
+
+        bool caught = false;
+        try
+        {
+            future.result();
+        }
+        catch (const std::runtime_error &)
+        {
+            caught = true;
+        }
+        QVERIFY(caught);
+    }
+};
+
+QTEST_GUILESS_MAIN(DatabaseTaskSchedulerTest)
+
+#include "DatabaseTaskSchedulerTest.moc"
@@ -0,0 +1,186 @@
+#include "StartupTaskGraph.h"
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <QObject>
+#include <QTest>
+
+/// Test cases for the \ref StartupTaskGraph class
+class StartupTaskGraphTest : public QObject
+{
+    Q_OBJECT
+
+public:
+    StartupTaskGraphTest() : QObject(nullptr) {}
+
+private slots:
+    /// Verifies that a task only starts once all of its dependencies are complete, regardless of their threads
+    void testDependenciesRunFirst()
+    {
+        std::mutex orderMutex;
+        std::vector<std::string> order;
+        auto record = [&orderMutex, &order](const std::string &name) {
+            return [&orderMutex, &order, name](){
+                std::lock_guard<std::mutex> lock{orderMutex};
+                order.push_back(name);
+            };
+        };
+
+        StartupTaskGraph graph;
+        QVERIFY(graph.addTask("Window", StartupThread::Main, { "Icons", "Bookmarks" }, record("Window")));
+        QVERIFY(graph.addTask("Bookmarks", StartupThread::Main, { "Settings", "Icons" }, record("Bookmarks")));
+        QVERIFY(graph.addTask("Icons", StartupThread::Worker, { "Settings" }, record("Icons")));
+        QVERIFY(graph.addTask("Settings", StartupThread::Main, {}, record("Settings")));
+
+        graph.waitFor("Window");
+        QVERIFY(graph.isFinished("Window"));
+        QVERIFY(graph.isFinished());
+
+        const std::vector<std::string> expected { "Settings", "Icons", "Bookmarks", "Window" };
+        QCOMPARE(order, expected);
+    }
+
+    /// Verifies that main thread tasks run on the waiting thread, and worker tasks on other threads
+    void testTasksRunOnTheirThread()
+    {
+        const std::thread::id mainThreadId = std::this_thread::get_id();
+        std::thread::id mainTaskThreadId, workerTaskThreadId;
+
+        StartupTaskGraph graph;
+        graph.addTask("Main", StartupThread::Main, {}, [&mainTaskThreadId](){ mainTaskThreadId = std::this_thread::get_id(); });
+        graph.addTask("Worker", StartupThread::Worker, {}, [&workerTaskThreadId](){ workerTaskThreadId = std::this_thread::get_id(); });
+        graph.waitForAll();
+
+        QVERIFY(mainTaskThreadId == mainThreadId);
+        QVERIFY(workerTaskThreadId != mainThreadId);
+    }
+
+    /// Verifies that independent tasks are executed at the same time, by making each of them
+    /// wait until the others have started
+    void testIndependentTasksRunConcurrently()
+    {
+        std::atomic_int numStarted { 0 };
+        std::atomic_int numOverlapping { 0 };
+        auto rendezvous = [&numStarted, &numOverlapping](){
+            ++numStarted;
+            const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+            while (numStarted.load() < 3 && std::chrono::steady_clock::now() < deadline)
+                std::this_thread::yield();
+            if (numStarted.load() == 3)
+                ++numOverlapping;
+        };
+
+        StartupTaskGraph graph;
+        graph.addTask("First", StartupThread::Worker, {}, rendezvous);
+        graph.addTask("Second", StartupThread::Worker, {}, rendezvous);
+        graph.addTask("Third", StartupThread::Main, {}, rendezvous);
+        graph.waitForAll();
+
+        // The pool may have fewer threads than worker tasks on a single core machine
+        if (std::thread::hardware_concurrency() >= 2)
+            QCOMPARE(numOverlapping.load(), 3);
+        QVERIFY(graph.isFinished());
+    }
+
+    /// Verifies that waiting on a task does not execute main thread tasks it does not depend on
+    void testWaitForSkipsUnrelatedMainTasks()
+    {
+        bool unrelatedExecuted = false;
+
+        StartupTaskGraph graph;
+        graph.addTask("Settings", StartupThread::Main, {}, [](){});
+        graph.addTask("Window", StartupThread::Main, { "Settings" }, [](){});
+        graph.addTask("Plugins", StartupThread::Main, {}, [&unrelatedExecuted](){ unrelatedExecuted = true; });
+
+        graph.waitFor("Window");
+        QVERIFY(graph.isFinished("Window"));
+        QVERIFY(!unrelatedExecuted);
+        QVERIFY(!graph.isFinished());
+
+        graph.waitForAll();
+        QVERIFY(unrelatedExecuted);
+    }
+
+    /// Verifies that a worker task that is not awaited keeps running in the background, and is
+    /// awaited by the destructor of the graph
+    void testWorkerTasksContinueInBackground()
+    {
+        std::promise<void> gate;
+        std::shared_future<void> gateFuture = gate.get_future().share();
+        std::atomic_bool backgroundFinished { false };
+
+        {
+            StartupTaskGraph graph;
+            graph.addTask("Window", StartupThread::Main, {}, [](){});
+            graph.addTask("Filters", StartupThread::Worker, {}, [&backgroundFinished, gateFuture](){
+                gateFuture.wait();
+                backgroundFinished = true;
+            });
+
+            graph.waitFor("Window");
+            QVERIFY(!graph.isFinished("Filters"));
+
+            gate.set_value();
+        }
+
+        QVERIFY(backgroundFinished);
+    }
+
+    /// Verifies that duplicate names, unknown dependencies and cycles are rejected
+    void testInvalidGraphsAreRejected()
+    {
+        StartupTaskGraph duplicates;
+        QVERIFY(duplicates.addTask("Settings", StartupThread::Main, {}, [](){}));
+        QVERIFY(!duplicates.addTask("Settings", StartupThread::Worker, {}, [](){}));
+
+        bool executed = false;
+        StartupTaskGraph unknown;
+        unknown.addTask("Window", StartupThread::Main, { "Missing" }, [&executed](){ executed = true; });
+        QVERIFY(!unknown.start());
+        unknown.waitForAll();
+        QVERIFY(!executed);
+
+        StartupTaskGraph cycle;
+        cycle.addTask("First", StartupThread::Main, { "Third" }, [&executed](){ executed = true; });
+        cycle.addTask("Second", StartupThread::Worker, { "First" }, [&executed](){ executed = true; });
+        cycle.addTask("Third", StartupThread::Main, { "Second" }, [&executed](){ executed = true; });
+        QVERIFY(!cycle.start());
+        QVERIFY(!executed);
+
+        StartupTaskGraph started;
+        QVERIFY(started.start());
+        QVERIFY(!started.addTask("Late", StartupThread::Main, {}, [](){}));
+    }
+
+    /// Verifies that every completed task has a timing entry, in order of completion
+    void testTimingsAreRecorded()
+    {
+        StartupTaskGraph graph;
+        graph.addTask("Settings", StartupThread::Main, {}, [](){});
+        graph.addTask("History", StartupThread::Worker, { "Settings" }, [](){
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        });
+        graph.addTask("Window", StartupThread::Main, { "History" }, [](){});
+        graph.waitForAll();
+
+        const std::vector<StartupTaskTiming> timings = graph.getTimings();
+        QCOMPARE(timings.size(), size_t{3});
+        QCOMPARE(timings.at(0).Name, std::string("Settings"));
+        QCOMPARE(timings.at(1).Name, std::string("History"));
+        QCOMPARE(timings.at(2).Name, std::string("Window"));
+        QVERIFY(timings.at(1).Thread == StartupThread::Worker);
+        QVERIFY(timings.at(1).getDuration() >= std::chrono::milliseconds(20));
+        QVERIFY(timings.at(2).StartTime >= timings.at(1).EndTime);
+        QVERIFY(graph.getElapsedTime() >= timings.at(2).EndTime);
+    }
+};
+
+QTEST_GUILESS_MAIN(StartupTaskGraphTest)
+
+#include "StartupTaskGraphTest.moc"
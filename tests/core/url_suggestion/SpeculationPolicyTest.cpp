@@ -0,0 +1,150 @@
+#include "SpeculationPolicy.h"
+#include "URLSuggestion.h"
+
+#include <chrono>
+#include <vector>
+
+#include <QDateTime>
+#include <QObject>
+#include <QTest>
+
+using namespace std::chrono_literals;
+
+/// Test cases for the \ref SpeculationPolicy class, driven by a fake clock
+class SpeculationPolicyTest : public QObject
+{
+    Q_OBJECT
+
+public:
+    SpeculationPolicyTest() :
+        QObject(nullptr),
+        m_now(0)
+    {
+    }
+
+private:
+    /// Returns a policy that reads the fake clock of the test
+    SpeculationPolicy makePolicy()
+    {
+        return SpeculationPolicy([this](){ return m_now; });
+    }
+
+    /// Returns a suggestion for a URL, visited and typed the given number of times, last visited some days ago
+    URLSuggestion makeSuggestion(const QString &url, int visitCount, int typedCount, int daysSinceVisit)
+    {
+        URLSuggestion suggestion;
+        suggestion.URL = url;
+        suggestion.Title = url;
+        suggestion.LastVisit = QDateTime::currentDateTime().addDays(-daysSinceVisit);
+        suggestion.URLTypedCount = typedCount;
+        suggestion.VisitCount = visitCount;
+        suggestion.PercentMatch = 0;
+        suggestion.IsHostMatch = true;
+        suggestion.IsBookmark = false;
+        suggestion.Type = MatchType::URL;
+        suggestion.HistoryId = 1;
+        return suggestion;
+    }
+
+private Q_SLOTS:
+    /// Verifies that confidence grows with the part of the host typed, and is zero when the input is not a
+    /// prefix of the host
+    void testConfidenceFollowsInput()
+    {
+        const std::vector<URLSuggestion> suggestions { makeSuggestion(QStringLiteral("https://www.github.com/"), 100, 20, 1) };
+        const QDateTime now = QDateTime::currentDateTime();
+
+        const double shortInput = SpeculationPolicy::getConfidence(QStringLiteral("gi"), suggestions, now);
+        const double longInput = SpeculationPolicy::getConfidence(QStringLiteral("github.c"), suggestions, now);
+        QVERIFY(shortInput > 0.0);
+        QVERIFY(longInput > shortInput);
+        QVERIFY(longInput <= 1.0);
+
+        QCOMPARE(SpeculationPolicy::getConfidence(QStringLiteral("hub"), suggestions, now), 0.0);
+        QCOMPARE(SpeculationPolicy::getConfidence(QStringLiteral("g"), suggestions, now), 0.0);
+    }
+
+    /// Verifies that rarely and long ago visited sites, or sites with a close rival, are less likely
+    void testConfidenceFollowsFrecency()
+    {
+        const QDateTime now = QDateTime::currentDateTime();
+        const QString input = QStringLiteral("example");
+
+        const double frequent = SpeculationPolicy::getConfidence(input, { makeSuggestion(QStringLiteral("https://example.com/"), 100, 10, 1) }, now);
+        const double rare = SpeculationPolicy::getConfidence(input, { makeSuggestion(QStringLiteral("https://example.com/"), 2, 0, 1) }, now);
+        const double old = SpeculationPolicy::getConfidence(input, { makeSuggestion(QStringLiteral("https://example.com/"), 100, 10, 200) }, now);
+        const double rivalled = SpeculationPolicy::getConfidence(input, {
+            makeSuggestion(QStringLiteral("https://example.com/"), 100, 10, 1),
+            makeSuggestion(QStringLiteral("https://example.org/"), 100, 10, 1)
+        }, now);
+
+        QVERIFY(frequent > rare);
+        QVERIFY(frequent > old);
+        QVERIFY(frequent > rivalled);
+    }
+
+    /// Verifies that preconnections are made above their threshold, and prerendering only when it is enabled and
+    /// above its own threshold
+    void testThresholds()
+    {
+        const std::vector<URLSuggestion> suggestions { makeSuggestion(QStringLiteral("https://example.com/"), 100, 10, 1) };
+        const double confidence = SpeculationPolicy::getConfidence(QStringLiteral("example.c"), suggestions, QDateTime::currentDateTime());
+
+        SpeculationPolicy policy = makePolicy();
+        policy.setThresholds(confidence + 0.01, 1.0);
+        QVERIFY(policy.evaluate(QStringLiteral("example.c"), suggestions).Kind == SpeculationPolicy::Action::None);
+
+        policy.setThresholds(confidence - 0.01, confidence - 0.01);
+        SpeculationPolicy::Decision decision = policy.evaluate(QStringLiteral("example.c"), suggestions);
+        QVERIFY(decision.Kind == SpeculationPolicy::Action::Preconnect);
+        QCOMPARE(decision.Url, QUrl(QStringLiteral("https://example.com/")));
+
+        policy.setPrerenderEnabled(true);
+        policy.reset();
+        QVERIFY(policy.evaluate(QStringLiteral("example.c"), suggestions).Kind == SpeculationPolicy::Action::Prerender);
+    }
+
+    /// Verifies that the same site is not speculated on twice in a row, and that each action has its budget per
+    /// minute
+    void testBudgetsAndRepeats()
+    {
+        SpeculationPolicy policy = makePolicy();
+        policy.setThresholds(0.0, 1.0);
+        policy.setBudgets(2, 0);
+
+        const std::vector<URLSuggestion> first { makeSuggestion(QStringLiteral("https://first.com/"), 100, 10, 1) };
+        const std::vector<URLSuggestion> second { makeSuggestion(QStringLiteral("https://second.com/"), 100, 10, 1) };
+        const std::vector<URLSuggestion> third { makeSuggestion(QStringLiteral("https://third.com/"), 100, 10, 1) };
+
+        QVERIFY(policy.evaluate(QStringLiteral("first"), first).Kind == SpeculationPolicy::Action::Preconnect);
+        QVERIFY(policy.evaluate(QStringLiteral("first.c"), first).Kind == SpeculationPolicy::Action::None);
+        QVERIFY(policy.evaluate(QStringLiteral("second"), second).Kind == SpeculationPolicy::Action::Preconnect);
+
+        // The budget of two connections per minute is used up
+        QVERIFY(policy.evaluate(QStringLiteral("third"), third).Kind == SpeculationPolicy::Action::None);
+
+        m_now += 61s;
+        QVERIFY(policy.evaluate(QStringLiteral("third"), third).Kind == SpeculationPolicy::Action::Preconnect);
+
+        // The same site can only be connected to again after a while
+        m_now += 5s;
+        QVERIFY(policy.evaluate(QStringLiteral("third"), third).Kind == SpeculationPolicy::Action::None);
+        m_now += 6s;
+        QVERIFY(policy.evaluate(QStringLiteral("third"), third).Kind == SpeculationPolicy::Action::Preconnect);
+    }
+
+    /// Verifies that nothing is done when speculation is disabled
+    void testDisabled()
+    {
+        SpeculationPolicy policy = makePolicy();
+        policy.setThresholds(0.0, 0.0);
+        policy.setPreconnectEnabled(false);
+
+        const std::vector<URLSuggestion> suggestions { makeSuggestion(QStringLiteral("https://example.com/"), 100, 10, 1) };
+        QVERIFY(policy.evaluate(QStringLiteral("example"), suggestions).Kind == SpeculationPolicy::Action::None);
+    }
+};
+
+QTEST_APPLESS_MAIN(SpeculationPolicyTest)
+
+#include "SpeculationPolicyTest.moc"
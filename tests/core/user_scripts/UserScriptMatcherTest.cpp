@@ -0,0 +1,156 @@
+#include "UserScriptMatcher.h"
+
+#include <vector>
+
+#include <QObject>
+#include <QTest>
+#include <QUrl>
+
+/// Test cases for the \ref UserScriptMatcher class
+class UserScriptMatcherTest : public QObject
+{
+    Q_OBJECT
+
+public:
+    UserScriptMatcherTest() :
+        QObject(nullptr)
+    {
+    }
+
+private:
+    /// Returns the indices of the scripts that apply to the given URL
+    std::vector<int> match(UserScriptMatcher &matcher, const QString &url)
+    {
+        return matcher.match(QUrl(url)).Scripts;
+    }
+
+private Q_SLOTS:
+    /// Verifies that an @include rule naming a host applies to that host only, and does not depend on the path
+    void testExactHost()
+    {
+        UserScriptMatcher matcher;
+        matcher.addScript(0, { QStringLiteral("https://example.com/*") }, {}, {});
+
+        const UserScriptMatcher::Result result = matcher.match(QUrl(QStringLiteral("https://example.com/page?q=1")));
+        QCOMPARE(result.Scripts, std::vector<int>({ 0 }));
+        QVERIFY(!result.DependsOnPath);
+
+        QVERIFY(match(matcher, QStringLiteral("https://www.example.com/")).empty());
+        QVERIFY(match(matcher, QStringLiteral("https://other.com/?u=https://example.com/")).empty());
+        QVERIFY(match(matcher, QStringLiteral("http://example.com/")).empty());
+        QVERIFY(match(matcher, QStringLiteral("https://example.com:8443/")).empty());
+        QCOMPARE(matcher.getResidueSize(), std::size_t{0});
+    }
+
+    /// Verifies that a wildcard suffix applies to subdomains, and to the domain itself only for @match rules
+    void testWildcardSuffix()
+    {
+        UserScriptMatcher matcher;
+        matcher.addScript(0, { QStringLiteral("http*://*.example.com/*") }, {}, {});
+        matcher.addScript(1, {}, {}, { QStringLiteral("*://*.example.com/*") });
+
+        QCOMPARE(match(matcher, QStringLiteral("https://a.b.example.com/")), std::vector<int>({ 0, 1 }));
+        QCOMPARE(match(matcher, QStringLiteral("http://example.com/")), std::vector<int>({ 1 }));
+        QVERIFY(match(matcher, QStringLiteral("https://notexample.com/")).empty());
+        QVERIFY(match(matcher, QStringLiteral("ftp://www.example.com/")).empty());
+    }
+
+    /// Verifies that catch-all rules, and scripts without any rule, apply to every URL
+    void testCatchAll()
+    {
+        UserScriptMatcher matcher;
+        matcher.addScript(0, { QStringLiteral("*") }, {}, {});
+        matcher.addScript(1, {}, {}, {});
+        matcher.addScript(2, {}, {}, { QStringLiteral("<all_urls>") });
+
+        const UserScriptMatcher::Result result = matcher.match(QUrl(QStringLiteral("https://anything.org/path")));
+        QCOMPARE(result.Scripts, std::vector<int>({ 0, 1, 2 }));
+        QVERIFY(!result.DependsOnPath);
+    }
+
+    /// Verifies that @exclude rules take precedence over @include rules
+    void testExclude()
+    {
+        UserScriptMatcher matcher;
+        matcher.addScript(0, { QStringLiteral("*") }, { QStringLiteral("https://*.bank.com/*") }, {});
+        matcher.addScript(1, { QStringLiteral("*") }, { QStringLiteral("https://example.com/private/*") }, {});
+
+        QCOMPARE(match(matcher, QStringLiteral("https://www.bank.com/")), std::vector<int>({ 1 }));
+        QCOMPARE(match(matcher, QStringLiteral("https://example.com/private/page")), std::vector<int>({ 0 }));
+        QCOMPARE(match(matcher, QStringLiteral("https://example.com/public/page")), std::vector<int>({ 0, 1 }));
+    }
+
+    /// Verifies that the paths of @include rules are prefixes, while the paths of @match rules are whole paths
+    void testPaths()
+    {
+        UserScriptMatcher matcher;
+        matcher.addScript(0, { QStringLiteral("https://example.com/docs") }, {}, {});
+        matcher.addScript(1, {}, {}, { QStringLiteral("https://example.com/docs/*.html") });
+
+        const UserScriptMatcher::Result result = matcher.match(QUrl(QStringLiteral("https://example.com/docs/index.html")));
+        QCOMPARE(result.Scripts, std::vector<int>({ 0, 1 }));
+        QCOMPARE(result.PathDependentScripts, std::vector<int>({ 0, 1 }));
+        QVERIFY(result.DependsOnPath);
+
+        QCOMPARE(match(matcher, QStringLiteral("https://example.com/docs/index.html.bak")), std::vector<int>({ 0 }));
+        QVERIFY(match(matcher, QStringLiteral("https://example.com/blog/docs")).empty());
+    }
+
+    /// Verifies that rules whose host cannot be indexed are matched as regular expressions against the whole URL
+    void testResidue()
+    {
+        UserScriptMatcher matcher;
+        matcher.addScript(0, { QStringLiteral("/xample\\.com/") }, {}, {});
+        matcher.addScript(1, { QStringLiteral("https://ex*ple.com/*") }, {}, {});
+        QCOMPARE(matcher.getResidueSize(), std::size_t{2});
+
+        const UserScriptMatcher::Result result = matcher.match(QUrl(QStringLiteral("https://example.com/")));
+        QCOMPARE(result.Scripts, std::vector<int>({ 0, 1 }));
+        QCOMPARE(result.PathDependentScripts, std::vector<int>({ 0, 1 }));
+        QVERIFY(result.DependsOnPath);
+
+        // The expression is used as written, without its slashes, so the dot only matches a dot
+        QVERIFY(match(matcher, QStringLiteral("https://examplexcom.org/")).empty());
+        QVERIFY(match(matcher, QStringLiteral("https://other.com/")).empty());
+    }
+
+    /// Verifies that only the scripts with rules matched against more than the origin are reported as depending
+    /// on the path, so that the other scripts can be cached by origin
+    void testPathDependentScripts()
+    {
+        UserScriptMatcher matcher;
+        matcher.addScript(0, { QStringLiteral("/\\/private\\//") }, {}, {});
+        matcher.addScript(1, { QStringLiteral("https://example.com/*") }, {}, {});
+        matcher.addScript(2, { QStringLiteral("https://example.com/docs") }, {}, {});
+        matcher.addScript(3, { QStringLiteral("https://other.com/*") }, {}, {});
+
+        UserScriptMatcher::Result result = matcher.match(QUrl(QStringLiteral("https://example.com/docs/private/")));
+        QCOMPARE(result.Scripts, std::vector<int>({ 0, 1, 2 }));
+        QCOMPARE(result.PathDependentScripts, std::vector<int>({ 0, 2 }));
+        QVERIFY(result.DependsOnPath);
+
+        result = matcher.match(QUrl(QStringLiteral("https://other.com/")));
+        QCOMPARE(result.Scripts, std::vector<int>({ 3 }));
+        QVERIFY(result.PathDependentScripts.empty());
+        QVERIFY(result.DependsOnPath);
+    }
+
+    /// Verifies that clearing the matcher removes its rules and its cached origins
+    void testClear()
+    {
+        UserScriptMatcher matcher;
+        matcher.addScript(0, { QStringLiteral("https://example.com/*") }, {}, {});
+        QCOMPARE(match(matcher, QStringLiteral("https://example.com/")), std::vector<int>({ 0 }));
+
+        matcher.clear();
+        QVERIFY(match(matcher, QStringLiteral("https://example.com/")).empty());
+
+        matcher.addScript(0, { QStringLiteral("https://other.com/*") }, {}, {});
+        QVERIFY(match(matcher, QStringLiteral("https://example.com/")).empty());
+        QCOMPARE(match(matcher, QStringLiteral("https://other.com/")), std::vector<int>({ 0 }));
+    }
+};
+
+QTEST_APPLESS_MAIN(UserScriptMatcherTest)
+
+#include "UserScriptMatcherTest.moc"
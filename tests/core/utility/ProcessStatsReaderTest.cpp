@@ -0,0 +1,76 @@
+#include "ProcessStatsReader.h"
+
+#include <QDir>
+#include <QFile>
+#include <QObject>
+#include <QTemporaryDir>
+#include <QTest>
+
+/// Test cases for the \ref ProcessStatsReader class, reading a fake proc filesystem
+class ProcessStatsReaderTest : public QObject
+{
+    Q_OBJECT
+
+private:
+    /// Writes a file of a fake process into the temporary proc directory
+    void writeProcFile(int pid, const QString &name, const QByteArray &contents)
+    {
+        QDir(m_procDir.path()).mkpath(QString::number(pid));
+
+        QFile file(QStringLiteral("%1/%2/%3").arg(m_procDir.path()).arg(pid).arg(name));
+        QVERIFY(file.open(QIODevice::WriteOnly | QIODevice::Truncate));
+        file.write(contents);
+    }
+
+private Q_SLOTS:
+    /// Verifies that the resident set size is read from statm, in pages
+    void testReadsResidentMemory()
+    {
+        writeProcFile(100, QStringLiteral("statm"), "51200 2560 1024 10 0 4096 0\n");
+
+        ProcessStatsReader reader(m_procDir.path());
+        QCOMPARE(reader.read(100, false).ResidentKiB, 2560 * reader.getPageSizeKiB());
+    }
+
+    /// Verifies that the CPU time is found after process names containing spaces and parentheses
+    void testReadsCpuTicksAfterProcessName()
+    {
+        writeProcFile(101, QStringLiteral("stat"),
+                      "101 (QtWebEngine (render) Process) S 1 101 101 0 -1 4194560 9000 0 0 0 350 75 0 0 20 0 12 0\n");
+
+        ProcessStatsReader reader(m_procDir.path());
+        QCOMPARE(reader.read(101, false).CpuTicks, int64_t{425});
+    }
+
+    /// Verifies that the proportional set size is only read when it is asked for
+    void testReadsProportionalMemoryOnRequest()
+    {
+        writeProcFile(102, QStringLiteral("smaps_rollup"),
+                      "00400000-7fff0000 ---p 00000000 00:00 0    [rollup]\n"
+                      "Rss:               90000 kB\n"
+                      "Pss:               61234 kB\n"
+                      "Pss_Anon:          40000 kB\n");
+
+        ProcessStatsReader reader(m_procDir.path());
+        QCOMPARE(reader.read(102, false).ProportionalKiB, int64_t{-1});
+        QCOMPARE(reader.read(102, true).ProportionalKiB, int64_t{61234});
+    }
+
+    /// Verifies that the usage of a process that does not exist is unknown
+    void testMissingProcessIsUnknown()
+    {
+        ProcessStatsReader reader(m_procDir.path());
+        const ProcessStats stats = reader.read(4242, true);
+        QCOMPARE(stats.ResidentKiB, int64_t{-1});
+        QCOMPARE(stats.ProportionalKiB, int64_t{-1});
+        QCOMPARE(stats.CpuTicks, int64_t{-1});
+    }
+
+private:
+    /// Fake proc filesystem
+    QTemporaryDir m_procDir;
+};
+
+QTEST_APPLESS_MAIN(ProcessStatsReaderTest)
+
+#include "ProcessStatsReaderTest.moc"
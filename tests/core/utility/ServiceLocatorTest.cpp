@@ -0,0 +1,177 @@
+#include "ServiceLocator.h"
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <QObject>
+#include <QTest>
+
+/// Test cases for the \ref ServiceLocator class
+class ServiceLocatorTest : public QObject
+{
+    Q_OBJECT
+
+public:
+    ServiceLocatorTest() : QObject(nullptr) {}
+
+private slots:
+    /// Verifies that services registered as instances are returned as-is, and that keys are unique
+    void testAddService()
+    {
+        ViperServiceLocator locator;
+        QObject service(nullptr);
+
+        QVERIFY(locator.addService("Service", &service));
+        QVERIFY(!locator.addService("Service", &service));
+        QVERIFY(!locator.addFactory("Service", [](){ return nullptr; }));
+
+        QCOMPARE(locator.getService("Service"), &service);
+        QCOMPARE(locator.getServiceAs<QObject>("Service"), &service);
+        QVERIFY(locator.getService("Unknown") == nullptr);
+        QVERIFY(locator.isCreated("Service"));
+        QVERIFY(!locator.isCreated("Unknown"));
+    }
+
+    /// Verifies that a service registered with a factory is only constructed when it is first looked up
+    void testFactoryIsInvokedOnFirstLookup()
+    {
+        ViperServiceLocator locator;
+        std::unique_ptr<QObject> service;
+        int numCalls = 0;
+
+        QVERIFY(locator.addFactory("Lazy", [&](){
+            ++numCalls;
+            service = std::make_unique<QObject>(nullptr);
+            return service.get();
+        }));
+        QVERIFY(!locator.addService("Lazy", nullptr));
+
+        QCOMPARE(numCalls, 0);
+        QVERIFY(!locator.isCreated("Lazy"));
+
+        QObject *first = locator.getService("Lazy");
+        QVERIFY(first != nullptr);
+        QCOMPARE(first, service.get());
+        QCOMPARE(locator.getService("Lazy"), first);
+        QCOMPARE(numCalls, 1);
+        QVERIFY(locator.isCreated("Lazy"));
+    }
+
+    /// Verifies that a factory which refuses to construct its service is invoked again by the next lookup
+    void testRefusedFactoryIsRetried()
+    {
+        ViperServiceLocator locator;
+        QObject service(nullptr);
+        bool canCreate = false;
+        int numCalls = 0;
+
+        QVERIFY(locator.addFactory("Lazy", [&]() -> QObject* {
+            ++numCalls;
+            return canCreate ? &service : nullptr;
+        }));
+
+        QVERIFY(locator.getService("Lazy") == nullptr);
+        QVERIFY(!locator.isCreated("Lazy"));
+
+        canCreate = true;
+        QCOMPARE(locator.getService("Lazy"), &service);
+        QCOMPARE(locator.getService("Lazy"), &service);
+        QCOMPARE(numCalls, 2);
+        QVERIFY(locator.isCreated("Lazy"));
+    }
+
+    /// Verifies that a factory may look up the services it depends on
+    void testFactoryCanLookUpDependencies()
+    {
+        ViperServiceLocator locator;
+        QObject dependency(nullptr), service(nullptr);
+        QObject *dependencySeen = nullptr;
+
+        QVERIFY(locator.addFactory("Service", [&](){
+            dependencySeen = locator.getService("Dependency");
+            return &service;
+        }));
+        QVERIFY(locator.addFactory("Dependency", [&](){ return &dependency; }));
+
+        QCOMPARE(locator.getService("Service"), &service);
+        QCOMPARE(dependencySeen, &dependency);
+        QVERIFY(locator.isCreated("Dependency"));
+    }
+
+    /// Verifies that a factory is invoked exactly once when several threads look up its service at the same time
+    void testConcurrentLookupsConstructOnce()
+    {
+        ViperServiceLocator locator;
+        QObject service(nullptr);
+        std::atomic_int numCalls { 0 };
+
+        QVERIFY(locator.addFactory("Shared", [&](){
+            ++numCalls;
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            return &service;
+        }));
+
+        constexpr int numThreads = 8;
+        std::atomic_bool go { false };
+        std::vector<QObject*> results(numThreads, nullptr);
+        std::vector<std::thread> threads;
+        for (int i = 0; i < numThreads; ++i)
+        {
+            threads.emplace_back([&, i](){
+                while (!go.load())
+                    std::this_thread::yield();
+                results[i] = locator.getService("Shared");
+            });
+        }
+
+        go.store(true);
+        for (std::thread &thread : threads)
+            thread.join();
+
+        QCOMPARE(numCalls.load(), 1);
+        for (QObject *result : results)
+            QCOMPARE(result, &service);
+    }
+
+    /// Verifies that the creation report lists every service in registration order, with the time spent in each factory
+    void testCreationReport()
+    {
+        ViperServiceLocator locator;
+        QObject eager(nullptr), used(nullptr), unused(nullptr);
+
+        QVERIFY(locator.addService("Eager", &eager));
+        QVERIFY(locator.addFactory("Used", [&](){
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+            return &used;
+        }));
+        QVERIFY(locator.addFactory("Unused", [&](){ return &unused; }));
+
+        QCOMPARE(locator.getService("Used"), &used);
+
+        const std::vector<ViperServiceLocator::CreationRecord> report = locator.getCreationReport();
+        QCOMPARE(report.size(), size_t{3});
+
+        QCOMPARE(report[0].Key, std::string("Eager"));
+        QVERIFY(!report[0].IsLazy);
+        QVERIFY(report[0].IsCreated);
+        QVERIFY(report[0].Duration.count() == 0);
+
+        QCOMPARE(report[1].Key, std::string("Used"));
+        QVERIFY(report[1].IsLazy);
+        QVERIFY(report[1].IsCreated);
+        QVERIFY(report[1].Duration >= std::chrono::milliseconds(5));
+        QVERIFY(report[1].CreatedAt >= report[0].CreatedAt);
+
+        QCOMPARE(report[2].Key, std::string("Unused"));
+        QVERIFY(report[2].IsLazy);
+        QVERIFY(!report[2].IsCreated);
+    }
+};
+
+QTEST_APPLESS_MAIN(ServiceLocatorTest)
+
+#include "ServiceLocatorTest.moc"
@@ -0,0 +1,219 @@
+#include "Tracer.h"
+
+#include <chrono>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <QByteArray>
+#include <QDebug>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QObject>
+#include <QSet>
+#include <QString>
+#include <QTest>
+
+/// Test cases for the \ref Tracer and \ref TraceSpan classes
+class TracerTest : public QObject
+{
+    Q_OBJECT
+
+public:
+    TracerTest() : QObject(nullptr), m_traceFile(QLatin1String("TracerTest.json")) {}
+
+private:
+    /// Returns the trace events written by the tracer, after verifying that the document is valid JSON
+    QJsonArray getTraceEvents()
+    {
+        std::ostringstream stream;
+        Tracer::instance().write(stream);
+
+        QJsonParseError error;
+        const QJsonDocument document = QJsonDocument::fromJson(QByteArray::fromStdString(stream.str()), &error);
+        if (error.error != QJsonParseError::NoError)
+            qWarning() << "Invalid trace:" << error.errorString();
+
+        return document.object().value(QLatin1String("traceEvents")).toArray();
+    }
+
+    /// Returns the first event with the given name and phase, or an empty object if there is none
+    QJsonObject findEvent(const QJsonArray &events, const QString &name, const QString &phase)
+    {
+        for (const QJsonValue &value : events)
+        {
+            const QJsonObject event = value.toObject();
+            if (event.value(QLatin1String("name")).toString() == name
+                    && event.value(QLatin1String("ph")).toString() == phase)
+                return event;
+        }
+        return QJsonObject();
+    }
+
+private slots:
+    void cleanup()
+    {
+        Tracer::instance().stop();
+        if (QFile::exists(m_traceFile))
+            QFile::remove(m_traceFile);
+    }
+
+    /// Verifies that nothing is recorded while tracing is disabled
+    void testDisabledTracerRecordsNothing()
+    {
+        Tracer &tracer = Tracer::instance();
+        tracer.start(m_traceFile.toStdString());
+        QVERIFY(tracer.stop());
+        QVERIFY(!Tracer::isEnabled());
+
+        {
+            VIPER_TRACE_SCOPE("test", "Span");
+        }
+        TraceSpan span("test", "Inactive");
+        QVERIFY(!span.isActive());
+
+        tracer.setCounter("test", "Counter", 1);
+        tracer.addInstantEvent("test", "Instant");
+        tracer.beginAsyncSpan("test", "Async", 1);
+        tracer.endAsyncSpan("test", "Async", 1);
+
+        QCOMPARE(tracer.getNumEvents(), size_t{0});
+        QVERIFY(!tracer.stop());
+    }
+
+    /// Verifies that each kind of event is written with the fields expected by trace viewers
+    void testEventsAreWrittenAsTraceEvents()
+    {
+        Tracer &tracer = Tracer::instance();
+        tracer.start(m_traceFile.toStdString());
+        tracer.setThreadName("Main");
+
+        {
+            TraceSpan span("startup", "LoadHistory");
+            QVERIFY(span.isActive());
+            span.setDetail("History.db \"quoted\"\n");
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        }
+        tracer.setCounter("adblock", "Filters", 1234);
+        tracer.addInstantEvent("navigation", "AcceptNavigation", "https://example.com/");
+        tracer.beginAsyncSpan("navigation", "PageLoad", 0xabc, "https://example.com/");
+        tracer.endAsyncSpan("navigation", "PageLoad", 0xabc);
+
+        QCOMPARE(tracer.getNumEvents(), size_t{5});
+
+        const QJsonArray events = getTraceEvents();
+        QVERIFY(!events.isEmpty());
+
+        const QJsonObject threadName = findEvent(events, QLatin1String("thread_name"), QLatin1String("M"));
+        QCOMPARE(threadName.value(QLatin1String("args")).toObject().value(QLatin1String("name")).toString(), QLatin1String("Main"));
+
+        const QJsonObject span = findEvent(events, QLatin1String("LoadHistory"), QLatin1String("X"));
+        QCOMPARE(span.value(QLatin1String("cat")).toString(), QLatin1String("startup"));
+        QVERIFY(span.value(QLatin1String("dur")).toDouble() >= 2000.0);
+        QCOMPARE(span.value(QLatin1String("tid")).toInt(), threadName.value(QLatin1String("tid")).toInt());
+        QCOMPARE(span.value(QLatin1String("args")).toObject().value(QLatin1String("detail")).toString(), QLatin1String("History.db \"quoted\"\n"));
+
+        const QJsonObject counter = findEvent(events, QLatin1String("Filters"), QLatin1String("C"));
+        QCOMPARE(counter.value(QLatin1String("args")).toObject().value(QLatin1String("value")).toInt(), 1234);
+
+        const QJsonObject instant = findEvent(events, QLatin1String("AcceptNavigation"), QLatin1String("i"));
+        QVERIFY(!instant.isEmpty());
+
+        const QJsonObject asyncBegin = findEvent(events, QLatin1String("PageLoad"), QLatin1String("b"));
+        const QJsonObject asyncEnd = findEvent(events, QLatin1String("PageLoad"), QLatin1String("e"));
+        QCOMPARE(asyncBegin.value(QLatin1String("id")).toString(), QLatin1String("0xabc"));
+        QCOMPARE(asyncEnd.value(QLatin1String("id")).toString(), QLatin1String("0xabc"));
+        QVERIFY(asyncEnd.value(QLatin1String("ts")).toDouble() >= asyncBegin.value(QLatin1String("ts")).toDouble());
+    }
+
+    /// Verifies that events recorded on several threads are all written, each with its own thread identifier,
+    /// even after their threads have exited
+    void testEventsFromSeveralThreads()
+    {
+        Tracer &tracer = Tracer::instance();
+        tracer.start(m_traceFile.toStdString());
+
+        constexpr int numThreads = 4, numSpans = 1000;
+        std::vector<std::thread> threads;
+        for (int i = 0; i < numThreads; ++i)
+        {
+            threads.emplace_back([i](){
+                Tracer::instance().setThreadName("Worker " + std::to_string(i));
+                for (int j = 0; j < numSpans; ++j)
+                {
+                    VIPER_TRACE_SCOPE("test", "WorkItem");
+                }
+            });
+        }
+        for (std::thread &thread : threads)
+            thread.join();
+
+        QCOMPARE(tracer.getNumEvents(), size_t{numThreads * numSpans});
+
+        QSet<int> threadIds;
+        const QJsonArray events = getTraceEvents();
+        for (const QJsonValue &value : events)
+        {
+            const QJsonObject event = value.toObject();
+            if (event.value(QLatin1String("name")).toString() == QLatin1String("WorkItem"))
+                threadIds.insert(event.value(QLatin1String("tid")).toInt());
+        }
+        QCOMPARE(threadIds.size(), numThreads);
+    }
+
+    /// Verifies that the trace is written to the file given when tracing was started, and that
+    /// restarting the tracer discards the previous events
+    void testTraceIsWrittenToFile()
+    {
+        Tracer &tracer = Tracer::instance();
+        tracer.start(m_traceFile.toStdString());
+        tracer.addInstantEvent("test", "First");
+        QVERIFY(tracer.stop());
+
+        QFile file(m_traceFile);
+        QVERIFY(file.open(QIODevice::ReadOnly));
+        const QJsonDocument document = QJsonDocument::fromJson(file.readAll());
+        QVERIFY(!findEvent(document.object().value(QLatin1String("traceEvents")).toArray(), QLatin1String("First"), QLatin1String("i")).isEmpty());
+
+        tracer.start(m_traceFile.toStdString());
+        QCOMPARE(tracer.getNumEvents(), size_t{0});
+    }
+
+    /// Measures the cost of a scoped span while tracing is disabled
+    void benchmarkDisabledSpan()
+    {
+        QVERIFY(!Tracer::isEnabled());
+
+        QBENCHMARK {
+            for (int i = 0; i < 100000; ++i)
+            {
+                VIPER_TRACE_SCOPE("test", "Disabled");
+            }
+        }
+    }
+
+    /// Measures the cost of a scoped span while tracing is enabled
+    void benchmarkEnabledSpan()
+    {
+        Tracer &tracer = Tracer::instance();
+        tracer.start(m_traceFile.toStdString());
+
+        QBENCHMARK {
+            for (int i = 0; i < 10000; ++i)
+            {
+                VIPER_TRACE_SCOPE("test", "Enabled");
+            }
+        }
+    }
+
+private:
+    /// Path of the trace file written by the tests
+    const QString m_traceFile;
+};
+
+QTEST_APPLESS_MAIN(TracerTest)
+
+#include "TracerTest.moc"
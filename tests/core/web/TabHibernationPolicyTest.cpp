@@ -0,0 +1,200 @@
+#include "TabHibernationPolicy.h"
+
+#include <chrono>
+#include <vector>
+
+#include <QObject>
+#include <QTest>
+
+using namespace std::chrono_literals;
+
+/// Test cases for the \ref TabHibernationPolicy class, driven by a fake clock and a fake memory source
+class TabHibernationPolicyTest : public QObject
+{
+    Q_OBJECT
+
+public:
+    TabHibernationPolicyTest() :
+        QObject(nullptr),
+        m_now(0),
+        m_memory{ 16 * 1024 * 1024, 8 * 1024 * 1024 }
+    {
+    }
+
+private:
+    /// Returns a policy that reads the fake clock and memory source of the test
+    TabHibernationPolicy makePolicy()
+    {
+        return TabHibernationPolicy([this](){ return m_now; }, [this](){ return m_memory; });
+    }
+
+    /// Adds the given number of awake tabs to the policy, one minute apart, with identifiers starting at 1
+    void addTabs(TabHibernationPolicy &policy, int numTabs)
+    {
+        for (int i = 1; i <= numTabs; ++i)
+        {
+            policy.addTab(static_cast<uintptr_t>(i), false);
+            m_now += 1min;
+        }
+    }
+
+    /// Returns the identifiers of the tabs chosen by the policy, in the order they were chosen
+    std::vector<uintptr_t> getChosenTabs(const TabHibernationPolicy &policy)
+    {
+        std::vector<uintptr_t> tabs;
+        for (const TabHibernationPolicy::Decision &decision : policy.evaluate())
+            tabs.push_back(decision.TabId);
+        return tabs;
+    }
+
+private slots:
+    /// Resets the fake clock and memory source before each test
+    void init()
+    {
+        m_now = 0ms;
+        m_memory = { 16 * 1024 * 1024, 8 * 1024 * 1024 };
+    }
+
+    /// Verifies that nothing is hibernated while every limit is disabled
+    void testLimitsAreDisabledByDefault()
+    {
+        TabHibernationPolicy policy = makePolicy();
+        addTabs(policy, 10);
+
+        m_now += 24h;
+        m_memory.AvailableKiB = 0;
+        QVERIFY(policy.evaluate().empty());
+    }
+
+    /// Verifies that tabs which were not used for longer than the idle timeout are hibernated, least recently
+    /// used first, and that using a tab again restarts its timeout
+    void testIdleTabsAreHibernated()
+    {
+        TabHibernationPolicy policy = makePolicy();
+        policy.setIdleTimeout(30min);
+        addTabs(policy, 4);
+
+        // Tab 4 is active, and tab 1 is used again just before the timeout of the oldest tabs expires
+        policy.setTabActive(4, true);
+        m_now = 29min;
+        policy.setTabActive(1, true);
+        policy.setTabActive(1, false);
+        QVERIFY(policy.evaluate().empty());
+
+        m_now = 32min;
+        const std::vector<TabHibernationPolicy::Decision> decisions = policy.evaluate();
+        QCOMPARE(decisions.size(), size_t{2});
+        QCOMPARE(decisions[0].TabId, uintptr_t{2});
+        QCOMPARE(decisions[1].TabId, uintptr_t{3});
+        QVERIFY(decisions[0].Cause == TabHibernationPolicy::Reason::IdleTimeout);
+
+        // The active tab is never hibernated, however long it stays active
+        m_now = 10h;
+        policy.setTabHibernating(2, true);
+        policy.setTabHibernating(3, true);
+        QCOMPARE(getChosenTabs(policy), std::vector<uintptr_t>{ 1 });
+    }
+
+    /// Verifies that the least recently used tabs are hibernated while more tabs are awake than the budget allows
+    void testTabBudget()
+    {
+        TabHibernationPolicy policy = makePolicy();
+        policy.setTabBudget(3);
+        addTabs(policy, 6);
+        policy.setTabActive(1, true);
+
+        const std::vector<TabHibernationPolicy::Decision> decisions = policy.evaluate();
+        QCOMPARE(decisions.size(), size_t{3});
+        QCOMPARE(decisions[0].TabId, uintptr_t{2});
+        QCOMPARE(decisions[1].TabId, uintptr_t{3});
+        QCOMPARE(decisions[2].TabId, uintptr_t{4});
+        QVERIFY(decisions[2].Cause == TabHibernationPolicy::Reason::TabBudget);
+
+        for (const TabHibernationPolicy::Decision &decision : decisions)
+            policy.setTabHibernating(decision.TabId, true);
+        QCOMPARE(policy.getNumAwakeTabs(), 3);
+        QVERIFY(policy.evaluate().empty());
+
+        // A tab that wakes up counts as used, so another tab makes room for it
+        m_now += 1min;
+        policy.setTabHibernating(2, false);
+        QCOMPARE(getChosenTabs(policy), std::vector<uintptr_t>{ 5 });
+    }
+
+    /// Verifies that a share of the background tabs is hibernated while the system is low on memory
+    void testMemoryPressure()
+    {
+        TabHibernationPolicy policy = makePolicy();
+        policy.setMemoryPressureThreshold(10);
+        addTabs(policy, 9);
+        policy.setTabActive(9, true);
+
+        QVERIFY(!policy.isUnderMemoryPressure());
+        QVERIFY(policy.evaluate().empty());
+
+        m_memory.AvailableKiB = m_memory.TotalKiB / 20;
+        QVERIFY(policy.isUnderMemoryPressure());
+
+        const std::vector<TabHibernationPolicy::Decision> decisions = policy.evaluate();
+        QCOMPARE(decisions.size(), size_t{2});
+        QCOMPARE(decisions[0].TabId, uintptr_t{1});
+        QCOMPARE(decisions[1].TabId, uintptr_t{2});
+        QVERIFY(decisions[0].Cause == TabHibernationPolicy::Reason::MemoryPressure);
+
+        // Unknown memory states are not considered to be under pressure
+        m_memory = { -1, -1 };
+        QVERIFY(!policy.isUnderMemoryPressure());
+        QVERIFY(policy.evaluate().empty());
+    }
+
+    /// Verifies that pinned tabs, tabs playing audio and tabs with unsaved form input are never hibernated, and
+    /// that the next least recently used tabs are chosen instead
+    void testExemptTabsStayAwake()
+    {
+        TabHibernationPolicy policy = makePolicy();
+        policy.setTabBudget(2);
+        policy.setMemoryPressureThreshold(10);
+        addTabs(policy, 6);
+        policy.setTabActive(6, true);
+
+        policy.setTabPinned(1, true);
+        policy.setTabPlayingAudio(2, true);
+        policy.setTabHasFormInput(3, true);
+        QCOMPARE(getChosenTabs(policy), (std::vector<uintptr_t>{ 4, 5 }));
+
+        policy.setTabHibernating(4, true);
+        policy.setTabHibernating(5, true);
+        m_now += 24h;
+        m_memory.AvailableKiB = 0;
+        QVERIFY(policy.evaluate().empty());
+
+        // Tabs can be hibernated again once they are no longer exempt
+        policy.setTabPlayingAudio(2, false);
+        QCOMPARE(getChosenTabs(policy), std::vector<uintptr_t>{ 2 });
+    }
+
+    /// Verifies that tabs used at the same time are chosen in the order they were added, and that removed tabs
+    /// are forgotten
+    void testDecisionsAreDeterministic()
+    {
+        TabHibernationPolicy policy = makePolicy();
+        policy.setTabBudget(1);
+        for (uintptr_t tabId : { 7, 3, 9, 5 })
+            policy.addTab(tabId, false);
+        policy.removeTab(9);
+
+        QCOMPARE(getChosenTabs(policy), (std::vector<uintptr_t>{ 7, 3 }));
+        QCOMPARE(getChosenTabs(policy), (std::vector<uintptr_t>{ 7, 3 }));
+    }
+
+private:
+    /// Current time of the fake clock
+    std::chrono::milliseconds m_now;
+
+    /// Current state of the fake memory source
+    TabHibernationPolicy::SystemMemory m_memory;
+};
+
+QTEST_APPLESS_MAIN(TabHibernationPolicyTest)
+
+#include "TabHibernationPolicyTest.moc"
@@ -0,0 +1,215 @@
+#include "ProcessStatsReader.h"
+#include "TabResourceModel.h"
+
+#include <chrono>
+#include <vector>
+
+#include <QDir>
+#include <QFile>
+#include <QMetaObject>
+#include <QObject>
+#include <QTemporaryDir>
+#include <QTest>
+
+using namespace std::chrono_literals;
+
+/// Test cases for the \ref TabResourceModel class, driven by fake tabs, a fake clock and a fake proc filesystem
+class TabResourceModelTest : public QObject
+{
+    Q_OBJECT
+
+public:
+    TabResourceModelTest() :
+        QObject(nullptr),
+        m_procDir(),
+        m_now(0),
+        m_sampleDuration(0),
+        m_tabs()
+    {
+    }
+
+private:
+    /// Writes the statm, smaps_rollup and stat files of a fake process
+    void writeProcess(int pid, int64_t residentPages, int64_t proportionalKiB, int64_t cpuTicks)
+    {
+        QDir(m_procDir.path()).mkpath(QString::number(pid));
+
+        const QString processPath = QStringLiteral("%1/%2/").arg(m_procDir.path()).arg(pid);
+        writeFile(processPath + QStringLiteral("statm"), QStringLiteral("50000 %1 1000 10 0 4000 0\n").arg(residentPages).toLatin1());
+        writeFile(processPath + QStringLiteral("smaps_rollup"), QStringLiteral("Rss: 1 kB\nPss: %1 kB\n").arg(proportionalKiB).toLatin1());
+        writeFile(processPath + QStringLiteral("stat"),
+                  QStringLiteral("%1 (QtWebEngineProcess) S 1 1 1 0 -1 0 0 0 0 0 %2 0 0 0 20 0 1 0\n").arg(pid).arg(cpuTicks).toLatin1());
+    }
+
+    void writeFile(const QString &fileName, const QByteArray &contents)
+    {
+        QFile file(fileName);
+        QVERIFY(file.open(QIODevice::WriteOnly | QIODevice::Truncate));
+        file.write(contents);
+    }
+
+    /// Returns a model of the fake tabs. Each sample advances the fake clock by the sample duration
+    TabResourceModel *makeModel()
+    {
+        auto tabSource = [this](){
+            m_now += m_sampleDuration;
+            return m_tabs;
+        };
+        return new TabResourceModel(tabSource, [this](){ return m_now; }, m_procDir.path(), this);
+    }
+
+    /// Returns the raw value of a column of the given row
+    QVariant rawValue(TabResourceModel *model, int row, int column)
+    {
+        return model->data(model->index(row, column), Qt::UserRole);
+    }
+
+private Q_SLOTS:
+    void init()
+    {
+        m_now = 0ms;
+        m_sampleDuration = 0ms;
+        m_tabs = {
+            { QStringLiteral("A"), QIcon(), 100, TabLifecycle::Active },
+            { QStringLiteral("B"), QIcon(), 100, TabLifecycle::Frozen },
+            { QStringLiteral("C"), QIcon(), 200, TabLifecycle::Active },
+            { QStringLiteral("D"), QIcon(), 0, TabLifecycle::Hibernated }
+        };
+        writeProcess(100, 1000, 6000, 0);
+        writeProcess(200, 500, 1500, 0);
+    }
+
+    /// Verifies that the usage of a shared renderer process is divided between its tabs
+    void testSharedProcessIsDividedBetweenTabs()
+    {
+        TabResourceModel *model = makeModel();
+        model->sample();
+
+        const int64_t pageSizeKiB = ProcessStatsReader(m_procDir.path()).getPageSizeKiB();
+        QCOMPARE(model->rowCount(), 4);
+        QCOMPARE(rawValue(model, 0, TabResourceModel::MemoryColumn).toLongLong(), 500 * pageSizeKiB);
+        QCOMPARE(rawValue(model, 1, TabResourceModel::ProportionalMemoryColumn).toLongLong(), qlonglong{3000});
+        QCOMPARE(rawValue(model, 2, TabResourceModel::MemoryColumn).toLongLong(), 500 * pageSizeKiB);
+        QCOMPARE(rawValue(model, 2, TabResourceModel::ProportionalMemoryColumn).toLongLong(), qlonglong{1500});
+
+        // Hibernating tabs have no usage
+        QCOMPARE(rawValue(model, 3, TabResourceModel::MemoryColumn).toLongLong(), qlonglong{-1});
+        QCOMPARE(model->data(model->index(3, TabResourceModel::ProcessColumn)).toString(), QString());
+    }
+
+    /// Verifies that the lifecycle stage of each tab is shown, and sorts from active to hibernated
+    void testShowsLifecycle()
+    {
+        TabResourceModel *model = makeModel();
+        model->sample();
+
+        QCOMPARE(model->data(model->index(0, TabResourceModel::LifecycleColumn)).toString(), QStringLiteral("Active"));
+        QCOMPARE(model->data(model->index(1, TabResourceModel::LifecycleColumn)).toString(), QStringLiteral("Frozen"));
+        QCOMPARE(model->data(model->index(3, TabResourceModel::LifecycleColumn)).toString(), QStringLiteral("Hibernated"));
+        QVERIFY(rawValue(model, 1, TabResourceModel::LifecycleColumn).toInt() < rawValue(model, 3, TabResourceModel::LifecycleColumn).toInt());
+    }
+
+    /// Verifies that CPU usage is measured between two samples, against the clock
+    void testCpuUsageBetweenSamples()
+    {
+        TabResourceModel *model = makeModel();
+        model->sample();
+        QCOMPARE(rawValue(model, 2, TabResourceModel::CpuColumn).toDouble(), -1.0);
+
+        // Half a second of CPU time over two seconds is a quarter of a core, split by the tabs of the process
+        const int64_t ticksPerSecond = ProcessStatsReader(m_procDir.path()).getTicksPerSecond();
+        writeProcess(100, 1000, 6000, ticksPerSecond / 2);
+        writeProcess(200, 500, 1500, ticksPerSecond);
+        m_now = 2000ms;
+        model->sample();
+
+        QCOMPARE(rawValue(model, 0, TabResourceModel::CpuColumn).toDouble(), 12.5);
+        QCOMPARE(rawValue(model, 2, TabResourceModel::CpuColumn).toDouble(), 50.0);
+    }
+
+    /// Verifies that the proportional set size is only read every few samples
+    void testProportionalMemoryIsReadPeriodically()
+    {
+        TabResourceModel *model = makeModel();
+        model->sample();
+
+        writeProcess(200, 500, 3000, 0);
+        for (int i = 1; i < TabResourceModel::ProportionalMemoryInterval; ++i)
+        {
+            model->sample();
+            QCOMPARE(rawValue(model, 2, TabResourceModel::ProportionalMemoryColumn).toLongLong(), qlonglong{1500});
+        }
+
+        model->sample();
+        QCOMPARE(rawValue(model, 2, TabResourceModel::ProportionalMemoryColumn).toLongLong(), qlonglong{3000});
+    }
+
+    /// Verifies that closing a tab that shared a process gives the remaining tab the whole process
+    void testClosedTabsAreRemoved()
+    {
+        TabResourceModel *model = makeModel();
+        model->sample();
+
+        m_tabs.erase(m_tabs.begin());
+        model->sample();
+
+        const int64_t pageSizeKiB = ProcessStatsReader(m_procDir.path()).getPageSizeKiB();
+        QCOMPARE(model->rowCount(), 3);
+        QCOMPARE(rawValue(model, 0, TabResourceModel::MemoryColumn).toLongLong(), 1000 * pageSizeKiB);
+        QCOMPARE(model->data(model->index(0, TabResourceModel::ProcessColumn)).toString(), QStringLiteral("100"));
+    }
+
+    /// Verifies that a cheap sampler keeps the default interval, including after the sample taken when it starts
+    void testCheapSamplingKeepsInterval()
+    {
+        m_sampleDuration = 1ms;
+        TabResourceModel *model = makeModel();
+        model->start();
+        QCOMPARE(model->getSamplingInterval(), 2000);
+        QCOMPARE(model->getSamplingOverhead(), 0.0);
+
+        for (int i = 0; i < 3; ++i)
+        {
+            QVERIFY(QMetaObject::invokeMethod(model, "onSamplingTimeout", Qt::DirectConnection));
+            QCOMPARE(model->getSamplingInterval(), 2000);
+            QCOMPARE(model->getSamplingOverhead(), 0.05);
+        }
+
+        model->stop();
+    }
+
+    /// Verifies that the sampling interval is doubled when a sample takes too long, until samples are cheap enough
+    void testExpensiveSamplingSlowsDown()
+    {
+        m_sampleDuration = 3ms;
+        TabResourceModel *model = makeModel();
+        model->start();
+
+        QVERIFY(QMetaObject::invokeMethod(model, "onSamplingTimeout", Qt::DirectConnection));
+        QCOMPARE(model->getSamplingOverhead(), 0.15);
+        QCOMPARE(model->getSamplingInterval(), 4000);
+
+        QVERIFY(QMetaObject::invokeMethod(model, "onSamplingTimeout", Qt::DirectConnection));
+        QCOMPARE(model->getSamplingOverhead(), 0.075);
+        QCOMPARE(model->getSamplingInterval(), 4000);
+
+        model->stop();
+    }
+
+private:
+    /// Fake proc filesystem
+    QTemporaryDir m_procDir;
+
+    /// Fake clock
+    std::chrono::nanoseconds m_now;
+
+    /// Time by which the fake clock advances during each sample
+    std::chrono::nanoseconds m_sampleDuration;
+
+    /// Fake tabs
+    std::vector<TabResourceModel::Tab> m_tabs;
+};
+
+QTEST_GUILESS_MAIN(TabResourceModelTest)
+
+#include "TabResourceModelTest.moc"